@@ -22,12 +22,16 @@
 
 
 /**
- * MODIFY THIS to configure which modules are connected to which power channels!
+ * Set MODULES_PER_POWER_CHANNEL (see config.h) to configure which modules are connected to which power channels;
+ * SplitflapTask's power scheduler uses the same mapping to budget each channel's current.
  */
 uint8_t BaseSupervisorTask::getPowerChannelForModuleIndex(uint8_t module_index) {
-    return module_index / 36;
+    return module_index / MODULES_PER_POWER_CHANNEL;
 }
 
+static_assert((NUM_MODULES - 1) / MODULES_PER_POWER_CHANNEL < NUM_POWER_CHANNELS, "More modules than power channels; raise MODULES_PER_POWER_CHANNEL");
+static_assert(POWER_CHANNEL_BUDGET_MA < ABSOLUTE_MAX_CHANNEL_CURRENT_MA, "POWER_CHANNEL_BUDGET_MA must leave headroom under ABSOLUTE_MAX_CHANNEL_CURRENT_MA");
+
 /** Maps power channel index (0-4) to MCP GPIO pin. */
 static const uint8_t MCP_PIN_CHANNEL_EN[NUM_POWER_CHANNELS] = {
     5,
@@ -234,7 +238,8 @@ void BaseSupervisorTask::runStateNormal() {
     uint8_t homing[NUM_POWER_CHANNELS] = {};
     for (uint8_t i = 0; i < NUM_MODULES; i++) {
         uint8_t power_channel = getPowerChannelForModuleIndex(i);
-        if (splitflap_state_.modules[i].moving) {
+        // Modules waiting for a power slot are at rest, so they don't count towards the expected current
+        if (splitflap_state_.modules[i].moving && !splitflap_state_.modules[i].waiting_for_power) {
             if (splitflap_state_.modules[i].state == State::LOOK_FOR_HOME) {
                 homing[power_channel]++;
             } else {
@@ -353,7 +358,8 @@ void BaseSupervisorTask::readPower() {
 }
 
 void BaseSupervisorTask::updateSplitflapState() {
-    splitflap_state_ = splitflap_task_.getState();
+    ModuleBitmask changed_modules;
+    splitflap_state_generation_ = splitflap_task_.getStateChanges(splitflap_state_generation_, splitflap_state_, changed_modules);
 }
 
 void BaseSupervisorTask::fault(PB_SupervisorState_FaultInfo_FaultType type, const char* msg) {
@@ -0,0 +1,133 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "command_mailbox.h"
+
+static_assert(CommandMailbox::NO_FLAP == CommandMailbox::NO_ACTION, "Slots share one empty marker");
+
+// Stamps wrap around, so compare them by difference
+static bool isBefore(uint32_t sequence, uint32_t before) {
+    return (int32_t)(sequence - before) < 0;
+}
+
+uint32_t CommandMailbox::nextSequence() {
+    portENTER_CRITICAL(&lock_);
+    uint32_t sequence = next_sequence_++;
+    portEXIT_CRITICAL(&lock_);
+    return sequence;
+}
+
+uint32_t CommandMailbox::sequence() {
+    portENTER_CRITICAL(&lock_);
+    uint32_t sequence = next_sequence_;
+    portEXIT_CRITICAL(&lock_);
+    return sequence;
+}
+
+void CommandMailbox::post(ModuleSlots& slots, const uint8_t value[NUM_MODULES], uint32_t sequence) {
+    for (uint8_t i = 0; i < NUM_MODULES; i++) {
+        if (value[i] != NO_ACTION) {
+            slots.value[i] = value[i];
+            slots.sequence[i] = sequence;
+            slots.dirty[i / 32] |= 1UL << (i % 32);
+        }
+    }
+}
+
+bool CommandMailbox::take(ModuleSlots& slots, uint32_t before, uint8_t value[NUM_MODULES]) {
+    bool any = false;
+    for (uint8_t word = 0; word < sizeof(slots.dirty) / sizeof(slots.dirty[0]); word++) {
+        uint32_t dirty = slots.dirty[word];
+        while (dirty != 0) {
+            uint8_t bit = __builtin_ctz(dirty);
+            dirty &= dirty - 1;
+            uint8_t i = word * 32 + bit;
+            if (isBefore(slots.sequence[i], before)) {
+                value[i] = slots.value[i];
+                slots.dirty[word] &= ~(1UL << bit);
+                any = true;
+            }
+        }
+    }
+    return any;
+}
+
+void CommandMailbox::postFlaps(const uint8_t flap_index[NUM_MODULES]) {
+    portENTER_CRITICAL(&lock_);
+    post(flaps_, flap_index, next_sequence_++);
+    portEXIT_CRITICAL(&lock_);
+}
+
+void CommandMailbox::postConfigs(const ModuleConfigs& configs) {
+    portENTER_CRITICAL(&lock_);
+    configs_ = configs;
+    configs_sequence_ = next_sequence_++;
+    configs_dirty_ = true;
+    portEXIT_CRITICAL(&lock_);
+}
+
+void CommandMailbox::postActions(const uint8_t action[NUM_MODULES]) {
+    portENTER_CRITICAL(&lock_);
+    post(actions_, action, next_sequence_++);
+    for (uint8_t i = 0; i < NUM_MODULES; i++) {
+        if (action[i] != NO_ACTION) {
+            flaps_.dirty[i / 32] &= ~(1UL << (i % 32));
+        }
+    }
+    portEXIT_CRITICAL(&lock_);
+}
+
+void CommandMailbox::postLeds(const uint8_t led[NUM_MODULES]) {
+    portENTER_CRITICAL(&lock_);
+    post(leds_, led, next_sequence_++);
+    portEXIT_CRITICAL(&lock_);
+}
+
+bool CommandMailbox::takeFlaps(uint32_t before, uint8_t flap_index[NUM_MODULES]) {
+    memset(flap_index, NO_FLAP, NUM_MODULES);
+    portENTER_CRITICAL(&lock_);
+    bool any = take(flaps_, before, flap_index);
+    portEXIT_CRITICAL(&lock_);
+    return any;
+}
+
+bool CommandMailbox::takeConfigs(uint32_t before, ModuleConfigs& configs, uint32_t& sequence) {
+    bool taken = false;
+    portENTER_CRITICAL(&lock_);
+    if (configs_dirty_ && isBefore(configs_sequence_, before)) {
+        configs = configs_;
+        sequence = configs_sequence_;
+        configs_dirty_ = false;
+        taken = true;
+    }
+    portEXIT_CRITICAL(&lock_);
+    return taken;
+}
+
+bool CommandMailbox::takeActions(uint32_t before, uint8_t action[NUM_MODULES]) {
+    memset(action, NO_ACTION, NUM_MODULES);
+    portENTER_CRITICAL(&lock_);
+    bool any = take(actions_, before, action);
+    portEXIT_CRITICAL(&lock_);
+    return any;
+}
+
+bool CommandMailbox::takeLeds(uint32_t before, uint8_t led[NUM_MODULES]) {
+    memset(led, NO_ACTION, NUM_MODULES);
+    portENTER_CRITICAL(&lock_);
+    bool any = take(leds_, before, led);
+    portEXIT_CRITICAL(&lock_);
+    return any;
+}
@@ -0,0 +1,112 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#pragma once
+
+#include <Arduino.h>
+
+#include "config.h"
+
+struct ModuleConfig {
+    uint8_t target_flap_index;
+    uint8_t movement_nonce;
+    uint8_t reset_nonce;
+};
+
+struct ModuleConfigs {
+    ModuleConfig config[NUM_MODULES];
+    // Delay the start of the modules this moves so that they all arrive at the same time
+    bool synchronized_arrival;
+};
+
+/**
+ * Latest-wins slots for the commands that set where modules should go, which are by far the most frequent ones
+ * (every MQTT message, serial config, etc). Each module has one flap target slot, flagged in a dirty bitmask, and
+ * there's a single slot for the latest SplitflapConfig. Posting overwrites whatever is still waiting in a slot
+ * instead of queueing behind it, so producers never block and the motion loop only ever acts on the newest
+ * targets, however far behind it is.
+ *
+ * Module actions (resets and disables) and LEDs get per-module slots of their own, the same way. They're rarer, but
+ * they come in bursts (resetAll(), an LED chase in the tester, a fault disabling everything) and must never be
+ * dropped or wait behind other commands. Only the latest action for a module matters: a reset clears the module's
+ * target and a disabled module can't move, so an action also drops the module's older flap target, and any flap
+ * target still waiting in the mailbox is always newer than the module's waiting action.
+ *
+ * Every post is stamped from a shared sequence counter, which SplitflapTask also stamps its queued commands with,
+ * so that targets and queued commands (offsets, QUEUE_FLAPS, etc) still take effect in the order they were posted.
+ *
+ * Posts and takes copy in and out under a spinlock, so each post is published all at once; the copies are short
+ * enough that nobody waits noticeably.
+ */
+class CommandMailbox {
+    public:
+        // Leaves the module alone in postFlaps(), postActions() and postLeds(), and marks modules without a new
+        // one in takeFlaps(), takeActions() and takeLeds()
+        static const uint8_t NO_FLAP = 0xFF;
+        static const uint8_t NO_ACTION = 0xFF;
+
+        CommandMailbox() {}
+
+        /** Stamp for a command posted by other means, ordering it after everything posted here so far */
+        uint32_t nextSequence();
+
+        /** Stamp that everything posted so far comes before */
+        uint32_t sequence();
+
+        void postFlaps(const uint8_t flap_index[NUM_MODULES]);
+        void postConfigs(const ModuleConfigs& configs);
+        /** Posts each module's action (a QCMD_* command), dropping any older flap target the module has waiting */
+        void postActions(const uint8_t action[NUM_MODULES]);
+        /** Posts each module's LED command (QCMD_LED_ON or QCMD_LED_OFF) */
+        void postLeds(const uint8_t led[NUM_MODULES]);
+
+        /**
+         * Takes the latest flap target of every module that got one posted before `before`. Returns false if there
+         * weren't any.
+         */
+        bool takeFlaps(uint32_t before, uint8_t flap_index[NUM_MODULES]);
+
+        /** Takes the latest configs if they were posted before `before`, along with their stamp */
+        bool takeConfigs(uint32_t before, ModuleConfigs& configs, uint32_t& sequence);
+
+        /** Like takeFlaps(), for actions. Apply these before the flap targets taken with the same `before`. */
+        bool takeActions(uint32_t before, uint8_t action[NUM_MODULES]);
+
+        /** Like takeFlaps(), for LEDs */
+        bool takeLeds(uint32_t before, uint8_t led[NUM_MODULES]);
+
+    private:
+        // One latest-wins value per module, with a bit set in `dirty` while it's waiting to be taken
+        struct ModuleSlots {
+            uint32_t dirty[(NUM_MODULES + 31) / 32] = {};
+            uint8_t value[NUM_MODULES] = {};
+            uint32_t sequence[NUM_MODULES] = {};
+        };
+
+        // Call with lock_ held. NO_FLAP and NO_ACTION are the same, so either marks an empty slot.
+        void post(ModuleSlots& slots, const uint8_t value[NUM_MODULES], uint32_t sequence);
+        bool take(ModuleSlots& slots, uint32_t before, uint8_t value[NUM_MODULES]);
+
+        portMUX_TYPE lock_ = portMUX_INITIALIZER_UNLOCKED;
+        uint32_t next_sequence_ = 0;
+
+        ModuleSlots flaps_;
+        ModuleSlots actions_;
+        ModuleSlots leds_;
+
+        bool configs_dirty_ = false;
+        ModuleConfigs configs_ = {};
+        uint32_t configs_sequence_ = 0;
+};
@@ -75,14 +75,35 @@ bool Configuration::loadFromDisk() {
         pb_buffer_ = {};
         return false;
     }
+
+    uint16_t stored_steps = pb_buffer_.steps_per_revolution == 0 ? 2048 : pb_buffer_.steps_per_revolution;
+    if (stored_steps != STEPS_PER_REVOLUTION) {
+        // Saved by firmware with the other HALF_STEP setting; offsets are still valid once rescaled, but the rest
+        // positions can't be trusted to line up with the motor phases any more
+        for (uint8_t i = 0; i < pb_buffer_.module_offset_steps_count; i++) {
+            pb_buffer_.module_offset_steps[i] = (uint32_t)pb_buffer_.module_offset_steps[i] * STEPS_PER_REVOLUTION / stored_steps;
+        }
+        // The default ramps for the two modes have the same speed at proportional accel steps
+        for (uint8_t i = 0; i < pb_buffer_.module_max_accel_step_count; i++) {
+            pb_buffer_.module_max_accel_step[i] = (uint32_t)pb_buffer_.module_max_accel_step[i] * STEPS_PER_REVOLUTION / stored_steps;
+        }
+        pb_buffer_.clean_shutdown = false;
+        pb_buffer_.steps_per_revolution = STEPS_PER_REVOLUTION;
+
+        char buf[200];
+        snprintf(buf, sizeof(buf), "Converted offsets from %u to %u steps per revolution", stored_steps, STEPS_PER_REVOLUTION);
+        log(buf);
+    }
     loaded_ = true;
 
     char buf[200];
     snprintf(
         buf,
         sizeof(buf),
-        "Loaded %u offsets",
-        pb_buffer_.module_offset_steps_count
+        "Loaded %u offsets and %u motion profiles (%s)",
+        pb_buffer_.module_offset_steps_count,
+        pb_buffer_.module_motion_profile_count,
+        pb_buffer_.clean_shutdown ? "clean shutdown" : "no clean shutdown"
     );
     log(buf);
 
@@ -113,6 +134,7 @@ bool Configuration::saveToDisk() {
 
     pb_ostream_t stream = pb_ostream_from_buffer(buffer_, sizeof(buffer_));
     pb_buffer_.version = PERSISTENT_CONFIGURATION_VERSION;
+    pb_buffer_.steps_per_revolution = STEPS_PER_REVOLUTION;
     if (!pb_encode(&stream, PB_PersistentConfiguration_fields, &pb_buffer_)) {
         char buf[200];
         snprintf(buf, sizeof(buf), "Encoding failed: %s", PB_GET_ERROR(&stream));
@@ -164,6 +186,72 @@ bool Configuration::setModuleOffsetsAndSave(uint16_t offsets[NUM_MODULES]) {
     return saveToDisk();
 }
 
+bool Configuration::setModuleCalibrationAndSave(uint16_t offsets[NUM_MODULES], uint8_t motion_profiles[NUM_MODULES]) {
+    {
+        SemaphoreGuard lock(mutex_);
+        pb_buffer_.num_flaps = NUM_FLAPS;
+        pb_buffer_.module_offset_steps_count = NUM_MODULES;
+        pb_buffer_.module_motion_profile_count = NUM_MODULES;
+        for (uint8_t i = 0; i < NUM_MODULES; i++) {
+            pb_buffer_.module_offset_steps[i] = offsets[i];
+            pb_buffer_.module_motion_profile[i] = motion_profiles[i];
+        }
+    }
+    return saveToDisk();
+}
+
+bool Configuration::setModuleMaxAccelStepsAndSave(uint8_t max_accel_steps[NUM_MODULES]) {
+    {
+        SemaphoreGuard lock(mutex_);
+        pb_buffer_.num_flaps = NUM_FLAPS;
+        pb_buffer_.module_max_accel_step_count = NUM_MODULES;
+        for (uint8_t i = 0; i < NUM_MODULES; i++) {
+            pb_buffer_.module_max_accel_step[i] = max_accel_steps[i];
+        }
+    }
+    return saveToDisk();
+}
+
+/**
+ * Where the module was left at rest, if the last shutdown was clean (see setCleanShutdownAndSave()). The offset is
+ * the saved calibration offset, or 0 if there isn't one.
+ */
+bool Configuration::getRestPosition(uint8_t module, uint16_t& offset, uint16_t& step, uint8_t& phase, uint8_t& flap_index) {
+    SemaphoreGuard lock(mutex_);
+    if (!loaded_ || !pb_buffer_.clean_shutdown
+            || module >= pb_buffer_.module_rest_step_count
+            || module >= pb_buffer_.module_rest_phase_count
+            || module >= pb_buffer_.module_rest_flap_index_count
+            || pb_buffer_.module_rest_step[module] == UINT16_MAX) {
+        return false;
+    }
+    offset = module < pb_buffer_.module_offset_steps_count ? pb_buffer_.module_offset_steps[module] : 0;
+    step = pb_buffer_.module_rest_step[module];
+    phase = pb_buffer_.module_rest_phase[module];
+    flap_index = pb_buffer_.module_rest_flap_index[module];
+    return true;
+}
+
+/** Updates a module's rest position in memory only; it's saved by the next setCleanShutdownAndSave(true). */
+void Configuration::setRestPosition(uint8_t module, uint16_t step, uint8_t phase, uint8_t flap_index) {
+    SemaphoreGuard lock(mutex_);
+    pb_buffer_.module_rest_step_count = NUM_MODULES;
+    pb_buffer_.module_rest_phase_count = NUM_MODULES;
+    pb_buffer_.module_rest_flap_index_count = NUM_MODULES;
+    pb_buffer_.module_rest_step[module] = step;
+    pb_buffer_.module_rest_phase[module] = phase;
+    pb_buffer_.module_rest_flap_index[module] = flap_index;
+}
+
+bool Configuration::setCleanShutdownAndSave(bool clean_shutdown) {
+    {
+        SemaphoreGuard lock(mutex_);
+        pb_buffer_.num_flaps = NUM_FLAPS;
+        pb_buffer_.clean_shutdown = clean_shutdown;
+    }
+    return saveToDisk();
+}
+
 void Configuration::setLogger(Logger* logger) {
     logger_ = logger;
 }
@@ -21,6 +21,7 @@
 #include "../proto_gen/splitflap.pb.h"
 
 #include "logger.h"
+#include "semaphore_guard.h"
 
 const uint32_t PERSISTENT_CONFIGURATION_VERSION = 1;
 
@@ -34,6 +35,12 @@ class Configuration {
         bool saveToDisk();
         PB_PersistentConfiguration get();
         bool setModuleOffsetsAndSave(uint16_t offsets[NUM_MODULES]);
+        bool setModuleCalibrationAndSave(uint16_t offsets[NUM_MODULES], uint8_t motion_profiles[NUM_MODULES]);
+        bool setModuleMaxAccelStepsAndSave(uint8_t max_accel_steps[NUM_MODULES]);
+
+        bool getRestPosition(uint8_t module, uint16_t& offset, uint16_t& step, uint8_t& phase, uint8_t& flap_index);
+        void setRestPosition(uint8_t module, uint16_t step, uint8_t phase, uint8_t flap_index);
+        bool setCleanShutdownAndSave(bool clean_shutdown);
 
     private:
         SemaphoreHandle_t mutex_;
@@ -46,22 +53,35 @@ class Configuration {
 
         void log(const char* msg);
 };
+/**
+ * Keeps FFat mounted while in scope. Guards can be held by several tasks at once (or for as long as a task needs
+ * the filesystem): it's mounted by the first and only unmounted when the last one goes away.
+ */
 class FatGuard {
     public:
         FatGuard(Logger* logger) : logger_(logger) {
-            if (!FFat.begin(true)) {
+            SemaphoreGuard lock(mutex());
+            if (users() == 0) {
+                if (!FFat.begin(true)) {
+                    if (logger_ != nullptr) {
+                        logger_->log("Failed to mount FFat");
+                    }
+                    return;
+                }
                 if (logger_ != nullptr) {
-                    logger_->log("Failed to mount FFat");
+                    logger_->log("Mounted FFat");
                 }
-                return;
-            }
-            if (logger_ != nullptr) {
-                logger_->log("Mounted FFat");
             }
+            users()++;
             mounted_ = true;
         }
         ~FatGuard() {
-            if (mounted_) {
+            if (!mounted_) {
+                return;
+            }
+            SemaphoreGuard lock(mutex());
+            users()--;
+            if (users() == 0) {
                 FFat.end();
                 if (logger_ != nullptr) {
                     logger_->log("Unmounted FFat");
@@ -75,4 +95,13 @@ class FatGuard {
 
     private:
         Logger* logger_;
+
+        static SemaphoreHandle_t mutex() {
+            static SemaphoreHandle_t mutex = xSemaphoreCreateMutex();
+            return mutex;
+        }
+        static uint8_t& users() {
+            static uint8_t users = 0;
+            return users;
+        }
 };
@@ -0,0 +1,133 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "configuration_save_task.h"
+
+ConfigurationSaveTask::ConfigurationSaveTask() : Task("ConfigurationSave", 4096, 0) {}
+
+void ConfigurationSaveTask::setConfiguration(Configuration* configuration) {
+    portENTER_CRITICAL(&lock_);
+    configuration_ = configuration;
+    portEXIT_CRITICAL(&lock_);
+}
+
+void ConfigurationSaveTask::setLogger(Logger* logger) {
+    portENTER_CRITICAL(&lock_);
+    logger_ = logger;
+    portEXIT_CRITICAL(&lock_);
+}
+
+void ConfigurationSaveTask::setRestPosition(uint8_t module, uint16_t step, uint8_t phase, uint8_t flap_index) {
+    portENTER_CRITICAL(&lock_);
+    rest_step_[module] = step;
+    rest_phase_[module] = phase;
+    rest_flap_index_[module] = flap_index;
+    portEXIT_CRITICAL(&lock_);
+}
+
+void ConfigurationSaveTask::requestSaveRestPositions() {
+    portENTER_CRITICAL(&lock_);
+    clean_shutdown_request_ = CleanShutdownRequest::SAVE;
+    portEXIT_CRITICAL(&lock_);
+    xTaskNotifyGive(getHandle());
+}
+
+void ConfigurationSaveTask::requestClearCleanShutdown() {
+    portENTER_CRITICAL(&lock_);
+    clean_shutdown_request_ = CleanShutdownRequest::CLEAR;
+    clearing_clean_shutdown_ = true;
+    portEXIT_CRITICAL(&lock_);
+    xTaskNotifyGive(getHandle());
+}
+
+bool ConfigurationSaveTask::cleanShutdownCleared() {
+    portENTER_CRITICAL(&lock_);
+    bool cleared = !clearing_clean_shutdown_;
+    portEXIT_CRITICAL(&lock_);
+    return cleared;
+}
+
+void ConfigurationSaveTask::requestSaveMaxAccelSteps(const uint8_t max_accel_steps[NUM_MODULES]) {
+    portENTER_CRITICAL(&lock_);
+    memcpy(max_accel_steps_, max_accel_steps, sizeof(max_accel_steps_));
+    max_accel_steps_requested_ = true;
+    portEXIT_CRITICAL(&lock_);
+    xTaskNotifyGive(getHandle());
+}
+
+void ConfigurationSaveTask::run() {
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // Keep going until nothing's left, since requests can arrive while a write is in progress
+        while (1) {
+            portENTER_CRITICAL(&lock_);
+            Configuration* configuration = configuration_;
+            CleanShutdownRequest clean_shutdown_request = clean_shutdown_request_;
+            clean_shutdown_request_ = CleanShutdownRequest::NONE;
+            if (clean_shutdown_request == CleanShutdownRequest::SAVE) {
+                memcpy(save_rest_step_, rest_step_, sizeof(save_rest_step_));
+                memcpy(save_rest_phase_, rest_phase_, sizeof(save_rest_phase_));
+                memcpy(save_rest_flap_index_, rest_flap_index_, sizeof(save_rest_flap_index_));
+            }
+            bool save_max_accel_steps = max_accel_steps_requested_;
+            max_accel_steps_requested_ = false;
+            if (save_max_accel_steps) {
+                memcpy(save_max_accel_steps_, max_accel_steps_, sizeof(save_max_accel_steps_));
+            }
+            portEXIT_CRITICAL(&lock_);
+
+            if (clean_shutdown_request == CleanShutdownRequest::NONE && !save_max_accel_steps) {
+                break;
+            }
+
+            if (configuration != nullptr) {
+                if (clean_shutdown_request == CleanShutdownRequest::SAVE) {
+                    for (uint8_t i = 0; i < NUM_MODULES; i++) {
+                        configuration->setRestPosition(i, save_rest_step_[i], save_rest_phase_[i], save_rest_flap_index_[i]);
+                    }
+                    if (!configuration->setCleanShutdownAndSave(true)) {
+                        log("ERROR - failed to save rest positions");
+                    }
+                } else if (clean_shutdown_request == CleanShutdownRequest::CLEAR) {
+                    if (!configuration->setCleanShutdownAndSave(false)) {
+                        log("ERROR - failed to clear saved rest positions");
+                    }
+                }
+                if (save_max_accel_steps && !configuration->setModuleMaxAccelStepsAndSave(save_max_accel_steps_)) {
+                    log("ERROR - failed to save learned module speeds");
+                }
+            }
+
+            if (clean_shutdown_request == CleanShutdownRequest::CLEAR) {
+                portENTER_CRITICAL(&lock_);
+                // Unless another clear was requested in the meantime, which still has to be written
+                if (clean_shutdown_request_ != CleanShutdownRequest::CLEAR) {
+                    clearing_clean_shutdown_ = false;
+                }
+                portEXIT_CRITICAL(&lock_);
+            }
+        }
+    }
+}
+
+void ConfigurationSaveTask::log(const char* msg) {
+    portENTER_CRITICAL(&lock_);
+    Logger* logger = logger_;
+    portEXIT_CRITICAL(&lock_);
+    if (logger != nullptr) {
+        logger->log(msg);
+    }
+}
@@ -0,0 +1,89 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#pragma once
+
+#include <Arduino.h>
+
+#include "config.h"
+#include "configuration.h"
+#include "logger.h"
+#include "task.h"
+
+/**
+ * Writes what SplitflapTask learns while it runs (the FAST_BOOT rest positions and clean shutdown marker, and the
+ * ADAPTIVE_SPEED top speeds) to the Configuration from a low priority task, so the motion loop never waits on FFat.
+ *
+ * Each kind of save is a latest-wins slot: a request replaces one of the same kind that hasn't been written yet,
+ * and clearing the clean shutdown marker replaces a rest position save that hasn't been written yet. Requests never
+ * block.
+ */
+class ConfigurationSaveTask : public Task<ConfigurationSaveTask> {
+    friend class Task<ConfigurationSaveTask>; // Allow base Task to invoke protected run()
+
+    public:
+        ConfigurationSaveTask();
+
+        void setConfiguration(Configuration* configuration);
+        void setLogger(Logger* logger);
+
+        /** Stages a module's rest position (step UINT16_MAX if it's unknown) for the next requestSaveRestPositions() */
+        void setRestPosition(uint8_t module, uint16_t step, uint8_t phase, uint8_t flap_index);
+
+        /** Saves the staged rest positions along with the clean shutdown marker */
+        void requestSaveRestPositions();
+
+        /**
+         * Clears the clean shutdown marker, so that the saved rest positions aren't restored at the next boot.
+         * cleanShutdownCleared() returns true once that's been written (or failed to be).
+         */
+        void requestClearCleanShutdown();
+        bool cleanShutdownCleared();
+
+        void requestSaveMaxAccelSteps(const uint8_t max_accel_steps[NUM_MODULES]);
+
+    protected:
+        void run();
+
+    private:
+        enum class CleanShutdownRequest : uint8_t {
+            NONE,
+            SAVE,
+            CLEAR,
+        };
+
+        // Guards everything below; only held for copies
+        portMUX_TYPE lock_ = portMUX_INITIALIZER_UNLOCKED;
+        Configuration* configuration_ = nullptr;
+        Logger* logger_ = nullptr;
+
+        CleanShutdownRequest clean_shutdown_request_ = CleanShutdownRequest::NONE;
+        // Set from requestClearCleanShutdown() until the clear has been written
+        bool clearing_clean_shutdown_ = false;
+        uint16_t rest_step_[NUM_MODULES] = {};
+        uint8_t rest_phase_[NUM_MODULES] = {};
+        uint8_t rest_flap_index_[NUM_MODULES] = {};
+
+        bool max_accel_steps_requested_ = false;
+        uint8_t max_accel_steps_[NUM_MODULES] = {};
+
+        // Copies taken by run(), so that the writes happen without the lock
+        uint16_t save_rest_step_[NUM_MODULES] = {};
+        uint8_t save_rest_phase_[NUM_MODULES] = {};
+        uint8_t save_rest_flap_index_[NUM_MODULES] = {};
+        uint8_t save_max_accel_steps_[NUM_MODULES] = {};
+
+        void log(const char* msg);
+};
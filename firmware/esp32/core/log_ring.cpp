@@ -0,0 +1,85 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "log_ring.h"
+
+// A header with this bit set has been published; the rest of it is the message length
+static const uint32_t HEADER_PUBLISHED = 0x80000000;
+static const uint32_t HEADER_SIZE = 4;
+
+static uint32_t recordSize(size_t length) {
+    return HEADER_SIZE + ((length + 3) & ~(uint32_t)3);
+}
+
+bool LogRing::write(const char* msg) {
+    size_t length = strnlen(msg, MAX_MESSAGE_LENGTH);
+    uint32_t record_size = recordSize(length);
+
+    uint32_t start = reserved_.load(std::memory_order_relaxed);
+    uint32_t used;
+    do {
+        // Acquire, so that the reader is done zeroing the space before we reuse it
+        used = start + record_size - tail_.load(std::memory_order_acquire);
+        if (used > SIZE) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    } while (!reserved_.compare_exchange_weak(start, start + record_size, std::memory_order_relaxed));
+
+    uint32_t high_water_mark = high_water_mark_.load(std::memory_order_relaxed);
+    while (used > high_water_mark
+            && !high_water_mark_.compare_exchange_weak(high_water_mark, used, std::memory_order_relaxed)) {}
+
+    copyIn(start + HEADER_SIZE, msg, length);
+    __atomic_store_n(&words_[(start % SIZE) / 4], HEADER_PUBLISHED | length, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool LogRing::read(char* buffer, size_t size) {
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    uint32_t header = __atomic_load_n(&words_[(tail % SIZE) / 4], __ATOMIC_ACQUIRE);
+    if (!(header & HEADER_PUBLISHED)) {
+        // Either empty, or the oldest reservation's writer hasn't finished yet
+        return false;
+    }
+    size_t length = header & ~HEADER_PUBLISHED;
+    size_t copy_length = min(length, size - 1);
+    copyOut(tail + HEADER_SIZE, buffer, copy_length);
+    buffer[copy_length] = '\0';
+
+    // Writers rely on free space reading as unpublished headers
+    uint32_t record_size = recordSize(length);
+    for (uint32_t offset = 0; offset < record_size; offset += 4) {
+        words_[((tail + offset) % SIZE) / 4] = 0;
+    }
+    tail_.store(tail + record_size, std::memory_order_release);
+    return true;
+}
+
+void LogRing::copyIn(uint32_t position, const char* src, size_t length) {
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(words_);
+    uint32_t offset = position % SIZE;
+    size_t first = min(length, (size_t)(SIZE - offset));
+    memcpy(bytes + offset, src, first);
+    memcpy(bytes, src + first, length - first);
+}
+
+void LogRing::copyOut(uint32_t position, char* dst, size_t length) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(words_);
+    uint32_t offset = position % SIZE;
+    size_t first = min(length, (size_t)(SIZE - offset));
+    memcpy(dst, bytes + offset, first);
+    memcpy(dst + first, bytes, length - first);
+}
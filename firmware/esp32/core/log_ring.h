@@ -0,0 +1,73 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+
+/**
+ * Fixed-size ring of log messages that any number of tasks can write to without allocating or blocking, and one
+ * task reads from.
+ *
+ * Each message is stored as a 4-byte header followed by its text, padded to a multiple of 4 bytes. Writers reserve
+ * space by advancing a shared counter with compare-and-swap, copy their text in, then publish the header; the
+ * reader takes messages in reservation order, waiting for each one's header to be published, and zeroes their
+ * space before handing it back. If there isn't room for a message, it's dropped and counted.
+ */
+class LogRing {
+    public:
+        // Must be a power of 2
+        static const uint32_t SIZE = 2048;
+        // Longer messages are truncated
+        static const uint16_t MAX_MESSAGE_LENGTH = 255;
+
+        LogRing() {}
+
+        /** Copies the message into the ring. Returns false if it was dropped for lack of room. */
+        bool write(const char* msg);
+
+        /**
+         * Takes the oldest message, if there is one that's been completely written, as a NUL-terminated string.
+         * Only one task may read.
+         */
+        bool read(char* buffer, size_t size);
+
+        /** Total number of messages dropped because the ring was full */
+        uint32_t dropped() {
+            return dropped_.load(std::memory_order_relaxed);
+        }
+
+        /** Most bytes that have been in use at once, out of SIZE */
+        uint32_t highWaterMark() {
+            return high_water_mark_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        static_assert(SIZE >= 4 + MAX_MESSAGE_LENGTH + 1 && (SIZE & (SIZE - 1)) == 0, "Invalid LogRing size");
+
+        // Whole words, so that headers (which are always at word boundaries) never wrap around the end
+        uint32_t words_[SIZE / 4] = {};
+
+        // Free-running byte counts; positions in words_ are these modulo SIZE
+        std::atomic<uint32_t> reserved_ = {0};
+        std::atomic<uint32_t> tail_ = {0};
+
+        std::atomic<uint32_t> dropped_ = {0};
+        std::atomic<uint32_t> high_water_mark_ = {0};
+
+        void copyIn(uint32_t position, const char* src, size_t length);
+        void copyOut(uint32_t position, char* dst, size_t length);
+};
@@ -0,0 +1,102 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "splitflap_state.h"
+
+void SplitflapStateCache::beginUpdate() {
+    if (!updating_) {
+        updating_ = true;
+        generation_.store(generation_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+}
+
+void SplitflapStateCache::updateModule(uint8_t i, const SplitflapModuleState& module_state) {
+    if (state_.modules[i] != module_state) {
+        beginUpdate();
+        state_.modules[i] = module_state;
+        // The generation this update will finish at
+        module_generation_[i] = generation_.load(std::memory_order_relaxed) + 1;
+    }
+}
+
+void SplitflapStateCache::updateMode(SplitflapMode mode) {
+    if (mode != state_.mode) {
+        beginUpdate();
+        state_.mode = mode;
+    }
+}
+
+#ifdef CHAINLINK
+void SplitflapStateCache::updateLoopbacksOk(bool loopbacks_ok) {
+    if (loopbacks_ok != state_.loopbacks_ok) {
+        beginUpdate();
+        state_.loopbacks_ok = loopbacks_ok;
+    }
+}
+#endif
+
+void SplitflapStateCache::finishUpdate() {
+    if (updating_) {
+        updating_ = false;
+        generation_.store(generation_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+}
+
+/** Returns the current generation once no update is in progress. The returned generation is even. */
+uint32_t SplitflapStateCache::waitForStableGeneration() {
+    uint32_t generation;
+    while ((generation = generation_.load(std::memory_order_acquire)) & 1) {
+        // Updates are short, but let the motion task finish if it's on this core
+        taskYIELD();
+    }
+    return generation;
+}
+
+SplitflapState SplitflapStateCache::get() {
+    SplitflapState state;
+    uint32_t generation;
+    do {
+        generation = waitForStableGeneration();
+        state = state_;
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while (generation_.load(std::memory_order_relaxed) != generation);
+    return state;
+}
+
+uint32_t SplitflapStateCache::getChanges(uint32_t since_generation, SplitflapState& state, ModuleBitmask& changed) {
+    changed.clear();
+    uint32_t generation;
+    do {
+        generation = waitForStableGeneration();
+        if (generation == since_generation) {
+            return generation;
+        }
+        for (uint8_t i = 0; i < NUM_MODULES; i++) {
+            // Generations wrap around, so compare them by difference
+            if ((int32_t)(module_generation_[i] - since_generation) > 0) {
+                state.modules[i] = state_.modules[i];
+                changed.set(i);
+            }
+        }
+        state.mode = state_.mode;
+#ifdef CHAINLINK
+        state.loopbacks_ok = state_.loopbacks_ok;
+#endif
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // If an update overlapped the copy, any module it tore has a newer generation, so the retry copies it again
+    } while (generation_.load(std::memory_order_relaxed) != generation);
+    return generation;
+}
@@ -0,0 +1,166 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+
+#include "config.h"
+#include "splitflap_module_data.h"
+
+enum class SplitflapMode {
+    MODE_RUN,
+    MODE_SENSOR_TEST,
+};
+
+struct SplitflapModuleState {
+    State state;
+    uint8_t flap_index;
+    bool moving;
+    // Moving, but held at rest until its power channel has room (see power_scheduler.h), so not drawing current yet
+    bool waiting_for_power;
+    bool home_state;
+    uint8_t count_unexpected_home;
+    uint8_t count_missed_home;
+    // Targets still queued up for the module (see MotionEngine::QueueFlapIndex()), out of MODULE_QUEUE_DEPTH
+    uint8_t queued_flaps;
+    // How long the module's most recent move waited for power (see power_scheduler.h)
+    uint16_t queue_wait_millis;
+    // Top acceleration step the module currently runs at (see ADAPTIVE_SPEED)
+    uint8_t max_accel_step;
+
+    bool operator==(const SplitflapModuleState& other) {
+        return state == other.state
+            && flap_index == other.flap_index
+            && moving == other.moving
+            && waiting_for_power == other.waiting_for_power
+            && home_state == other.home_state
+            && count_unexpected_home == other.count_unexpected_home
+            && count_missed_home == other.count_missed_home
+            && queued_flaps == other.queued_flaps
+            && queue_wait_millis == other.queue_wait_millis
+            && max_accel_step == other.max_accel_step;
+    }
+
+    bool operator!=(const SplitflapModuleState& other) {
+        return !(*this == other);
+    }
+};
+
+struct SplitflapState {
+    SplitflapMode mode;
+    SplitflapModuleState modules[NUM_MODULES];
+
+#ifdef CHAINLINK
+    bool loopbacks_ok = false;
+#endif
+
+    bool operator==(const SplitflapState& other) {
+        for (uint8_t i = 0; i < NUM_MODULES; i++) {
+            if (modules[i] != other.modules[i]) {
+                return false;
+            }
+        }
+
+        return mode == other.mode
+#ifdef CHAINLINK
+            && loopbacks_ok == other.loopbacks_ok
+#endif
+            ;
+    }
+
+    bool operator!=(const SplitflapState& other) {
+        return !(*this == other);
+    }
+};
+
+/** One bit per module, e.g. for which modules' states changed (see SplitflapStateCache::getChanges()) */
+struct ModuleBitmask {
+    uint32_t words[(NUM_MODULES + 31) / 32] = {};
+
+    bool get(uint8_t i) const {
+        return words[i / 32] & (1UL << (i % 32));
+    }
+
+    void set(uint8_t i) {
+        words[i / 32] |= 1UL << (i % 32);
+    }
+
+    void setAll() {
+        for (uint8_t i = 0; i < NUM_MODULES; i++) {
+            set(i);
+        }
+    }
+
+    void clear() {
+        memset(words, 0, sizeof(words));
+    }
+
+    ModuleBitmask& operator|=(const ModuleBitmask& other) {
+        for (uint8_t w = 0; w < sizeof(words) / sizeof(words[0]); w++) {
+            words[w] |= other.words[w];
+        }
+        return *this;
+    }
+
+    bool any() const {
+        for (uint8_t w = 0; w < sizeof(words) / sizeof(words[0]); w++) {
+            if (words[w] != 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+/**
+ * The latest SplitflapState, published by the motion task for any other task to copy without locking or blocking
+ * it. Only one task may update it; it writes while the generation is odd (a seqlock), and readers retry if it was
+ * odd or changed while they copied. Each module also records the generation its state last changed in, so that
+ * readers can copy just the modules that changed since they last looked.
+ */
+class SplitflapStateCache {
+    public:
+        SplitflapStateCache() {}
+
+        /** Stores a module's state, if it changed. Writer only; call finishUpdate() once all of them are stored. */
+        void updateModule(uint8_t i, const SplitflapModuleState& module_state);
+        void updateMode(SplitflapMode mode);
+#ifdef CHAINLINK
+        void updateLoopbacksOk(bool loopbacks_ok);
+#endif
+        /** Publishes everything stored since the last call. Readers see either all of it or none of it. */
+        void finishUpdate();
+
+        SplitflapState get();
+
+        /**
+         * Brings `state` up to date from `since_generation`, the generation a previous call returned (or 0 for a
+         * zero-initialized `state`), copying only the modules that changed since then and setting their bits in
+         * `changed`. Returns the generation `state` is now at.
+         */
+        uint32_t getChanges(uint32_t since_generation, SplitflapState& state, ModuleBitmask& changed);
+
+    private:
+        SplitflapState state_ = {};
+        uint32_t module_generation_[NUM_MODULES] = {};
+        std::atomic<uint32_t> generation_ = {0};
+        // Whether the writer has made the generation odd for the update in progress
+        bool updating_ = false;
+
+        void beginUpdate();
+        uint32_t waitForStableGeneration();
+};
@@ -20,6 +20,7 @@
 #include "config.h"
 #include "splitflap_module.h"
 #include "spi_io_config.h"
+#include "power_scheduler.h"
 
 // ESP32-specific includes
 #include "semaphore_guard.h"
@@ -28,9 +29,7 @@
 
 static_assert(QCMD_FLAP + NUM_FLAPS <= 255, "Too many flaps to fit in uint8_t command structure");
 
-SplitflapTask::SplitflapTask(const uint8_t task_core, const LedMode led_mode) : Task("Splitflap", 4096, 1, task_core), led_mode_(led_mode), state_semaphore_(xSemaphoreCreateMutex()), configuration_semaphore_(xSemaphoreCreateMutex()) {
-  assert(state_semaphore_ != NULL);
-  xSemaphoreGive(state_semaphore_);
+SplitflapTask::SplitflapTask(const uint8_t task_core, const LedMode led_mode) : Task("Splitflap", 4096, 1, task_core), led_mode_(led_mode), configuration_semaphore_(xSemaphoreCreateMutex()) {
   assert(configuration_semaphore_ != NULL);
   xSemaphoreGive(configuration_semaphore_);
 
@@ -42,9 +41,6 @@ SplitflapTask::~SplitflapTask() {
   if (queue_ != NULL) {
     vQueueDelete(queue_);
   }
-  if (state_semaphore_ != NULL) {
-    vSemaphoreDelete(state_semaphore_);
-  }
   if (configuration_semaphore_ != NULL) {
     vSemaphoreDelete(configuration_semaphore_);
   }
@@ -55,7 +51,10 @@ void SplitflapTask::run() {
     esp_err_t result = esp_task_wdt_add(NULL);
     ESP_ERROR_CHECK(result);
 
+    configuration_save_task_.begin();
+
     initialize_modules();
+    step_scheduler_.begin();
 
     // Initialize shift registers before turning on shift register output-enable
     motor_sensor_io();
@@ -108,51 +107,40 @@ void SplitflapTask::run() {
     }
 #endif
 
+    power_scheduler.begin();
     for (uint8_t i = 0; i < NUM_MODULES; i++) {
         modules[i]->Init();
+    }
 #if !defined(CHAINLINK_DRIVER_TESTER) && !defined(CHAINLINK_BASE)
-        modules[i]->FindAndRecalibrateHome();
+    restorePositionsOrHome();
 #endif
-    }
 
     while(1) {
         processQueue();
         runUpdate();
         result = esp_task_wdt_reset();
         ESP_ERROR_CHECK(result);
+        step_scheduler_.waitForNextDeadline();
     }
 }
 
 void SplitflapTask::processQueue() {
-    if (xQueueReceive(queue_, &queue_receive_buffer_, 0) == pdTRUE) {
+    // Read before checking the queue: a task that queues a command and then posts targets has finished queueing
+    // by the time any of those targets are stamped, so if the queue is empty, nothing stamped before this is still
+    // waiting behind a command
+    uint32_t mailbox_sequence = mailbox_.sequence();
+    bool received = xQueueReceive(queue_, &queue_receive_buffer_, 0) == pdTRUE;
+    // Targets posted before the command take effect first; later ones wait until it's been handled
+    applyMailbox(received ? queue_receive_buffer_.sequence : mailbox_sequence);
+    if (received) {
         switch (queue_receive_buffer_.command_type) {
             case CommandType::MODULES: {
                 uint8_t* data = queue_receive_buffer_.data.module_command;
-                bool any_leds = false;
                 for (uint8_t i = 0; i < NUM_MODULES; i++) {
                     switch (data[i]) {
                         case QCMD_NO_OP:
                             // No-op
                             break;
-                        case QCMD_RESET_AND_HOME:
-                            modules[i]->ResetState();
-                            modules[i]->FindAndRecalibrateHome();
-                            break;
-                        case QCMD_LED_ON:
-                            any_leds = true;
-    #ifdef CHAINLINK
-                            chainlink_set_led(i, true);
-    #endif
-                            break;
-                        case QCMD_LED_OFF:
-                            any_leds = true;
-    #ifdef CHAINLINK
-                            chainlink_set_led(i, false);
-    #endif
-                            break;
-                        case QCMD_DISABLE:
-                            modules[i]->Disable();
-                            break;
                         case QCMD_INCR_OFFSET_TENTH:
                             modules[i]->IncreaseOffset(1);
                             break;
@@ -162,6 +150,9 @@ void SplitflapTask::processQueue() {
                         case QCMD_SET_OFFSET:
                             modules[i]->SetOffset();
                             break;
+                        case QCMD_CLEAR_QUEUE:
+                            modules[i]->ClearQueue();
+                            break;
                         case RESET_OFFSET:
                         {
                             char buffer[200] = {};
@@ -209,14 +200,13 @@ void SplitflapTask::processQueue() {
                             break;
                         
                         default:
-                            assert(data[i] >= QCMD_FLAP && data[i] < QCMD_FLAP + NUM_FLAPS);
-                            modules[i]->GoToFlapIndex(data[i] - QCMD_FLAP);
+                            // QCMD_FLAP, QCMD_RESET_AND_HOME, QCMD_DISABLE and QCMD_LED_* commands go through the
+                            // mailbox instead (see postRawCommand())
+                            assert(data[i] >= QCMD_MOTION_PROFILE && data[i] < QCMD_MOTION_PROFILE + Acceleration::NUM_MOTION_PROFILES);
+                            modules[i]->SetMotionProfile(data[i] - QCMD_MOTION_PROFILE);
                             break;
                     }
                 }
-                if (any_leds) {
-                    motor_sensor_io();
-                }
                 break;
             }
             case CommandType::SENSOR_TEST_SET:
@@ -225,35 +215,49 @@ void SplitflapTask::processQueue() {
             case CommandType::SENSOR_TEST_CLEAR:
                 sensor_test_ = false;
                 break;
-            case CommandType::CONFIG: {
-                ModuleConfigs configs = queue_receive_buffer_.data.module_configs;
+            case CommandType::SYNCHRONIZED_ARRIVAL_SET:
+                synchronized_arrival_ = true;
+                break;
+            case CommandType::SYNCHRONIZED_ARRIVAL_CLEAR:
+                synchronized_arrival_ = false;
+                break;
+            case CommandType::TIMELINE_PLAY:
+                if (timeline_player_.start(timeline_store_, queue_receive_buffer_.data.timeline_loops, millis())) {
+                    log("Playing timeline");
+                }
+                break;
+            case CommandType::TIMELINE_STOP:
+                stopTimelinePlayback();
+                break;
+            case CommandType::QUEUE_FLAPS: {
+                const QueuedFlaps& queued = queue_receive_buffer_.data.queued_flaps;
+                bool any_queued = false;
+                char buffer[200] = {};
                 for (uint8_t i = 0; i < NUM_MODULES; i++) {
-                    ModuleConfig config = configs.config[i];
-
-                    if (config.reset_nonce != current_configs_.config[i].reset_nonce) {
-                        modules[i]->ResetErrorCounters();
-                        modules[i]->FindAndRecalibrateHome();
+                    if (queued.flap_index[i] == QUEUE_NO_FLAP) {
+                        continue;
                     }
-
-                    if (config.target_flap_index != current_configs_.config[i].target_flap_index ||
-                            config.target_flap_index != modules[i]->GetTargetFlapIndex() ||
-                            config.movement_nonce != current_configs_.config[i].movement_nonce) {
-                        if (config.target_flap_index >= NUM_FLAPS) {
-                            char buffer[200] = {};
-                            snprintf(buffer, sizeof(buffer), "Invalid flap index (%u) specified for module %u", config.target_flap_index, i);
-                            log(buffer);
-                        } else {
-                            modules[i]->GoToFlapIndex(config.target_flap_index);
-                        }
+                    if (queued.flap_index[i] >= NUM_FLAPS) {
+                        snprintf(buffer, sizeof(buffer), "Invalid flap index (%u) queued for module %u", queued.flap_index[i], i);
+                        log(buffer);
+                    } else if (!modules[i]->QueueFlapIndex(queued.flap_index[i], queued.dwell_millis[i])) {
+                        snprintf(buffer, sizeof(buffer), "Queue full for module %u; dropped flap %u", i, queued.flap_index[i]);
+                        log(buffer);
+                    } else {
+                        any_queued = true;
                     }
                 }
-                current_configs_ = configs;
+                if (any_queued) {
+                    // The timeline's next frame would replace the queue anyway
+                    stopTimelinePlayback();
+                }
                 break;
             }
             case CommandType::SAVE_ALL_OFFSETS: {
                 char buffer[200] = {};
 
                 uint16_t offsets[NUM_MODULES];
+                uint8_t motion_profiles[NUM_MODULES];
                 for (uint8_t i = 0; i < NUM_MODULES; i++) {
                     // Make sure all modules are stopped, since writing to config may take a while
                     if (modules[i]->current_accel_step != 0) {
@@ -263,6 +267,7 @@ void SplitflapTask::processQueue() {
                     }
 
                     offsets[i] = modules[i]->GetOffset();
+                    motion_profiles[i] = modules[i]->GetMotionProfile();
                 }
 
                 // Write to configuration
@@ -273,7 +278,7 @@ void SplitflapTask::processQueue() {
                 }
                 if (configuration != nullptr) {
                     log("Saving calibration...");
-                    bool success = configuration->setModuleOffsetsAndSave(offsets);
+                    bool success = configuration->setModuleCalibrationAndSave(offsets, motion_profiles);
                     if (success) {
                         log("SUCCESS - saved calibration!");
                     } else {
@@ -288,6 +293,14 @@ void SplitflapTask::processQueue() {
                     modules[i]->RestoreOffset(offset);
                 }
                 break;
+            case CommandType::RESTORE_MAX_ACCEL_STEPS:
+                for (uint8_t i = 0; i < NUM_MODULES; i++) {
+                    uint8_t max_accel_step = queue_receive_buffer_.data.max_accel_steps[i];
+                    if (max_accel_step != 0) {
+                        modules[i]->SetMaxAccelStep(max_accel_step);
+                    }
+                }
+                break;
             default: {
                 log("Unknown command");
                 break;
@@ -296,6 +309,112 @@ void SplitflapTask::processQueue() {
     }
 }
 
+/**
+ * Applies the module actions, flap targets, configs and LEDs that were posted to the mailbox before `before`, in
+ * the order they were posted.
+ */
+void SplitflapTask::applyMailbox(uint32_t before) {
+    uint32_t configs_sequence;
+    if (mailbox_.takeConfigs(before, mailbox_configs_, configs_sequence)) {
+        applyActions(configs_sequence);
+        applyFlaps(configs_sequence);
+        applyConfigs(mailbox_configs_);
+    }
+    // A module's waiting flap target is always newer than its waiting action (see CommandMailbox::postActions())
+    applyActions(before);
+    applyFlaps(before);
+    applyLeds(before);
+}
+
+void SplitflapTask::applyActions(uint32_t before) {
+    if (!mailbox_.takeActions(before, mailbox_actions_)) {
+        return;
+    }
+    for (uint8_t i = 0; i < NUM_MODULES; i++) {
+        switch (mailbox_actions_[i]) {
+            case QCMD_RESET_AND_HOME:
+                modules[i]->ResetState();
+                modules[i]->FindAndRecalibrateHome();
+                break;
+            case QCMD_DISABLE:
+                modules[i]->Disable();
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void SplitflapTask::applyLeds(uint32_t before) {
+    if (!mailbox_.takeLeds(before, mailbox_leds_)) {
+        return;
+    }
+#ifdef CHAINLINK
+    for (uint8_t i = 0; i < NUM_MODULES; i++) {
+        if (mailbox_leds_[i] != CommandMailbox::NO_ACTION) {
+            chainlink_set_led(i, mailbox_leds_[i] == QCMD_LED_ON);
+        }
+    }
+#endif
+    motor_sensor_io();
+}
+
+void SplitflapTask::applyFlaps(uint32_t before) {
+    if (!mailbox_.takeFlaps(before, mailbox_flaps_)) {
+        return;
+    }
+    for (uint8_t i = 0; i < NUM_MODULES; i++) {
+        if (mailbox_flaps_[i] == CommandMailbox::NO_FLAP) {
+            continue;
+        }
+        if (mailbox_flaps_[i] >= NUM_FLAPS) {
+            char buffer[200] = {};
+            snprintf(buffer, sizeof(buffer), "Invalid flap index (%u) specified for module %u", mailbox_flaps_[i], i);
+            log(buffer);
+        } else {
+            modules[i]->GoToFlapIndex(mailbox_flaps_[i]);
+        }
+    }
+    // Anything else that moves the modules takes over from the timeline
+    stopTimelinePlayback();
+    if (synchronized_arrival_) {
+        motion_engine.SynchronizeArrival(micros());
+    }
+}
+
+void SplitflapTask::applyConfigs(const ModuleConfigs& configs) {
+    bool any_moves = false;
+    for (uint8_t i = 0; i < NUM_MODULES; i++) {
+        const ModuleConfig& config = configs.config[i];
+
+        if (config.reset_nonce != current_configs_.config[i].reset_nonce) {
+            modules[i]->ResetErrorCounters();
+            modules[i]->FindAndRecalibrateHome();
+        }
+
+        if (config.target_flap_index != current_configs_.config[i].target_flap_index ||
+                config.target_flap_index != modules[i]->GetTargetFlapIndex() ||
+                config.movement_nonce != current_configs_.config[i].movement_nonce) {
+            if (config.target_flap_index >= NUM_FLAPS) {
+                char buffer[200] = {};
+                snprintf(buffer, sizeof(buffer), "Invalid flap index (%u) specified for module %u", config.target_flap_index, i);
+                log(buffer);
+            } else {
+                modules[i]->GoToFlapIndex(config.target_flap_index);
+                any_moves = true;
+            }
+        }
+    }
+    if (any_moves) {
+        // Anything else that moves the modules takes over from the timeline
+        stopTimelinePlayback();
+    }
+    if (any_moves && (configs.synchronized_arrival || synchronized_arrival_)) {
+        motion_engine.SynchronizeArrival(micros());
+    }
+    current_configs_ = configs;
+}
+
 void SplitflapTask::runUpdate() {
     boolean all_idle = true;
 
@@ -305,6 +424,10 @@ void SplitflapTask::runUpdate() {
     uint32_t flashGroup = (flashStep % 16) / 2;
     uint8_t flashPhase = flashStep % 2;
 
+    step_scheduler_.beginPass();
+    // Pick up the sensor data from the last pass's transfer if it's already done (only with SPI_IO_PIPELINED)
+    motor_sensor_io_poll();
+
     if (sensor_test_ && all_stopped_) {
       // Read sensor state
       motor_sensor_io();
@@ -319,18 +442,37 @@ void SplitflapTask::runUpdate() {
       }
 #endif
     } else {
+#if LOG_STEP_TIMING
+      bool was_stopped = all_stopped_;
+#endif
+#if FAST_BOOT
+      if (clean_shutdown_saved_ && anyModuleMoving()) {
+        // The saved rest positions are about to go stale, so they have to be marked as such before the first step
+        setCleanShutdown(false);
+      }
+      if (clearing_clean_shutdown_ && configuration_save_task_.cleanShutdownCleared()) {
+        clearing_clean_shutdown_ = false;
+      }
+      // Until then, hold every move, but keep the rest of the loop (commands, LEDs, loopbacks, state) running
+      bool hold_moves = clearing_clean_shutdown_;
+#else
+      bool hold_moves = false;
+#endif
       all_stopped_ = true;
+      if (!hold_moves) {
+        power_scheduler.update(step_scheduler_.now());
+        motion_engine.Update(step_scheduler_);
+      }
       for (uint8_t i = 0; i < NUM_MODULES; i++) {
-        modules[i]->Update();
         bool is_idle = modules[i]->state == PANIC
           || modules[i]->state == STATE_DISABLED
           || modules[i]->state == LOOK_FOR_HOME
           || modules[i]->state == SENSOR_ERROR
-          || (modules[i]->state == NORMAL && modules[i]->current_accel_step == 0);
+          || (modules[i]->state == NORMAL && !motion_engine.IsBusy(i));
 
         bool is_stopped = modules[i]->state == PANIC
           || modules[i]->state == STATE_DISABLED
-          || modules[i]->current_accel_step == 0;
+          || !motion_engine.IsBusy(i);
 
 #ifdef CHAINLINK
         if (led_mode_ == LedMode::AUTO) {
@@ -341,7 +483,41 @@ void SplitflapTask::runUpdate() {
         all_idle &= is_idle;
         all_stopped_ &= is_stopped;
       }
-      motor_sensor_io();
+      motor_sensor_io_queue();
+
+#if LOG_STEP_TIMING
+      if (all_stopped_ && !was_stopped) {
+        logStepTiming();
+      }
+#endif
+      if (timeline_player_.playing()) {
+        uint8_t flags;
+        const uint8_t* targets = timeline_player_.update(timeline_store_, iterationStartMillis, all_stopped_, flags);
+        if (targets != nullptr) {
+          showTimelineFrame(targets, flags);
+        }
+        if (timeline_player_.finished()) {
+          log("Timeline finished");
+        }
+      }
+#if FAST_BOOT
+      if (!clean_shutdown_saved_) {
+        if (anyModuleMoving()) {
+          settled_since_millis_ = iterationStartMillis;
+        } else if (iterationStartMillis - settled_since_millis_ >= REST_POSITION_SAVE_DELAY_MILLIS) {
+          setCleanShutdown(true);
+        }
+      }
+#endif
+#if ADAPTIVE_SPEED
+      if (motion_engine.max_accel_step_changed) {
+        if (!all_stopped_) {
+          max_accel_steps_settled_since_millis_ = iterationStartMillis;
+        } else if (iterationStartMillis - max_accel_steps_settled_since_millis_ >= REST_POSITION_SAVE_DELAY_MILLIS) {
+          saveMaxAccelSteps();
+        }
+      }
+#endif
     }
 
 
@@ -352,7 +528,8 @@ void SplitflapTask::runUpdate() {
     loopback_step_index_++;
     if (loopback_step_index_ == 1) {
       chainlink_set_loopback(loopback_current_out_index_);
-    } else if (loopback_step_index_ == 3) {
+    } else if (loopback_step_index_ == 3 + SPI_IO_PIPELINED) {
+      // With SPI_IO_PIPELINED, the sensor data from each pass's transfer only arrives during the following pass
       bool ok = chainlink_validate_loopback(loopback_current_out_index_, nullptr);
       loopback_current_ok_ &= ok;
 
@@ -383,6 +560,111 @@ void SplitflapTask::runUpdate() {
     updateStateCache();
 }
 
+/**
+ * Puts each module back where it was last saved to be at rest (see Configuration::getRestPosition()), if
+ * FAST_BOOT is enabled and its position is known, or else starts homing it. Only called at startup.
+ */
+void SplitflapTask::restorePositionsOrHome() {
+#if FAST_BOOT
+    uint8_t restored = 0;
+    Configuration* configuration;
+    {
+        SemaphoreGuard lock(configuration_semaphore_);
+        configuration = configuration_;
+    }
+#endif
+    for (uint8_t i = 0; i < NUM_MODULES; i++) {
+#if FAST_BOOT
+        uint16_t offset, step;
+        uint8_t phase, flap_index;
+        if (configuration != nullptr && configuration->getRestPosition(i, offset, step, phase, flap_index)
+                && modules[i]->RestorePosition(offset, step, phase, flap_index)) {
+            restored++;
+            continue;
+        }
+#endif
+        modules[i]->FindAndRecalibrateHome();
+    }
+#if FAST_BOOT
+    // Only a clean shutdown marker lets any module be restored, and it stays set until something moves
+    clean_shutdown_saved_ = restored > 0;
+    settled_since_millis_ = millis();
+
+    char buffer[200] = {};
+    snprintf(buffer, sizeof(buffer), "Restored %u of %u modules from their saved rest positions", restored, NUM_MODULES);
+    log(buffer);
+#endif
+}
+
+bool SplitflapTask::anyModuleMoving() {
+    for (uint8_t i = 0; i < NUM_MODULES; i++) {
+        if (motion_engine.IsBusy(i) || modules[i]->state == LOOK_FOR_HOME) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#if FAST_BOOT
+/**
+ * Has ConfigurationSaveTask save every module's rest position along with the clean shutdown marker, or clear the
+ * marker. Either way it's a flash write, so this is only called when everything has been still for
+ * REST_POSITION_SAVE_DELAY_MILLIS and again when the next move starts.
+ */
+void SplitflapTask::setCleanShutdown(bool clean_shutdown) {
+    clean_shutdown_saved_ = clean_shutdown;
+    if (!clean_shutdown) {
+        clearing_clean_shutdown_ = true;
+        configuration_save_task_.requestClearCleanShutdown();
+        return;
+    }
+    for (uint8_t i = 0; i < NUM_MODULES; i++) {
+        uint16_t step = modules[i]->state == NORMAL ? motion_engine.current_step[i] : UINT16_MAX;
+        configuration_save_task_.setRestPosition(i, step, motion_engine.current_phase[i], modules[i]->GetTargetFlapIndex());
+    }
+    configuration_save_task_.requestSaveRestPositions();
+}
+#endif
+
+#if ADAPTIVE_SPEED
+/**
+ * Has ConfigurationSaveTask save each module's learned top speed. Like the rest positions, only called once
+ * everything has been still for REST_POSITION_SAVE_DELAY_MILLIS, so a run of adjustments costs a single flash write.
+ */
+void SplitflapTask::saveMaxAccelSteps() {
+    motion_engine.max_accel_step_changed = false;
+
+    uint8_t max_accel_steps[NUM_MODULES];
+    for (uint8_t i = 0; i < NUM_MODULES; i++) {
+        max_accel_steps[i] = motion_engine.max_accel_step[i];
+    }
+    configuration_save_task_.requestSaveMaxAccelSteps(max_accel_steps);
+}
+#endif
+
+void SplitflapTask::showTimelineFrame(const uint8_t* targets, uint8_t flags) {
+    bool any_moves = false;
+    for (uint8_t i = 0; i < NUM_MODULES; i++) {
+        if (targets[i] == TIMELINE_NO_CHANGE || targets[i] >= NUM_FLAPS) {
+            continue;
+        }
+        if ((flags & TIMELINE_FLAG_FORCE_MOVEMENT) || targets[i] != modules[i]->GetTargetFlapIndex()) {
+            modules[i]->GoToFlapIndex(targets[i]);
+            any_moves = true;
+        }
+    }
+    if (any_moves && ((flags & TIMELINE_FLAG_SYNCHRONIZED_ARRIVAL) || synchronized_arrival_)) {
+        motion_engine.SynchronizeArrival(micros());
+    }
+}
+
+void SplitflapTask::stopTimelinePlayback() {
+    if (timeline_player_.playing()) {
+        timeline_player_.stop();
+        log("Stopped timeline");
+    }
+}
+
 int8_t SplitflapTask::findFlapIndex(uint8_t character) {
     for (int8_t i = 0; i < NUM_FLAPS; i++) {
         if (character == flaps[i]) {
@@ -392,25 +674,55 @@ int8_t SplitflapTask::findFlapIndex(uint8_t character) {
     return -1;
 }
 
+/**
+ * Publishes the modules' states, only touching (and flagging) the ones that changed. Readers see either all of a
+ * pass's changes or none of them.
+ */
 void SplitflapTask::updateStateCache() {
-    SplitflapState new_state;
-    new_state.mode = sensor_test_ ? SplitflapMode::MODE_SENSOR_TEST : SplitflapMode::MODE_RUN;
     for (uint8_t i = 0; i < NUM_MODULES; i++) {
-      new_state.modules[i].flap_index = modules[i]->GetCurrentFlapIndex();
-      new_state.modules[i].state = modules[i]->state;
-      new_state.modules[i].moving = modules[i]->current_accel_step > 0;
-      new_state.modules[i].home_state = modules[i]->GetHomeState();
-      new_state.modules[i].count_missed_home = modules[i]->count_missed_home;
-      new_state.modules[i].count_unexpected_home = modules[i]->count_unexpected_home;
+      SplitflapModuleState module_state;
+      module_state.flap_index = modules[i]->GetCurrentFlapIndex();
+      module_state.state = modules[i]->state;
+      module_state.moving = motion_engine.IsMoving(i);
+      module_state.waiting_for_power = module_state.moving && motion_engine.power_hold[i];
+      module_state.home_state = modules[i]->GetHomeState();
+      module_state.count_missed_home = modules[i]->count_missed_home;
+      module_state.count_unexpected_home = modules[i]->count_unexpected_home;
+      module_state.queued_flaps = motion_engine.queue_length[i];
+      module_state.queue_wait_millis = min(power_scheduler.last_wait_micros[i] / 1000, (uint32_t)UINT16_MAX);
+      module_state.max_accel_step = motion_engine.max_accel_step[i];
+      state_cache_.updateModule(i, module_state);
     }
 
+    state_cache_.updateMode(sensor_test_ ? SplitflapMode::MODE_SENSOR_TEST : SplitflapMode::MODE_RUN);
 #ifdef CHAINLINK
-    new_state.loopbacks_ok = loopback_all_ok_;
+    state_cache_.updateLoopbacksOk(loopback_all_ok_);
 #endif
-    if (memcmp(&state_cache_, &new_state, sizeof(state_cache_))) {
-        SemaphoreGuard lock(state_semaphore_);
-        memcpy(&state_cache_, &new_state, sizeof(state_cache_));
+    state_cache_.finishUpdate();
+}
+
+void SplitflapTask::logStepTiming() {
+    char buffer[200] = {};
+    for (uint8_t i = 1; i <= Acceleration::MAX_ACCEL_STEP; i++) {
+        const StepPeriodStats& stats = step_scheduler_.stats(i);
+        if (stats.count == 0) {
+            continue;
+        }
+        snprintf(buffer, sizeof(buffer), "Step timing: accel step %u requested %u us, achieved mean %u us / max %u us over %u steps",
+            i, Acceleration::ACCEL_STEP_PERIODS[i], (unsigned int)(stats.total_micros / stats.count),
+            (unsigned int)stats.max_micros, (unsigned int)stats.count);
+        log(buffer);
     }
+    step_scheduler_.resetStats();
+
+    const MotorSensorIoStats& io_stats = motor_sensor_io_stats;
+    if (io_stats.transfers > 0) {
+        snprintf(buffer, sizeof(buffer), "SPI timing: round trip mean %u us / max %u us, %u%% overlapped, over %u transfers",
+            (unsigned int)(io_stats.total_round_trip_micros / io_stats.transfers), (unsigned int)io_stats.max_round_trip_micros,
+            motor_sensor_io_overlap_percent(), (unsigned int)io_stats.transfers);
+        log(buffer);
+    }
+    memset(&motor_sensor_io_stats, 0, sizeof(motor_sensor_io_stats));
 }
 
 void SplitflapTask::log(const char* msg) {
@@ -431,7 +743,7 @@ void SplitflapTask::showString(const char* str, uint8_t length, bool force_full_
             }
         }
     }
-    assert(xQueueSendToBack(queue_, &command, portMAX_DELAY) == pdTRUE);
+    postRawCommand(command);
 }
 
 void SplitflapTask::resetAll() {
@@ -440,7 +752,7 @@ void SplitflapTask::resetAll() {
     for (uint8_t i = 0; i < NUM_MODULES; i++) {
         command.data.module_command[i] = QCMD_RESET_AND_HOME;
     }
-    assert(xQueueSendToBack(queue_, &command, portMAX_DELAY) == pdTRUE);
+    postRawCommand(command);
 }
 
 void SplitflapTask::disableAll() {
@@ -449,7 +761,7 @@ void SplitflapTask::disableAll() {
     for (uint8_t i = 0; i < NUM_MODULES; i++) {
         command.data.module_command[i] = QCMD_DISABLE;
     }
-    assert(xQueueSendToBack(queue_, &command, portMAX_DELAY) == pdTRUE);
+    postRawCommand(command);
 }
 
 void SplitflapTask::setLed(const uint8_t id, const bool on) {
@@ -458,65 +770,167 @@ void SplitflapTask::setLed(const uint8_t id, const bool on) {
     Command command = {};
     command.command_type = CommandType::MODULES;
     command.data.module_command[id] = on ? QCMD_LED_ON : QCMD_LED_OFF;
-    assert(xQueueSendToBack(queue_, &command, portMAX_DELAY) == pdTRUE);
+    postRawCommand(command);
 }
 
 void SplitflapTask::setSensorTest(bool sensor_test) {
     Command command = {};
     command.command_type = sensor_test ? CommandType::SENSOR_TEST_SET : CommandType::SENSOR_TEST_CLEAR;
-    assert(xQueueSendToBack(queue_, &command, portMAX_DELAY) == pdTRUE);
+    postRawCommand(command);
+}
+
+/**
+ * While enabled, every move (from showString(), CONFIG commands, etc) delays the start of the modules it moves so
+ * that they all land on their new flaps at the same time. See MotionEngine::SynchronizeArrival().
+ */
+void SplitflapTask::setSynchronizedArrival(bool synchronized_arrival) {
+    Command command = {};
+    command.command_type = synchronized_arrival ? CommandType::SYNCHRONIZED_ARRIVAL_SET : CommandType::SYNCHRONIZED_ARRIVAL_CLEAR;
+    postRawCommand(command);
+}
+
+void SplitflapTask::playTimeline(uint16_t loops) {
+    Command command = {};
+    command.command_type = CommandType::TIMELINE_PLAY;
+    command.data.timeline_loops = loops;
+    postRawCommand(command);
+}
+
+void SplitflapTask::stopTimeline() {
+    Command command = {};
+    command.command_type = CommandType::TIMELINE_STOP;
+    postRawCommand(command);
+}
+
+TimelineStore& SplitflapTask::timelineStore() {
+    return timeline_store_;
+}
+
+MotionLog& SplitflapTask::motionLog() {
+    return motion_log;
 }
 
 SplitflapState SplitflapTask::getState() {
-    SemaphoreGuard lock(state_semaphore_);
-    return state_cache_;
+    return state_cache_.get();
+}
+
+uint32_t SplitflapTask::getStateChanges(uint32_t since_generation, SplitflapState& state, ModuleBitmask& changed) {
+    return state_cache_.getChanges(since_generation, state, changed);
 }
 
 void SplitflapTask::increaseOffsetTenth(const uint8_t id) {
     Command command = {};
     command.command_type = CommandType::MODULES;
     command.data.module_command[id] = QCMD_INCR_OFFSET_TENTH;
-    assert(xQueueSendToBack(queue_, &command, portMAX_DELAY) == pdTRUE);
+    postRawCommand(command);
 }
 
 void SplitflapTask::increaseOffsetHalf(const uint8_t id) {
     Command command = {};
     command.command_type = CommandType::MODULES;
     command.data.module_command[id] = QCMD_INCR_OFFSET_HALF;
-    assert(xQueueSendToBack(queue_, &command, portMAX_DELAY) == pdTRUE);
+    postRawCommand(command);
 }
 
 void SplitflapTask::setOffset(const uint8_t id) {
     Command command = {};
     command.command_type = CommandType::MODULES;
     command.data.module_command[id] = QCMD_SET_OFFSET;
-    assert(xQueueSendToBack(queue_, &command, portMAX_DELAY) == pdTRUE);
+    postRawCommand(command);
 }
 
 void SplitflapTask::resetOffsets(const uint8_t id) {
     Command command = {};
     command.command_type = CommandType::MODULES;
     command.data.module_command[id] = RESET_OFFSET;
-    assert(xQueueSendToBack(queue_, &command, portMAX_DELAY) == pdTRUE);
+    postRawCommand(command);
 }
 
 void SplitflapTask::setConfiguration(Configuration* configuration) {
     SemaphoreGuard lock(configuration_semaphore_);
     configuration_ = configuration;
+    configuration_save_task_.setConfiguration(configuration);
 }
 
 void SplitflapTask::setLogger(Logger* logger) {
     logger_ = logger;
+    timeline_store_.setLogger(logger);
+    configuration_save_task_.setLogger(logger);
 }
 
+/**
+ * Flap moves, configs, resets, disables and LEDs go to the mailbox, replacing any older ones for the same modules
+ * that haven't been picked up yet, so they never block or get dropped. Everything else is queued, waiting for room
+ * if the queue is full; those commands are rare, and each one matters.
+ */
 void SplitflapTask::postRawCommand(Command command) {
-    assert(xQueueSendToBack(queue_, &command, portMAX_DELAY) == pdTRUE);
+    if (command.command_type == CommandType::CONFIG) {
+        mailbox_.postConfigs(command.data.module_configs);
+    } else {
+        uint8_t flaps[NUM_MODULES];
+        uint8_t actions[NUM_MODULES];
+        uint8_t leds[NUM_MODULES];
+        bool any_flaps = false;
+        bool any_actions = false;
+        bool any_leds = false;
+        bool any_others = command.command_type != CommandType::MODULES;
+        for (uint8_t i = 0; i < NUM_MODULES; i++) {
+            flaps[i] = CommandMailbox::NO_FLAP;
+            actions[i] = CommandMailbox::NO_ACTION;
+            leds[i] = CommandMailbox::NO_ACTION;
+            if (command.command_type != CommandType::MODULES) {
+                continue;
+            }
+            uint8_t module_command = command.data.module_command[i];
+            switch (module_command) {
+                case QCMD_NO_OP:
+                    continue;
+                case QCMD_RESET_AND_HOME:
+                case QCMD_DISABLE:
+                    actions[i] = module_command;
+                    any_actions = true;
+                    break;
+                case QCMD_LED_ON:
+                case QCMD_LED_OFF:
+                    leds[i] = module_command;
+                    any_leds = true;
+                    break;
+                default:
+                    if (module_command < QCMD_FLAP) {
+                        // Queued below, along with the rest of the command
+                        any_others = true;
+                        continue;
+                    }
+                    flaps[i] = module_command - QCMD_FLAP;
+                    any_flaps = true;
+                    break;
+            }
+            command.data.module_command[i] = QCMD_NO_OP;
+        }
+
+        if (any_others) {
+            command.sequence = mailbox_.nextSequence();
+            // Can't time out with portMAX_DELAY
+            xQueueSendToBack(queue_, &command, portMAX_DELAY);
+        }
+        if (any_actions) {
+            mailbox_.postActions(actions);
+        }
+        if (any_flaps) {
+            mailbox_.postFlaps(flaps);
+        }
+        if (any_leds) {
+            mailbox_.postLeds(leds);
+        }
+    }
+    // Wake the motion loop in case it's sleeping until the next step deadline
+    xTaskNotifyGive(getHandle());
 }
 
 void SplitflapTask::saveAllOffsets() {
     Command command = {};
     command.command_type = CommandType::SAVE_ALL_OFFSETS;
-    assert(xQueueSendToBack(queue_, &command, portMAX_DELAY) == pdTRUE);
+    postRawCommand(command);
 }
 
 void SplitflapTask::restoreAllOffsets(uint16_t offsets[NUM_MODULES]) {
@@ -525,5 +939,33 @@ void SplitflapTask::restoreAllOffsets(uint16_t offsets[NUM_MODULES]) {
     for (uint8_t i = 0; i < NUM_MODULES; i++) {
         command.data.module_offsets[i] = offsets[i];
     }
-    assert(xQueueSendToBack(queue_, &command, portMAX_DELAY) == pdTRUE);
+    postRawCommand(command);
+}
+
+void SplitflapTask::setMotionProfile(const uint8_t id, const uint8_t profile) {
+    assert(profile < Acceleration::NUM_MOTION_PROFILES);
+    Command command = {};
+    command.command_type = CommandType::MODULES;
+    command.data.module_command[id] = QCMD_MOTION_PROFILE + profile;
+    postRawCommand(command);
+}
+
+void SplitflapTask::restoreMotionProfiles(uint8_t profiles[NUM_MODULES]) {
+    Command command = {};
+    command.command_type = CommandType::MODULES;
+    for (uint8_t i = 0; i < NUM_MODULES; i++) {
+        if (profiles[i] < Acceleration::NUM_MOTION_PROFILES) {
+            command.data.module_command[i] = QCMD_MOTION_PROFILE + profiles[i];
+        }
+    }
+    postRawCommand(command);
+}
+
+void SplitflapTask::restoreMaxAccelSteps(uint8_t max_accel_steps[NUM_MODULES]) {
+    Command command = {};
+    command.command_type = CommandType::RESTORE_MAX_ACCEL_STEPS;
+    for (uint8_t i = 0; i < NUM_MODULES; i++) {
+        command.data.max_accel_steps[i] = max_accel_steps[i];
+    }
+    postRawCommand(command);
 }
@@ -16,66 +16,18 @@
 #pragma once
 
 #include "config.h"
+#include "command_mailbox.h"
 #include "logger.h"
+#include "motion_log.h"
 #include "splitflap_module_data.h"
+#include "splitflap_state.h"
 #include "configuration.h"
+#include "configuration_save_task.h"
+#include "step_scheduler.h"
+#include "timeline.h"
 
 #include "task.h"
 
-enum class SplitflapMode {
-    MODE_RUN,
-    MODE_SENSOR_TEST,
-};
-
-struct SplitflapModuleState {
-    State state;
-    uint8_t flap_index;
-    bool moving;
-    bool home_state;
-    uint8_t count_unexpected_home;
-    uint8_t count_missed_home;
-
-    bool operator==(const SplitflapModuleState& other) {
-        return state == other.state
-            && flap_index == other.flap_index
-            && moving == other.moving
-            && home_state == other.home_state
-            && count_unexpected_home == other.count_unexpected_home
-            && count_missed_home == other.count_missed_home;
-    }
-
-    bool operator!=(const SplitflapModuleState& other) {
-        return !(*this == other);
-    }
-};
-
-struct SplitflapState {
-    SplitflapMode mode;
-    SplitflapModuleState modules[NUM_MODULES];
-
-#ifdef CHAINLINK
-    bool loopbacks_ok = false;
-#endif
-
-    bool operator==(const SplitflapState& other) {
-        for (uint8_t i = 0; i < NUM_MODULES; i++) {
-            if (modules[i] != other.modules[i]) {
-                return false;
-            }
-        }
-
-        return mode == other.mode
-#ifdef CHAINLINK
-            && loopbacks_ok == other.loopbacks_ok
-#endif
-            ;
-    }
-
-    bool operator!=(const SplitflapState& other) {
-        return !(*this == other);
-    }
-};
-
 enum class LedMode {
     AUTO,
     MANUAL,
@@ -88,24 +40,36 @@ enum class CommandType {
     CONFIG,
     SAVE_ALL_OFFSETS,
     RESTORE_ALL_OFFSETS,
+    SYNCHRONIZED_ARRIVAL_SET,
+    SYNCHRONIZED_ARRIVAL_CLEAR,
+    TIMELINE_PLAY,
+    TIMELINE_STOP,
+    QUEUE_FLAPS,
+    RESTORE_MAX_ACCEL_STEPS,
 };
 
-struct ModuleConfig {
-    uint8_t target_flap_index;
-    uint8_t movement_nonce;
-    uint8_t reset_nonce;
-};
+static const uint8_t QUEUE_NO_FLAP = 0xFF;
 
-struct ModuleConfigs {
-    ModuleConfig config[NUM_MODULES];
+struct QueuedFlaps {
+    // Flap index to add to the end of each module's queue, or QUEUE_NO_FLAP to leave the module's queue alone
+    uint8_t flap_index[NUM_MODULES];
+    // How long the module stays on that flap before moving on to the next queued one
+    uint16_t dwell_millis[NUM_MODULES];
 };
 
 struct Command {
     CommandType command_type;
+    // Set by postRawCommand(), to order the command relative to the targets in the CommandMailbox
+    uint32_t sequence;
     union CommandData {
         uint8_t module_command[NUM_MODULES];
         ModuleConfigs module_configs;
         uint16_t module_offsets[NUM_MODULES];
+        QueuedFlaps queued_flaps;
+        // Learned top acceleration step for each module, or 0 to leave the module at its current one
+        uint8_t max_accel_steps[NUM_MODULES];
+        // Times to play the timeline, or 0 to repeat until stopped
+        uint16_t timeline_loops;
     };
     CommandData data;
 };
@@ -119,8 +83,13 @@ struct Command {
 #define QCMD_INCR_OFFSET_HALF   6
 #define QCMD_SET_OFFSET         7
 #define RESET_OFFSET            8
+#define QCMD_CLEAR_QUEUE        9
+// QCMD_MOTION_PROFILE + profile index (see Acceleration::NUM_MOTION_PROFILES)
+#define QCMD_MOTION_PROFILE     20
 #define QCMD_FLAP               99
 
+static_assert(QCMD_MOTION_PROFILE + Acceleration::NUM_MOTION_PROFILES <= QCMD_FLAP, "Motion profile commands overlap flap commands");
+
 class SplitflapTask : public Task<SplitflapTask> {
     friend class Task<SplitflapTask>; // Allow base Task to invoke protected run()
 
@@ -130,17 +99,30 @@ class SplitflapTask : public Task<SplitflapTask> {
         
         SplitflapState getState();
 
+        /**
+         * Brings `state` up to date from `since_generation`, the generation a previous call returned (or 0 for a
+         * zero-initialized `state`), copying only the modules that changed since then and setting their bits in
+         * `changed`. Returns the generation `state` is now at. Never blocks the motion loop.
+         */
+        uint32_t getStateChanges(uint32_t since_generation, SplitflapState& state, ModuleBitmask& changed);
+
         void showString(const char *str, uint8_t length, bool force_full_rotation = FORCE_FULL_ROTATION, bool default_unspecified_home = false);
         void resetAll();
         void disableAll();
         void setLed(uint8_t id, bool on);
         void setSensorTest(bool sensor_test);
+        void setSynchronizedArrival(bool synchronized_arrival);
+        void playTimeline(uint16_t loops);
+        void stopTimeline();
 
         void increaseOffsetTenth(uint8_t id);
         void increaseOffsetHalf(uint8_t id);
         void setOffset(uint8_t id);
         void saveAllOffsets();
         void restoreAllOffsets(uint16_t offsets[NUM_MODULES]);
+        void setMotionProfile(uint8_t id, uint8_t profile);
+        void restoreMotionProfiles(uint8_t profiles[NUM_MODULES]);
+        void restoreMaxAccelSteps(uint8_t max_accel_steps[NUM_MODULES]);
 
         //reset offsets
         void resetOffsets(const uint8_t id);
@@ -150,26 +132,56 @@ class SplitflapTask : public Task<SplitflapTask> {
 
         void setConfiguration(Configuration* configuration);
 
+        /** Where uploaded timelines are stored; see timeline.h */
+        TimelineStore& timelineStore();
+
+        /** Events from the motion loop, waiting to be formatted and printed by a single consumer; see motion_log.h */
+        MotionLog& motionLog();
+
     protected:
         void run();
 
     private:
         const LedMode led_mode_;
-        const SemaphoreHandle_t state_semaphore_;
         const SemaphoreHandle_t configuration_semaphore_;
         QueueHandle_t queue_;
         Command queue_receive_buffer_ = {};
+        // Flap targets, configs, module actions and LEDs, which don't go through queue_
+        CommandMailbox mailbox_;
+        uint8_t mailbox_flaps_[NUM_MODULES] = {};
+        uint8_t mailbox_actions_[NUM_MODULES] = {};
+        uint8_t mailbox_leds_[NUM_MODULES] = {};
+        ModuleConfigs mailbox_configs_ = {};
         Logger* logger_;
         
         // Protected by configuration_semaphore_
         Configuration* configuration_;
+        // Writes rest positions and learned speeds, so this task never waits on FFat for them
+        ConfigurationSaveTask configuration_save_task_;
 
         bool all_stopped_ = true;
 
+        StepScheduler step_scheduler_;
+
         uint32_t last_sensor_print_millis_ = 0;
         bool sensor_test_ = SENSOR_TEST;
+        bool synchronized_arrival_ = false;
+#if FAST_BOOT
+        // Whether the saved configuration currently says (or is about to) that every module is at rest at its
+        // saved position
+        bool clean_shutdown_saved_ = false;
+        // Moves are held until configuration_save_task_ has cleared the clean shutdown marker
+        bool clearing_clean_shutdown_ = false;
+        uint32_t settled_since_millis_ = 0;
+#endif
+#if ADAPTIVE_SPEED
+        uint32_t max_accel_steps_settled_since_millis_ = 0;
+#endif
         ModuleConfigs current_configs_ = {};
 
+        TimelineStore timeline_store_;
+        TimelinePlayer timeline_player_;
+
 #ifdef CHAINLINK
         uint8_t loopback_current_out_index_ = 0;
         uint16_t loopback_step_index_ = 0;
@@ -177,13 +189,29 @@ class SplitflapTask : public Task<SplitflapTask> {
         bool loopback_all_ok_ = false;
 #endif
 
-        // Cached state. Protected by state_semaphore_
-        SplitflapState state_cache_;
+        // Published state, for other tasks to copy without locking
+        SplitflapStateCache state_cache_;
         void updateStateCache();
 
         void processQueue();
+        void applyMailbox(uint32_t before);
+        void applyFlaps(uint32_t before);
+        void applyActions(uint32_t before);
+        void applyLeds(uint32_t before);
+        void applyConfigs(const ModuleConfigs& configs);
         void runUpdate();
+        void restorePositionsOrHome();
+        bool anyModuleMoving();
+#if FAST_BOOT
+        void setCleanShutdown(bool clean_shutdown);
+#endif
+#if ADAPTIVE_SPEED
+        void saveMaxAccelSteps();
+#endif
+        void showTimelineFrame(const uint8_t* targets, uint8_t flags);
+        void stopTimelinePlayback();
         void sensorTestUpdate();
+        void logStepTiming();
         void log(const char* msg);
 
         int8_t findFlapIndex(uint8_t character);
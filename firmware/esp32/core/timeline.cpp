@@ -0,0 +1,273 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include <FFat.h>
+
+#include "configuration.h"
+#include "semaphore_guard.h"
+#include "timeline.h"
+
+static const char* TIMELINE_PATH = "/timeline.bin";
+static const char* UPLOAD_PATH = "/timeline.tmp";
+
+static const uint32_t MAX_CATCH_UP_MILLIS = 100;
+
+static bool parseHeader(const uint8_t* buffer, TimelineHeader& header) {
+    if (memcmp(buffer, "SFTL", 4) != 0 || buffer[4] != TIMELINE_VERSION) {
+        return false;
+    }
+    header.module_count = buffer[5];
+    header.frame_count = buffer[6] | (buffer[7] << 8);
+    return header.module_count > 0 && header.frame_count > 0;
+}
+
+static uint32_t timelineSize(const TimelineHeader& header) {
+    return TIMELINE_HEADER_SIZE + (uint32_t)header.frame_count * (TIMELINE_FRAME_HEADER_SIZE + header.module_count);
+}
+
+TimelineStore::TimelineStore() {
+    mutex_ = xSemaphoreCreateMutex();
+    assert(mutex_ != NULL);
+}
+
+TimelineStore::~TimelineStore() {
+    vSemaphoreDelete(mutex_);
+}
+
+bool TimelineStore::writeChunk(uint32_t offset, const uint8_t* data, size_t length) {
+    SemaphoreGuard lock(mutex_);
+    if (offset != 0 && offset != upload_size_) {
+        char buf[100];
+        snprintf(buf, sizeof(buf), "Timeline chunk out of order: got offset %u but expected %u", offset, upload_size_);
+        log(buf);
+        return false;
+    }
+
+    FatGuard fatGuard(logger_);
+    if (!fatGuard.mounted_) {
+        return false;
+    }
+    File f = FFat.open(UPLOAD_PATH, offset == 0 ? FILE_WRITE : FILE_APPEND);
+    if (!f) {
+        log("Failed to open timeline upload file");
+        return false;
+    }
+    size_t written = f.write(data, length);
+    f.close();
+
+    if (written != length) {
+        log("Failed to write timeline chunk");
+        upload_size_ = 0;
+        return false;
+    }
+    upload_size_ = offset + length;
+    return true;
+}
+
+bool TimelineStore::finishUpload() {
+    SemaphoreGuard lock(mutex_);
+    FatGuard fatGuard(logger_);
+    if (!fatGuard.mounted_) {
+        return false;
+    }
+
+    File f = FFat.open(UPLOAD_PATH);
+    if (!f) {
+        log("No timeline was uploaded");
+        return false;
+    }
+    uint8_t buffer[TIMELINE_HEADER_SIZE];
+    TimelineHeader header;
+    bool valid = f.read(buffer, sizeof(buffer)) == sizeof(buffer)
+        && parseHeader(buffer, header)
+        && f.size() == timelineSize(header);
+    f.close();
+    upload_size_ = 0;
+
+    if (!valid) {
+        log("Invalid timeline; keeping the stored one");
+        FFat.remove(UPLOAD_PATH);
+        return false;
+    }
+
+    FFat.remove(TIMELINE_PATH);
+    if (!FFat.rename(UPLOAD_PATH, TIMELINE_PATH)) {
+        log("Failed to store timeline");
+        return false;
+    }
+    generation_++;
+
+    char buf[100];
+    snprintf(buf, sizeof(buf), "Stored timeline: %u frames of %u modules", header.frame_count, header.module_count);
+    log(buf);
+    return true;
+}
+
+bool TimelineStore::readHeader(TimelineHeader& header) {
+    SemaphoreGuard lock(mutex_);
+    FatGuard fatGuard(logger_);
+    if (!fatGuard.mounted_) {
+        return false;
+    }
+
+    File f = FFat.open(TIMELINE_PATH);
+    if (!f) {
+        log("No timeline stored");
+        return false;
+    }
+    uint8_t buffer[TIMELINE_HEADER_SIZE];
+    bool valid = f.read(buffer, sizeof(buffer)) == sizeof(buffer)
+        && parseHeader(buffer, header)
+        && f.size() == timelineSize(header);
+    f.close();
+
+    if (!valid) {
+        log("Stored timeline is invalid");
+    }
+    return valid;
+}
+
+bool TimelineStore::readFrames(const TimelineHeader& header, uint16_t first, uint16_t count, uint8_t* frames) {
+    SemaphoreGuard lock(mutex_);
+    // Called from the motion loop during playback, so don't log every mount
+    FatGuard fatGuard(nullptr);
+    if (!fatGuard.mounted_) {
+        log("Failed to mount FFat to read timeline");
+        return false;
+    }
+
+    File f = FFat.open(TIMELINE_PATH);
+    if (!f) {
+        log("Failed to open timeline");
+        return false;
+    }
+    const uint16_t stride = NUM_MODULES + TIMELINE_FRAME_HEADER_SIZE;
+    const uint16_t file_stride = header.module_count + TIMELINE_FRAME_HEADER_SIZE;
+    const uint16_t read_length = min(stride, file_stride);
+    bool ok = true;
+    for (uint16_t i = 0; i < count && ok; i++) {
+        uint8_t* frame = &frames[i * stride];
+        ok = f.seek(TIMELINE_HEADER_SIZE + (uint32_t)(first + i) * file_stride)
+            && f.read(frame, read_length) == read_length;
+        memset(frame + read_length, TIMELINE_NO_CHANGE, stride - read_length);
+    }
+    f.close();
+
+    if (!ok) {
+        log("Failed to read timeline frames");
+    }
+    return ok;
+}
+
+uint32_t TimelineStore::generation() {
+    // A single aligned word, so it's safe to read without the mutex
+    return generation_;
+}
+
+void TimelineStore::setLogger(Logger* logger) {
+    logger_ = logger;
+}
+
+void TimelineStore::log(const char* msg) {
+    if (logger_ != nullptr) {
+        logger_->log(msg);
+    }
+}
+
+
+bool TimelinePlayer::start(TimelineStore& store, uint16_t loops, uint32_t now_millis) {
+    playing_ = false;
+    finished_ = false;
+    if (!store.readHeader(header_)) {
+        return false;
+    }
+    generation_ = store.generation();
+    loops_ = loops;
+    loops_done_ = 0;
+    next_frame_ = 0;
+    base_millis_ = now_millis;
+    // A first frame with TIMELINE_FLAG_AFTER_STOP waits for whatever was already moving
+    waiting_for_stop_ = true;
+    cache_count_ = 0;
+    playing_ = true;
+    return true;
+}
+
+void TimelinePlayer::stop() {
+    playing_ = false;
+    finished_ = false;
+}
+
+void TimelinePlayer::finish() {
+    playing_ = false;
+    finished_ = true;
+}
+
+const uint8_t* TimelinePlayer::update(TimelineStore& store, uint32_t now_millis, bool all_stopped, uint8_t& flags) {
+    finished_ = false;
+    if (!playing_) {
+        return nullptr;
+    }
+    if (store.generation() != generation_) {
+        // A new timeline was uploaded; the frames no longer line up with header_
+        finish();
+        return nullptr;
+    }
+
+    if (next_frame_ < cache_first_ || next_frame_ >= cache_first_ + cache_count_) {
+        if (!all_stopped) {
+            return nullptr;
+        }
+        uint8_t count = min((uint16_t)(header_.frame_count - next_frame_), (uint16_t)TIMELINE_CACHE_FRAMES);
+        if (!store.readFrames(header_, next_frame_, count, cache_)) {
+            finish();
+            return nullptr;
+        }
+        cache_first_ = next_frame_;
+        cache_count_ = count;
+    }
+
+    const uint8_t* frame = &cache_[(next_frame_ - cache_first_) * FRAME_STRIDE];
+    uint16_t delay_millis = frame[0] | (frame[1] << 8);
+    flags = frame[2];
+    if (flags & TIMELINE_FLAG_AFTER_STOP) {
+        if (waiting_for_stop_) {
+            if (!all_stopped) {
+                return nullptr;
+            }
+            waiting_for_stop_ = false;
+            base_millis_ = now_millis;
+        }
+    }
+    uint32_t due_millis = base_millis_ + delay_millis;
+    if ((int32_t)(now_millis - due_millis) < 0) {
+        return nullptr;
+    }
+
+    // Keep to the schedule through loop pass jitter, but after a real stall (e.g. waiting to read more frames),
+    // carry on from here rather than rushing through the frames that were missed
+    base_millis_ = now_millis - due_millis > MAX_CATCH_UP_MILLIS ? now_millis : due_millis;
+    waiting_for_stop_ = true;
+    next_frame_++;
+    if (next_frame_ == header_.frame_count) {
+        next_frame_ = 0;
+        loops_done_++;
+        if (loops_ != 0 && loops_done_ >= loops_) {
+            // Still show this last frame
+            finish();
+        }
+    }
+    return frame + TIMELINE_FRAME_HEADER_SIZE;
+}
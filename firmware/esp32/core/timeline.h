@@ -0,0 +1,148 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#pragma once
+
+#include <Arduino.h>
+
+#include "config.h"
+#include "logger.h"
+
+/**
+ * Animation timelines: a sequence of frames of per-module flap targets, uploaded once and stored in FFat, then
+ * played back on the device by SplitflapTask (see TimelinePlayer) with no host in the loop.
+ *
+ * File format (all values little-endian):
+ *
+ *   Header, TIMELINE_HEADER_SIZE bytes:
+ *     char[4]   magic, "SFTL"
+ *     uint8     version, TIMELINE_VERSION
+ *     uint8     module_count, the number of targets in each frame
+ *     uint16    frame_count
+ *
+ *   frame_count frames, TIMELINE_FRAME_HEADER_SIZE + module_count bytes each:
+ *     uint16    delay_millis, how long after the previous frame (or the start of playback) to show this one
+ *     uint8     flags, any of the TIMELINE_FLAG_* values
+ *     uint8     reserved, 0
+ *     uint8[]   target flap index for each module, or TIMELINE_NO_CHANGE to leave the module alone
+ *
+ * module_count doesn't have to match NUM_MODULES: extra targets are ignored and missing ones are left alone.
+ */
+static const uint8_t TIMELINE_VERSION = 1;
+static const uint8_t TIMELINE_HEADER_SIZE = 8;
+static const uint8_t TIMELINE_FRAME_HEADER_SIZE = 4;
+static const uint8_t TIMELINE_NO_CHANGE = 0xFF;
+
+// delay_millis counts from when every module has stopped after the previous frame, rather than from when the
+// previous frame was shown
+static const uint8_t TIMELINE_FLAG_AFTER_STOP = 1 << 0;
+// Modules moved by the frame all land at the same time (see MotionEngine::SynchronizeArrival())
+static const uint8_t TIMELINE_FLAG_SYNCHRONIZED_ARRIVAL = 1 << 1;
+// Modules already showing their target flap go all the way around again
+static const uint8_t TIMELINE_FLAG_FORCE_MOVEMENT = 1 << 2;
+
+struct TimelineHeader {
+    uint8_t module_count;
+    uint16_t frame_count;
+};
+
+/**
+ * Stores one timeline in FFat. Uploads go to a temporary file, which only replaces the stored timeline once it's
+ * complete and valid, so a broken upload never leaves a half-written timeline behind.
+ */
+class TimelineStore {
+    public:
+        TimelineStore();
+        ~TimelineStore();
+
+        void setLogger(Logger* logger);
+
+        /** Appends a chunk of an upload. Chunks must arrive in order; offset 0 starts a new upload. */
+        bool writeChunk(uint32_t offset, const uint8_t* data, size_t length);
+        /** Validates the uploaded timeline and replaces the stored one with it. */
+        bool finishUpload();
+
+        bool readHeader(TimelineHeader& header);
+        /**
+         * Reads frames [first, first + count) into `frames`, NUM_MODULES + TIMELINE_FRAME_HEADER_SIZE bytes per
+         * frame, with targets for any modules beyond header.module_count set to TIMELINE_NO_CHANGE.
+         */
+        bool readFrames(const TimelineHeader& header, uint16_t first, uint16_t count, uint8_t* frames);
+
+        /** Changes whenever a new timeline is stored, so that playback can tell the file changed underneath it */
+        uint32_t generation();
+
+    private:
+        SemaphoreHandle_t mutex_;
+        Logger* logger_ = nullptr;
+        uint32_t upload_size_ = 0;
+        uint32_t generation_ = 0;
+
+        void log(const char* msg);
+};
+
+/**
+ * Plays a stored timeline. Lives in SplitflapTask and is driven by its motion loop, which calls update() every
+ * pass with whether all modules have stopped. Frames are scheduled from the ideal time of the frame before, so
+ * loop pass jitter doesn't add up over a long timeline.
+ *
+ * Frames are read from FFat TIMELINE_CACHE_FRAMES at a time, and only while every module is stopped, so that
+ * flash reads never hold up the motion loop mid-move. A frame that isn't due until after the previous one has
+ * stopped (TIMELINE_FLAG_AFTER_STOP) is therefore never late, but a long run of frames that overlap each other's
+ * moves can be: once the cache runs out, the next frame waits for everything to stop.
+ */
+class TimelinePlayer {
+    public:
+        static const uint8_t TIMELINE_CACHE_FRAMES = 16;
+        static const uint16_t FRAME_STRIDE = NUM_MODULES + TIMELINE_FRAME_HEADER_SIZE;
+
+        /** Starts from the first frame; loops is how many times to play the timeline, or 0 to repeat forever. */
+        bool start(TimelineStore& store, uint16_t loops, uint32_t now_millis);
+        void stop();
+        bool playing() const {
+            return playing_;
+        }
+
+        /**
+         * Call every motion loop pass. If the next frame is due, returns its NUM_MODULES targets and sets `flags`;
+         * otherwise returns nullptr.
+         */
+        const uint8_t* update(TimelineStore& store, uint32_t now_millis, bool all_stopped, uint8_t& flags);
+
+        /** Whether the last update() stopped playback because the end was reached or the timeline changed */
+        bool finished() const {
+            return finished_;
+        }
+
+    private:
+        bool playing_ = false;
+        bool finished_ = false;
+        TimelineHeader header_ = {};
+        uint32_t generation_ = 0;
+        uint16_t loops_ = 0;
+        uint16_t loops_done_ = 0;
+
+        uint16_t next_frame_ = 0;
+        // Ideal time the previous frame was (or the playback started) at, which TIMELINE_FLAG_AFTER_STOP delays
+        // count from once waiting_for_stop_ is cleared
+        uint32_t base_millis_ = 0;
+        bool waiting_for_stop_ = false;
+
+        uint16_t cache_first_ = 0;
+        uint8_t cache_count_ = 0;
+        uint8_t cache_[TIMELINE_CACHE_FRAMES * FRAME_STRIDE];
+
+        void finish();
+};
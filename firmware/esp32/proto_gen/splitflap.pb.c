@@ -6,12 +6,15 @@
 #error Regenerate this file with the current version of nanopb generator.
 #endif
 
-PB_BIND(PB_SplitflapState, PB_SplitflapState, 4)
+PB_BIND(PB_SplitflapState, PB_SplitflapState, AUTO)
 
 
 PB_BIND(PB_SplitflapState_ModuleState, PB_SplitflapState_ModuleState, AUTO)
 
 
+PB_BIND(PB_SplitflapStateDelta, PB_SplitflapStateDelta, 2)
+
+
 PB_BIND(PB_Log, PB_Log, 2)
 
 
@@ -33,16 +36,16 @@ PB_BIND(PB_GeneralState, PB_GeneralState, AUTO)
 PB_BIND(PB_GeneralState_BuildInfo, PB_GeneralState_BuildInfo, AUTO)
 
 
-PB_BIND(PB_FromSplitflap, PB_FromSplitflap, 4)
+PB_BIND(PB_FromSplitflap, PB_FromSplitflap, 2)
 
 
-PB_BIND(PB_SplitflapCommand, PB_SplitflapCommand, 2)
+PB_BIND(PB_SplitflapCommand, PB_SplitflapCommand, AUTO)
 
 
 PB_BIND(PB_SplitflapCommand_ModuleCommand, PB_SplitflapCommand_ModuleCommand, AUTO)
 
 
-PB_BIND(PB_SplitflapConfig, PB_SplitflapConfig, 2)
+PB_BIND(PB_SplitflapConfig, PB_SplitflapConfig, AUTO)
 
 
 PB_BIND(PB_SplitflapConfig_ModuleConfig, PB_SplitflapConfig_ModuleConfig, AUTO)
@@ -51,6 +54,12 @@ PB_BIND(PB_SplitflapConfig_ModuleConfig, PB_SplitflapConfig_ModuleConfig, AUTO)
 PB_BIND(PB_RequestState, PB_RequestState, AUTO)
 
 
+PB_BIND(PB_TimelineUpload, PB_TimelineUpload, 2)
+
+
+PB_BIND(PB_TimelineControl, PB_TimelineControl, AUTO)
+
+
 PB_BIND(PB_ToSplitflap, PB_ToSplitflap, 2)
 
 
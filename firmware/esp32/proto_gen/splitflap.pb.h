@@ -41,19 +41,25 @@ typedef enum _PB_SplitflapCommand_ModuleCommand_Action {
     PB_SplitflapCommand_ModuleCommand_Action_NO_OP = 0, 
     PB_SplitflapCommand_ModuleCommand_Action_GO_TO_FLAP = 1, 
     PB_SplitflapCommand_ModuleCommand_Action_RESET_AND_HOME = 2, 
+    PB_SplitflapCommand_ModuleCommand_Action_QUEUE_FLAP = 3, 
+    PB_SplitflapCommand_ModuleCommand_Action_CLEAR_QUEUE = 4, 
     PB_SplitflapCommand_ModuleCommand_Action_INCREASE_OFFSET_TENTH = 90, 
     PB_SplitflapCommand_ModuleCommand_Action_INCREASE_OFFSET_HALF = 91, 
-    PB_SplitflapCommand_ModuleCommand_Action_SET_OFFSET = 92 
+    PB_SplitflapCommand_ModuleCommand_Action_SET_OFFSET = 92, 
+    PB_SplitflapCommand_ModuleCommand_Action_SET_MOTION_PROFILE = 93 
 } PB_SplitflapCommand_ModuleCommand_Action;
 
-/* Struct definitions */
-typedef struct _PB_RequestState { 
-    char dummy_field;
-} PB_RequestState;
+typedef enum _PB_TimelineControl_Action { 
+    PB_TimelineControl_Action_STOP = 0, 
+    PB_TimelineControl_Action_PLAY = 1 
+} PB_TimelineControl_Action;
 
+/* Struct definitions */
 /* * Chainlink Base state -- only reported by Chainlink Base firmware, NOT standard Chainlink firmware */
 typedef struct _PB_Ack { 
     uint32_t nonce; 
+    uint32_t window_end_nonce; 
+    uint32_t window_received; 
 } PB_Ack;
 
 typedef struct _PB_GeneralState_BuildInfo { 
@@ -71,13 +77,30 @@ typedef struct _PB_PersistentConfiguration {
     uint32_t num_flaps; 
     pb_size_t module_offset_steps_count;
     uint16_t module_offset_steps[255]; 
+    pb_size_t module_motion_profile_count;
+    uint8_t module_motion_profile[255]; 
+    pb_size_t module_rest_step_count;
+    uint16_t module_rest_step[255]; 
+    pb_size_t module_rest_phase_count;
+    uint8_t module_rest_phase[255]; 
+    pb_size_t module_rest_flap_index_count;
+    uint8_t module_rest_flap_index[255]; 
+    bool clean_shutdown; 
+    uint16_t steps_per_revolution; 
+    pb_size_t module_max_accel_step_count;
+    uint8_t module_max_accel_step[255]; 
 } PB_PersistentConfiguration;
 
 typedef struct _PB_SplitflapCommand_ModuleCommand { 
     PB_SplitflapCommand_ModuleCommand_Action action; 
     uint8_t param; 
+    uint16_t dwell_millis; 
 } PB_SplitflapCommand_ModuleCommand;
 
+typedef struct _PB_RequestState { 
+    bool state_deltas; 
+} PB_RequestState;
+
 typedef struct _PB_SplitflapConfig_ModuleConfig { 
     uint8_t target_flap_index; 
     uint8_t movement_nonce; 
@@ -91,6 +114,9 @@ typedef struct _PB_SplitflapState_ModuleState {
     bool home_state; 
     uint8_t count_unexpected_home; 
     uint8_t count_missed_home; 
+    uint16_t queue_wait_millis; 
+    uint8_t queued_flaps; 
+    uint8_t max_accel_step; 
 } PB_SplitflapState_ModuleState;
 
 typedef struct _PB_SupervisorState_FaultInfo { 
@@ -105,6 +131,21 @@ typedef struct _PB_SupervisorState_PowerChannelState {
     bool on; 
 } PB_SupervisorState_PowerChannelState;
 
+typedef struct _PB_TimelineControl { 
+    PB_TimelineControl_Action action; 
+    uint16_t loops; 
+} PB_TimelineControl;
+
+typedef PB_BYTES_ARRAY_T(1024) PB_TimelineUpload_data_t;
+/* * A chunk of an animation timeline to store on the device (see firmware/esp32/core/timeline.h for the format).
+ Chunks must be sent in order, starting from offset 0. The stored timeline is only replaced once the chunk with
+ `done` set arrives and the whole upload checks out. */
+typedef struct _PB_TimelineUpload { 
+    uint32_t offset; 
+    PB_TimelineUpload_data_t data; 
+    bool done; 
+} PB_TimelineUpload;
+
 typedef PB_BYTES_ARRAY_T(80) PB_GeneralState_flap_character_set_t;
 typedef struct _PB_GeneralState { 
     uint16_t serial_protocol_version; 
@@ -112,26 +153,41 @@ typedef struct _PB_GeneralState {
     bool has_build_info;
     PB_GeneralState_BuildInfo build_info; 
     PB_GeneralState_flap_character_set_t flap_character_set; 
+    uint8_t module_queue_depth; 
+    uint8_t max_accel_step; 
+    uint8_t ack_window_size; 
 } PB_GeneralState;
 
 /* * Non-volatile on-device storage schema */
 typedef struct _PB_SplitflapCommand { 
-    pb_size_t modules_count;
-    PB_SplitflapCommand_ModuleCommand modules[255]; 
+    pb_callback_t modules; 
     bool save_all_offsets; 
 } PB_SplitflapCommand;
 
 typedef struct _PB_SplitflapConfig { 
-    pb_size_t modules_count;
-    PB_SplitflapConfig_ModuleConfig modules[255]; 
+    pb_callback_t modules; 
+    bool synchronized_arrival; 
 } PB_SplitflapConfig;
 
 typedef struct _PB_SplitflapState { 
-    pb_size_t modules_count;
-    PB_SplitflapState_ModuleState modules[255]; 
+    pb_callback_t modules; 
     bool loopbacks_ok; 
+    uint32_t generation; 
 } PB_SplitflapState;
 
+typedef PB_BYTES_ARRAY_T(255) PB_SplitflapStateDelta_module_indices_t;
+/* * Only the modules that changed since the SplitflapState (or SplitflapStateDelta) numbered base_generation,
+ sent in place of a full SplitflapState once a client has asked for deltas (see RequestState.state_deltas).
+ A full SplitflapState still goes out every few seconds and whenever state is requested, as a keyframe for
+ clients that missed a delta to start over from. */
+typedef struct _PB_SplitflapStateDelta { 
+    uint32_t base_generation; 
+    uint32_t generation; 
+    pb_callback_t modules; 
+    PB_SplitflapStateDelta_module_indices_t module_indices; 
+    bool loopbacks_ok; 
+} PB_SplitflapStateDelta;
+
 /* * Chainlink general state, reported infrequently -- only reported by standard Chainlink firmware, NOT Chainlink Base firmware */
 typedef struct _PB_SupervisorState { 
     uint32_t uptime_millis; 
@@ -150,17 +206,22 @@ typedef struct _PB_FromSplitflap {
         PB_Ack ack;
         PB_SupervisorState supervisor_state;
         PB_GeneralState general_state;
+        PB_SplitflapStateDelta splitflap_state_delta;
     } payload; 
 } PB_FromSplitflap;
 
 typedef struct _PB_ToSplitflap { 
     uint32_t nonce; 
+    pb_callback_t cb_payload;
     pb_size_t which_payload;
     union {
         PB_SplitflapCommand splitflap_command;
         PB_SplitflapConfig splitflap_config;
         PB_RequestState request_state;
+        PB_TimelineUpload timeline_upload;
+        PB_TimelineControl timeline_control;
     } payload; 
+    bool pipelined; 
 } PB_ToSplitflap;
 
 
@@ -178,8 +239,12 @@ typedef struct _PB_ToSplitflap {
 #define _PB_SupervisorState_FaultInfo_FaultType_ARRAYSIZE ((PB_SupervisorState_FaultInfo_FaultType)(PB_SupervisorState_FaultInfo_FaultType_UNEXPECTED_POWER+1))
 
 #define _PB_SplitflapCommand_ModuleCommand_Action_MIN PB_SplitflapCommand_ModuleCommand_Action_NO_OP
-#define _PB_SplitflapCommand_ModuleCommand_Action_MAX PB_SplitflapCommand_ModuleCommand_Action_SET_OFFSET
-#define _PB_SplitflapCommand_ModuleCommand_Action_ARRAYSIZE ((PB_SplitflapCommand_ModuleCommand_Action)(PB_SplitflapCommand_ModuleCommand_Action_SET_OFFSET+1))
+#define _PB_SplitflapCommand_ModuleCommand_Action_MAX PB_SplitflapCommand_ModuleCommand_Action_SET_MOTION_PROFILE
+#define _PB_SplitflapCommand_ModuleCommand_Action_ARRAYSIZE ((PB_SplitflapCommand_ModuleCommand_Action)(PB_SplitflapCommand_ModuleCommand_Action_SET_MOTION_PROFILE+1))
+
+#define _PB_TimelineControl_Action_MIN PB_TimelineControl_Action_STOP
+#define _PB_TimelineControl_Action_MAX PB_TimelineControl_Action_PLAY
+#define _PB_TimelineControl_Action_ARRAYSIZE ((PB_TimelineControl_Action)(PB_TimelineControl_Action_PLAY+1))
 
 
 #ifdef __cplusplus
@@ -187,43 +252,51 @@ extern "C" {
 #endif
 
 /* Initializer values for message structs */
-#define PB_SplitflapState_init_default           {0, {PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default, PB_SplitflapState_ModuleState_init_default}, 0}
-#define PB_SplitflapState_ModuleState_init_default {_PB_SplitflapState_ModuleState_State_MIN, 0, 0, 0, 0, 0}
+#define PB_SplitflapState_init_default           {{{NULL}, NULL}, 0, 0}
+#define PB_SplitflapState_ModuleState_init_default {_PB_SplitflapState_ModuleState_State_MIN, 0, 0, 0, 0, 0, 0, 0, 0}
+#define PB_SplitflapStateDelta_init_default      {0, 0, {{NULL}, NULL}, {0, {0}}, 0}
 #define PB_Log_init_default                      {""}
-#define PB_Ack_init_default                      {0}
+#define PB_Ack_init_default                      {0, 0, 0}
 #define PB_SupervisorState_init_default          {0, _PB_SupervisorState_State_MIN, 0, {PB_SupervisorState_PowerChannelState_init_default, PB_SupervisorState_PowerChannelState_init_default, PB_SupervisorState_PowerChannelState_init_default, PB_SupervisorState_PowerChannelState_init_default, PB_SupervisorState_PowerChannelState_init_default}, false, PB_SupervisorState_FaultInfo_init_default}
 #define PB_SupervisorState_PowerChannelState_init_default {0, 0, 0}
 #define PB_SupervisorState_FaultInfo_init_default {_PB_SupervisorState_FaultInfo_FaultType_MIN, "", 0}
-#define PB_GeneralState_init_default             {0, 0, false, PB_GeneralState_BuildInfo_init_default, {0, {0}}}
+#define PB_GeneralState_init_default             {0, 0, false, PB_GeneralState_BuildInfo_init_default, {0, {0}}, 0, 0, 0}
 #define PB_GeneralState_BuildInfo_init_default   {"", "", ""}
 #define PB_FromSplitflap_init_default            {0, {PB_SplitflapState_init_default}}
-#define PB_SplitflapCommand_init_default         {0, {PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default, PB_SplitflapCommand_ModuleCommand_init_default}, 0}
-#define PB_SplitflapCommand_ModuleCommand_init_default {_PB_SplitflapCommand_ModuleCommand_Action_MIN, 0}
-#define PB_SplitflapConfig_init_default          {0, {PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default, PB_SplitflapConfig_ModuleConfig_init_default}}
+#define PB_SplitflapCommand_init_default         {{{NULL}, NULL}, 0}
+#define PB_SplitflapCommand_ModuleCommand_init_default {_PB_SplitflapCommand_ModuleCommand_Action_MIN, 0, 0}
+#define PB_SplitflapConfig_init_default          {{{NULL}, NULL}, 0}
 #define PB_SplitflapConfig_ModuleConfig_init_default {0, 0, 0}
 #define PB_RequestState_init_default             {0}
-#define PB_ToSplitflap_init_default              {0, 0, {PB_SplitflapCommand_init_default}}
-#define PB_PersistentConfiguration_init_default  {0, 0, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}}
-#define PB_SplitflapState_init_zero              {0, {PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero, PB_SplitflapState_ModuleState_init_zero}, 0}
-#define PB_SplitflapState_ModuleState_init_zero  {_PB_SplitflapState_ModuleState_State_MIN, 0, 0, 0, 0, 0}
+#define PB_TimelineUpload_init_default           {0, {0, {0}}, 0}
+#define PB_TimelineControl_init_default          {_PB_TimelineControl_Action_MIN, 0}
+#define PB_ToSplitflap_init_default              {0, {{NULL}, NULL}, 0, {PB_SplitflapCommand_init_default}, 0}
+#define PB_PersistentConfiguration_init_default  {0, 0, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 0, 0, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}}
+#define PB_SplitflapState_init_zero              {{{NULL}, NULL}, 0, 0}
+#define PB_SplitflapState_ModuleState_init_zero  {_PB_SplitflapState_ModuleState_State_MIN, 0, 0, 0, 0, 0, 0, 0, 0}
+#define PB_SplitflapStateDelta_init_zero         {0, 0, {{NULL}, NULL}, {0, {0}}, 0}
 #define PB_Log_init_zero                         {""}
-#define PB_Ack_init_zero                         {0}
+#define PB_Ack_init_zero                         {0, 0, 0}
 #define PB_SupervisorState_init_zero             {0, _PB_SupervisorState_State_MIN, 0, {PB_SupervisorState_PowerChannelState_init_zero, PB_SupervisorState_PowerChannelState_init_zero, PB_SupervisorState_PowerChannelState_init_zero, PB_SupervisorState_PowerChannelState_init_zero, PB_SupervisorState_PowerChannelState_init_zero}, false, PB_SupervisorState_FaultInfo_init_zero}
 #define PB_SupervisorState_PowerChannelState_init_zero {0, 0, 0}
 #define PB_SupervisorState_FaultInfo_init_zero   {_PB_SupervisorState_FaultInfo_FaultType_MIN, "", 0}
-#define PB_GeneralState_init_zero                {0, 0, false, PB_GeneralState_BuildInfo_init_zero, {0, {0}}}
+#define PB_GeneralState_init_zero                {0, 0, false, PB_GeneralState_BuildInfo_init_zero, {0, {0}}, 0, 0, 0}
 #define PB_GeneralState_BuildInfo_init_zero      {"", "", ""}
 #define PB_FromSplitflap_init_zero               {0, {PB_SplitflapState_init_zero}}
-#define PB_SplitflapCommand_init_zero            {0, {PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero, PB_SplitflapCommand_ModuleCommand_init_zero}, 0}
-#define PB_SplitflapCommand_ModuleCommand_init_zero {_PB_SplitflapCommand_ModuleCommand_Action_MIN, 0}
-#define PB_SplitflapConfig_init_zero             {0, {PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero, PB_SplitflapConfig_ModuleConfig_init_zero}}
+#define PB_SplitflapCommand_init_zero            {{{NULL}, NULL}, 0}
+#define PB_SplitflapCommand_ModuleCommand_init_zero {_PB_SplitflapCommand_ModuleCommand_Action_MIN, 0, 0}
+#define PB_SplitflapConfig_init_zero             {{{NULL}, NULL}, 0}
 #define PB_SplitflapConfig_ModuleConfig_init_zero {0, 0, 0}
 #define PB_RequestState_init_zero                {0}
-#define PB_ToSplitflap_init_zero                 {0, 0, {PB_SplitflapCommand_init_zero}}
-#define PB_PersistentConfiguration_init_zero     {0, 0, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}}
+#define PB_TimelineUpload_init_zero              {0, {0, {0}}, 0}
+#define PB_TimelineControl_init_zero             {_PB_TimelineControl_Action_MIN, 0}
+#define PB_ToSplitflap_init_zero                 {0, {{NULL}, NULL}, 0, {PB_SplitflapCommand_init_zero}, 0}
+#define PB_PersistentConfiguration_init_zero     {0, 0, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 0, 0, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}}
 
 /* Field tags (for use in manual encoding/decoding) */
 #define PB_Ack_nonce_tag                         1
+#define PB_Ack_window_end_nonce_tag              2
+#define PB_Ack_window_received_tag               3
 #define PB_GeneralState_BuildInfo_git_hash_tag   1
 #define PB_GeneralState_BuildInfo_build_date_tag 2
 #define PB_GeneralState_BuildInfo_build_os_tag   3
@@ -231,8 +304,17 @@ extern "C" {
 #define PB_PersistentConfiguration_version_tag   1
 #define PB_PersistentConfiguration_num_flaps_tag 2
 #define PB_PersistentConfiguration_module_offset_steps_tag 3
+#define PB_PersistentConfiguration_module_motion_profile_tag 4
+#define PB_PersistentConfiguration_module_rest_step_tag 5
+#define PB_PersistentConfiguration_module_rest_phase_tag 6
+#define PB_PersistentConfiguration_module_rest_flap_index_tag 7
+#define PB_PersistentConfiguration_clean_shutdown_tag 8
+#define PB_PersistentConfiguration_steps_per_revolution_tag 9
+#define PB_PersistentConfiguration_module_max_accel_step_tag 10
 #define PB_SplitflapCommand_ModuleCommand_action_tag 1
 #define PB_SplitflapCommand_ModuleCommand_param_tag 2
+#define PB_SplitflapCommand_ModuleCommand_dwell_millis_tag 3
+#define PB_RequestState_state_deltas_tag         1
 #define PB_SplitflapConfig_ModuleConfig_target_flap_index_tag 1
 #define PB_SplitflapConfig_ModuleConfig_movement_nonce_tag 2
 #define PB_SplitflapConfig_ModuleConfig_reset_nonce_tag 3
@@ -242,21 +324,39 @@ extern "C" {
 #define PB_SplitflapState_ModuleState_home_state_tag 4
 #define PB_SplitflapState_ModuleState_count_unexpected_home_tag 5
 #define PB_SplitflapState_ModuleState_count_missed_home_tag 6
+#define PB_SplitflapState_ModuleState_queue_wait_millis_tag 7
+#define PB_SplitflapState_ModuleState_queued_flaps_tag 8
+#define PB_SplitflapState_ModuleState_max_accel_step_tag 9
 #define PB_SupervisorState_FaultInfo_type_tag    1
 #define PB_SupervisorState_FaultInfo_msg_tag     2
 #define PB_SupervisorState_FaultInfo_ts_millis_tag 3
 #define PB_SupervisorState_PowerChannelState_voltage_volts_tag 1
 #define PB_SupervisorState_PowerChannelState_current_amps_tag 2
 #define PB_SupervisorState_PowerChannelState_on_tag 3
+#define PB_TimelineControl_action_tag            1
+#define PB_TimelineControl_loops_tag             2
+#define PB_TimelineUpload_offset_tag             1
+#define PB_TimelineUpload_data_tag               2
+#define PB_TimelineUpload_done_tag               3
 #define PB_GeneralState_serial_protocol_version_tag 1
 #define PB_GeneralState_uptime_millis_tag        2
 #define PB_GeneralState_build_info_tag           3
 #define PB_GeneralState_flap_character_set_tag   4
+#define PB_GeneralState_module_queue_depth_tag   5
+#define PB_GeneralState_max_accel_step_tag       6
+#define PB_GeneralState_ack_window_size_tag      7
 #define PB_SplitflapCommand_modules_tag          2
 #define PB_SplitflapCommand_save_all_offsets_tag 3
 #define PB_SplitflapConfig_modules_tag           1
+#define PB_SplitflapConfig_synchronized_arrival_tag 2
 #define PB_SplitflapState_modules_tag            1
 #define PB_SplitflapState_loopbacks_ok_tag       2
+#define PB_SplitflapState_generation_tag         3
+#define PB_SplitflapStateDelta_base_generation_tag 1
+#define PB_SplitflapStateDelta_generation_tag    2
+#define PB_SplitflapStateDelta_modules_tag       3
+#define PB_SplitflapStateDelta_module_indices_tag 4
+#define PB_SplitflapStateDelta_loopbacks_ok_tag  5
 #define PB_SupervisorState_uptime_millis_tag     1
 #define PB_SupervisorState_state_tag             2
 #define PB_SupervisorState_power_channels_tag    3
@@ -266,16 +366,21 @@ extern "C" {
 #define PB_FromSplitflap_ack_tag                 3
 #define PB_FromSplitflap_supervisor_state_tag    4
 #define PB_FromSplitflap_general_state_tag       5
+#define PB_FromSplitflap_splitflap_state_delta_tag 6
 #define PB_ToSplitflap_nonce_tag                 1
 #define PB_ToSplitflap_splitflap_command_tag     2
 #define PB_ToSplitflap_splitflap_config_tag      3
 #define PB_ToSplitflap_request_state_tag         4
+#define PB_ToSplitflap_timeline_upload_tag       5
+#define PB_ToSplitflap_timeline_control_tag      6
+#define PB_ToSplitflap_pipelined_tag             7
 
 /* Struct field encoding specification for nanopb */
 #define PB_SplitflapState_FIELDLIST(X, a) \
-X(a, STATIC,   REPEATED, MESSAGE,  modules,           1) \
-X(a, STATIC,   SINGULAR, BOOL,     loopbacks_ok,      2)
-#define PB_SplitflapState_CALLBACK NULL
+X(a, CALLBACK, REPEATED, MESSAGE,  modules,           1) \
+X(a, STATIC,   SINGULAR, BOOL,     loopbacks_ok,      2) \
+X(a, STATIC,   SINGULAR, UINT32,   generation,        3)
+#define PB_SplitflapState_CALLBACK pb_default_field_callback
 #define PB_SplitflapState_DEFAULT NULL
 #define PB_SplitflapState_modules_MSGTYPE PB_SplitflapState_ModuleState
 
@@ -285,17 +390,32 @@ X(a, STATIC,   SINGULAR, UINT32,   flap_index,        2) \
 X(a, STATIC,   SINGULAR, BOOL,     moving,            3) \
 X(a, STATIC,   SINGULAR, BOOL,     home_state,        4) \
 X(a, STATIC,   SINGULAR, UINT32,   count_unexpected_home,   5) \
-X(a, STATIC,   SINGULAR, UINT32,   count_missed_home,   6)
+X(a, STATIC,   SINGULAR, UINT32,   count_missed_home,   6) \
+X(a, STATIC,   SINGULAR, UINT32,   queue_wait_millis,   7) \
+X(a, STATIC,   SINGULAR, UINT32,   queued_flaps,      8) \
+X(a, STATIC,   SINGULAR, UINT32,   max_accel_step,    9)
 #define PB_SplitflapState_ModuleState_CALLBACK NULL
 #define PB_SplitflapState_ModuleState_DEFAULT NULL
 
+#define PB_SplitflapStateDelta_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   base_generation,   1) \
+X(a, STATIC,   SINGULAR, UINT32,   generation,        2) \
+X(a, CALLBACK, REPEATED, MESSAGE,  modules,           3) \
+X(a, STATIC,   SINGULAR, BYTES,    module_indices,    4) \
+X(a, STATIC,   SINGULAR, BOOL,     loopbacks_ok,      5)
+#define PB_SplitflapStateDelta_CALLBACK pb_default_field_callback
+#define PB_SplitflapStateDelta_DEFAULT NULL
+#define PB_SplitflapStateDelta_modules_MSGTYPE PB_SplitflapState_ModuleState
+
 #define PB_Log_FIELDLIST(X, a) \
 X(a, STATIC,   SINGULAR, STRING,   msg,               1)
 #define PB_Log_CALLBACK NULL
 #define PB_Log_DEFAULT NULL
 
 #define PB_Ack_FIELDLIST(X, a) \
-X(a, STATIC,   SINGULAR, UINT32,   nonce,             1)
+X(a, STATIC,   SINGULAR, UINT32,   nonce,             1) \
+X(a, STATIC,   SINGULAR, UINT32,   window_end_nonce,   2) \
+X(a, STATIC,   SINGULAR, UINT32,   window_received,   3)
 #define PB_Ack_CALLBACK NULL
 #define PB_Ack_DEFAULT NULL
 
@@ -327,7 +447,10 @@ X(a, STATIC,   SINGULAR, UINT32,   ts_millis,         3)
 X(a, STATIC,   SINGULAR, UINT32,   serial_protocol_version,   1) \
 X(a, STATIC,   SINGULAR, UINT32,   uptime_millis,     2) \
 X(a, STATIC,   OPTIONAL, MESSAGE,  build_info,        3) \
-X(a, STATIC,   SINGULAR, BYTES,    flap_character_set,   4)
+X(a, STATIC,   SINGULAR, BYTES,    flap_character_set,   4) \
+X(a, STATIC,   SINGULAR, UINT32,   module_queue_depth,   5) \
+X(a, STATIC,   SINGULAR, UINT32,   max_accel_step,    6) \
+X(a, STATIC,   SINGULAR, UINT32,   ack_window_size,   7)
 #define PB_GeneralState_CALLBACK NULL
 #define PB_GeneralState_DEFAULT NULL
 #define PB_GeneralState_build_info_MSGTYPE PB_GeneralState_BuildInfo
@@ -344,7 +467,8 @@ X(a, STATIC,   ONEOF,    MESSAGE,  (payload,splitflap_state,payload.splitflap_st
 X(a, STATIC,   ONEOF,    MESSAGE,  (payload,log,payload.log),   2) \
 X(a, STATIC,   ONEOF,    MESSAGE,  (payload,ack,payload.ack),   3) \
 X(a, STATIC,   ONEOF,    MESSAGE,  (payload,supervisor_state,payload.supervisor_state),   4) \
-X(a, STATIC,   ONEOF,    MESSAGE,  (payload,general_state,payload.general_state),   5)
+X(a, STATIC,   ONEOF,    MESSAGE,  (payload,general_state,payload.general_state),   5) \
+X(a, STATIC,   ONEOF,    MESSAGE,  (payload,splitflap_state_delta,payload.splitflap_state_delta),   6)
 #define PB_FromSplitflap_CALLBACK NULL
 #define PB_FromSplitflap_DEFAULT NULL
 #define PB_FromSplitflap_payload_splitflap_state_MSGTYPE PB_SplitflapState
@@ -352,23 +476,26 @@ X(a, STATIC,   ONEOF,    MESSAGE,  (payload,general_state,payload.general_state)
 #define PB_FromSplitflap_payload_ack_MSGTYPE PB_Ack
 #define PB_FromSplitflap_payload_supervisor_state_MSGTYPE PB_SupervisorState
 #define PB_FromSplitflap_payload_general_state_MSGTYPE PB_GeneralState
+#define PB_FromSplitflap_payload_splitflap_state_delta_MSGTYPE PB_SplitflapStateDelta
 
 #define PB_SplitflapCommand_FIELDLIST(X, a) \
-X(a, STATIC,   REPEATED, MESSAGE,  modules,           2) \
+X(a, CALLBACK, REPEATED, MESSAGE,  modules,           2) \
 X(a, STATIC,   SINGULAR, BOOL,     save_all_offsets,   3)
-#define PB_SplitflapCommand_CALLBACK NULL
+#define PB_SplitflapCommand_CALLBACK pb_default_field_callback
 #define PB_SplitflapCommand_DEFAULT NULL
 #define PB_SplitflapCommand_modules_MSGTYPE PB_SplitflapCommand_ModuleCommand
 
 #define PB_SplitflapCommand_ModuleCommand_FIELDLIST(X, a) \
 X(a, STATIC,   SINGULAR, UENUM,    action,            1) \
-X(a, STATIC,   SINGULAR, UINT32,   param,             2)
+X(a, STATIC,   SINGULAR, UINT32,   param,             2) \
+X(a, STATIC,   SINGULAR, UINT32,   dwell_millis,      3)
 #define PB_SplitflapCommand_ModuleCommand_CALLBACK NULL
 #define PB_SplitflapCommand_ModuleCommand_DEFAULT NULL
 
 #define PB_SplitflapConfig_FIELDLIST(X, a) \
-X(a, STATIC,   REPEATED, MESSAGE,  modules,           1)
-#define PB_SplitflapConfig_CALLBACK NULL
+X(a, CALLBACK, REPEATED, MESSAGE,  modules,           1) \
+X(a, STATIC,   SINGULAR, BOOL,     synchronized_arrival,   2)
+#define PB_SplitflapConfig_CALLBACK pb_default_field_callback
 #define PB_SplitflapConfig_DEFAULT NULL
 #define PB_SplitflapConfig_modules_MSGTYPE PB_SplitflapConfig_ModuleConfig
 
@@ -380,30 +507,56 @@ X(a, STATIC,   SINGULAR, UINT32,   reset_nonce,       3)
 #define PB_SplitflapConfig_ModuleConfig_DEFAULT NULL
 
 #define PB_RequestState_FIELDLIST(X, a) \
-
+X(a, STATIC,   SINGULAR, BOOL,     state_deltas,      1)
 #define PB_RequestState_CALLBACK NULL
 #define PB_RequestState_DEFAULT NULL
 
+#define PB_TimelineUpload_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   offset,            1) \
+X(a, STATIC,   SINGULAR, BYTES,    data,              2) \
+X(a, STATIC,   SINGULAR, BOOL,     done,              3)
+#define PB_TimelineUpload_CALLBACK NULL
+#define PB_TimelineUpload_DEFAULT NULL
+
+#define PB_TimelineControl_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UENUM,    action,            1) \
+X(a, STATIC,   SINGULAR, UINT32,   loops,             2)
+#define PB_TimelineControl_CALLBACK NULL
+#define PB_TimelineControl_DEFAULT NULL
+
 #define PB_ToSplitflap_FIELDLIST(X, a) \
 X(a, STATIC,   SINGULAR, UINT32,   nonce,             1) \
-X(a, STATIC,   ONEOF,    MESSAGE,  (payload,splitflap_command,payload.splitflap_command),   2) \
-X(a, STATIC,   ONEOF,    MESSAGE,  (payload,splitflap_config,payload.splitflap_config),   3) \
-X(a, STATIC,   ONEOF,    MESSAGE,  (payload,request_state,payload.request_state),   4)
+X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,splitflap_command,payload.splitflap_command),   2) \
+X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,splitflap_config,payload.splitflap_config),   3) \
+X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,request_state,payload.request_state),   4) \
+X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,timeline_upload,payload.timeline_upload),   5) \
+X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,timeline_control,payload.timeline_control),   6) \
+X(a, STATIC,   SINGULAR, BOOL,     pipelined,         7)
 #define PB_ToSplitflap_CALLBACK NULL
 #define PB_ToSplitflap_DEFAULT NULL
 #define PB_ToSplitflap_payload_splitflap_command_MSGTYPE PB_SplitflapCommand
 #define PB_ToSplitflap_payload_splitflap_config_MSGTYPE PB_SplitflapConfig
 #define PB_ToSplitflap_payload_request_state_MSGTYPE PB_RequestState
+#define PB_ToSplitflap_payload_timeline_upload_MSGTYPE PB_TimelineUpload
+#define PB_ToSplitflap_payload_timeline_control_MSGTYPE PB_TimelineControl
 
 #define PB_PersistentConfiguration_FIELDLIST(X, a) \
 X(a, STATIC,   SINGULAR, UINT32,   version,           1) \
 X(a, STATIC,   SINGULAR, UINT32,   num_flaps,         2) \
-X(a, STATIC,   REPEATED, UINT32,   module_offset_steps,   3)
+X(a, STATIC,   REPEATED, UINT32,   module_offset_steps,   3) \
+X(a, STATIC,   REPEATED, UINT32,   module_motion_profile,   4) \
+X(a, STATIC,   REPEATED, UINT32,   module_rest_step,   5) \
+X(a, STATIC,   REPEATED, UINT32,   module_rest_phase,   6) \
+X(a, STATIC,   REPEATED, UINT32,   module_rest_flap_index,   7) \
+X(a, STATIC,   SINGULAR, BOOL,     clean_shutdown,    8) \
+X(a, STATIC,   SINGULAR, UINT32,   steps_per_revolution,   9) \
+X(a, STATIC,   REPEATED, UINT32,   module_max_accel_step,  10)
 #define PB_PersistentConfiguration_CALLBACK NULL
 #define PB_PersistentConfiguration_DEFAULT NULL
 
 extern const pb_msgdesc_t PB_SplitflapState_msg;
 extern const pb_msgdesc_t PB_SplitflapState_ModuleState_msg;
+extern const pb_msgdesc_t PB_SplitflapStateDelta_msg;
 extern const pb_msgdesc_t PB_Log_msg;
 extern const pb_msgdesc_t PB_Ack_msg;
 extern const pb_msgdesc_t PB_SupervisorState_msg;
@@ -417,12 +570,15 @@ extern const pb_msgdesc_t PB_SplitflapCommand_ModuleCommand_msg;
 extern const pb_msgdesc_t PB_SplitflapConfig_msg;
 extern const pb_msgdesc_t PB_SplitflapConfig_ModuleConfig_msg;
 extern const pb_msgdesc_t PB_RequestState_msg;
+extern const pb_msgdesc_t PB_TimelineUpload_msg;
+extern const pb_msgdesc_t PB_TimelineControl_msg;
 extern const pb_msgdesc_t PB_ToSplitflap_msg;
 extern const pb_msgdesc_t PB_PersistentConfiguration_msg;
 
 /* Defines for backwards compatibility with code written before nanopb-0.4.0 */
 #define PB_SplitflapState_fields &PB_SplitflapState_msg
 #define PB_SplitflapState_ModuleState_fields &PB_SplitflapState_ModuleState_msg
+#define PB_SplitflapStateDelta_fields &PB_SplitflapStateDelta_msg
 #define PB_Log_fields &PB_Log_msg
 #define PB_Ack_fields &PB_Ack_msg
 #define PB_SupervisorState_fields &PB_SupervisorState_msg
@@ -436,27 +592,32 @@ extern const pb_msgdesc_t PB_PersistentConfiguration_msg;
 #define PB_SplitflapConfig_fields &PB_SplitflapConfig_msg
 #define PB_SplitflapConfig_ModuleConfig_fields &PB_SplitflapConfig_ModuleConfig_msg
 #define PB_RequestState_fields &PB_RequestState_msg
+#define PB_TimelineUpload_fields &PB_TimelineUpload_msg
+#define PB_TimelineControl_fields &PB_TimelineControl_msg
 #define PB_ToSplitflap_fields &PB_ToSplitflap_msg
 #define PB_PersistentConfiguration_fields &PB_PersistentConfiguration_msg
 
 /* Maximum encoded size of messages (where known) */
-#define PB_Ack_size                              6
-#define PB_FromSplitflap_size                    4340
+/* PB_FromSplitflap_size depends on runtime parameters */
+/* PB_SplitflapCommand_size depends on runtime parameters */
+/* PB_SplitflapConfig_size depends on runtime parameters */
+/* PB_SplitflapStateDelta_size depends on runtime parameters */
+/* PB_SplitflapState_size depends on runtime parameters */
+/* PB_ToSplitflap_size depends on runtime parameters */
+#define PB_Ack_size                              18
 #define PB_GeneralState_BuildInfo_size           120
-#define PB_GeneralState_size                     214
+#define PB_GeneralState_size                     223
 #define PB_Log_size                              258
-#define PB_PersistentConfiguration_size          1032
-#define PB_RequestState_size                     0
-#define PB_SplitflapCommand_ModuleCommand_size   5
-#define PB_SplitflapCommand_size                 1787
+#define PB_PersistentConfiguration_size          5118
+#define PB_RequestState_size                     2
+#define PB_SplitflapCommand_ModuleCommand_size   9
 #define PB_SplitflapConfig_ModuleConfig_size     9
-#define PB_SplitflapConfig_size                  2805
-#define PB_SplitflapState_ModuleState_size       15
-#define PB_SplitflapState_size                   4337
+#define PB_SplitflapState_ModuleState_size       25
 #define PB_SupervisorState_FaultInfo_size        266
 #define PB_SupervisorState_PowerChannelState_size 12
 #define PB_SupervisorState_size                  347
-#define PB_ToSplitflap_size                      2814
+#define PB_TimelineControl_size                  6
+#define PB_TimelineUpload_size                   1035
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -60,15 +60,17 @@ void DisplayTask::run() {
 
     uint8_t module_row, module_col;
     int32_t module_x, module_y;
-    SplitflapState last_state = {};
+    SplitflapState state = {};
+    uint32_t state_generation = 0;
     String last_messages[countof(messages_)] = {};
     while(1) {
-        SplitflapState state = splitflap_task_.getState();
-        if (state != last_state) {
+        ModuleBitmask changed_modules;
+        state_generation = splitflap_task_.getStateChanges(state_generation, state, changed_modules);
+        if (changed_modules.any()) {
             tft_.setTextSize(module_text_size);
             for (uint8_t i = 0; i < NUM_MODULES; i++) {
                 SplitflapModuleState& s = state.modules[i];
-                if (s == last_state.modules[i]) {
+                if (!changed_modules.get(i)) {
                     continue;
                 }
 
@@ -116,7 +118,6 @@ void DisplayTask::run() {
                 tft_.setCursor(module_x + 1, module_y + 2);
                 tft_.printf("%c", c);
             }
-            last_state = state;
         }
 
         const int message_height = 10;
@@ -68,8 +68,9 @@ void setup() {
   config.setLogger(&serialTask);
   bool loaded = config.loadFromDisk();
 
-  splitflapTask.begin();
+  // Set before starting the task, since it looks up saved rest positions as soon as it starts (see FAST_BOOT)
   splitflapTask.setConfiguration(&config);
+  splitflapTask.begin();
 
   if (loaded) {
     PB_PersistentConfiguration saved = config.get();
@@ -78,6 +79,22 @@ void setup() {
       offsets[i] = saved.module_offset_steps[i];
     }
     splitflapTask.restoreAllOffsets(offsets);
+
+    uint8_t motion_profiles[NUM_MODULES] = {};
+    for (uint8_t i = 0; i < min(saved.module_motion_profile_count, (pb_size_t)NUM_MODULES); i++) {
+      motion_profiles[i] = saved.module_motion_profile[i];
+    }
+    splitflapTask.restoreMotionProfiles(motion_profiles);
+
+#if ADAPTIVE_SPEED
+    if (saved.module_max_accel_step_count > 0) {
+      uint8_t max_accel_steps[NUM_MODULES] = {};
+      for (uint8_t i = 0; i < min(saved.module_max_accel_step_count, (pb_size_t)NUM_MODULES); i++) {
+        max_accel_steps[i] = saved.module_max_accel_step[i];
+      }
+      splitflapTask.restoreMaxAccelSteps(max_accel_steps);
+    }
+#endif
   }
 
   #if ENABLE_DISPLAY
@@ -21,17 +21,32 @@
 
 using namespace json11;
 
-void SerialLegacyJsonProtocol::handleState(const SplitflapState& old_state, const SplitflapState& new_state) {
+// How long to hold back a received byte for the next one (see SerialLegacyJsonProtocol::loop()). Bytes of a frame
+// arrive together, so this only needs to cover the gaps within a USB transfer.
+static const uint32_t HELD_BYTE_MILLIS = 5;
+
+// Legacy commands are all printable ASCII, plus line endings; COBS frames start with binary
+static bool isText(int b) {
+    return b == '\n' || b == '\r' || (b >= 0x20 && b < 0x7F);
+}
+
+void SerialLegacyJsonProtocol::handleState(const SplitflapState& state, const ModuleBitmask& changed) {
     bool all_stopped = true;
     for (uint8_t i = 0; i < NUM_MODULES; i++) {
-        all_stopped &= !new_state.modules[i].moving;
+        all_stopped &= !state.modules[i].moving;
+        if (changed.get(i)) {
+            latest_state_.modules[i] = state.modules[i];
+        }
     }
+    latest_state_.mode = state.mode;
+#ifdef CHAINLINK
+    latest_state_.loopbacks_ok = state.loopbacks_ok;
+#endif
+
     if (pending_move_response_ && all_stopped) {
         pending_move_response_ = false;
-        dumpStatus(new_state);
+        dumpStatus(state);
     }
-
-    latest_state_ = new_state;
 }
 
 void SerialLegacyJsonProtocol::log(const char* msg) {
@@ -55,104 +70,122 @@ void SerialLegacyJsonProtocol::loop() {
 
     while (stream_.available() > 0) {
         int b = stream_.read();
-        if (b == 0) {
+        if (b == 0 || !isText(b)) {
+            // A proto client: either the 0 that ends a frame (clients send one on its own when they connect) or part
+            // of a COBS frame. Any held back byte was the start of that frame, so it's dropped along with the rest of
+            // the frame, which the client will retry.
+            held_byte_ = -1;
             if (protocol_change_callback_) {
                 protocol_change_callback_(SERIAL_PROTOCOL_PROTO);
             }
-            break;
+            return;
         }
-        if (b == '%') {
-            bool new_sensor_test_state = latest_state_.mode != SplitflapMode::MODE_SENSOR_TEST;
-            splitflap_task_.setSensorTest(new_sensor_test_state);
-            stream_.print("{\"type\":\"sensor_test\", \"enabled\":");
-            stream_.print(new_sensor_test_state ? "true" : "false");
-            stream_.print("}\n");
-        } else if (latest_state_.mode == SplitflapMode::MODE_RUN) {
-            switch (b) {
-                case '@':
-                    
-                    splitflap_task_.resetAll();
-                    break;
-                case '#':
-                    stream_.print("{\"type\":\"no_op\"}\n");
-                    stream_.flush();
-                    break;
-                case '=':
-                    recv_count_ = 0;
-                    break;
-                case '\n':
-                    pending_move_response_ = true;
-                    stream_.printf("{\"type\":\"move_echo\", \"dest\":\"");
-                    stream_.flush();
-                    for (uint8_t i = 0; i < recv_count_; i++) {
-                        stream_.write(recv_buffer_[i]);
-                    }
-                    stream_.printf("\"}\n");
-                    stream_.flush();
-                    splitflap_task_.showString(recv_buffer_, recv_count_);
-                    break;
-                case '+':
-                    if (recv_count_ == 1) {
-                        for (uint8_t i = 1; i < NUM_MODULES; i++) {
-                            recv_buffer_[i] = recv_buffer_[0];
-                        }
-                        splitflap_task_.showString(recv_buffer_, NUM_MODULES);
-                    }
-                    break;
-                case '>':
-                    // TODO: make the index configurable
-                    splitflap_task_.increaseOffsetTenth(1);
-                    break;
-                case '<':
-                    // TODO: make the index configurable
-                    splitflap_task_.increaseOffsetHalf(1);
-                    break;
-                case ',':
-                    // TODO: make the index configurable
-                    splitflap_task_.increaseOffsetTenth(5);
-                    break;
-                case '.':
-                    // TODO: make the index configurable
-                    splitflap_task_.increaseOffsetHalf(5);
-                    break;
-                case ';':
-                    // TODO: make the index configurable
-                    splitflap_task_.increaseOffsetTenth(2);
-                    break;
-                case '\'':
-                    // TODO: make the index configurable
-                    splitflap_task_.increaseOffsetHalf(2);
-                    break;
-                case ':':
-                    // TODO: make the index configurable
-                    splitflap_task_.increaseOffsetTenth(0);
-                    break;
-                case '"':
-                    // TODO: make the index configurable
-                    splitflap_task_.increaseOffsetHalf(0);
-                    break;
-                case '\\':
-                    splitflap_task_.saveAllOffsets();
-                    break;
-                case '\r':
-                    // Ignore
-                    break;
-                case '}': // <-- NEW COMMAND ADDED HERE
-                    // Command to set current position as the new offset for Module 1
-                    splitflap_task_.setOffset(0); 
-                    break;
-                case '{': // <-- NEW COMMAND ADDED HERE
-                    // Command to reset offsets
-                    splitflap_task_.resetOffsets(0); 
-                    break;
-                default:
-                    if (recv_count_ > NUM_MODULES - 1) {
-                        break;
+        if (held_byte_ >= 0) {
+            handleByte(held_byte_);
+        }
+        held_byte_ = b;
+        held_byte_millis_ = millis();
+    }
+
+    // Nothing followed, so it was a legacy command after all
+    if (held_byte_ >= 0 && millis() - held_byte_millis_ >= HELD_BYTE_MILLIS) {
+        handleByte(held_byte_);
+        held_byte_ = -1;
+    }
+}
+
+void SerialLegacyJsonProtocol::handleByte(uint8_t b) {
+    if (b == '%') {
+        bool new_sensor_test_state = latest_state_.mode != SplitflapMode::MODE_SENSOR_TEST;
+        splitflap_task_.setSensorTest(new_sensor_test_state);
+        stream_.print("{\"type\":\"sensor_test\", \"enabled\":");
+        stream_.print(new_sensor_test_state ? "true" : "false");
+        stream_.print("}\n");
+    } else if (latest_state_.mode == SplitflapMode::MODE_RUN) {
+        switch (b) {
+            case '@':
+                
+                splitflap_task_.resetAll();
+                break;
+            case '#':
+                stream_.print("{\"type\":\"no_op\"}\n");
+                stream_.flush();
+                break;
+            case '=':
+                recv_count_ = 0;
+                break;
+            case '\n':
+                pending_move_response_ = true;
+                stream_.printf("{\"type\":\"move_echo\", \"dest\":\"");
+                stream_.flush();
+                for (uint8_t i = 0; i < recv_count_; i++) {
+                    stream_.write(recv_buffer_[i]);
+                }
+                stream_.printf("\"}\n");
+                stream_.flush();
+                splitflap_task_.showString(recv_buffer_, recv_count_);
+                break;
+            case '+':
+                if (recv_count_ == 1) {
+                    for (uint8_t i = 1; i < NUM_MODULES; i++) {
+                        recv_buffer_[i] = recv_buffer_[0];
                     }
-                    recv_buffer_[recv_count_] = b;
-                    recv_count_++;
+                    splitflap_task_.showString(recv_buffer_, NUM_MODULES);
+                }
+                break;
+            case '>':
+                // TODO: make the index configurable
+                splitflap_task_.increaseOffsetTenth(1);
+                break;
+            case '<':
+                // TODO: make the index configurable
+                splitflap_task_.increaseOffsetHalf(1);
+                break;
+            case ',':
+                // TODO: make the index configurable
+                splitflap_task_.increaseOffsetTenth(5);
+                break;
+            case '.':
+                // TODO: make the index configurable
+                splitflap_task_.increaseOffsetHalf(5);
+                break;
+            case ';':
+                // TODO: make the index configurable
+                splitflap_task_.increaseOffsetTenth(2);
+                break;
+            case '\'':
+                // TODO: make the index configurable
+                splitflap_task_.increaseOffsetHalf(2);
+                break;
+            case ':':
+                // TODO: make the index configurable
+                splitflap_task_.increaseOffsetTenth(0);
+                break;
+            case '"':
+                // TODO: make the index configurable
+                splitflap_task_.increaseOffsetHalf(0);
+                break;
+            case '\\':
+                splitflap_task_.saveAllOffsets();
+                break;
+            case '\r':
+                // Ignore
+                break;
+            case '}': // <-- NEW COMMAND ADDED HERE
+                // Command to set current position as the new offset for Module 1
+                splitflap_task_.setOffset(0); 
+                break;
+            case '{': // <-- NEW COMMAND ADDED HERE
+                // Command to reset offsets
+                splitflap_task_.resetOffsets(0); 
+                break;
+            default:
+                if (recv_count_ > NUM_MODULES - 1) {
                     break;
-            }
+                }
+                recv_buffer_[recv_count_] = b;
+                recv_count_++;
+                break;
         }
     }
 }
@@ -164,6 +197,9 @@ void SerialLegacyJsonProtocol::sendSupervisorState(PB_SupervisorState& superviso
 }
 
 void SerialLegacyJsonProtocol::init() {
+    held_byte_ = -1;
+    recv_count_ = 0;
+    pending_move_response_ = false;
     stream_.print("\n\n\n");
     stream_.print("{\"type\":\"init\", \"num_modules\":");
     stream_.print(NUM_MODULES);
@@ -171,6 +207,9 @@ void SerialLegacyJsonProtocol::init() {
 }
 
 void SerialLegacyJsonProtocol::dumpStatus(const SplitflapState& state) {
+#if LOG_SERIAL_TIMING
+    uint32_t start_micros = micros();
+#endif
     stream_.print("{\"type\":\"status\", \"modules\":[");
     for (uint8_t i = 0; i < NUM_MODULES; i++) {
         stream_.print("{\"state\":\"");
@@ -204,4 +243,7 @@ void SerialLegacyJsonProtocol::dumpStatus(const SplitflapState& state) {
     }
     stream_.print("]}\n");
     stream_.flush();
+#if LOG_SERIAL_TIMING
+    recordStatusTiming(start_micros);
+#endif
 }
@@ -24,7 +24,7 @@ class SerialLegacyJsonProtocol : public SerialProtocol {
         ~SerialLegacyJsonProtocol(){}
         void log(const char* msg) override;
         void loop() override;
-        void handleState(const SplitflapState& old_state, const SplitflapState& new_state) override;
+        void handleState(const SplitflapState& state, const ModuleBitmask& changed) override;
         void sendSupervisorState(PB_SupervisorState& supervisor_state) override;
 
         void init();
@@ -37,5 +37,11 @@ class SerialLegacyJsonProtocol : public SerialProtocol {
         bool pending_move_response_ = false;
         uint32_t last_sensor_print_millis_ = 0;
 
+        // Last byte received, held back until the next one shows whether it was the start of a proto frame (see
+        // loop()), or -1
+        int held_byte_ = -1;
+        uint32_t held_byte_millis_ = 0;
+
+        void handleByte(uint8_t b);
         void dumpStatus(const SplitflapState& state);
 };
@@ -26,6 +26,10 @@ static SerialProtoProtocol* singleton_for_packet_serial = 0;
 static const uint16_t MIN_STATE_INTERVAL_MILLIS = 100;
 static const uint16_t PERIODIC_STATE_INTERVAL_MILLIS = 5000;
 
+// How long input can keep arriving without a valid packet before assuming it's from a legacy client instead. Proto
+// clients retry well within this, so a corrupted packet alone won't trigger it.
+static const uint16_t LEGACY_FALLBACK_MILLIS = 3000;
+
 SerialProtoProtocol::SerialProtoProtocol(SplitflapTask& splitflap_task, Stream& stream) :
         SerialProtocol(splitflap_task),
         stream_(stream) {
@@ -41,20 +45,68 @@ SerialProtoProtocol::SerialProtoProtocol(SplitflapTask& splitflap_task, Stream&
     });
 }
 
-void SerialProtoProtocol::handleState(const SplitflapState& old_state, const SplitflapState& new_state) {
-    latest_state_ = new_state;
+void SerialProtoProtocol::init() {
+    // A new session: the client needs GeneralState and a full state right away, and has to ask for deltas again
+    state_requested_ = true;
+    state_deltas_ = false;
+    window_received_ = 0;
+    unframed_bytes_ = 0;
+
+    // End whatever the host has received so far (e.g. legacy output), so that the first frame arrives intact
+    stream_.write((uint8_t)0);
 }
 
-void SerialProtoProtocol::ack(uint32_t nonce) {
-    pb_tx_buffer_ = {};
+void SerialProtoProtocol::handleState(const SplitflapState& state, const ModuleBitmask& changed) {
+    for (uint8_t i = 0; i < NUM_MODULES; i++) {
+        if (changed.get(i)) {
+            latest_state_.modules[i] = state.modules[i];
+        }
+    }
+    latest_state_.mode = state.mode;
+#ifdef CHAINLINK
+    latest_state_.loopbacks_ok = state.loopbacks_ok;
+#endif
+    changed_modules_ |= changed;
+    state_changed_ = true;
+}
+
+void SerialProtoProtocol::ack(uint32_t nonce, bool pipelined) {
     pb_tx_buffer_.which_payload = PB_FromSplitflap_ack_tag;
+    pb_tx_buffer_.payload.ack = {};
     pb_tx_buffer_.payload.ack.nonce = nonce;
+    if (pipelined) {
+        pb_tx_buffer_.payload.ack.window_end_nonce = window_end_nonce_;
+        pb_tx_buffer_.payload.ack.window_received = window_received_;
+    }
     sendPbTxBuffer();
 }
 
+bool SerialProtoProtocol::markPipelinedNonce(uint32_t nonce) {
+    // Nonces wrap around, so compare them by difference
+    int32_t ahead = (int32_t)(nonce - window_end_nonce_);
+    if (window_received_ == 0 || ahead >= ACK_WINDOW_SIZE || ahead <= -ACK_WINDOW_SIZE) {
+        // Too far from the window to be a retry, so the host has started over
+        window_end_nonce_ = nonce;
+        window_received_ = 1;
+        last_config_nonce_ = nonce - 1;
+        return true;
+    }
+    if (ahead > 0) {
+        window_end_nonce_ = nonce;
+        window_received_ = (window_received_ << ahead) | 1;
+        return true;
+    }
+    uint32_t bit = 1UL << -ahead;
+    if (window_received_ & bit) {
+        return false;
+    }
+    window_received_ |= bit;
+    return true;
+}
+
 void SerialProtoProtocol::log(const char* msg) {
-    pb_tx_buffer_ = {};
     pb_tx_buffer_.which_payload = PB_FromSplitflap_log_tag;
+    pb_tx_buffer_.payload.log = {};
 
     strlcpy(pb_tx_buffer_.payload.log.msg, msg, sizeof(pb_tx_buffer_.payload.log.msg));
 
@@ -62,47 +114,42 @@ void SerialProtoProtocol::log(const char* msg) {
 }
 
 void SerialProtoProtocol::sendSupervisorState(PB_SupervisorState& supervisor_state) {
-    pb_tx_buffer_ = {};
     pb_tx_buffer_.which_payload = PB_FromSplitflap_supervisor_state_tag;
     pb_tx_buffer_.payload.supervisor_state = supervisor_state;
     sendPbTxBuffer();
 }
 
 void SerialProtoProtocol::loop() {
+    int available = stream_.available();
+    if (available > 0 && unframed_bytes_ == 0) {
+        unframed_since_millis_ = millis();
+    }
+    unframed_bytes_ += available;
     do {
         packet_serial_.update();
     } while (stream_.available());
 
+    if (unframed_bytes_ > 0 && millis() - unframed_since_millis_ > LEGACY_FALLBACK_MILLIS) {
+        unframed_bytes_ = 0;
+        if (protocol_change_callback_) {
+            protocol_change_callback_(SERIAL_PROTOCOL_LEGACY);
+            return;
+        }
+    }
+
     {
         // SplitflapState updates
             
         // Rate limit state change transmissions
-        bool state_changed = latest_state_ != last_sent_state_ && millis() - last_sent_state_millis_ >= MIN_STATE_INTERVAL_MILLIS;
-
-        // Send state periodically or when forced, regardless of rate limit for state changes
-        bool force_send_state = state_requested_ || millis() - last_sent_state_millis_ > PERIODIC_STATE_INTERVAL_MILLIS;
-        if (state_changed || force_send_state) {
-            pb_tx_buffer_ = {};
-            pb_tx_buffer_.which_payload = PB_FromSplitflap_splitflap_state_tag;
-            pb_tx_buffer_.payload.splitflap_state.modules_count = NUM_MODULES;
-            for (uint8_t i = 0; i < NUM_MODULES; i++) {
-                pb_tx_buffer_.payload.splitflap_state.modules[i] = {
-                    .state = (PB_SplitflapState_ModuleState_State) latest_state_.modules[i].state,
-                    .flap_index = latest_state_.modules[i].flap_index,
-                    .moving = latest_state_.modules[i].moving,
-                    .home_state = latest_state_.modules[i].home_state,
-                    .count_unexpected_home = latest_state_.modules[i].count_unexpected_home,
-                    .count_missed_home = latest_state_.modules[i].count_missed_home,
-                };
-            }
-            #ifdef CHAINLINK
-            pb_tx_buffer_.payload.splitflap_state.loopbacks_ok = latest_state_.loopbacks_ok;
-            #endif
-
-            sendPbTxBuffer();
-
-            last_sent_state_ = latest_state_;
-            last_sent_state_millis_ = millis();
+        bool state_changed = state_changed_ && millis() - last_sent_state_millis_ >= MIN_STATE_INTERVAL_MILLIS;
+
+        // Send the full state periodically or when forced, regardless of rate limit for state changes. This is also
+        // the keyframe that clients receiving deltas fall back on if they miss one.
+        bool send_keyframe = state_requested_ || millis() - last_sent_keyframe_millis_ > PERIODIC_STATE_INTERVAL_MILLIS;
+        if (send_keyframe || (state_changed && !state_deltas_)) {
+            sendState();
+        } else if (state_changed) {
+            sendStateDelta();
         }
     }
 
@@ -112,7 +159,9 @@ void SerialProtoProtocol::loop() {
         // Send state periodically or when forced
         bool force_send_state = state_requested_ || millis() - last_sent_general_state_millis_ > 2000;
         if (force_send_state) {
-            PB_GeneralState state = {};
+            pb_tx_buffer_.which_payload = PB_FromSplitflap_general_state_tag;
+            PB_GeneralState& state = pb_tx_buffer_.payload.general_state;
+            state = {};
 
             state.serial_protocol_version = SERIAL_PROTOCOL_VERSION;
             state.uptime_millis = millis();
@@ -124,10 +173,9 @@ void SerialProtoProtocol::loop() {
 
             memcpy(&state.flap_character_set.bytes, flaps, NUM_FLAPS);
             state.flap_character_set.size = NUM_FLAPS;
-
-            pb_tx_buffer_ = {};
-            pb_tx_buffer_.which_payload = PB_FromSplitflap_general_state_tag;
-            pb_tx_buffer_.payload.general_state = state;
+            state.module_queue_depth = MODULE_QUEUE_DEPTH;
+            state.max_accel_step = Acceleration::MAX_ACCEL_STEP;
+            state.ack_window_size = ACK_WINDOW_SIZE;
             sendPbTxBuffer();
 
             last_sent_general_state_millis_ = millis();
@@ -140,7 +188,123 @@ void SerialProtoProtocol::loop() {
     }
 }
 
+// Where the modules of a SplitflapCommand or SplitflapConfig go as they're decoded: straight into the Commands that
+// carry them out, rather than into an array sized for 255 modules first
+struct ModulesDestination {
+    Command command;
+    // QUEUE_FLAP actions go in a separate command, since they need a dwell time as well as a flap
+    Command queue_command;
+    bool any_queued;
+    // Modules decoded so far, including any past NUM_MODULES, which are dropped
+    size_t count;
+};
+
+static bool decodeModuleCommand(pb_istream_t* stream, const pb_field_t* field, void** arg) {
+    ModulesDestination& destination = *(ModulesDestination*)*arg;
+    PB_SplitflapCommand_ModuleCommand module_command = {};
+    if (!pb_decode(stream, PB_SplitflapCommand_ModuleCommand_fields, &module_command)) {
+        return false;
+    }
+    size_t i = destination.count++;
+    if (i >= NUM_MODULES) {
+        return true;
+    }
+
+    Command& c = destination.command;
+    switch (module_command.action) {
+        case PB_SplitflapCommand_ModuleCommand_Action_NO_OP:
+            c.data.module_command[i] = QCMD_NO_OP;
+            break;
+        case PB_SplitflapCommand_ModuleCommand_Action_RESET_AND_HOME:
+            c.data.module_command[i] = QCMD_RESET_AND_HOME;
+            break;
+        case PB_SplitflapCommand_ModuleCommand_Action_GO_TO_FLAP:
+            if (module_command.param <= 255 - QCMD_FLAP) {
+                c.data.module_command[i] = QCMD_FLAP + module_command.param;
+            }
+            break;
+        case PB_SplitflapCommand_ModuleCommand_Action_QUEUE_FLAP:
+            destination.queue_command.data.queued_flaps.flap_index[i] = module_command.param;
+            destination.queue_command.data.queued_flaps.dwell_millis[i] = module_command.dwell_millis;
+            destination.any_queued = true;
+            break;
+        case PB_SplitflapCommand_ModuleCommand_Action_CLEAR_QUEUE:
+            c.data.module_command[i] = QCMD_CLEAR_QUEUE;
+            break;
+        case PB_SplitflapCommand_ModuleCommand_Action_INCREASE_OFFSET_TENTH:
+            c.data.module_command[i] = QCMD_INCR_OFFSET_TENTH;
+            break;
+        case PB_SplitflapCommand_ModuleCommand_Action_INCREASE_OFFSET_HALF:
+            c.data.module_command[i] = QCMD_INCR_OFFSET_HALF;
+            break;
+        case PB_SplitflapCommand_ModuleCommand_Action_SET_OFFSET:
+            c.data.module_command[i] = QCMD_SET_OFFSET;
+            break;
+        case PB_SplitflapCommand_ModuleCommand_Action_SET_MOTION_PROFILE:
+            if (module_command.param < Acceleration::NUM_MOTION_PROFILES) {
+                c.data.module_command[i] = QCMD_MOTION_PROFILE + module_command.param;
+            }
+            break;
+        default:
+            // Ignore unknown action
+            break;
+    }
+    return true;
+}
+
+static bool decodeModuleConfig(pb_istream_t* stream, const pb_field_t* field, void** arg) {
+    ModulesDestination& destination = *(ModulesDestination*)*arg;
+    PB_SplitflapConfig_ModuleConfig pb_module_config = {};
+    if (!pb_decode(stream, PB_SplitflapConfig_ModuleConfig_fields, &pb_module_config)) {
+        return false;
+    }
+    size_t i = destination.count++;
+    if (i >= NUM_MODULES) {
+        return true;
+    }
+
+    ModuleConfig& module_config = destination.command.data.module_configs.config[i];
+    module_config.target_flap_index = pb_module_config.target_flap_index;
+    module_config.movement_nonce = pb_module_config.movement_nonce;
+    module_config.reset_nonce = pb_module_config.reset_nonce;
+    return true;
+}
+
+// Called once nanopb knows which payload a ToSplitflap has, just before decoding it, to point the payload's modules
+// at the ModulesDestination in arg
+static bool decodePayload(pb_istream_t* stream, const pb_field_t* field, void** arg) {
+    ModulesDestination& destination = *(ModulesDestination*)*arg;
+    switch (field->tag) {
+        case PB_ToSplitflap_splitflap_command_tag: {
+            destination.command.command_type = CommandType::MODULES;
+            destination.queue_command.command_type = CommandType::QUEUE_FLAPS;
+            memset(destination.queue_command.data.queued_flaps.flap_index, QUEUE_NO_FLAP, NUM_MODULES);
+
+            PB_SplitflapCommand& command = *(PB_SplitflapCommand*)field->pData;
+            command.modules.funcs.decode = decodeModuleCommand;
+            command.modules.arg = &destination;
+            break;
+        }
+        case PB_ToSplitflap_splitflap_config_tag: {
+            destination.command.command_type = CommandType::CONFIG;
+
+            PB_SplitflapConfig& config = *(PB_SplitflapConfig*)field->pData;
+            config.modules.funcs.decode = decodeModuleConfig;
+            config.modules.arg = &destination;
+            break;
+        }
+        default:
+            break;
+    }
+    return true;
+}
+
 void SerialProtoProtocol::handlePacket(const uint8_t* buffer, size_t size) {
+    if (size == 0) {
+        // Just a delimiter, e.g. the 0 that clients send to switch protocols
+        unframed_bytes_ = 0;
+        return;
+    }
     if (size <= 4) {
         // Too small, ignore bad packet
         log("Small packet");
@@ -163,6 +327,10 @@ void SerialProtoProtocol::handlePacket(const uint8_t* buffer, size_t size) {
         return;
     }
 
+    ModulesDestination modules = {};
+    pb_rx_buffer_.cb_payload.funcs.decode = decodePayload;
+    pb_rx_buffer_.cb_payload.arg = &modules;
+
     pb_istream_t stream = pb_istream_from_buffer(buffer, size - 4);
     if (!pb_decode(&stream, PB_ToSplitflap_fields, &pb_rx_buffer_)) {
         char buf[200];
@@ -170,73 +338,75 @@ void SerialProtoProtocol::handlePacket(const uint8_t* buffer, size_t size) {
         log(buf);
         return;
     }
+    unframed_bytes_ = 0;
+
+    bool pipelined = pb_rx_buffer_.pipelined;
+    bool already_handled = pipelined ? !markPipelinedNonce(pb_rx_buffer_.nonce) : pb_rx_buffer_.nonce == last_nonce_;
 
     // Always ACK immediately
-    ack(pb_rx_buffer_.nonce);
-    if (pb_rx_buffer_.nonce == last_nonce_) {
+    ack(pb_rx_buffer_.nonce, pipelined);
+    if (already_handled) {
         // Ignore any extraneous retries
         char buf[200];
         snprintf(buf, sizeof(buf), "Already handled nonce %u", pb_rx_buffer_.nonce);
         log(buf);
         return;
     }
-    last_nonce_ = pb_rx_buffer_.nonce;
+    if (!pipelined) {
+        last_nonce_ = pb_rx_buffer_.nonce;
+    }
     
     switch (pb_rx_buffer_.which_payload) {
-        case PB_ToSplitflap_splitflap_command_tag: {
-            PB_SplitflapCommand command = pb_rx_buffer_.payload.splitflap_command;
-            if (command.modules_count > 0) {
-                Command c = {};
-                c.command_type = CommandType::MODULES;
-                for (uint8_t i = 0; i < min((int)command.modules_count, NUM_MODULES); i++) {
-                    switch (command.modules[i].action) {
-                        case PB_SplitflapCommand_ModuleCommand_Action_NO_OP:
-                            c.data.module_command[i] = QCMD_NO_OP;
-                            break;
-                        case PB_SplitflapCommand_ModuleCommand_Action_RESET_AND_HOME:
-                            c.data.module_command[i] = QCMD_RESET_AND_HOME;
-                            break;
-                        case PB_SplitflapCommand_ModuleCommand_Action_GO_TO_FLAP:
-                            if (command.modules[i].param <= 255 - QCMD_FLAP) {
-                                c.data.module_command[i] = QCMD_FLAP + command.modules[i].param;
-                            }
-                            break;
-                        case PB_SplitflapCommand_ModuleCommand_Action_INCREASE_OFFSET_TENTH:
-                            c.data.module_command[i] = QCMD_INCR_OFFSET_TENTH;
-                            break;
-                        case PB_SplitflapCommand_ModuleCommand_Action_INCREASE_OFFSET_HALF:
-                            c.data.module_command[i] = QCMD_INCR_OFFSET_HALF;
-                            break;
-                        case PB_SplitflapCommand_ModuleCommand_Action_SET_OFFSET:
-                            c.data.module_command[i] = QCMD_SET_OFFSET;
-                            break;
-                        default:
-                            // Ignore unknown action
-                            break;
-                    }
+        case PB_ToSplitflap_splitflap_command_tag:
+            // The modules were decoded into commands already (see decodeModuleCommand())
+            if (modules.count > 0) {
+                splitflap_task_.postRawCommand(modules.command);
+                if (modules.any_queued) {
+                    splitflap_task_.postRawCommand(modules.queue_command);
                 }
-                splitflap_task_.postRawCommand(c);
-            } else if (command.save_all_offsets) {
+            } else if (pb_rx_buffer_.payload.splitflap_command.save_all_offsets) {
                 splitflap_task_.saveAllOffsets();
             }
             break;
-        }
-        case PB_ToSplitflap_splitflap_config_tag: {
-            PB_SplitflapConfig config = pb_rx_buffer_.payload.splitflap_config;
-            Command c = {};
-            c.command_type = CommandType::CONFIG;
-            for (uint8_t i = 0; i < min((int)config.modules_count, NUM_MODULES); i++) {
-                ModuleConfig& module_config = c.data.module_configs.config[i];
-                module_config.target_flap_index = config.modules[i].target_flap_index;
-                module_config.movement_nonce = config.modules[i].movement_nonce;
-                module_config.reset_nonce = config.modules[i].reset_nonce;
+        case PB_ToSplitflap_splitflap_config_tag:
+            if (pipelined) {
+                if ((int32_t)(pb_rx_buffer_.nonce - last_config_nonce_) < 0) {
+                    // A retry that arrived after a newer config, which already replaced it
+                    break;
+                }
+                last_config_nonce_ = pb_rx_buffer_.nonce;
             }
-            splitflap_task_.postRawCommand(c);
+            // The modules were decoded into the command already (see decodeModuleConfig())
+            modules.command.data.module_configs.synchronized_arrival =
+                    pb_rx_buffer_.payload.splitflap_config.synchronized_arrival;
+            splitflap_task_.postRawCommand(modules.command);
             break;
-        }
         case PB_ToSplitflap_request_state_tag:
             state_requested_ = true;
+            if (pb_rx_buffer_.payload.request_state.state_deltas) {
+                state_deltas_ = true;
+            }
+            break;
+        case PB_ToSplitflap_timeline_upload_tag: {
+            const PB_TimelineUpload& upload = pb_rx_buffer_.payload.timeline_upload;
+            TimelineStore& store = splitflap_task_.timelineStore();
+            if (upload.data.size > 0) {
+                store.writeChunk(upload.offset, upload.data.bytes, upload.data.size);
+            }
+            if (upload.done) {
+                store.finishUpload();
+            }
             break;
+        }
+        case PB_ToSplitflap_timeline_control_tag: {
+            const PB_TimelineControl& control = pb_rx_buffer_.payload.timeline_control;
+            if (control.action == PB_TimelineControl_Action_PLAY) {
+                splitflap_task_.playTimeline(control.loops);
+            } else {
+                splitflap_task_.stopTimeline();
+            }
+            break;
+        }
         default: {
             char buf[200];
             snprintf(buf, sizeof(buf), "Unknown ToSplitflap type: %d", pb_rx_buffer_.which_payload);
@@ -246,6 +416,105 @@ void SerialProtoProtocol::handlePacket(const uint8_t* buffer, size_t size) {
     }
 }
 
+static PB_SplitflapState_ModuleState toPb(const SplitflapModuleState& module_state) {
+    return {
+        .state = (PB_SplitflapState_ModuleState_State) module_state.state,
+        .flap_index = module_state.flap_index,
+        .moving = module_state.moving,
+        .home_state = module_state.home_state,
+        .count_unexpected_home = module_state.count_unexpected_home,
+        .count_missed_home = module_state.count_missed_home,
+        .queue_wait_millis = module_state.queue_wait_millis,
+        .queued_flaps = module_state.queued_flaps,
+        .max_accel_step = module_state.max_accel_step,
+    };
+}
+
+// Which modules the modules field of a SplitflapState or SplitflapStateDelta is encoded from
+struct ModuleStatesSource {
+    const SplitflapState* state;
+    // If set, only these modules are encoded
+    const ModuleBitmask* changed;
+};
+
+static bool encodeModuleStates(pb_ostream_t* stream, const pb_field_t* field, void* const* arg) {
+    const ModuleStatesSource& source = *(const ModuleStatesSource*)*arg;
+    for (uint8_t i = 0; i < NUM_MODULES; i++) {
+        if (source.changed != nullptr && !source.changed->get(i)) {
+            continue;
+        }
+        PB_SplitflapState_ModuleState module_state = toPb(source.state->modules[i]);
+        if (!pb_encode_tag_for_field(stream, field)
+                || !pb_encode_submessage(stream, PB_SplitflapState_ModuleState_fields, &module_state)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SerialProtoProtocol::sendState() {
+#if LOG_SERIAL_TIMING
+    uint32_t start_micros = micros();
+#endif
+    pb_tx_buffer_.which_payload = PB_FromSplitflap_splitflap_state_tag;
+    PB_SplitflapState& state = pb_tx_buffer_.payload.splitflap_state;
+    state = {};
+    ModuleStatesSource source = {&latest_state_, nullptr};
+    state.modules.funcs.encode = encodeModuleStates;
+    state.modules.arg = &source;
+    #ifdef CHAINLINK
+    state.loopbacks_ok = latest_state_.loopbacks_ok;
+    #endif
+    state.generation = ++state_generation_;
+
+    sendPbTxBuffer();
+
+    state_changed_ = false;
+    changed_modules_.clear();
+    last_sent_state_millis_ = millis();
+    last_sent_keyframe_millis_ = last_sent_state_millis_;
+#if LOG_SERIAL_TIMING
+    recordStatusTiming(start_micros);
+#endif
+}
+
+void SerialProtoProtocol::sendStateDelta() {
+#if LOG_SERIAL_TIMING
+    uint32_t start_micros = micros();
+#endif
+    pb_tx_buffer_.which_payload = PB_FromSplitflap_splitflap_state_delta_tag;
+    PB_SplitflapStateDelta& delta = pb_tx_buffer_.payload.splitflap_state_delta;
+    delta = {};
+    for (uint8_t i = 0; i < NUM_MODULES; i++) {
+        if (changed_modules_.get(i)) {
+            delta.module_indices.bytes[delta.module_indices.size++] = i;
+        }
+    }
+    if (delta.module_indices.size == NUM_MODULES) {
+        // The indices would make this bigger than the full state, which may as well be a keyframe then
+        sendState();
+        return;
+    }
+    // The changed modules themselves are encoded straight from latest_state_
+    ModuleStatesSource source = {&latest_state_, &changed_modules_};
+    delta.modules.funcs.encode = encodeModuleStates;
+    delta.modules.arg = &source;
+    #ifdef CHAINLINK
+    delta.loopbacks_ok = latest_state_.loopbacks_ok;
+    #endif
+    delta.base_generation = state_generation_;
+    delta.generation = ++state_generation_;
+
+    sendPbTxBuffer();
+
+    state_changed_ = false;
+    changed_modules_.clear();
+    last_sent_state_millis_ = millis();
+#if LOG_SERIAL_TIMING
+    recordStatusTiming(start_micros);
+#endif
+}
+
 void SerialProtoProtocol::sendPbTxBuffer() {
     // Encode protobuf message to byte buffer
     pb_ostream_t stream = pb_ostream_from_buffer(tx_buffer_, sizeof(tx_buffer_));
@@ -28,8 +28,13 @@
  *      - May or may not have software offset support
  * 1:
  *      - GeneralState is introduced (including introduction of serial protocol versioning)
+ * 2:
+ *      - SplitflapState carries a generation number
+ *      - SplitflapStateDelta is sent in place of SplitflapState for changes, once requested via RequestState
+ * 3:
+ *      - ToSplitflap messages can be pipelined, with up to GeneralState.ack_window_size awaiting acks at once
 */
-#define SERIAL_PROTOCOL_VERSION (1);
+#define SERIAL_PROTOCOL_VERSION (3);
 
 class SerialProtoProtocol : public SerialProtocol {
     public:
@@ -37,31 +42,70 @@ class SerialProtoProtocol : public SerialProtocol {
         ~SerialProtoProtocol() {}
         void log(const char* msg) override;
         void loop() override;
-        void handleState(const SplitflapState& old_state, const SplitflapState& new_state) override;
+        void handleState(const SplitflapState& state, const ModuleBitmask& changed) override;
         void sendSupervisorState(PB_SupervisorState& supervisor_state) override;
 
+        /** Starts a new session with a client that just switched to this protocol */
         void init();
     
     private:
+        // How many pipelined nonces are remembered for spotting retries; at most 32, the bits in window_received_
+        static const uint8_t ACK_WINDOW_SIZE = 32;
+
+        // Module lists are streamed through nanopb callbacks, so nanopb can't size the messages that carry them; these
+        // are the largest ones with NUM_MODULES modules. Each module is tagged and has a 1 byte length (they're all
+        // under 128 bytes), and a payload's tag and length take up to 3 bytes.
+        static const size_t MAX_COMMAND_SIZE = NUM_MODULES * (2 + PB_SplitflapCommand_ModuleCommand_size) + 2;
+        static const size_t MAX_TO_SPLITFLAP_SIZE = 6 + 2 + 3 +
+                (MAX_COMMAND_SIZE > PB_TimelineUpload_size ? MAX_COMMAND_SIZE : PB_TimelineUpload_size);
+        // A SplitflapStateDelta with every module, which is bigger than the SplitflapState
+        static const size_t MAX_STATE_SIZE = 6 + 6 + NUM_MODULES * (2 + PB_SplitflapState_ModuleState_size) + 3 +
+                NUM_MODULES + 2;
+        static const size_t MAX_FROM_SPLITFLAP_SIZE = 3 +
+                (MAX_STATE_SIZE > PB_SupervisorState_size ? MAX_STATE_SIZE : PB_SupervisorState_size);
+
         Stream& stream_;
         PB_FromSplitflap pb_tx_buffer_;
         PB_ToSplitflap pb_rx_buffer_;
 
-        uint8_t tx_buffer_[PB_FromSplitflap_size + 4]; // Max message size + CRC32
+        uint8_t tx_buffer_[MAX_FROM_SPLITFLAP_SIZE + 4]; // Max message size + CRC32
+
+        PacketSerial_<COBS, 0, (MAX_TO_SPLITFLAP_SIZE + 4) * 2 + 10> packet_serial_;
 
-        PacketSerial_<COBS, 0, (PB_ToSplitflap_size + 4) * 2 + 10> packet_serial_;
+        uint32_t last_nonce_ = 0;
 
-        uint32_t last_nonce_;
+        // Pipelined nonces handled so far: bit i of window_received_ is window_end_nonce_ - i (see PB_Ack)
+        uint32_t window_end_nonce_ = 0;
+        uint32_t window_received_ = 0;
+        // Nonce of the latest pipelined SplitflapConfig handled, for skipping older ones that are retried late
+        uint32_t last_config_nonce_ = 0;
 
         SplitflapState latest_state_ = {};
-        SplitflapState last_sent_state_ = {};
+        // Whether latest_state_ has changed since the last SplitflapState or SplitflapStateDelta, and which of its
+        // modules did
+        bool state_changed_ = false;
+        ModuleBitmask changed_modules_;
         uint32_t last_sent_state_millis_ = 0;
+        uint32_t last_sent_keyframe_millis_ = 0;
+
+        // Number of the last SplitflapState or SplitflapStateDelta sent
+        uint32_t state_generation_ = 0;
+        // Whether the client has asked for SplitflapStateDelta messages
+        bool state_deltas_ = false;
 
         uint32_t last_sent_general_state_millis_ = 0;
 
-        bool state_requested_;
+        bool state_requested_ = false;
+
+        // Bytes received since the last valid packet, and when the first of them arrived, for spotting a legacy
+        // client (see loop())
+        uint32_t unframed_bytes_ = 0;
+        uint32_t unframed_since_millis_ = 0;
 
+        void sendState();
+        void sendStateDelta();
         void sendPbTxBuffer();
         void handlePacket(const uint8_t* buffer, size_t size);
-        void ack(uint32_t nonce);
+        bool markPipelinedNonce(uint32_t nonce);
+        void ack(uint32_t nonce, bool pipelined);
 };
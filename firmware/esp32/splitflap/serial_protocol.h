@@ -32,7 +32,11 @@ class SerialProtocol : public Logger {
 
         virtual void loop() = 0;
 
-        virtual void handleState(const SplitflapState& old_state, const SplitflapState& new_state) = 0;
+        /**
+         * Called with the latest state whenever it changes. Only the modules set in `changed` differ from the
+         * previous call (all of them, the first time a protocol becomes current).
+         */
+        virtual void handleState(const SplitflapState& state, const ModuleBitmask& changed) = 0;
         virtual void sendSupervisorState(PB_SupervisorState& supervisor_state) = 0;
 
         virtual void setProtocolChangeCallback(ProtocolChangeCallback cb) {
@@ -42,4 +46,30 @@ class SerialProtocol : public Logger {
     protected:
         SplitflapTask& splitflap_task_;
         ProtocolChangeCallback protocol_change_callback_;
+
+#if LOG_SERIAL_TIMING
+        /** Counts a status update that started at start_micros, and logs the totals every 10 seconds */
+        void recordStatusTiming(uint32_t start_micros) {
+            uint32_t elapsed = micros() - start_micros;
+            status_updates_++;
+            status_total_micros_ += elapsed;
+            status_max_micros_ = max(status_max_micros_, elapsed);
+            if (millis() - status_timing_log_millis_ > 10000) {
+                char buf[120];
+                snprintf(buf, sizeof(buf), "Status timing: %u updates, %u us average, %u us max",
+                    (unsigned)status_updates_, (unsigned)(status_total_micros_ / status_updates_), (unsigned)status_max_micros_);
+                status_updates_ = 0;
+                status_total_micros_ = 0;
+                status_max_micros_ = 0;
+                status_timing_log_millis_ = millis();
+                log(buf);
+            }
+        }
+
+    private:
+        uint32_t status_updates_ = 0;
+        uint32_t status_total_micros_ = 0;
+        uint32_t status_max_micros_ = 0;
+        uint32_t status_timing_log_millis_ = 0;
+#endif
 };
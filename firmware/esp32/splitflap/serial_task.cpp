@@ -24,9 +24,6 @@ SerialTask::SerialTask(SplitflapTask& splitflap_task, const uint8_t task_core) :
         stream_(),
         legacy_protocol_(splitflap_task_, stream_),
         proto_protocol_(splitflap_task_, stream_) {
-    log_queue_ = xQueueCreate(10, sizeof(std::string *));
-    assert(log_queue_ != NULL);
-
     supervisor_state_queue_ = xQueueCreate(1, sizeof(PB_SupervisorState));
     assert(supervisor_state_queue_ != NULL);
 }
@@ -36,49 +33,60 @@ void SerialTask::run() {
     while (Serial.available()) {
         Serial.read();
     }
-    // Start in legacy protocol mode
+    // Start in legacy protocol mode; a proto client switches to proto by sending a 0 byte or a frame (see
+    // SerialLegacyJsonProtocol::loop()), and the proto protocol falls back if it only gets garbage
     legacy_protocol_.init();
     SerialProtocol* current_protocol = &legacy_protocol_;
-    log("Protocol change requested!");
-    
-    ProtocolChangeCallback protocol_change_callback = [this, &current_protocol] (uint8_t protocol) {
-        /*
+
+    // Kept up to date in place by getStateChanges(), which only copies the modules that changed
+    SplitflapState state = {};
+
+    // Called from within current_protocol->loop(), so output from the old protocol is always complete by the time
+    // the new one starts
+    ProtocolChangeCallback protocol_change_callback = [this, &current_protocol, &state] (uint8_t protocol) {
         switch (protocol) {
             case SERIAL_PROTOCOL_LEGACY:
-                current_protocol = &legacy_protocol_;
+                if (current_protocol != &legacy_protocol_) {
+                    current_protocol = &legacy_protocol_;
+                    legacy_protocol_.init();
+                    log("Switched to legacy protocol");
+                }
                 break;
             case SERIAL_PROTOCOL_PROTO:
-                log("Switching to Protobuf Protocol!");
-                current_protocol = &proto_protocol_;
+                if (current_protocol != &proto_protocol_) {
+                    current_protocol = &proto_protocol_;
+                    proto_protocol_.init();
+                    log("Switched to Protobuf protocol");
+                }
                 break;
             default:
                 log("Unknown protocol requested");
-                break;
+                return;
         }
-                */
+        // Only the current protocol is kept up to date with the state, so catch the new one up
+        ModuleBitmask all_modules;
+        all_modules.setAll();
+        current_protocol->handleState(state, all_modules);
     };
 
     legacy_protocol_.setProtocolChangeCallback(protocol_change_callback);
-    //proto_protocol_.setProtocolChangeCallback(protocol_change_callback);
+    proto_protocol_.setProtocolChangeCallback(protocol_change_callback);
 
     splitflap_task_.setLogger(this);
 
-    SplitflapState last_state = {};
+    uint32_t state_generation = 0;
     while(1) {
-        SplitflapState new_state = splitflap_task_.getState();
-
-        if (new_state != last_state) {
-            current_protocol->handleState(last_state, new_state);
-            last_state = new_state;
+        ModuleBitmask changed_modules;
+        uint32_t generation = splitflap_task_.getStateChanges(state_generation, state, changed_modules);
+        if (generation != state_generation) {
+            state_generation = generation;
+            current_protocol->handleState(state, changed_modules);
         }
 
         current_protocol->loop();
 
-        std::string* log_string;
-        while (xQueueReceive(log_queue_, &log_string, 0) == pdTRUE) {
-            current_protocol->log(log_string->c_str());
-            delete log_string;
-        }
+        printLog(current_protocol);
+        printMotionLog(current_protocol);
 
         PB_SupervisorState supervisor_state;
         if (xQueueReceive(supervisor_state_queue_, &supervisor_state, 0) == pdTRUE) {
@@ -89,11 +97,41 @@ void SerialTask::run() {
 }
 
 void SerialTask::log(const char* msg) {
-    // Allocate a string for the duration it's in the queue; it is free'd by the queue consumer
-    std::string* msg_str = new std::string(msg);
+    // Copied into the ring (or dropped if it's full) without blocking; printed by run()
+    log_ring_.write(msg);
+}
 
-    // Put string in queue (or drop if full to avoid blocking)
-    xQueueSendToBack(log_queue_, &msg_str, 0);
+void SerialTask::printLog(SerialProtocol* protocol) {
+    char buffer[LogRing::MAX_MESSAGE_LENGTH + 1];
+    while (log_ring_.read(buffer, sizeof(buffer))) {
+        protocol->log(buffer);
+    }
+
+    uint32_t dropped = log_ring_.dropped();
+    if (dropped != log_dropped_) {
+        snprintf(buffer, sizeof(buffer), "Dropped %u log messages (%u total); log ring high water mark %u/%u bytes",
+            (unsigned)(dropped - log_dropped_), (unsigned)dropped, (unsigned)log_ring_.highWaterMark(), (unsigned)LogRing::SIZE);
+        protocol->log(buffer);
+        log_dropped_ = dropped;
+    }
+}
+
+/** Formats and prints whatever the motion loop has logged since the last pass */
+void SerialTask::printMotionLog(SerialProtocol* protocol) {
+    MotionLog& motion_log = splitflap_task_.motionLog();
+    char buffer[100];
+    MotionLogRecord record;
+    while (motion_log.read(record)) {
+        MotionLog::format(record, buffer, sizeof(buffer));
+        protocol->log(buffer);
+    }
+
+    uint32_t dropped = motion_log.dropped();
+    if (dropped != motion_log_dropped_) {
+        snprintf(buffer, sizeof(buffer), "Dropped %u motion log events (%u total)", (unsigned)(dropped - motion_log_dropped_), (unsigned)dropped);
+        protocol->log(buffer);
+        motion_log_dropped_ = dropped;
+    }
 }
 
 void SerialTask::sendSupervisorState(PB_SupervisorState& supervisor_state) {
@@ -17,6 +17,7 @@
 
 #include "config.h"
 
+#include "../core/log_ring.h"
 #include "../core/splitflap_task.h"
 #include "../core/task.h"
 #include "../core/uart_stream.h"
@@ -45,8 +46,13 @@ class SerialTask : public Task<SerialTask>, public Logger {
         SerialLegacyJsonProtocol legacy_protocol_;
         SerialProtoProtocol proto_protocol_;
 
-        QueueHandle_t log_queue_;
+        LogRing log_ring_;
         QueueHandle_t supervisor_state_queue_;
 
+        uint32_t log_dropped_ = 0;
+        uint32_t motion_log_dropped_ = 0;
+
         void dumpStatus(SplitflapState& state);
+        void printLog(SerialProtocol* protocol);
+        void printMotionLog(SerialProtocol* protocol);
 };
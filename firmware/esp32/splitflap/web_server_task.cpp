@@ -174,11 +174,13 @@ WebServerTask::~WebServerTask() {
         server_->end();
         delete server_;
     }
+    delete fat_guard_;
 }
 
 void WebServerTask::run() {
         // --- NEW: Initialize the filesystem ---
-    if(!FFat.begin(true)){ // true = format if mount failed
+    fat_guard_ = new FatGuard(&logger_);
+    if (!fat_guard_->mounted_) {
         log("An Error has occurred while mounting FFat");
         return;
     }
@@ -219,6 +221,14 @@ void WebServerTask::run() {
     });
     // --- END NEW ---
 
+    server_->on("/timeline/upload", HTTP_POST,
+        std::bind(&WebServerTask::handleTimelineUpload, this, std::placeholders::_1),
+        nullptr,
+        std::bind(&WebServerTask::handleTimelineUploadBody, this, std::placeholders::_1, std::placeholders::_2,
+            std::placeholders::_3, std::placeholders::_4, std::placeholders::_5));
+    server_->on("/timeline/play", HTTP_POST, std::bind(&WebServerTask::handleTimelinePlay, this, std::placeholders::_1));
+    server_->on("/timeline/stop", HTTP_POST, std::bind(&WebServerTask::handleTimelineStop, this, std::placeholders::_1));
+
     server_->onNotFound(std::bind(&WebServerTask::handleNotFound, this, std::placeholders::_1));
 
     // Start the server (use ->)
@@ -353,6 +363,47 @@ void WebServerTask::handleMqttCreds(AsyncWebServerRequest *request) {
 }
 // --- END NEW ---
 
+/**
+ * POST /timeline/upload with the timeline file as the body. The body arrives in chunks, which go straight to
+ * FFat as they come in.
+ */
+void WebServerTask::handleTimelineUploadBody(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+    TimelineStore& store = splitflap_task_.timelineStore();
+    if (index == 0) {
+        timeline_upload_ok_ = true;
+    }
+    timeline_upload_ok_ = timeline_upload_ok_ && store.writeChunk(index, data, len);
+    if (index + len == total) {
+        timeline_upload_ok_ = timeline_upload_ok_ && store.finishUpload();
+    }
+}
+
+void WebServerTask::handleTimelineUpload(AsyncWebServerRequest *request) {
+    if (timeline_upload_ok_) {
+        request->send(200, "text/plain", "Timeline stored");
+    } else {
+        request->send(400, "text/plain", "Invalid timeline");
+    }
+    timeline_upload_ok_ = false;
+}
+
+/** POST /timeline/play, with an optional `loops` parameter (0, the default, repeats until stopped) */
+void WebServerTask::handleTimelinePlay(AsyncWebServerRequest *request) {
+    uint16_t loops = 0;
+    if (request->hasParam("loops", true)) {
+        loops = request->getParam("loops", true)->value().toInt();
+    } else if (request->hasParam("loops")) {
+        loops = request->getParam("loops")->value().toInt();
+    }
+    splitflap_task_.playTimeline(loops);
+    request->send(200, "text/plain", "OK");
+}
+
+void WebServerTask::handleTimelineStop(AsyncWebServerRequest *request) {
+    splitflap_task_.stopTimeline();
+    request->send(200, "text/plain", "OK");
+}
+
 // --- MISSING FUNCTION (FIX) ---
 void WebServerTask::handleNotFound(AsyncWebServerRequest *request) {
     request->send(404, "text/plain", "404: Not Found");
@@ -9,6 +9,7 @@
 #include <ESPAsyncWebServer.h>
 
 #include "../core/task.h"
+#include "../core/configuration.h"
 #include "../core/logger.h"
 #include "../core/splitflap_task.h"
 #include "mqtt_task.h"
@@ -38,6 +39,10 @@ class WebServerTask : public Task<WebServerTask> {
         // We will create the object inside run() to avoid boot crashes.
         AsyncWebServer* server_ = nullptr; 
 
+        // Keeps FFat mounted while the server is serving files from it
+        FatGuard* fat_guard_ = nullptr;
+        bool timeline_upload_ok_ = false;
+
         // Webpage Handlers
         void handleRoot(AsyncWebServerRequest *request);
         void handleSend(AsyncWebServerRequest *request);
@@ -51,6 +56,12 @@ class WebServerTask : public Task<WebServerTask> {
         void handleMqttCreds(AsyncWebServerRequest *request);
         // --- END NEW ---
 
+        // Animation timelines (see timeline.h)
+        void handleTimelineUploadBody(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total);
+        void handleTimelineUpload(AsyncWebServerRequest *request);
+        void handleTimelinePlay(AsyncWebServerRequest *request);
+        void handleTimelineStop(AsyncWebServerRequest *request);
+
         void log(const char* msg);
 };
 
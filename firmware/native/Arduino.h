@@ -0,0 +1,141 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#pragma once
+
+/**
+ * Minimal host-side stand-in for the Arduino core, used by the `native` PlatformIO environments to compile
+ * the splitflap motion code on a regular computer.
+ *
+ * Time is virtual: micros()/millis() report a simulated clock that only advances when the simulator (or
+ * delay()/delayMicroseconds()) advances it, which keeps runs fully deterministic regardless of host speed.
+ */
+
+#include <assert.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#define PROGMEM
+#define pgm_read_byte_near(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word_near(addr) (*(const uint16_t*)(addr))
+
+#define B00000001 1
+#define B00000010 2
+#define B00000100 4
+#define B00001000 8
+#define B00010000 16
+#define B00100000 32
+#define B01000000 64
+#define B10000000 128
+
+#define HIGH 0x1
+#define LOW  0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+using std::min;
+using std::max;
+
+namespace sim {
+    // Simulated time, in nanoseconds since boot
+    inline uint64_t now_nanos = 0;
+
+    inline void advanceNanos(uint64_t nanos) {
+        now_nanos += nanos;
+    }
+}
+
+// Like the ESP32, micros() is 32 bits wide and wraps after ~71 minutes
+inline unsigned long micros() {
+    return (uint32_t)(sim::now_nanos / 1000);
+}
+
+inline unsigned long millis() {
+    return (uint32_t)(sim::now_nanos / 1000000);
+}
+
+inline void delay(unsigned long ms) {
+    sim::advanceNanos((uint64_t)ms * 1000000);
+}
+
+inline void delayMicroseconds(unsigned int us) {
+    sim::advanceNanos((uint64_t)us * 1000);
+}
+
+inline void pinMode(uint8_t /* pin */, uint8_t /* mode */) {}
+inline void digitalWrite(uint8_t /* pin */, uint8_t /* val */) {}
+inline int digitalRead(uint8_t /* pin */) { return LOW; }
+
+class String : public std::string {
+    public:
+        String() : std::string() {}
+        String(const char* s) : std::string(s) {}
+        String(const std::string& s) : std::string(s) {}
+};
+
+/**
+ * Serial output is discarded unless echo is enabled, so that debug prints left in the motion loop don't
+ * dominate host-side benchmarks.
+ */
+class HostSerial {
+    public:
+        bool echo = false;
+
+        void print(const char* s) { if (echo) fputs(s, stdout); }
+        void print(const std::string& s) { if (echo) fputs(s.c_str(), stdout); }
+        void print(char c) { if (echo) fputc(c, stdout); }
+        void print(int v) { if (echo) printf("%d", v); }
+        void print(unsigned int v) { if (echo) printf("%u", v); }
+        void print(long v) { if (echo) printf("%ld", v); }
+        void print(unsigned long v) { if (echo) printf("%lu", v); }
+        void print(unsigned char v) { print((unsigned int)v); }
+        void print(unsigned short v) { print((unsigned int)v); }
+        void println(const char* s = "") { if (echo) { fputs(s, stdout); fputc('\n', stdout); } }
+
+        int printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+            if (!echo) {
+                return 0;
+            }
+            va_list args;
+            va_start(args, fmt);
+            int result = vprintf(fmt, args);
+            va_end(args);
+            return result;
+        }
+};
+
+inline HostSerial Serial;
+
+// FreeRTOS spinlocks and yields (which the ESP32 Arduino core includes), backed by real threads for the
+// multithreaded stress tests in stress/
+struct portMUX_TYPE {
+    std::mutex mutex;
+};
+#define portMUX_INITIALIZER_UNLOCKED {}
+#define portENTER_CRITICAL(mux) (mux)->mutex.lock()
+#define portEXIT_CRITICAL(mux) (mux)->mutex.unlock()
+#define taskYIELD() std::this_thread::yield()
@@ -0,0 +1,572 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+// Host-side simulator/benchmark for the splitflap motion loop. See README.md in this directory.
+
+#include <chrono>
+
+#include <Arduino.h>
+
+#include "config.h"
+#include "splitflap_module.h"
+#include "spi_io_config.h"
+#include "step_scheduler.h"
+#include "power_scheduler.h"
+
+// Give up on any phase of the simulation after this much simulated time
+static const uint64_t TIMEOUT_NANOS = 300ULL * 1000000000ULL;
+
+struct Options {
+    uint32_t seed = 1;
+    uint16_t flips = 20;
+    bool bench = false;
+    // Simulated CPU time spent on each module per motion loop pass (module update, LED and state bookkeeping)
+    uint32_t cpu_nanos_per_module = 1500;
+    uint32_t blip_ppm = 0;
+    // Motion profile for every module (see Acceleration::MOTION_PROFILE_PERIODS)
+    uint8_t motion_profile = 0;
+    // Delay module starts so that every flip's modules arrive together (see MotionEngine::SynchronizeArrival())
+    bool synchronized_arrival = false;
+    // Per power channel current budget (see PowerScheduler), 0 for no limit
+    uint16_t power_budget_ma = POWER_CHANNEL_BUDGET_MA;
+    // After the flips, power cycle and restore the modules' rest positions instead of homing (see FAST_BOOT)
+    bool power_cycle = false;
+    // After the flips, queue up this many more targets for every module at once (see MotionEngine::QueueFlapIndex())
+    uint8_t queued_flips = 0;
+    uint16_t dwell_millis = 0;
+    // How many modules (from the first) get motors with half the usual rate and acceleration limits
+    uint8_t weak_modules = 0;
+    bool verbose = false;
+};
+
+/**
+ * Mirrors the motion portion of SplitflapTask::run()/runUpdate(): update every module, do one shift register
+ * round trip (or queue it, with SPI_IO_PIPELINED), then sleep until the next step deadline. Command queueing,
+ * LEDs and the iterative loopback checks are omitted.
+ */
+class SimRunner {
+    public:
+        SimRunner(const Options& options) : options_(options) {}
+
+        uint64_t passes = 0;
+        uint64_t host_nanos = 0;
+        StepScheduler scheduler;
+        // Simulated time of each module's most recent step
+        uint64_t last_step_nanos[NUM_MODULES] = {};
+
+        bool runUpdate() {
+            scheduler.beginPass();
+            motor_sensor_io_poll();
+            auto start = std::chrono::steady_clock::now();
+            power_scheduler.update(scheduler.now());
+            motion_engine.Update(scheduler);
+            bool all_idle = true;
+            for (uint8_t i = 0; i < NUM_MODULES; i++) {
+                // Unlike SplitflapTask, a module that's still looking for home isn't considered idle here
+                all_idle &= modules[i]->state == PANIC
+                    || modules[i]->state == STATE_DISABLED
+                    || modules[i]->state == SENSOR_ERROR
+                    || (modules[i]->state == NORMAL && !motion_engine.IsBusy(i));
+            }
+            host_nanos += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+            // Stands in for SerialTask, which prints the motion log from the other core
+            MotionLogRecord record;
+            while (motion_log.read(record)) {
+                if (options_.verbose) {
+                    char buffer[100];
+                    MotionLog::format(record, buffer, sizeof(buffer));
+                    printf("%s\n", buffer);
+                }
+            }
+
+            for (uint8_t i = 0; i < NUM_MODULES; i++) {
+                if (motion_engine.current_step[i] != last_step_[i]) {
+                    last_step_[i] = motion_engine.current_step[i];
+                    last_step_nanos[i] = sim::now_nanos;
+                }
+            }
+
+            sim::advanceNanos((uint64_t)options_.cpu_nanos_per_module * NUM_MODULES);
+            motor_sensor_io_queue();
+            passes++;
+            scheduler.waitForNextDeadline();
+            return all_idle;
+        }
+
+        /** Runs the loop until all modules are idle. Returns the elapsed simulated time, or 0 on timeout. */
+        uint64_t runUntilIdle() {
+            uint64_t start = sim::now_nanos;
+            // Modules only start moving at their next step period, so give every module a chance to begin
+            // before checking for idle
+            while (sim::now_nanos - start <= (uint64_t)Acceleration::ACCEL_STEP_PERIODS[0] * 1000) {
+                runUpdate();
+            }
+            while (!runUpdate()) {
+                if (sim::now_nanos - start > TIMEOUT_NANOS) {
+                    return 0;
+                }
+            }
+            return sim::now_nanos - start;
+        }
+
+    private:
+        const Options& options_;
+        uint16_t last_step_[NUM_MODULES] = {};
+};
+
+/**
+ * Steady-state cost of the motion update alone: snapshots the modules mid-move and replays a fixed number of
+ * update passes, with no simulated I/O in between to pollute the cache, keeping the best of several repeats.
+ */
+static double benchmarkUpdate(StepScheduler& scheduler, uint64_t pass_nanos) {
+    static const uint16_t PASSES = 2000;
+    static const uint8_t REPEATS = 200;
+
+    static MotionEngine snapshot;
+    snapshot = motion_engine;
+    uint64_t start_nanos = sim::now_nanos;
+
+    uint64_t best_nanos = UINT64_MAX;
+    for (uint8_t r = 0; r < REPEATS; r++) {
+        motion_engine = snapshot;
+        sim::now_nanos = start_nanos;
+        auto start = std::chrono::steady_clock::now();
+        for (uint16_t p = 0; p < PASSES; p++) {
+            scheduler.beginPass();
+            motion_engine.Update(scheduler);
+            sim::advanceNanos(pass_nanos);
+        }
+        uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        best_nanos = min(best_nanos, elapsed);
+    }
+
+    motion_engine = snapshot;
+    sim::now_nanos = start_nanos;
+    return (double)best_nanos / PASSES;
+}
+
+/** Time for one motor_sensor_io(), with all chains transferring at once */
+static uint64_t spiRoundTripNanos() {
+    uint64_t nanos = 0;
+    for (uint8_t c = 0; c < NUM_CHAINS; c++) {
+        nanos = max(nanos, sim_chains[c].transferNanos(SPI_CHAINS[c].motor_length, SPI_CHAINS[c].sensor_length));
+    }
+    return nanos;
+}
+
+static void printPowerStats(const char* prefix) {
+    const PowerSchedulerStats& stats = power_scheduler.stats();
+    printf("%squeue_wait_ms: mean %.1f / max %.1f over %u admissions\n", prefix,
+        stats.admissions > 0 ? stats.total_wait_micros / 1e3 / stats.admissions : 0, stats.max_wait_micros / 1e3, stats.admissions);
+    printf("%speak_moving_per_channel: %u\n", prefix, stats.peak_moving);
+}
+
+static uint32_t rng_state = 1;
+static uint32_t nextRandom() {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static void usage(const char* name) {
+    fprintf(stderr,
+        "Usage: %s [--seed N] [--flips N] [--cpu-nanos-per-module N] [--blip-ppm N] [--motion-profile N] [--synchronized-arrival] [--power-budget-ma N] [--queued-flips N] [--dwell-ms N] [--weak-modules N] [--power-cycle] [--bench] [--verbose]\n", name);
+}
+
+static bool parseArgs(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (!strcmp(arg, "--seed") && has_value) {
+            options.seed = strtoul(argv[++i], nullptr, 0);
+        } else if (!strcmp(arg, "--flips") && has_value) {
+            options.flips = strtoul(argv[++i], nullptr, 0);
+        } else if (!strcmp(arg, "--cpu-nanos-per-module") && has_value) {
+            options.cpu_nanos_per_module = strtoul(argv[++i], nullptr, 0);
+        } else if (!strcmp(arg, "--blip-ppm") && has_value) {
+            options.blip_ppm = strtoul(argv[++i], nullptr, 0);
+        } else if (!strcmp(arg, "--motion-profile") && has_value) {
+            options.motion_profile = strtoul(argv[++i], nullptr, 0);
+            if (options.motion_profile >= Acceleration::NUM_MOTION_PROFILES) {
+                return false;
+            }
+        } else if (!strcmp(arg, "--synchronized-arrival")) {
+            options.synchronized_arrival = true;
+        } else if (!strcmp(arg, "--power-budget-ma") && has_value) {
+            options.power_budget_ma = strtoul(argv[++i], nullptr, 0);
+        } else if (!strcmp(arg, "--queued-flips") && has_value) {
+            options.queued_flips = strtoul(argv[++i], nullptr, 0);
+            if (options.queued_flips > MODULE_QUEUE_DEPTH) {
+                return false;
+            }
+        } else if (!strcmp(arg, "--dwell-ms") && has_value) {
+            options.dwell_millis = strtoul(argv[++i], nullptr, 0);
+        } else if (!strcmp(arg, "--weak-modules") && has_value) {
+            options.weak_modules = min(strtoul(argv[++i], nullptr, 0), (unsigned long)NUM_MODULES);
+        } else if (!strcmp(arg, "--power-cycle")) {
+            options.power_cycle = true;
+        } else if (!strcmp(arg, "--bench")) {
+            options.bench = true;
+        } else if (!strcmp(arg, "--verbose")) {
+            options.verbose = true;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseArgs(argc, argv, options)) {
+        usage(argv[0]);
+        return 2;
+    }
+    Serial.echo = options.verbose;
+    rng_state = options.seed;
+
+    for (uint8_t c = 0; c < NUM_CHAINS; c++) {
+        sim_chains[c].begin(options.seed + c, SPI_CHAINS[c].first_module, SPI_CHAINS[c].num_modules);
+        sim_chains[c].spurious_blip_ppm = options.blip_ppm;
+    }
+    for (uint8_t i = 0; i < options.weak_modules; i++) {
+        SimModuleParams& p = sim_chain_for(i).params(i);
+        p.pull_in_rate /= 2;
+        p.max_rate /= 2;
+        p.max_accel /= 2;
+    }
+
+    initialize_modules();
+    motor_sensor_io();
+
+    printf("modules: %u\n", NUM_MODULES);
+    printf("spi_io_pipelined: %s\n", SPI_IO_PIPELINED ? "true" : "false");
+    printf("seed: %u\n", options.seed);
+    printf("chains: %u\n", NUM_CHAINS);
+    printf("spi_round_trip_us: %.1f\n", spiRoundTripNanos() / 1000.0);
+
+    bool ok = true;
+
+#ifdef CHAINLINK
+    bool loopback_result[NUM_LOOPBACKS][NUM_LOOPBACKS];
+    bool loopback_off_result[NUM_LOOPBACKS];
+    bool loopbacks_ok = chainlink_test_all_loopbacks(loopback_result, loopback_off_result);
+    printf("loopbacks_ok: %s\n", loopbacks_ok ? "true" : "false");
+    ok &= loopbacks_ok;
+#endif
+
+    SimRunner runner(options);
+    runner.scheduler.begin();
+    power_scheduler.begin(options.power_budget_ma);
+
+    for (uint8_t i = 0; i < NUM_MODULES; i++) {
+        modules[i]->SetMotionProfile(options.motion_profile);
+        modules[i]->Init();
+        modules[i]->FindAndRecalibrateHome();
+    }
+    uint64_t homing_nanos = runner.runUntilIdle();
+    uint8_t homed = 0;
+    for (uint8_t i = 0; i < NUM_MODULES; i++) {
+        homed += modules[i]->state == NORMAL;
+    }
+    printf("homing_ms: %.1f\n", homing_nanos / 1e6);
+    printf("homed: %u/%u\n", homed, NUM_MODULES);
+    ok &= homing_nanos > 0 && homed == NUM_MODULES;
+    if (power_scheduler.maxMoving() > 0) {
+        printf("power_max_moving_per_channel: %u\n", power_scheduler.maxMoving());
+        printPowerStats("homing_");
+    }
+
+    uint64_t total_flip_nanos = 0;
+    uint64_t max_flip_nanos = 0;
+    uint32_t wrong_flaps = 0;
+    uint64_t flip_passes = 0;
+    uint64_t flip_host_nanos = 0;
+    uint64_t total_spread_nanos = 0;
+    uint64_t max_spread_nanos = 0;
+    uint64_t flip_start_nanos = sim::now_nanos;
+    // Only report step timing for the flips, not homing
+    runner.scheduler.resetStats();
+    power_scheduler.resetStats();
+    memset(&motor_sensor_io_stats, 0, sizeof(motor_sensor_io_stats));
+    for (uint16_t f = 0; f < options.flips; f++) {
+        uint8_t targets[NUM_MODULES];
+        for (uint8_t i = 0; i < NUM_MODULES; i++) {
+            targets[i] = nextRandom() % NUM_FLAPS;
+            modules[i]->GoToFlapIndex(targets[i]);
+        }
+        if (options.synchronized_arrival) {
+            motion_engine.SynchronizeArrival(runner.scheduler.now());
+        }
+
+        uint64_t move_start_nanos = sim::now_nanos;
+        uint64_t passes_before = runner.passes;
+        uint64_t host_before = runner.host_nanos;
+        uint64_t flip_nanos = runner.runUntilIdle();
+        flip_passes += runner.passes - passes_before;
+        flip_host_nanos += runner.host_nanos - host_before;
+        if (flip_nanos == 0) {
+            printf("flip %u timed out\n", f);
+            ok = false;
+            break;
+        }
+        total_flip_nanos += flip_nanos;
+        max_flip_nanos = max(max_flip_nanos, flip_nanos);
+
+        // Spread between the first and last module to land on their new flap
+        uint64_t first_arrival = UINT64_MAX;
+        uint64_t last_arrival = 0;
+        for (uint8_t i = 0; i < NUM_MODULES; i++) {
+            if (runner.last_step_nanos[i] > move_start_nanos) {
+                first_arrival = min(first_arrival, runner.last_step_nanos[i]);
+                last_arrival = max(last_arrival, runner.last_step_nanos[i]);
+            }
+        }
+        if (last_arrival > 0) {
+            total_spread_nanos += last_arrival - first_arrival;
+            max_spread_nanos = max(max_spread_nanos, last_arrival - first_arrival);
+        }
+
+        for (uint8_t i = 0; i < NUM_MODULES; i++) {
+            uint8_t visible = sim_chain_for(i).visibleFlap(i, modules[i]->GetOffset());
+            if (modules[i]->state == NORMAL && visible != targets[i]) {
+                if (options.verbose) {
+                    printf("module %u: expected flap %u but spool shows %u\n", i, targets[i], visible);
+                }
+                wrong_flaps++;
+            }
+        }
+    }
+    uint64_t flip_elapsed_nanos = sim::now_nanos - flip_start_nanos;
+
+    uint32_t steps = 0;
+    uint32_t missed_steps = 0;
+    uint32_t unexpected_home = 0;
+    uint32_t missed_home = 0;
+    for (uint8_t i = 0; i < NUM_MODULES; i++) {
+        steps += sim_chain_for(i).stats(i).steps;
+        missed_steps += sim_chain_for(i).stats(i).missed_steps;
+        unexpected_home += modules[i]->count_unexpected_home;
+        missed_home += modules[i]->count_missed_home;
+    }
+
+    if (options.flips > 0) {
+        printf("flip_mean_ms: %.1f\n", total_flip_nanos / 1e6 / options.flips);
+        printf("flip_max_ms: %.1f\n", max_flip_nanos / 1e6);
+        printf("arrival_spread_ms: mean %.1f / max %.1f\n", total_spread_nanos / 1e6 / options.flips, max_spread_nanos / 1e6);
+    }
+    if (power_scheduler.maxMoving() > 0) {
+        printPowerStats("");
+        if (options.verbose) {
+            for (uint8_t i = 0; i < NUM_MODULES; i++) {
+                printf("module %u: last queue wait %.1fms\n", i, power_scheduler.last_wait_micros[i] / 1e3);
+            }
+        }
+    }
+    printf("wrong_flaps: %u\n", wrong_flaps);
+    printf("steps: %u\n", steps);
+    printf("missed_steps: %u\n", missed_steps);
+    printf("count_unexpected_home: %u\n", unexpected_home);
+    printf("count_missed_home: %u\n", missed_home);
+#if ADAPTIVE_SPEED
+    uint8_t min_accel_step = UINT8_MAX;
+    uint32_t total_accel_step = 0;
+    for (uint8_t i = 0; i < NUM_MODULES; i++) {
+        min_accel_step = min(min_accel_step, modules[i]->GetMaxAccelStep());
+        total_accel_step += modules[i]->GetMaxAccelStep();
+        if (options.verbose && modules[i]->GetMaxAccelStep() != Acceleration::MAX_ACCEL_STEP) {
+            printf("module %u: learned max accel step %u\n", i, modules[i]->GetMaxAccelStep());
+        }
+    }
+    printf("learned_max_accel_step: min %u / mean %.1f of %u\n", min_accel_step, (double)total_accel_step / NUM_MODULES, Acceleration::MAX_ACCEL_STEP);
+#endif
+    if (flip_passes > 0) {
+        printf("loop_pass_us: %.1f\n", flip_elapsed_nanos / 1e3 / flip_passes);
+        printf("host_update_ns_per_pass: %.1f\n", (double)flip_host_nanos / flip_passes);
+        printf("host_update_ns_per_module: %.2f\n", (double)flip_host_nanos / flip_passes / NUM_MODULES);
+    }
+    if (motor_sensor_io_stats.transfers > 0) {
+        printf("io_round_trip_us: mean %.1f / max %u\n",
+            (double)motor_sensor_io_stats.total_round_trip_micros / motor_sensor_io_stats.transfers, motor_sensor_io_stats.max_round_trip_micros);
+        printf("io_overlap_pct: %u\n", motor_sensor_io_overlap_percent());
+    }
+
+    for (uint8_t i = 1; i <= Acceleration::MAX_ACCEL_STEP; i++) {
+        const StepPeriodStats& stats = runner.scheduler.stats(i);
+        if (stats.count > 0) {
+            printf("step_period_us[%u]: requested %u, achieved mean %.1f / max %u over %u steps\n",
+                i, Acceleration::ACCEL_STEP_PERIODS[i], (double)stats.total_micros / stats.count, stats.max_micros, stats.count);
+        }
+    }
+
+    if (options.synchronized_arrival && ok) {
+        // A second synchronized flip sent while the first one's shorter moves are still waiting to start. Their old
+        // start delays must not carry over, so it should take no longer than its longest single move.
+        for (uint8_t i = 0; i < NUM_MODULES; i++) {
+            modules[i]->GoToFlapIndex(nextRandom() % NUM_FLAPS);
+        }
+        motion_engine.SynchronizeArrival(runner.scheduler.now());
+        uint64_t first_start_nanos = sim::now_nanos;
+        while (sim::now_nanos - first_start_nanos < (uint64_t)Acceleration::ACCEL_STEP_PERIODS[0] * 1000 * 4) {
+            runner.runUpdate();
+        }
+
+        uint8_t targets[NUM_MODULES];
+        uint32_t longest_move_micros = 0;
+        for (uint8_t i = 0; i < NUM_MODULES; i++) {
+            targets[i] = nextRandom() % NUM_FLAPS;
+            modules[i]->GoToFlapIndex(targets[i]);
+            if (motion_engine.IsMoving(i)) {
+                // A module that's already moving takes its next step within its current period
+                uint32_t next_step = motion_engine.current_accel_step[i] > 0 ? motion_engine.current_period[i] : 0;
+                longest_move_micros = max(longest_move_micros, next_step + motion_engine.TravelMicros(i));
+            }
+        }
+        motion_engine.SynchronizeArrival(runner.scheduler.now());
+        uint64_t second_flip_nanos = runner.runUntilIdle();
+        uint32_t back_to_back_wrong_flaps = 0;
+        for (uint8_t i = 0; i < NUM_MODULES; i++) {
+            uint8_t visible = sim_chain_for(i).visibleFlap(i, modules[i]->GetOffset());
+            if (modules[i]->state != NORMAL || visible != targets[i]) {
+                back_to_back_wrong_flaps++;
+            }
+        }
+        printf("sync_back_to_back_ms: %.1f (longest move %.1f)\n", second_flip_nanos / 1e6, longest_move_micros / 1e3);
+        printf("sync_back_to_back_wrong_flaps: %u\n", back_to_back_wrong_flaps);
+        ok &= second_flip_nanos > 0 && back_to_back_wrong_flaps == 0;
+        // Waiting for a power slot legitimately starts moves late. Otherwise, allow for loop passes running steps
+        // late (see arrival_spread_ms) and for runUntilIdle() only checking for idle after an idle period.
+        if (power_scheduler.maxMoving() == 0 || power_scheduler.maxMoving() >= MODULES_PER_POWER_CHANNEL) {
+            uint64_t allowed_nanos = (uint64_t)longest_move_micros * 1000 * 11 / 10
+                + (uint64_t)Acceleration::ACCEL_STEP_PERIODS[0] * 1000 * 2;
+            ok &= second_flip_nanos <= allowed_nanos;
+        }
+    }
+
+    if (options.queued_flips > 0 && ok) {
+        // Pre-load every module with a sequence of targets, which they then work through with no further commands
+        uint8_t targets[NUM_MODULES];
+        for (uint8_t f = 0; f < options.queued_flips; f++) {
+            for (uint8_t i = 0; i < NUM_MODULES; i++) {
+                targets[i] = nextRandom() % NUM_FLAPS;
+                ok &= modules[i]->QueueFlapIndex(targets[i], options.dwell_millis);
+            }
+        }
+        uint64_t queue_nanos = runner.runUntilIdle();
+        uint32_t queue_wrong_flaps = 0;
+        for (uint8_t i = 0; i < NUM_MODULES; i++) {
+            uint8_t visible = sim_chain_for(i).visibleFlap(i, modules[i]->GetOffset());
+            if (modules[i]->state != NORMAL || visible != targets[i]) {
+                if (options.verbose) {
+                    printf("module %u: expected flap %u after its queue but spool shows %u\n", i, targets[i], visible);
+                }
+                queue_wrong_flaps++;
+            }
+        }
+        printf("queue_drain_ms: %.1f\n", queue_nanos / 1e6);
+        printf("queue_wrong_flaps: %u\n", queue_wrong_flaps);
+        ok &= queue_nanos > 0 && queue_wrong_flaps == 0;
+    }
+
+    if (options.power_cycle && ok) {
+        // Everything is at rest, so this is what SplitflapTask would have saved. Cut the power (the spools stay
+        // where they are) and start back up from the saved positions, like SplitflapTask does with FAST_BOOT.
+        uint16_t offsets[NUM_MODULES];
+        uint16_t rest_steps[NUM_MODULES];
+        uint8_t rest_phases[NUM_MODULES];
+        uint8_t rest_flaps[NUM_MODULES];
+        for (uint8_t i = 0; i < NUM_MODULES; i++) {
+            offsets[i] = modules[i]->GetOffset();
+            rest_steps[i] = motion_engine.current_step[i];
+            rest_phases[i] = motion_engine.current_phase[i];
+            rest_flaps[i] = modules[i]->GetTargetFlapIndex();
+        }
+        initialize_modules();
+        motor_sensor_io();
+        power_scheduler.begin(options.power_budget_ma);
+        uint8_t restored = 0;
+        for (uint8_t i = 0; i < NUM_MODULES; i++) {
+            modules[i]->SetMotionProfile(options.motion_profile);
+            modules[i]->Init();
+            restored += modules[i]->RestorePosition(offsets[i], rest_steps[i], rest_phases[i], rest_flaps[i]);
+        }
+        printf("fast_boot_restored: %u/%u\n", restored, NUM_MODULES);
+        ok &= restored == NUM_MODULES;
+
+        // A few moves to check that the restored positions were right; the first is how long it takes from
+        // power on to showing something new, which would otherwise be homing_ms plus a flip
+        static const uint8_t FAST_BOOT_FLIPS = 5;
+        uint64_t first_flip_nanos = 0;
+        uint32_t fast_boot_wrong_flaps = 0;
+        for (uint8_t f = 0; f < FAST_BOOT_FLIPS; f++) {
+            uint8_t targets[NUM_MODULES];
+            for (uint8_t i = 0; i < NUM_MODULES; i++) {
+                targets[i] = nextRandom() % NUM_FLAPS;
+                modules[i]->GoToFlapIndex(targets[i]);
+            }
+            uint64_t flip_nanos = runner.runUntilIdle();
+            if (flip_nanos == 0) {
+                printf("fast boot flip %u timed out\n", f);
+                ok = false;
+                break;
+            }
+            if (f == 0) {
+                first_flip_nanos = flip_nanos;
+            }
+            for (uint8_t i = 0; i < NUM_MODULES; i++) {
+                uint8_t visible = sim_chain_for(i).visibleFlap(i, modules[i]->GetOffset());
+                if (modules[i]->state != NORMAL || visible != targets[i]) {
+                    if (options.verbose) {
+                        printf("module %u: expected flap %u after power cycle but spool shows %u\n", i, targets[i], visible);
+                    }
+                    fast_boot_wrong_flaps++;
+                }
+            }
+        }
+        uint32_t fast_boot_unexpected_home = 0;
+        uint32_t fast_boot_missed_home = 0;
+        for (uint8_t i = 0; i < NUM_MODULES; i++) {
+            fast_boot_unexpected_home += modules[i]->count_unexpected_home;
+            fast_boot_missed_home += modules[i]->count_missed_home;
+        }
+        printf("fast_boot_first_flip_ms: %.1f\n", first_flip_nanos / 1e6);
+        printf("fast_boot_wrong_flaps: %u\n", fast_boot_wrong_flaps);
+        printf("fast_boot_count_unexpected_home: %u\n", fast_boot_unexpected_home);
+        printf("fast_boot_count_missed_home: %u\n", fast_boot_missed_home);
+        ok &= fast_boot_wrong_flaps == 0;
+    }
+
+    if (options.bench && ok) {
+        // Send every module around a full revolution, and benchmark once they've all reached full speed
+        for (uint8_t i = 0; i < NUM_MODULES; i++) {
+            modules[i]->GoToFlapIndex(modules[i]->GetTargetFlapIndex());
+        }
+        uint64_t start_nanos = sim::now_nanos;
+        while (sim::now_nanos - start_nanos < 200ULL * 1000000) {
+            runner.runUpdate();
+        }
+        uint64_t pass_nanos = spiRoundTripNanos() + (uint64_t)options.cpu_nanos_per_module * NUM_MODULES;
+        double nanos_per_pass = benchmarkUpdate(runner.scheduler, pass_nanos);
+        printf("bench_update_ns_per_pass: %.1f\n", nanos_per_pass);
+        printf("bench_update_ns_per_module: %.2f\n", nanos_per_pass / NUM_MODULES);
+    }
+
+    ok &= wrong_flaps == 0;
+    printf("result: %s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
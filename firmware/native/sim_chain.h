@@ -0,0 +1,311 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#pragma once
+
+#include <Arduino.h>
+
+#include "config.h"
+
+/**
+ * Deterministic model of a chain of 74HC595 (motor/LED/loopback outputs) and 74HC165 (home sensor/loopback
+ * inputs) shift registers, plus the 28BYJ-48 motors and spools hanging off of them. With NUM_CHAINS > 1 there is
+ * one SimChain per chain, each covering a contiguous range of modules; public methods take global module indices.
+ *
+ * The bit layout mirrors the physical boards (Chainlink Driver, or the classic 2-motors-per-byte driver), and
+ * is intentionally derived independently of spi_io_config.h so that mapping bugs in the firmware show up as
+ * simulation failures.
+ *
+ * Rotor positions are tracked in half-steps so the same model can be driven by full- or half-step patterns.
+ */
+
+#define SIM_HALF_STEPS_PER_REVOLUTION (4096)
+
+struct SimModuleParams {
+    // Spool position (half-steps) where the home sensor starts reading active
+    uint16_t home_position;
+    // Width of the home sensor's active region, in half-steps
+    uint16_t home_width;
+    // Highest step rate the motor can start from a standstill, in full steps/sec
+    float pull_in_rate;
+    // Highest step rate the motor can sustain, in full steps/sec
+    float max_rate;
+    // Largest change in step rate the spool's inertia allows, in full steps/sec^2
+    float max_accel;
+};
+
+struct SimModuleStats {
+    uint32_t steps;
+    uint32_t missed_steps;
+};
+
+class SimChain {
+    public:
+        // Timing model for one motor_sensor_io() round trip
+        uint32_t spi_clock_hz = 4000000;
+        uint32_t transaction_overhead_nanos = 15000;
+
+        // Probability (parts per million) that any given sensor sample reads a spurious home blip
+        uint32_t spurious_blip_ppm = 0;
+
+        void begin(uint32_t seed, uint16_t first_module = 0, uint16_t num_modules = NUM_MODULES) {
+            rng_ = seed ? seed : 1;
+            first_module_ = first_module;
+            num_modules_ = num_modules;
+            for (uint16_t i = 0; i < num_modules_; i++) {
+                SimModuleParams& p = params_[i];
+                p.home_position = random() % SIM_HALF_STEPS_PER_REVOLUTION;
+                p.home_width = 16 + random() % 8;
+                p.pull_in_rate = 300 + random() % 100;
+                p.max_rate = 600 + random() % 150;
+                p.max_accel = 6000 + random() % 3000;
+
+                // Start each spool at rest, aligned with the first entry of the firmware's step pattern
+                rotor_[i] = (random() % (SIM_HALF_STEPS_PER_REVOLUTION / 8)) * 8 + coilAngle(step_pattern[0]);
+                velocity_[i] = 0;
+                last_move_nanos_[i] = 0;
+                coils_[i] = 0;
+                stats_[i] = {};
+            }
+            memset(latched_out_, 0, sizeof(latched_out_));
+        }
+
+        /**
+         * Simulates shifting out `motor_len` bytes and shifting in `sensor_len` bytes, then pulsing the shared
+         * latch. Like the hardware, the sensor inputs are sampled *before* the new outputs take effect, so a
+         * loopback needs two round trips to be observed.
+         */
+        void transfer(const uint8_t* motor_buffer, uint16_t motor_len, uint8_t* sensor_buffer, uint16_t sensor_len) {
+            beginTransfer(motor_buffer, motor_len, sensor_len);
+            endTransfer(sensor_buffer);
+        }
+
+        /**
+         * Starts a background transfer (like a queued DMA transaction). The frame is copied, so the caller may
+         * reuse `motor_buffer` right away. Must be followed by endTransfer() before the next beginTransfer().
+         */
+        void beginTransfer(const uint8_t* motor_buffer, uint16_t motor_len, uint16_t sensor_len) {
+            assert(!in_flight_);
+            memcpy(pending_out_, motor_buffer, motor_len);
+            motor_len_ = motor_len;
+            sensor_len_ = sensor_len;
+            complete_nanos_ = sim::now_nanos + transferNanos(motor_len, sensor_len);
+            in_flight_ = true;
+        }
+
+        bool transferComplete() const {
+            return sim::now_nanos >= complete_nanos_;
+        }
+
+        uint64_t completeNanos() const {
+            return complete_nanos_;
+        }
+
+        /**
+         * Waits (in simulated time) for the background transfer to finish, and returns the sensor data it read.
+         * The outputs take effect at the time the transfer finished, even if that was a while ago.
+         */
+        void endTransfer(uint8_t* sensor_buffer) {
+            assert(in_flight_);
+            in_flight_ = false;
+            if (sim::now_nanos < complete_nanos_) {
+                sim::now_nanos = complete_nanos_;
+            }
+            uint16_t motor_len = motor_len_;
+            uint16_t sensor_len = sensor_len_;
+
+            memset(sensor_buffer, 0, sensor_len);
+            for (uint16_t i = 0; i < num_modules_; i++) {
+                bool home = isLocalHome(i) || (spurious_blip_ppm > 0 && random() % 1000000 < spurious_blip_ppm);
+                if (home) {
+                    sensor_buffer[sensorByte(i)] |= 1 << sensorBit(i);
+                }
+            }
+#ifdef CHAINLINK
+            for (uint16_t l = 0; l < num_modules_ / 3; l++) {
+                if (latched_out_[motor_len - 1 - (l / 2) * 4 - (l % 2 == 0 ? 1 : 2)] & (l % 2 == 0 ? 1 << 7 : 1 << 3)) {
+                    sensor_buffer[l / 2] |= l % 2 == 0 ? 1 << 6 : 1 << 7;
+                }
+            }
+#endif
+
+            memcpy(latched_out_, pending_out_, motor_len);
+            for (uint16_t i = 0; i < num_modules_; i++) {
+                driveCoils(i, (latched_out_[motorByte(i, motor_len)] >> motorShift(i)) & 0x0F, complete_nanos_);
+            }
+        }
+
+        uint64_t transferNanos(uint16_t motor_len, uint16_t sensor_len) const {
+            return 2 * (uint64_t)transaction_overhead_nanos
+                + (uint64_t)(motor_len + sensor_len) * 8 * 1000000000ULL / spi_clock_hz;
+        }
+
+        bool isHome(uint16_t module) const {
+            return isLocalHome(module - first_module_);
+        }
+
+        /** Flap index that is physically visible, measured from the leading edge of the home sensor. */
+        uint8_t visibleFlap(uint16_t module, uint16_t offset_steps) const {
+            uint16_t i = module - first_module_;
+            uint32_t from_home = (spoolPosition(i) + 2 * SIM_HALF_STEPS_PER_REVOLUTION - params_[i].home_position - offset_steps * halfStepsPerStep()) % SIM_HALF_STEPS_PER_REVOLUTION;
+            return from_home * NUM_FLAPS / SIM_HALF_STEPS_PER_REVOLUTION;
+        }
+
+        SimModuleParams& params(uint16_t module) {
+            return params_[module - first_module_];
+        }
+
+        const SimModuleStats& stats(uint16_t module) const {
+            return stats_[module - first_module_];
+        }
+
+    private:
+        uint16_t first_module_ = 0;
+        uint16_t num_modules_ = 0;
+
+        bool isLocalHome(uint16_t i) const {
+            uint16_t position = spoolPosition(i);
+            uint16_t from_home = (position + SIM_HALF_STEPS_PER_REVOLUTION - params_[i].home_position) % SIM_HALF_STEPS_PER_REVOLUTION;
+            return from_home < params_[i].home_width;
+        }
+
+        SimModuleParams params_[NUM_MODULES];
+        SimModuleStats stats_[NUM_MODULES];
+
+        int32_t rotor_[NUM_MODULES];
+        float velocity_[NUM_MODULES];
+        uint64_t last_move_nanos_[NUM_MODULES];
+        uint8_t coils_[NUM_MODULES];
+
+        uint8_t latched_out_[1024];
+
+        uint8_t pending_out_[1024];
+        uint16_t motor_len_ = 0;
+        uint16_t sensor_len_ = 0;
+        uint64_t complete_nanos_ = 0;
+        bool in_flight_ = false;
+
+        uint32_t rng_;
+
+        uint32_t random() {
+            // xorshift32
+            rng_ ^= rng_ << 13;
+            rng_ ^= rng_ >> 17;
+            rng_ ^= rng_ << 5;
+            return rng_;
+        }
+
+        static uint8_t halfStepsPerStep() {
+            return SIM_HALF_STEPS_PER_REVOLUTION / STEPS_PER_REVOLUTION;
+        }
+
+        uint16_t spoolPosition(uint16_t i) const {
+            int32_t position = rotor_[i] % SIM_HALF_STEPS_PER_REVOLUTION;
+            return position < 0 ? position + SIM_HALF_STEPS_PER_REVOLUTION : position;
+        }
+
+        /** Electrical angle (in half-steps, 0-7) produced by a coil pattern, or -1 if the pattern isn't valid */
+        static int8_t coilAngle(uint8_t coils) {
+            static const uint8_t A = B00001000, B = B00000100, C = B00000010, D = B00000001;
+            static const uint8_t angles[] = {A, A | B, B, B | C, C, C | D, D, D | A};
+            for (int8_t a = 0; a < 8; a++) {
+                if (angles[a] == coils) {
+#if REVERSE_MOTOR_DIRECTION
+                    return (8 - a) % 8;
+#else
+                    return a;
+#endif
+                }
+            }
+            return -1;
+        }
+
+        void driveCoils(uint16_t i, uint8_t coils, uint64_t now_nanos) {
+            if (coils == coils_[i]) {
+                return;
+            }
+            coils_[i] = coils;
+
+            int8_t angle = coilAngle(coils);
+            if (angle < 0) {
+                // De-energized (or nonsense pattern): the spool stops at its current detent
+                velocity_[i] = 0;
+                return;
+            }
+
+            int8_t delta = (angle - (((rotor_[i] % 8) + 8) % 8) + 8) % 8;
+            if (delta > 4) {
+                delta -= 8;
+            }
+            if (delta == 0) {
+                return;
+            }
+
+            SimModuleParams& p = params_[i];
+            float dt = (now_nanos - last_move_nanos_[i]) / 1e9f;
+            // In full steps per second, whichever mode the firmware drives the coils in
+            float rate = abs(delta) / 2.0f / dt;
+            float max_rate_now = min(p.max_rate, max(p.pull_in_rate, velocity_[i] + p.max_accel * dt));
+
+            if (abs(delta) > 2 || rate > max_rate_now) {
+                // Rotor can't follow the field; it stays put and loses whatever speed it had
+                stats_[i].missed_steps++;
+                velocity_[i] = 0;
+                last_move_nanos_[i] = now_nanos;
+                return;
+            }
+
+            rotor_[i] += delta;
+            velocity_[i] = rate;
+            last_move_nanos_[i] = now_nanos;
+            stats_[i].steps++;
+        }
+
+        static uint16_t sensorByte(uint16_t i) {
+#ifdef CHAINLINK
+            return i / 6;
+#else
+            return i / 4;
+#endif
+        }
+
+        static uint8_t sensorBit(uint16_t i) {
+#ifdef CHAINLINK
+            return i % 6;
+#else
+            return i % 4;
+#endif
+        }
+
+        static uint16_t motorByte(uint16_t i, uint16_t motor_len) {
+#ifdef CHAINLINK
+            // Each Chainlink Driver is 4 bytes: [motors 4+5] [LEDs 3-5, loopback, motor 3] [loopback, LEDs 0-2, motor 2] [motors 0+1]
+            static const uint8_t offset[] = {0, 0, 1, 2, 3, 3};
+            return motor_len - 1 - (i / 6) * 4 - offset[i % 6];
+#else
+            return motor_len - 1 - i / 2;
+#endif
+        }
+
+        static uint8_t motorShift(uint16_t i) {
+            return i % 2 == 0 ? 0 : 4;
+        }
+};
+
+SimChain sim_chains[NUM_CHAINS];
+
+inline SimChain& sim_chain_for(uint16_t module) {
+    return sim_chains[module < CHAIN0_MODULES ? 0 : NUM_CHAINS - 1];
+}
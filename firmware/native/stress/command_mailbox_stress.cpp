@@ -0,0 +1,314 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+// Host-side stress test for CommandMailbox: several posting threads against one taker, the way SplitflapTask
+// takes them. See README.md in this directory.
+
+#include <atomic>
+#include <deque>
+#include <thread>
+#include <vector>
+
+#include <Arduino.h>
+
+#include "command_mailbox.h"
+
+// Each producer posts these values in order, so that the taker can tell which post it got. They stay clear of
+// NO_FLAP/NO_ACTION.
+static const uint8_t LAST_VALUE = 253;
+// Producers post an action to their first module after every this many flap targets
+static const uint8_t ACTION_INTERVAL = 7;
+
+static const uint8_t PRODUCERS = 4;
+static_assert(NUM_MODULES >= PRODUCERS * 2, "Each producer needs a module with actions and one without");
+
+struct Options {
+    uint32_t runs = 1000;
+};
+
+// Producer p owns modules p, p + PRODUCERS, p + 2 * PRODUCERS, etc. Only the first of them gets actions.
+static uint8_t producerOf(uint8_t module) {
+    return module % PRODUCERS;
+}
+
+static bool getsActions(uint8_t module) {
+    return module < PRODUCERS;
+}
+
+// Stands in for a command in SplitflapTask's queue, stamped with CommandMailbox::nextSequence() after producer
+// `producer` posted flap target `value`
+struct QueuedCommand {
+    uint32_t sequence;
+    uint8_t producer;
+    uint8_t value;
+};
+
+struct Results {
+    uint32_t takes = 0;
+    uint32_t queued_commands = 0;
+    uint32_t torn = 0;
+    uint32_t out_of_order = 0;
+    uint32_t stale_flaps = 0;
+    uint32_t too_new = 0;
+    uint32_t lost = 0;
+};
+
+class Taker {
+    public:
+        Taker(CommandMailbox& mailbox, Results& results) : mailbox_(mailbox), results_(results) {
+            memset(last_flap_, -1, sizeof(last_flap_));
+            memset(last_action_, -1, sizeof(last_action_));
+            memset(last_led_, -1, sizeof(last_led_));
+            memset(min_flap_, 0, sizeof(min_flap_));
+        }
+
+        /** Takes everything posted before `before`, in the same order as SplitflapTask::applyMailbox() */
+        void take(uint32_t before) {
+            results_.takes++;
+
+            uint8_t action[NUM_MODULES];
+            if (mailbox_.takeActions(before, action)) {
+                for (uint8_t i = 0; i < NUM_MODULES; i++) {
+                    if (action[i] == CommandMailbox::NO_ACTION) {
+                        continue;
+                    }
+                    checkNewer(action[i], last_action_[i]);
+                    last_action_[i] = action[i];
+                    // The action was posted after flap target action[i], which it drops
+                    min_flap_[i] = action[i] + 1;
+                }
+            }
+
+            uint8_t flap_index[NUM_MODULES];
+            if (mailbox_.takeFlaps(before, flap_index)) {
+                checkFlaps(flap_index);
+            }
+
+            uint8_t led[NUM_MODULES];
+            if (mailbox_.takeLeds(before, led)) {
+                checkPosts(led, last_led_);
+            }
+
+            ModuleConfigs configs;
+            uint32_t sequence;
+            if (mailbox_.takeConfigs(before, configs, sequence)) {
+                checkConfigs(configs, sequence, before);
+            }
+        }
+
+        /** Takes what was posted before the command, the way SplitflapTask does before processing it */
+        void takeBefore(const QueuedCommand& command) {
+            results_.queued_commands++;
+            take(command.sequence);
+            for (uint8_t i = command.producer; i < NUM_MODULES; i += PRODUCERS) {
+                // Anything newer was posted after the command
+                if (last_flap_[i] > command.value) {
+                    results_.too_new++;
+                }
+            }
+        }
+
+        /** Checks that the last post of each kind got through once everything has been taken */
+        void checkFinal() {
+            for (uint8_t i = 0; i < NUM_MODULES; i++) {
+                if (last_flap_[i] != LAST_VALUE || last_led_[i] != LAST_VALUE) {
+                    results_.lost++;
+                }
+                if (getsActions(i) && last_action_[i] != lastAction()) {
+                    results_.lost++;
+                }
+            }
+            if (last_config_ != LAST_VALUE) {
+                results_.lost++;
+            }
+        }
+
+        static uint8_t lastAction() {
+            return (LAST_VALUE - 1) / ACTION_INTERVAL * ACTION_INTERVAL;
+        }
+
+    private:
+        CommandMailbox& mailbox_;
+        Results& results_;
+
+        int16_t last_flap_[NUM_MODULES];
+        int16_t last_action_[NUM_MODULES];
+        int16_t last_led_[NUM_MODULES];
+        // Oldest flap target that's allowed, once an action has dropped the older ones
+        int16_t min_flap_[NUM_MODULES];
+        int16_t last_config_ = -1;
+
+        void checkNewer(int16_t value, int16_t last) {
+            if (value <= last) {
+                results_.out_of_order++;
+            }
+        }
+
+        // Every post sets all of a producer's modules to the same value, so any of them taken together must match
+        void checkPosts(const uint8_t value[NUM_MODULES], int16_t last[NUM_MODULES]) {
+            int16_t posted[PRODUCERS];
+            memset(posted, -1, sizeof(posted));
+            for (uint8_t i = 0; i < NUM_MODULES; i++) {
+                if (value[i] == CommandMailbox::NO_FLAP) {
+                    continue;
+                }
+                int16_t& expected = posted[producerOf(i)];
+                if (expected >= 0 && value[i] != expected) {
+                    results_.torn++;
+                }
+                expected = value[i];
+                checkNewer(value[i], last[i]);
+                last[i] = value[i];
+            }
+        }
+
+        void checkFlaps(const uint8_t flap_index[NUM_MODULES]) {
+            for (uint8_t i = 0; i < NUM_MODULES; i++) {
+                if (flap_index[i] != CommandMailbox::NO_FLAP && flap_index[i] < min_flap_[i]) {
+                    results_.stale_flaps++;
+                }
+            }
+            checkPosts(flap_index, last_flap_);
+        }
+
+        void checkConfigs(const ModuleConfigs& configs, uint32_t sequence, uint32_t before) {
+            uint8_t value = configs.config[0].target_flap_index;
+            for (uint8_t i = 0; i < NUM_MODULES; i++) {
+                const ModuleConfig& config = configs.config[i];
+                if (config.target_flap_index != value || config.movement_nonce != value || config.reset_nonce != value) {
+                    results_.torn++;
+                }
+            }
+            if ((int32_t)(sequence - before) >= 0) {
+                results_.too_new++;
+            }
+            checkNewer(value, last_config_);
+            last_config_ = value;
+        }
+};
+
+/** One run of every producer posting LAST_VALUE + 1 times while the taker keeps up as best it can */
+static void run(Results& results) {
+    CommandMailbox mailbox;
+    std::mutex queue_mutex;
+    std::deque<QueuedCommand> queue;
+    std::atomic<uint8_t> producers_done = {0};
+
+    std::vector<std::thread> producers;
+    for (uint8_t p = 0; p < PRODUCERS; p++) {
+        producers.emplace_back([&, p]() {
+            uint8_t flap_index[NUM_MODULES];
+            uint8_t action[NUM_MODULES];
+            uint8_t led[NUM_MODULES];
+            for (uint16_t value = 0; value <= LAST_VALUE; value++) {
+                memset(flap_index, CommandMailbox::NO_FLAP, NUM_MODULES);
+                memset(led, CommandMailbox::NO_FLAP, NUM_MODULES);
+                for (uint8_t i = p; i < NUM_MODULES; i += PRODUCERS) {
+                    flap_index[i] = value;
+                    led[i] = value;
+                }
+                mailbox.postFlaps(flap_index);
+                mailbox.postLeds(led);
+
+                if (value % ACTION_INTERVAL == 0 && value < LAST_VALUE) {
+                    memset(action, CommandMailbox::NO_ACTION, NUM_MODULES);
+                    action[p] = value;
+                    mailbox.postActions(action);
+                }
+
+                // Stamping and queueing aren't atomic together in SplitflapTask::postRawCommand() either
+                QueuedCommand command = {mailbox.nextSequence(), p, (uint8_t)value};
+                std::lock_guard<std::mutex> lock(queue_mutex);
+                queue.push_back(command);
+            }
+            producers_done.fetch_add(1, std::memory_order_release);
+        });
+    }
+    producers.emplace_back([&]() {
+        ModuleConfigs configs = {};
+        for (uint16_t value = 0; value <= LAST_VALUE; value++) {
+            for (uint8_t i = 0; i < NUM_MODULES; i++) {
+                configs.config[i] = {(uint8_t)value, (uint8_t)value, (uint8_t)value};
+            }
+            mailbox.postConfigs(configs);
+        }
+        producers_done.fetch_add(1, std::memory_order_release);
+    });
+
+    Taker taker(mailbox, results);
+    while (true) {
+        bool done = producers_done.load(std::memory_order_acquire) == PRODUCERS + 1;
+        // Read before checking the queue, like SplitflapTask::processQueue()
+        uint32_t sequence = mailbox.sequence();
+        QueuedCommand command;
+        bool queued = false;
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            if (!queue.empty()) {
+                command = queue.front();
+                queue.pop_front();
+                queued = true;
+            }
+        }
+        if (queued) {
+            taker.takeBefore(command);
+        } else if (done) {
+            break;
+        } else {
+            taker.take(sequence);
+            std::this_thread::yield();
+        }
+    }
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+    taker.take(mailbox.sequence());
+    taker.checkFinal();
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            options.runs = strtoul(argv[++i], nullptr, 10);
+        } else {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    Results results;
+    for (uint32_t r = 0; r < options.runs; r++) {
+        run(results);
+    }
+
+    bool pass = results.torn == 0
+        && results.out_of_order == 0
+        && results.stale_flaps == 0
+        && results.too_new == 0
+        && results.lost == 0;
+
+    printf("runs: %u\n", options.runs);
+    printf("takes: %u\n", results.takes);
+    printf("queued_commands: %u\n", results.queued_commands);
+    printf("torn_posts: %u\n", results.torn);
+    printf("out_of_order: %u\n", results.out_of_order);
+    printf("stale_flaps: %u\n", results.stale_flaps);
+    printf("taken_too_early: %u\n", results.too_new);
+    printf("lost: %u\n", results.lost);
+    printf("result: %s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+}
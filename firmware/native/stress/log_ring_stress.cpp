@@ -0,0 +1,137 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+// Host-side stress test for LogRing: several writer threads against one reader. See README.md in this directory.
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <Arduino.h>
+
+#include "log_ring.h"
+
+struct Options {
+    uint8_t writers = 4;
+    uint32_t messages = 100000;
+};
+
+/**
+ * The message a writer sends as its `sequence`th, which the reader can check it got intact. Lengths cycle through
+ * everything from a few bytes to past MAX_MESSAGE_LENGTH, so records land on every alignment, wrap around the end
+ * of the ring and get truncated.
+ */
+static std::string message(uint8_t writer, uint32_t sequence) {
+    char prefix[24];
+    snprintf(prefix, sizeof(prefix), "%u %u ", writer, sequence);
+    std::string message = prefix;
+    size_t length = message.size() + (sequence * 37 + writer * 11) % (LogRing::MAX_MESSAGE_LENGTH + 45);
+    for (size_t i = message.size(); i < length; i++) {
+        message += (char)('a' + (writer * 7 + sequence + i) % 26);
+    }
+    return message;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--writers") == 0 && i + 1 < argc) {
+            options.writers = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--messages") == 0 && i + 1 < argc) {
+            options.messages = strtoul(argv[++i], nullptr, 10);
+        } else {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+    if (options.writers == 0) {
+        fprintf(stderr, "--writers must be at least 1\n");
+        return 2;
+    }
+
+    static LogRing ring;
+    std::atomic<uint32_t> writes_dropped = {0};
+    std::atomic<uint8_t> writers_done = {0};
+
+    std::vector<std::thread> writers;
+    for (uint8_t w = 0; w < options.writers; w++) {
+        writers.emplace_back([&, w]() {
+            for (uint32_t sequence = 0; sequence < options.messages; sequence++) {
+                std::string text = message(w, sequence);
+                // The reader is slower than all the writers together, so keep retrying until there's room
+                while (!ring.write(text.c_str())) {
+                    writes_dropped.fetch_add(1, std::memory_order_relaxed);
+                    std::this_thread::yield();
+                }
+            }
+            writers_done.fetch_add(1, std::memory_order_release);
+        });
+    }
+
+    std::vector<uint32_t> next_sequence(options.writers, 0);
+    uint32_t received = 0;
+    uint32_t corrupt = 0;
+    uint32_t out_of_order = 0;
+    char buffer[LogRing::MAX_MESSAGE_LENGTH + 1];
+    while (true) {
+        // Check for the writers finishing before reading, so that nothing they wrote is missed
+        bool done = writers_done.load(std::memory_order_acquire) == options.writers;
+        if (!ring.read(buffer, sizeof(buffer))) {
+            if (done) {
+                break;
+            }
+            std::this_thread::yield();
+            continue;
+        }
+        received++;
+
+        unsigned writer;
+        unsigned sequence;
+        if (sscanf(buffer, "%u %u ", &writer, &sequence) != 2 || writer >= options.writers) {
+            corrupt++;
+            continue;
+        }
+        if (sequence != next_sequence[writer]) {
+            out_of_order++;
+        }
+        next_sequence[writer] = sequence + 1;
+        if (message(writer, sequence).substr(0, LogRing::MAX_MESSAGE_LENGTH) != buffer) {
+            corrupt++;
+        }
+    }
+    for (std::thread& writer : writers) {
+        writer.join();
+    }
+
+    uint32_t expected = options.writers * options.messages;
+    uint32_t missing = expected - min(received, expected);
+    bool pass = received == expected
+        && corrupt == 0
+        && out_of_order == 0
+        && ring.dropped() == writes_dropped.load()
+        && ring.highWaterMark() <= LogRing::SIZE;
+
+    printf("writers: %u\n", options.writers);
+    printf("messages_received: %u\n", received);
+    printf("messages_missing: %u\n", missing);
+    printf("messages_corrupt: %u\n", corrupt);
+    printf("messages_out_of_order: %u\n", out_of_order);
+    printf("writes_dropped: %u\n", writes_dropped.load());
+    printf("ring_dropped: %u\n", ring.dropped());
+    printf("ring_high_water_mark: %u/%u\n", ring.highWaterMark(), LogRing::SIZE);
+    printf("result: %s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+}
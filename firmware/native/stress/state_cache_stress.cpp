@@ -0,0 +1,234 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+// Host-side stress test for SplitflapStateCache: one writer thread against several readers. See README.md in this
+// directory.
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <Arduino.h>
+
+#include "splitflap_state.h"
+
+static_assert(NUM_MODULES >= 3, "Every update must change at least one module");
+
+struct Options {
+    uint32_t seconds = 10;
+    uint8_t readers = 3;
+};
+
+// Update n changes module i if this is true. Every update changes some modules, so each one advances the
+// generation by exactly 2 and the readers can tell which update they got from the generation.
+static bool changes(uint32_t n, uint8_t i) {
+    return (n + i) % 3 == 0 || n % 7 == 0;
+}
+
+// The update that last changed module i, as of update n
+static uint32_t lastChange(uint32_t n, uint8_t i) {
+    while (n > 0 && !changes(n, i)) {
+        n--;
+    }
+    return n;
+}
+
+// Module state that encodes the update it was set in across every field, so that a torn copy can't match it.
+// Update 0 is the zero-initialized state.
+static SplitflapModuleState moduleState(uint32_t n) {
+    SplitflapModuleState module_state = {};
+    module_state.state = (State)(n % 5);
+    module_state.flap_index = n;
+    module_state.moving = n & 1;
+    module_state.waiting_for_power = (n >> 2) & 1;
+    module_state.home_state = (n >> 1) & 1;
+    module_state.count_unexpected_home = n >> 8;
+    module_state.count_missed_home = n >> 16;
+    module_state.queued_flaps = n >> 24;
+    module_state.queue_wait_millis = n * 3;
+    module_state.max_accel_step = n * 7;
+    return module_state;
+}
+
+// The update moduleState() was given, if the copy isn't torn
+static uint32_t updateOf(const SplitflapModuleState& module_state) {
+    return module_state.flap_index
+        | (module_state.count_unexpected_home << 8)
+        | (module_state.count_missed_home << 16)
+        | ((uint32_t)module_state.queued_flaps << 24);
+}
+
+static SplitflapMode mode(uint32_t n) {
+    return (n / 5) % 2 ? SplitflapMode::MODE_SENSOR_TEST : SplitflapMode::MODE_RUN;
+}
+
+static bool loopbacksOk(uint32_t n) {
+    return (n / 11) % 2;
+}
+
+/** Whether `state` is exactly what the writer had published after update n */
+static bool matches(SplitflapState& state, uint32_t n) {
+    for (uint8_t i = 0; i < NUM_MODULES; i++) {
+        if (state.modules[i] != moduleState(lastChange(n, i))) {
+            return false;
+        }
+    }
+    return state.mode == mode(n)
+#ifdef CHAINLINK
+        && state.loopbacks_ok == loopbacksOk(n)
+#endif
+        ;
+}
+
+struct ReaderResults {
+    uint32_t reads = 0;
+    uint32_t updates_seen = 0;
+    uint32_t odd_generations = 0;
+    uint32_t backwards = 0;
+    uint32_t torn = 0;
+    uint32_t wrong_changed = 0;
+};
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            options.seconds = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--readers") == 0 && i + 1 < argc) {
+            options.readers = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+    if (options.readers == 0) {
+        fprintf(stderr, "--readers must be at least 1\n");
+        return 2;
+    }
+
+    static SplitflapStateCache cache;
+    std::atomic<bool> done = {false};
+    std::atomic<uint32_t> updates = {0};
+
+    // Like SerialTask, each reader but the first keeps its own state up to date with getChanges(), and checks it
+    // against the update the returned generation says it's at. The first one copies everything with get(), the
+    // way the tester does, and works out which update it got from the newest module state.
+    std::vector<ReaderResults> results(options.readers);
+    std::vector<std::thread> readers;
+    for (uint8_t r = 0; r < options.readers; r++) {
+        readers.emplace_back([&, r]() {
+            ReaderResults& result = results[r];
+            SplitflapState state = {};
+            uint32_t generation = 0;
+            bool last = false;
+            while (!last) {
+                last = done.load(std::memory_order_acquire);
+                result.reads++;
+                if (r == 0) {
+                    SplitflapState copy = cache.get();
+                    // Every update changes some modules, so the newest module state is from the latest update
+                    uint32_t n = 0;
+                    for (uint8_t i = 0; i < NUM_MODULES; i++) {
+                        n = max(n, updateOf(copy.modules[i]));
+                    }
+                    if (!matches(copy, n)) {
+                        result.torn++;
+                    }
+                    continue;
+                }
+
+                ModuleBitmask changed;
+                uint32_t new_generation = cache.getChanges(generation, state, changed);
+                if (new_generation & 1) {
+                    result.odd_generations++;
+                    continue;
+                }
+                if (new_generation < generation) {
+                    result.backwards++;
+                    continue;
+                }
+                if (new_generation == generation) {
+                    if (changed.any()) {
+                        result.wrong_changed++;
+                    }
+                    continue;
+                }
+                result.updates_seen++;
+                uint32_t since = generation / 2;
+                uint32_t n = new_generation / 2;
+                if (!matches(state, n)) {
+                    result.torn++;
+                }
+                for (uint8_t i = 0; i < NUM_MODULES; i++) {
+                    if (changed.get(i) != (lastChange(n, i) > since)) {
+                        result.wrong_changed++;
+                    }
+                }
+                generation = new_generation;
+            }
+            if (r != 0 && generation / 2 != updates.load()) {
+                // The last read came after the last update, so it must have caught up
+                result.torn++;
+            }
+        });
+    }
+
+    // Nobody yields, so on a single core the threads only interleave when the scheduler preempts them, and it takes a
+    // few seconds of that for some preemptions to land in the middle of a copy
+    auto start = std::chrono::steady_clock::now();
+    uint32_t n = 0;
+    while (std::chrono::steady_clock::now() - start < std::chrono::seconds(options.seconds)) {
+        for (uint16_t k = 0; k < 1000; k++) {
+            n++;
+            for (uint8_t i = 0; i < NUM_MODULES; i++) {
+                cache.updateModule(i, moduleState(lastChange(n, i)));
+            }
+            cache.updateMode(mode(n));
+#ifdef CHAINLINK
+            cache.updateLoopbacksOk(loopbacksOk(n));
+#endif
+            cache.finishUpdate();
+        }
+    }
+    updates.store(n);
+    done.store(true, std::memory_order_release);
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+
+    ReaderResults total;
+    for (const ReaderResults& result : results) {
+        total.reads += result.reads;
+        total.updates_seen += result.updates_seen;
+        total.odd_generations += result.odd_generations;
+        total.backwards += result.backwards;
+        total.torn += result.torn;
+        total.wrong_changed += result.wrong_changed;
+    }
+    bool pass = total.odd_generations == 0 && total.backwards == 0 && total.torn == 0 && total.wrong_changed == 0;
+
+    printf("updates: %u\n", updates.load());
+    printf("readers: %u\n", options.readers);
+    printf("reads: %u\n", total.reads);
+    printf("updates_seen: %u\n", total.updates_seen);
+    printf("odd_generations: %u\n", total.odd_generations);
+    printf("generations_backwards: %u\n", total.backwards);
+    printf("torn_reads: %u\n", total.torn);
+    printf("wrong_changed_modules: %u\n", total.wrong_changed);
+    printf("result: %s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+}
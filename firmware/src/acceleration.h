@@ -14,14 +14,168 @@
    limitations under the License.
 */
 
-// NOTE: THIS FILE IS AUTOGENERATED! DO NOT MODIFY!
-// To update, run `firmware/src/generate_acceleration.py`
-
 #ifndef ACCELERATION
 #define ACCELERATION
 
+/*
+ * Acceleration ramp, generated at compile time from the parameters below (override them with build flags in
+ * platformio.ini).
+ *
+ * The ramp accelerates from SPLITFLAP_MAX_PERIOD_MICROS to SPLITFLAP_MIN_PERIOD_MICROS between steps over
+ * SPLITFLAP_RAMP_TIME_MICROS, following SPLITFLAP_ACCEL_PROFILE. Motion stops accelerating after
+ * SPLITFLAP_MAX_ACCEL_STEP steps of it, which sets the top speed. ACCEL_STEP_PERIODS[0] isn't part of the ramp;
+ * it's the period of the motion loop when nothing is moving.
+ *
+ * Each module can also be switched to a slower motion profile at runtime (see MotionEngine::SetMotionProfile()),
+ * so that a module with a stiff spool or a weak motor doesn't hold back the rest. Profile 0 is the ramp above, and
+ * the others stretch every period of it by a fixed percentage.
+ *
+ * The defaults produce the same table that generate_acceleration.py used to. With HALF_STEP, the default periods are
+ * halved and the top accel step doubled, so the spool follows the same speed curve in twice as many (half) steps.
+ */
+
+#include "config.h"
+
+// Velocity increases linearly with time
+#define SPLITFLAP_ACCEL_PROFILE_CONSTANT_ACCELERATION (0)
+// Velocity increases by the same amount every step, so acceleration grows as the motor speeds up
+#define SPLITFLAP_ACCEL_PROFILE_LINEAR_VELOCITY (1)
+// Velocity follows a smoothstep curve over time, so acceleration ramps up from and back down to zero
+#define SPLITFLAP_ACCEL_PROFILE_S_CURVE (2)
+
+#ifndef SPLITFLAP_ACCEL_PROFILE
+#define SPLITFLAP_ACCEL_PROFILE SPLITFLAP_ACCEL_PROFILE_CONSTANT_ACCELERATION
+#endif
+
+#ifndef SPLITFLAP_MAX_PERIOD_MICROS
+#define SPLITFLAP_MAX_PERIOD_MICROS (10000 / STEPS_PER_FULL_STEP)
+#endif
+
+#ifndef SPLITFLAP_MIN_PERIOD_MICROS
+#define SPLITFLAP_MIN_PERIOD_MICROS (1600 / STEPS_PER_FULL_STEP)
+#endif
+
+#ifndef SPLITFLAP_RAMP_TIME_MICROS
+#define SPLITFLAP_RAMP_TIME_MICROS (200000)
+#endif
+
+#ifndef SPLITFLAP_MAX_ACCEL_STEP
+#define SPLITFLAP_MAX_ACCEL_STEP (10 * STEPS_PER_FULL_STEP)
+#endif
+
 namespace Acceleration {
-    const PROGMEM uint16_t ACCEL_STEP_PERIODS[] = {1600, 10000, 7920, 6800, 6064, 5530, 5119, 4790, 4518, 4288, 4090, 3918, 3766, 3631, 3510, 3400, 3300, 3208, 3123, 3045, 2973, 2906, 2843, 2783, 2728, 2676, 2626, 2580, 2535, 2493, 2453, 2415, 2379, 2344, 2310, 2278, 2248, 2218, 2190, 2163, 2137, 2111, 2087, 2063, 2040, 2018, 1997, 1976, 1956, 1937, 1918, 1900, 1882, 1864, 1848, 1831, 1815, 1800, 1784, 1770, 1755, 1741, 1727, 1714, 1701, 1688, 1675, 1663, 1651, 1639, 1628, 1617, 1606};
-    const uint8_t MAX_ACCEL_STEP = 10;//was 72 //is 10 now //25 worked //50 works
+    const uint16_t IDLE_PERIOD_MICROS = 1600;
+    const uint8_t MAX_ACCEL_STEP = SPLITFLAP_MAX_ACCEL_STEP;
+    const uint8_t NUM_MOTION_PROFILES = 4;
+
+    // Everything here is C++11 constexpr (single expression functions), since that's what the ESP32 toolchain builds
+    namespace detail {
+        constexpr double MIN_VELOCITY = 1000000 / (double)SPLITFLAP_MAX_PERIOD_MICROS;
+        constexpr double MAX_VELOCITY = 1000000 / (double)SPLITFLAP_MIN_PERIOD_MICROS;
+
+        // Ramps are cut off here, since accel steps are uint8_t
+        const uint16_t MAX_RAMP_STEPS = 254;
+
+        constexpr uint16_t periodForVelocity(double velocity) {
+            return (uint16_t)(1000000 / (velocity > MAX_VELOCITY ? MAX_VELOCITY : velocity));
+        }
+
+        /** Velocity for ramp step `step` (1-based) of a LINEAR_VELOCITY ramp that's `num_steps` long */
+        constexpr double linearVelocity(uint16_t step, uint16_t num_steps) {
+            return MIN_VELOCITY + (MAX_VELOCITY - MIN_VELOCITY) * (step - 1) / num_steps;
+        }
+
+        constexpr uint32_t linearRampMicros(uint16_t num_steps, uint16_t step = 1, uint32_t t = 0) {
+            return step > num_steps ? t : linearRampMicros(num_steps, step + 1, t + periodForVelocity(linearVelocity(step, num_steps)));
+        }
+
+        /** Fewest steps that a LINEAR_VELOCITY ramp can take and still last SPLITFLAP_RAMP_TIME_MICROS */
+        constexpr uint16_t linearRampSteps(uint16_t num_steps = 1) {
+            return num_steps >= MAX_RAMP_STEPS || linearRampMicros(num_steps) >= SPLITFLAP_RAMP_TIME_MICROS
+                ? num_steps : linearRampSteps(num_steps + 1);
+        }
+
+        constexpr double sCurve(double x) {
+            return x >= 1 ? 1 : x * x * (3 - 2 * x);
+        }
+
+        /** Velocity for ramp step `step` (1-based), which starts `t` micros into the ramp */
+        constexpr double velocity(__attribute__((unused)) uint16_t step, __attribute__((unused)) uint32_t t) {
+#if SPLITFLAP_ACCEL_PROFILE == SPLITFLAP_ACCEL_PROFILE_CONSTANT_ACCELERATION
+            return MIN_VELOCITY + (MAX_VELOCITY - MIN_VELOCITY) * (double)t / SPLITFLAP_RAMP_TIME_MICROS;
+#elif SPLITFLAP_ACCEL_PROFILE == SPLITFLAP_ACCEL_PROFILE_LINEAR_VELOCITY
+            return linearVelocity(step, linearRampSteps());
+#elif SPLITFLAP_ACCEL_PROFILE == SPLITFLAP_ACCEL_PROFILE_S_CURVE
+            return MIN_VELOCITY + (MAX_VELOCITY - MIN_VELOCITY) * sCurve((double)t / SPLITFLAP_RAMP_TIME_MICROS);
+#else
+#error "Unknown SPLITFLAP_ACCEL_PROFILE"
+#endif
+        }
+
+        constexpr uint16_t stepPeriod(uint16_t step, uint32_t t) {
+            return periodForVelocity(velocity(step, t));
+        }
+
+        /** Micros from the start of the ramp until ramp step `step` begins */
+        constexpr uint32_t stepStart(uint16_t step, uint16_t from = 1, uint32_t t = 0) {
+            return from >= step ? t : stepStart(step, from + 1, t + stepPeriod(from, t));
+        }
+
+        /** Number of steps the ramp takes to last SPLITFLAP_RAMP_TIME_MICROS */
+        constexpr uint16_t rampSteps(uint16_t step = 1, uint32_t t = 0) {
+            return t >= SPLITFLAP_RAMP_TIME_MICROS ? step - 1
+                : step > MAX_RAMP_STEPS ? step : rampSteps(step + 1, t + stepPeriod(step, t));
+        }
+
+        constexpr uint16_t accelStepPeriod(uint8_t accel_step) {
+            return accel_step == 0 ? IDLE_PERIOD_MICROS : stepPeriod(accel_step, stepStart(accel_step));
+        }
+
+        // Speed of each motion profile, relative to the ramp
+        constexpr uint8_t PROFILE_SPEED_PERCENT[NUM_MOTION_PROFILES] = {100, 85, 70, 55};
+
+        constexpr uint16_t profilePeriod(uint8_t profile, uint8_t accel_step) {
+            return accel_step == 0 ? IDLE_PERIOD_MICROS : (uint32_t)accelStepPeriod(accel_step) * 100 / PROFILE_SPEED_PERCENT[profile];
+        }
+
+        template <uint8_t... Steps> struct StepSequence {};
+
+        template <uint8_t N, uint8_t... Steps>
+        struct MakeStepSequence : MakeStepSequence<N - 1, N - 1, Steps...> {};
+
+        template <uint8_t... Steps>
+        struct MakeStepSequence<0, Steps...> {
+            typedef StepSequence<Steps...> type;
+        };
+
+        template <typename Sequence> struct PeriodTable;
+
+        static_assert(NUM_MOTION_PROFILES == 4, "PeriodTable needs a row for each motion profile");
+
+        template <uint8_t... Steps>
+        struct PeriodTable<StepSequence<Steps...>> {
+            static constexpr uint16_t PERIODS[NUM_MOTION_PROFILES][sizeof...(Steps)] = {
+                {profilePeriod(0, Steps)...},
+                {profilePeriod(1, Steps)...},
+                {profilePeriod(2, Steps)...},
+                {profilePeriod(3, Steps)...},
+            };
+        };
+
+        template <uint8_t... Steps>
+        constexpr PROGMEM uint16_t PeriodTable<StepSequence<Steps...>>::PERIODS[NUM_MOTION_PROFILES][sizeof...(Steps)];
+    }
+
+    static_assert(SPLITFLAP_MIN_PERIOD_MICROS < SPLITFLAP_MAX_PERIOD_MICROS, "SPLITFLAP_MIN_PERIOD_MICROS must be shorter than SPLITFLAP_MAX_PERIOD_MICROS");
+    static_assert((uint32_t)SPLITFLAP_MAX_PERIOD_MICROS * 100 / detail::PROFILE_SPEED_PERCENT[NUM_MOTION_PROFILES - 1] <= UINT16_MAX, "SPLITFLAP_MAX_PERIOD_MICROS doesn't fit in a uint16_t for the slowest motion profile");
+    static_assert(MAX_ACCEL_STEP >= 1, "SPLITFLAP_MAX_ACCEL_STEP must be at least 1");
+    static_assert(detail::rampSteps() <= detail::MAX_RAMP_STEPS, "Ramp is too long; raise SPLITFLAP_MIN_PERIOD_MICROS or shorten SPLITFLAP_RAMP_TIME_MICROS");
+    static_assert(MAX_ACCEL_STEP <= detail::rampSteps(), "SPLITFLAP_MAX_ACCEL_STEP is past the end of the ramp; lower SPLITFLAP_MIN_PERIOD_MICROS or lengthen SPLITFLAP_RAMP_TIME_MICROS");
+
+    // Only the part of the ramp that's actually used ends up in flash
+    static constexpr const uint16_t (&MOTION_PROFILE_PERIODS)[NUM_MOTION_PROFILES][MAX_ACCEL_STEP + 1] =
+        detail::PeriodTable<detail::MakeStepSequence<MAX_ACCEL_STEP + 1>::type>::PERIODS;
+    static constexpr const uint16_t (&ACCEL_STEP_PERIODS)[MAX_ACCEL_STEP + 1] = MOTION_PROFILE_PERIODS[0];
+    static_assert(sizeof(ACCEL_STEP_PERIODS) == (MAX_ACCEL_STEP + 1) * sizeof(uint16_t), "ACCEL_STEP_PERIODS must cover every accel step");
 }
 #endif
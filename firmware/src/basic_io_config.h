@@ -21,6 +21,29 @@
 
 #include "splitflap_module.h"
 
+// Home sensors are on arbitrary pins rather than in a shift register buffer, so look for rising edges one module
+// at a time
+bool last_home_sensors[NUM_MODULES];
+
+inline void detect_home_edges() {
+  for (uint8_t i = 0; i < NUM_MODULES; i++) {
+    bool home = motion_engine.GetHomeState(i);
+    if (home && !last_home_sensors[i]) {
+      motion_engine.home_edge[i] = true;
+    }
+    last_home_sensors[i] = home;
+  }
+}
+
+// Motor coils are on IO ports shared between two modules, so write each module's pattern into its half of the port
+inline void write_motor_ports() {
+  for (uint8_t i = 0; i < NUM_MODULES; i++) {
+    uint8_t shift = motion_engine.motor_bitshift[i];
+    uint8_t* port = motion_engine.motor_out[i];
+    *port = (*port & ~(0x0F << shift)) | (motion_engine.motor_coils[i] << shift);
+  }
+}
+
 #if defined(__AVR_ATmega168__) || defined(__AVR_ATmega328P__)
   #if NUM_MODULES > 3
   #error "Basic IO mode only supports up to 3 modules on Atmega168/328-based boards. Set NUM_MODULES to 3 or fewer."
@@ -33,9 +56,9 @@
   // Sensor B: PC4 = pin A4
   // Sensor C: PC5 = pin A5
 
-  SplitflapModule moduleA((uint8_t&)PORTB, 0, (uint8_t&)PINB, B00010000);
-  SplitflapModule moduleB((uint8_t&)PORTD, 4, (uint8_t&)PINC, B00010000);
-  SplitflapModule moduleC((uint8_t&)PORTC, 0, (uint8_t&)PINC, B00100000);
+  SplitflapModule moduleA(0, (uint8_t&)PORTB, 0, (uint8_t&)PINB, B00010000);
+  SplitflapModule moduleB(1, (uint8_t&)PORTD, 4, (uint8_t&)PINC, B00010000);
+  SplitflapModule moduleC(2, (uint8_t&)PORTC, 0, (uint8_t&)PINC, B00100000);
 
   SplitflapModule* modules[] = {
     &moduleA,
@@ -56,22 +79,24 @@
   }
 
   inline void motor_sensor_io() {
-    // No-op (modules write directly to IO pins)
+    // Nothing to shift; write the coil patterns straight to the IO pins and check the home sensors
+    write_motor_ports();
+    detect_home_edges();
   }
 #elif defined(__AVR_ATmega2560__)
 
-  SplitflapModule moduleA((uint8_t&)PORTB, 4, (uint8_t&)PINE, 1 << 5); //10-13    3
-  SplitflapModule moduleB((uint8_t&)PORTA, 0, (uint8_t&)PINE, 1 << 4); //25-22    2
-  SplitflapModule moduleC((uint8_t&)PORTA, 4, (uint8_t&)PINJ, 1 << 1); //29-26    14
-  SplitflapModule moduleD((uint8_t&)PORTC, 4, (uint8_t&)PINJ, 1 << 0); //33-30    15
-  SplitflapModule moduleE((uint8_t&)PORTC, 0, (uint8_t&)PINH, 1 << 1); //37-34    16
-  SplitflapModule moduleF((uint8_t&)PORTL, 4, (uint8_t&)PINH, 1 << 0); //45-42    17
-  SplitflapModule moduleG((uint8_t&)PORTL, 0, (uint8_t&)PIND, 1 << 3); //49-46    18
-  SplitflapModule moduleH((uint8_t&)PORTB, 0, (uint8_t&)PIND, 1 << 2); //53-50    19
-  SplitflapModule moduleI((uint8_t&)PORTK, 4, (uint8_t&)PIND, 1 << 7); //A12-A15  38
-  SplitflapModule moduleJ((uint8_t&)PORTK, 0, (uint8_t&)PING, 1 << 2); //A8-A11   39
-  SplitflapModule moduleK((uint8_t&)PORTF, 4, (uint8_t&)PING, 1 << 1); //A4-A7    40
-  SplitflapModule moduleL((uint8_t&)PORTF, 0, (uint8_t&)PING, 1 << 0); //A0-A3    41
+  SplitflapModule moduleA(0, (uint8_t&)PORTB, 4, (uint8_t&)PINE, 1 << 5); //10-13    3
+  SplitflapModule moduleB(1, (uint8_t&)PORTA, 0, (uint8_t&)PINE, 1 << 4); //25-22    2
+  SplitflapModule moduleC(2, (uint8_t&)PORTA, 4, (uint8_t&)PINJ, 1 << 1); //29-26    14
+  SplitflapModule moduleD(3, (uint8_t&)PORTC, 4, (uint8_t&)PINJ, 1 << 0); //33-30    15
+  SplitflapModule moduleE(4, (uint8_t&)PORTC, 0, (uint8_t&)PINH, 1 << 1); //37-34    16
+  SplitflapModule moduleF(5, (uint8_t&)PORTL, 4, (uint8_t&)PINH, 1 << 0); //45-42    17
+  SplitflapModule moduleG(6, (uint8_t&)PORTL, 0, (uint8_t&)PIND, 1 << 3); //49-46    18
+  SplitflapModule moduleH(7, (uint8_t&)PORTB, 0, (uint8_t&)PIND, 1 << 2); //53-50    19
+  SplitflapModule moduleI(8, (uint8_t&)PORTK, 4, (uint8_t&)PIND, 1 << 7); //A12-A15  38
+  SplitflapModule moduleJ(9, (uint8_t&)PORTK, 0, (uint8_t&)PING, 1 << 2); //A8-A11   39
+  SplitflapModule moduleK(10, (uint8_t&)PORTF, 4, (uint8_t&)PING, 1 << 1); //A4-A7    40
+  SplitflapModule moduleL(11, (uint8_t&)PORTF, 0, (uint8_t&)PING, 1 << 0); //A0-A3    41
 
   SplitflapModule* modules[] = {
     &moduleA,
@@ -113,7 +138,9 @@
   }
 
   inline void motor_sensor_io() {
-    // No-op (modules write directly to IO pins)
+    // Nothing to shift; write the coil patterns straight to the IO pins and check the home sensors
+    write_motor_ports();
+    detect_home_edges();
   }
 #else
   #error "Basic IO configuration is not supported for this board type. Use SPI IO or modify basic_io_config.h to add support for this board."
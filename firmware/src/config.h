@@ -13,10 +13,112 @@
 #define NUM_MODULES (12)
 #endif
 
-#define VERBOSE_LOGGING true
+// Most detailed motion events to log (see motion_log.h): MOTION_LOG_LEVEL_NONE, _ERROR, _WARN, _INFO or _DEBUG.
+// Disabled levels compile to nothing. DEBUG adds an event for every pass of home, which is a lot at high module
+// counts.
+#ifndef MOTION_LOG_LEVEL
+#define MOTION_LOG_LEVEL MOTION_LOG_LEVEL_INFO
+#endif
+// How many motion events can be waiting to be printed before more are dropped. Must be a power of 2; costs 4 bytes
+// of RAM per entry.
+#ifndef MOTION_LOG_SIZE
+#define MOTION_LOG_SIZE (128)
+#endif
+
 // Whether to force a full rotation when the same letter is specified again
 #define FORCE_FULL_ROTATION true
 
+// Whether to log the achieved vs requested step period for each acceleration step whenever all modules come to a
+// stop. Useful for checking that the motion loop keeps up with the acceleration table at large module counts.
+#ifndef LOG_STEP_TIMING
+#define LOG_STEP_TIMING false
+#endif
+
+// Whether to log how much CPU time the serial protocol spends on each status update (ESP32 only), for comparing the
+// legacy JSON protocol with the proto protocol at large module counts.
+#ifndef LOG_SERIAL_TIMING
+#define LOG_SERIAL_TIMING false
+#endif
+
+// Whether to run the shift register SPI transfers in the background (ESP32 only). Each motion loop pass queues
+// its frame with DMA and returns right away, so the transfer overlaps with the rest of the pass and the wait for
+// the next step, at the cost of home sensor data that can be up to one pass older.
+#ifndef SPI_IO_PIPELINED
+#define SPI_IO_PIPELINED false
+#endif
+
+// Number of separate shift register chains (ESP32 SPI IO only), each on its own SPI host so that their transfers
+// run concurrently. Modules keep a single continuous index space: the first CHAIN0_MODULES modules are on the first
+// chain (SPLITFLAP_SPI_HOST) and the rest are on the second (CHAIN1_SPI_HOST). CHAIN0_MODULES defaults to an even
+// split. See spi_io_config.h for the second chain's pins.
+#ifndef NUM_CHAINS
+#define NUM_CHAINS (1)
+#endif
+
+// Current budget for each power channel, in milliamps, or 0 for no limit. When set, the motion loop only lets as
+// many modules on a channel move (or home) at once as fit in the budget at MODULE_MOVING_CURRENT_MA each; the rest
+// wait their turn. See power_scheduler.h.
+#ifndef POWER_CHANNEL_BUDGET_MA
+#define POWER_CHANNEL_BUDGET_MA (0)
+#endif
+
+// Modules are powered in groups of this many consecutive modules (e.g. Chainlink Base power channels)
+#ifndef MODULES_PER_POWER_CHANNEL
+#define MODULES_PER_POWER_CHANNEL (36)
+#endif
+
+// Worst case current drawn by one module while its motor is energized
+#ifndef MODULE_MOVING_CURRENT_MA
+#define MODULE_MOVING_CURRENT_MA (260)
+#endif
+
+// Whether to save where every module came to rest, so that after a power cycle they can start from there instead
+// of homing first (ESP32 only). Positions are saved once the display has been still for
+// REST_POSITION_SAVE_DELAY_MILLIS, and marked stale again when the next move starts. The writes happen in the
+// background (see ConfigurationSaveTask), but the first move after each rest waits for the second one, and every
+// rest-then-move cycle costs two flash writes, so this is off by default.
+#ifndef FAST_BOOT
+#define FAST_BOOT false
+#endif
+#ifndef REST_POSITION_SAVE_DELAY_MILLIS
+#define REST_POSITION_SAVE_DELAY_MILLIS (10000)
+#endif
+
+// How many flap targets can be queued up for each module to move through after its current one (see
+// MotionEngine::QueueFlapIndex()). Costs 3 bytes of RAM per module per entry.
+#ifndef MODULE_QUEUE_DEPTH
+#define MODULE_QUEUE_DEPTH (8)
+#endif
+
+// Whether each module learns its own top speed from its home sensor errors. Every missed or unexpected home, and
+// every home that comes more than ADAPTIVE_SPEED_DRIFT_TOLERANCE_STEPS away from where it should, lowers the
+// module's top accel step (see acceleration.h) by one, down to half of SPLITFLAP_MAX_ACCEL_STEP. Every
+// ADAPTIVE_SPEED_CLEAN_REVOLUTIONS revolutions without one raise it by one again, up to SPLITFLAP_MAX_ACCEL_STEP.
+// If that raise brings errors back, the module waits twice as long before trying it again, so each module settles
+// on the fastest speed it runs reliably at. The learned speeds are saved (ESP32 only) once the display has been
+// still for a while.
+// Off by default, since it only cuts down on repeat errors rather than preventing them: errors are only seen when a
+// module passes home, so one that stalls during a move that doesn't pass home still ends up on the wrong flap (see
+// --weak-modules in firmware/native/README.md).
+#ifndef ADAPTIVE_SPEED
+#define ADAPTIVE_SPEED false
+#endif
+#ifndef ADAPTIVE_SPEED_CLEAN_REVOLUTIONS
+#define ADAPTIVE_SPEED_CLEAN_REVOLUTIONS (20)
+#endif
+#ifndef ADAPTIVE_SPEED_DRIFT_TOLERANCE_STEPS
+#define ADAPTIVE_SPEED_DRIFT_TOLERANCE_STEPS (2 * STEPS_PER_FULL_STEP)
+#endif
+
+// Whether to drive the motors in half steps (alternating one and two energized coils, 8 phases per cycle) instead of
+// full steps (always two coils). Half steps double the position resolution to 4096 steps per revolution and
+// smooth out the motion at low speed, at the cost of slightly less torque on the single-coil steps. The default
+// acceleration ramp in acceleration.h is scaled to match, so flips take the same time either way. Offsets saved in
+// either mode are converted when the other one loads them.
+#ifndef HALF_STEP
+#define HALF_STEP false
+#endif
+
 // Whether to use/expect a home sensor. Enable for auto-calibration via home
 // sensor feedback. Disable for basic open-loop control (useful when first
 // testing the split-flap, since home calibration can be tricky to fine tune)
@@ -156,3 +258,32 @@ const uint8_t flaps[NUM_FLAPS] = {
 
 #define NUM_LOOPBACKS (NUM_MODULES / 3)
 #endif
+
+#ifdef CHAINLINK
+#define CHAIN_MODULE_MULTIPLE (6)
+#else
+// Keeps each chain's motor bytes a multiple of 4 (word aligned for DMA) and its sensor bytes whole
+#define CHAIN_MODULE_MULTIPLE (8)
+#endif
+#if NUM_CHAINS == 1
+#undef CHAIN0_MODULES
+#define CHAIN0_MODULES (NUM_MODULES)
+#elif NUM_CHAINS == 2
+#ifndef CHAIN0_MODULES
+#define CHAIN0_MODULES ((NUM_MODULES / 2 + CHAIN_MODULE_MULTIPLE - 1) / CHAIN_MODULE_MULTIPLE * CHAIN_MODULE_MULTIPLE)
+#endif
+#if CHAIN0_MODULES % CHAIN_MODULE_MULTIPLE != 0 || CHAIN0_MODULES < 1 || CHAIN0_MODULES >= NUM_MODULES
+#error CHAIN0_MODULES must be a multiple of CHAIN_MODULE_MULTIPLE (6 for Chainlink, 8 otherwise) and leave at least one module for the second chain
+#endif
+#else
+#error NUM_CHAINS must be 1 or 2
+#endif
+#define CHAIN1_MODULES (NUM_MODULES - CHAIN0_MODULES)
+
+#if HALF_STEP
+#define STEPS_PER_FULL_STEP (2)
+#else
+#define STEPS_PER_FULL_STEP (1)
+#endif
+// Must be an integer. This code does not support a fractional steps per revolution for motors with non-integral gear ratios
+#define STEPS_PER_REVOLUTION (2048 * STEPS_PER_FULL_STEP)
@@ -0,0 +1,795 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef MOTION_ENGINE_H
+#define MOTION_ENGINE_H
+
+#include <Arduino.h>
+
+#include "acceleration.h"
+#include "splitflap_module_data.h"
+#include "config.h"
+#include "motion_log.h"
+#include "step_scheduler.h"
+
+// Assertions are useful for debugging, but likely add too much time/space overhead to be used when driving many
+// SplitflapModules at once. Logging is configured with MOTION_LOG_LEVEL (see config.h).
+#define ASSERTIONS_ENABLED true
+
+#define FAKE_HOME_SENSOR false
+
+// This is "rough" because it's integer division; it shouldn't be used for movement calculations or the error would
+// accumulate.
+#define _ROUGH_STEPS_PER_FLAP (STEPS_PER_REVOLUTION / NUM_FLAPS)
+
+#if HOME_CALIBRATION_ENABLED
+// The number of steps in either direction that's acceptable error for the home sensor
+#define HOME_ERROR_MARGIN_STEPS (_ROUGH_STEPS_PER_FLAP / 4)
+
+// After finding the home position, how long to wait before considering another home blip to be an unexpected error
+#define UNEXPECTED_HOME_START_BUFFER_STEPS (_ROUGH_STEPS_PER_FLAP * 5)
+
+// When recalibrating the home position, the number of steps to travel searching for home before giving up
+#define MAX_STEPS_LOOKING_FOR_HOME ((NUM_FLAPS + 2) * _ROUGH_STEPS_PER_FLAP)
+
+#define UNEXPECTED_HOME_START_STEP UNEXPECTED_HOME_START_BUFFER_STEPS  // Start of range where a home sensor blip is unexpected
+#define UNEXPECTED_HOME_END_STEP (STEPS_PER_REVOLUTION - HOME_ERROR_MARGIN_STEPS)  // End of range where a home sensor blip is unexpected
+
+// Expected home position step plus some margin of error. If we get to this step without having seen a home
+// sensor blip, something is wrong and we need to recalibrate.
+#define MISSED_HOME_STEP HOME_ERROR_MARGIN_STEPS
+#endif
+
+#if ADAPTIVE_SPEED
+// Lowest top accel step a module can learn; errors that carry on below this are more likely a sensor or mechanical
+// problem than too much speed
+#define ADAPTIVE_SPEED_MIN_ACCEL_STEP (Acceleration::MAX_ACCEL_STEP > 1 ? Acceleration::MAX_ACCEL_STEP / 2 : 1)
+#if HOME_CALIBRATION_ENABLED
+static_assert(ADAPTIVE_SPEED_DRIFT_TOLERANCE_STEPS < HOME_ERROR_MARGIN_STEPS, "ADAPTIVE_SPEED_DRIFT_TOLERANCE_STEPS must be less than HOME_ERROR_MARGIN_STEPS, or drift is never seen");
+#endif
+#endif
+
+#define MOT_PHASE_A B00001000
+#define MOT_PHASE_B B00000100
+#define MOT_PHASE_C B00000010
+#define MOT_PHASE_D B00000001
+
+#if HALF_STEP
+const uint8_t step_pattern[] = {
+#if REVERSE_MOTOR_DIRECTION
+  MOT_PHASE_D | MOT_PHASE_A,
+  MOT_PHASE_D,
+  MOT_PHASE_C | MOT_PHASE_D,
+  MOT_PHASE_C,
+  MOT_PHASE_B | MOT_PHASE_C,
+  MOT_PHASE_B,
+  MOT_PHASE_A | MOT_PHASE_B,
+  MOT_PHASE_A,
+#else
+  MOT_PHASE_A | MOT_PHASE_B,
+  MOT_PHASE_B,
+  MOT_PHASE_B | MOT_PHASE_C,
+  MOT_PHASE_C,
+  MOT_PHASE_C | MOT_PHASE_D,
+  MOT_PHASE_D,
+  MOT_PHASE_D | MOT_PHASE_A,
+  MOT_PHASE_A,
+#endif
+};
+#else
+const uint8_t step_pattern[] = {
+#if REVERSE_MOTOR_DIRECTION
+  MOT_PHASE_D | MOT_PHASE_A,
+  MOT_PHASE_C | MOT_PHASE_D,
+  MOT_PHASE_B | MOT_PHASE_C,
+  MOT_PHASE_A | MOT_PHASE_B,
+#else
+  MOT_PHASE_A | MOT_PHASE_B,
+  MOT_PHASE_B | MOT_PHASE_C,
+  MOT_PHASE_C | MOT_PHASE_D,
+  MOT_PHASE_D | MOT_PHASE_A,
+#endif
+};
+#endif
+const uint8_t NUM_STEP_PHASES = sizeof(step_pattern);
+
+static_assert(MODULE_QUEUE_DEPTH >= 1 && MODULE_QUEUE_DEPTH <= 255, "MODULE_QUEUE_DEPTH must fit in a uint8_t");
+
+/**
+ * Motion state for every module, stored as parallel arrays indexed by module so that the per-pass update can
+ * sweep through contiguous memory and cheaply skip modules that aren't due for a step yet. SplitflapModule is a
+ * thin per-module facade over this.
+ */
+class MotionEngine {
+ public:
+  // Configuration. The IO layer uses motor_out/motor_bitshift to place each module's coil pattern in its outputs.
+  uint8_t *motor_out[NUM_MODULES];
+  uint8_t motor_bitshift[NUM_MODULES];
+  uint8_t *sensor_in[NUM_MODULES];
+  uint8_t sensor_bitmask[NUM_MODULES];
+
+  // Coil pattern (low nibble) each module is currently driving. Written here, packed into the outputs by the IO
+  // layer (see motor_sensor_io()).
+  uint8_t motor_coils[NUM_MODULES];
+
+  // Hot state, touched by every pass:
+  uint32_t next_update_micros[NUM_MODULES];
+  State state[NUM_MODULES];
+  uint8_t current_accel_step[NUM_MODULES];
+
+  // Motion state, only touched when a module is due:
+  uint16_t current_step[NUM_MODULES]; // Numbers are modulo STEPS_PER_REVOLUTION
+  uint16_t delta_steps[NUM_MODULES];
+  uint16_t current_period[NUM_MODULES];
+  uint8_t current_phase[NUM_MODULES];
+  uint32_t last_step_micros[NUM_MODULES];
+  uint16_t last_late_micros[NUM_MODULES];
+  // Row of Acceleration::MOTION_PROFILE_PERIODS this module accelerates along
+  uint8_t motion_profile[NUM_MODULES];
+  // Set by the IO layer when it sees a rising edge on the module's home sensor; cleared when the module checks it
+  bool home_edge[NUM_MODULES];
+  // Set while the power scheduler (see power_scheduler.h) hasn't let the module move yet; it stays at rest until
+  // cleared
+  bool power_hold[NUM_MODULES];
+#if HOME_CALIBRATION_ENABLED
+  HomeState home_state[NUM_MODULES];
+#endif
+
+  // Tracks the most recent target flap index. Not used during motion, but needed to recalculate target step if we
+  // re-calibrate the home position
+  uint8_t target_flap_index[NUM_MODULES];
+  uint16_t offset_steps[NUM_MODULES];
+
+  // Flap targets to move through once the current one is reached (see QueueFlapIndex()), as a ring buffer per
+  // module. Only touched when a module is due and has arrived.
+  uint8_t queue_flap_index[NUM_MODULES][MODULE_QUEUE_DEPTH];
+  uint16_t queue_dwell_millis[NUM_MODULES][MODULE_QUEUE_DEPTH];
+  uint8_t queue_head[NUM_MODULES];
+  uint8_t queue_length[NUM_MODULES];
+  // How long to stay on the current target after arriving before moving on to the next queued one
+  uint16_t dwell_millis[NUM_MODULES];
+
+  uint8_t count_unexpected_home[NUM_MODULES];
+  uint8_t count_missed_home[NUM_MODULES];
+
+  // Top accel step each module runs at, at most Acceleration::MAX_ACCEL_STEP. Learned from home sensor errors with
+  // ADAPTIVE_SPEED.
+  uint8_t max_accel_step[NUM_MODULES];
+#if ADAPTIVE_SPEED
+  // Home passes without an error since max_accel_step last changed, and how many it takes to raise it again
+  uint16_t clean_revolutions[NUM_MODULES];
+  uint16_t raise_after_revolutions[NUM_MODULES];
+  // Set from raising max_accel_step until the new speed has gone raise_after_revolutions without an error
+  bool speed_on_probation[NUM_MODULES];
+#endif
+  // Set whenever any module's max_accel_step changes by itself; cleared by whatever saves them
+  bool max_accel_step_changed;
+
+  void Attach(uint8_t i, uint8_t &motor_out, const uint8_t motor_bitshift, uint8_t &sensor_in, const uint8_t sensor_bitmask);
+
+  inline void Update(StepScheduler& scheduler);
+  inline void UpdateModule(uint8_t i, StepScheduler& scheduler);
+
+  void GoToFlapIndex(uint8_t i, uint8_t index);
+  void GoToTargetFlapIndex(uint8_t i);
+  uint8_t GetCurrentFlapIndex(uint8_t i);
+  void FindAndRecalibrateHome(uint8_t i);
+  void ResetErrorCounters(uint8_t i);
+  void ResetState(uint8_t i);
+  void Init(uint8_t i);
+  bool GetHomeState(uint8_t i);
+  void Disable(uint8_t i);
+
+  void IncreaseOffset(uint8_t i, uint8_t flap_tenths);
+  void SetOffset(uint8_t i);
+  void RestoreOffset(uint8_t i, uint16_t offset);
+  bool RestorePosition(uint8_t i, uint16_t offset, uint16_t step, uint8_t phase, uint8_t flap_index);
+  void SetMotionProfile(uint8_t i, uint8_t profile);
+  void SetMaxAccelStep(uint8_t i, uint8_t accel_step);
+  bool QueueFlapIndex(uint8_t i, uint8_t flap_index, uint16_t dwell_millis);
+  void ClearQueue(uint8_t i);
+
+  bool IsMoving(uint8_t i);
+  bool IsBusy(uint8_t i);
+  uint32_t TravelMicros(uint8_t i);
+  void SynchronizeArrival(uint32_t now);
+
+ private:
+  void Panic(uint8_t i, MotionEvent reason);
+  bool CheckSensor(uint8_t i);
+  void SetMotor(uint8_t i, uint8_t out);
+  void Step(uint8_t i, uint32_t now, StepScheduler& scheduler);
+  void AdvanceQueue(uint8_t i);
+#if ADAPTIVE_SPEED
+  void LowerMaxAccelStep(uint8_t i);
+  void RecordCleanRevolution(uint8_t i);
+#endif
+
+  uint8_t GetFlapFloor(uint8_t i, uint16_t step);
+  uint16_t GetTargetStepForFlapIndex(uint8_t i, uint8_t target_flap_index);
+};
+
+MotionEngine motion_engine;
+MotionLog motion_log;
+
+void MotionEngine::Attach(uint8_t i, uint8_t &motor_out, const uint8_t motor_bitshift, uint8_t &sensor_in, const uint8_t sensor_bitmask) {
+  this->motor_out[i] = &motor_out;
+  this->motor_bitshift[i] = motor_bitshift;
+  this->sensor_in[i] = &sensor_in;
+  this->sensor_bitmask[i] = sensor_bitmask;
+
+  next_update_micros[i] = 0;
+#if HOME_CALIBRATION_ENABLED
+  state[i] = SENSOR_ERROR; // Start in SENSOR_ERROR state until initialized
+  home_state[i] = IGNORE;
+#else
+  state[i] = NORMAL;
+#endif
+  current_accel_step[i] = 0;
+  current_step[i] = 0;
+  delta_steps[i] = 0;
+  current_period[i] = Acceleration::ACCEL_STEP_PERIODS[0];
+  current_phase[i] = 0;
+  motor_coils[i] = 0;
+  last_step_micros[i] = 0;
+  last_late_micros[i] = 0;
+  motion_profile[i] = 0;
+  home_edge[i] = false;
+  power_hold[i] = false;
+  target_flap_index[i] = 0;
+  offset_steps[i] = 0;
+  queue_head[i] = 0;
+  queue_length[i] = 0;
+  dwell_millis[i] = 0;
+  count_unexpected_home[i] = 0;
+  count_missed_home[i] = 0;
+  max_accel_step[i] = Acceleration::MAX_ACCEL_STEP;
+#if ADAPTIVE_SPEED
+  clean_revolutions[i] = 0;
+  raise_after_revolutions[i] = ADAPTIVE_SPEED_CLEAN_REVOLUTIONS;
+  speed_on_probation[i] = false;
+#endif
+}
+
+void MotionEngine::Disable(uint8_t i) {
+  SetMotor(i, 0);
+  state[i] = STATE_DISABLED;
+}
+
+void MotionEngine::Panic(uint8_t i, MotionEvent reason) {
+  SetMotor(i, 0);
+  state[i] = PANIC;
+  MOTION_LOG_ERROR(reason, i, current_step[i]);
+}
+
+__attribute__((always_inline))
+inline bool MotionEngine::CheckSensor(uint8_t i) {
+    // Rising edges are found for all modules at once by the IO layer (see detect_home_edges()), so this only
+    // needs to consume the result. Like sampling the sensor level at each step, only count the edge if the
+    // sensor is still active now, so a blip that came and went between steps is ignored.
+    bool shift = home_edge[i] && GetHomeState(i);
+    home_edge[i] = false;
+
+    return shift;
+}
+
+__attribute__((always_inline))
+inline void MotionEngine::SetMotor(uint8_t i, uint8_t out) {
+  motor_coils[i] = out & 0x0F;
+}
+
+__attribute__((always_inline))
+inline uint8_t MotionEngine::GetFlapFloor(uint8_t i, uint16_t step) {
+    uint16_t step_without_offset = step >= offset_steps[i] ? step - offset_steps[i] : STEPS_PER_REVOLUTION + step - offset_steps[i];
+    return (uint32_t)step_without_offset * NUM_FLAPS / STEPS_PER_REVOLUTION;
+}
+
+__attribute__((always_inline))
+inline uint16_t MotionEngine::GetTargetStepForFlapIndex(uint8_t i, uint8_t flap) {
+    uint32_t intermediate = (uint32_t)flap * STEPS_PER_REVOLUTION;
+
+    // Round UP when dividing so that the inverse calculation on the result (GetFlapFloor) returns the expected
+    // result.
+    uint16_t result = intermediate / NUM_FLAPS;
+    if (intermediate % NUM_FLAPS != 0) {
+        result++;
+    }
+    result += offset_steps[i];
+    if (result >= STEPS_PER_REVOLUTION) {
+        result -= STEPS_PER_REVOLUTION;
+    }
+    return result;
+}
+
+__attribute__((always_inline))
+inline void MotionEngine::GoToTargetFlapIndex(uint8_t i) {
+    if (state[i] != NORMAL) {
+        return;
+    }
+    uint16_t target_step = GetTargetStepForFlapIndex(i, target_flap_index[i]);
+
+    uint16_t minimum_stopping_step = current_step[i] + current_accel_step[i]; // Can't come to a stop until we've used up any remaining deceleration steps
+
+    if (target_step <= minimum_stopping_step) {
+        // Must go around
+        delta_steps[i] = STEPS_PER_REVOLUTION - current_step[i] + target_step;
+        // NB: delta_steps can be > 1 full revolution in the event we are not yet at current_step, but couldn't stop in time
+    } else {
+        delta_steps[i] = target_step - current_step[i];
+    }
+}
+
+__attribute__((always_inline))
+inline void MotionEngine::GoToFlapIndex(uint8_t i, uint8_t index) {
+    if (state[i] != NORMAL
+#if HOME_CALIBRATION_ENABLED
+     && state[i] != LOOK_FOR_HOME
+#endif
+    ) {
+        return;
+    }
+    // A new target replaces anything that was queued up
+    ClearQueue(i);
+    if (current_accel_step[i] == 0) {
+        // Also drop any start delay left over from an earlier SynchronizeArrival() that hasn't run out yet
+        next_update_micros[i] = micros();
+    }
+    target_flap_index[i] = index;
+    GoToTargetFlapIndex(i);
+}
+
+__attribute__((always_inline))
+inline uint8_t MotionEngine::GetCurrentFlapIndex(uint8_t i) {
+   return GetFlapFloor(i, current_step[i]);
+}
+
+__attribute__((always_inline))
+inline void MotionEngine::FindAndRecalibrateHome(uint8_t i) {
+#if HOME_CALIBRATION_ENABLED
+    if (state[i] == PANIC || state[i] == STATE_DISABLED) {
+        return;
+    }
+    MOTION_LOG_INFO(MOTION_EVENT_LOOKING_FOR_HOME, i, current_step[i]);
+    state[i] = LOOK_FOR_HOME;
+    delta_steps[i] = MAX_STEPS_LOOKING_FOR_HOME;
+#endif
+}
+
+/**
+ * Updates all modules. This is equivalent to calling UpdateModule() for each module, but only does the work for
+ * modules whose next step deadline has arrived.
+ */
+__attribute__((always_inline))
+inline void MotionEngine::Update(StepScheduler& scheduler) {
+    uint32_t now = scheduler.now();
+    uint32_t earliest_deadline = scheduler.nextDeadline();
+    for (uint8_t i = 0; i < NUM_MODULES; i++) {
+        State s = state[i];
+        if (s == PANIC || s == STATE_DISABLED) {
+            continue;
+        }
+        uint32_t deadline = next_update_micros[i];
+        if ((int32_t)(now - deadline) >= 0) {
+            Step(i, now, scheduler);
+            deadline = next_update_micros[i];
+        }
+        if ((int32_t)(deadline - earliest_deadline) < 0) {
+            earliest_deadline = deadline;
+        }
+    }
+    scheduler.schedule(earliest_deadline);
+}
+
+__attribute__((always_inline))
+inline void MotionEngine::UpdateModule(uint8_t i, StepScheduler& scheduler) {
+    if (state[i] == PANIC || state[i] == STATE_DISABLED) {
+        return;
+    }
+    uint32_t now = scheduler.now();
+    if ((int32_t)(now - next_update_micros[i]) >= 0) {
+        Step(i, now, scheduler);
+    }
+    scheduler.schedule(next_update_micros[i]);
+}
+
+// Deliberately kept out of line so that the common not-due path through Update() stays small
+__attribute__((noinline))
+void MotionEngine::Step(uint8_t i, uint32_t now, StepScheduler& scheduler) {
+    uint32_t late_micros = now - next_update_micros[i];
+    uint8_t previous_accel_step = current_accel_step[i];
+    uint8_t target_accel_step;
+
+    if (state[i] == NORMAL) {
+        bool reset_to_home = false;
+#if HOME_CALIBRATION_ENABLED
+        bool found_home = CheckSensor(i);
+        if (home_state[i] == IGNORE) {
+            if (found_home) {
+                MOTION_LOG_DEBUG(MOTION_EVENT_IGNORED_HOME, i, current_step[i]);
+            }
+            if (current_step[i] == UNEXPECTED_HOME_START_STEP) {
+                home_state[i] = UNEXPECTED;
+            }
+        } else if (home_state[i] == UNEXPECTED) {
+            if (found_home) {
+              count_unexpected_home[i]++;
+                MOTION_LOG_WARN(MOTION_EVENT_UNEXPECTED_HOME, i, current_step[i]);
+                reset_to_home = true;
+            } else if (current_step[i] == UNEXPECTED_HOME_END_STEP) {
+                home_state[i] = EXPECTED;
+            }
+        } else if (home_state[i] == EXPECTED) {
+            if (FAKE_HOME_SENSOR || found_home) {
+                MOTION_LOG_DEBUG(MOTION_EVENT_FOUND_EXPECTED_HOME, i, current_step[i]);
+                home_state[i] = IGNORE;
+#if ADAPTIVE_SPEED
+                // Home should come at step 0. Steps lost (or gained) since the last pass show up as drift from
+                // that long before they add up to a missed home, so they count as errors too.
+                uint16_t drift = current_step[i] < STEPS_PER_REVOLUTION / 2 ? current_step[i] : STEPS_PER_REVOLUTION - current_step[i];
+                if (!FAKE_HOME_SENSOR && drift > ADAPTIVE_SPEED_DRIFT_TOLERANCE_STEPS) {
+                    MOTION_LOG_WARN(MOTION_EVENT_HOME_DRIFT, i, current_step[i]);
+                    LowerMaxAccelStep(i);
+                } else {
+                    RecordCleanRevolution(i);
+                }
+#endif
+            } else if (current_step[i] == MISSED_HOME_STEP) {
+              count_missed_home[i]++;
+                MOTION_LOG_WARN(MOTION_EVENT_MISSED_HOME, i, current_step[i]);
+                reset_to_home = true;
+            }
+        }
+#endif
+
+        if (reset_to_home) {
+#if ADAPTIVE_SPEED
+            LowerMaxAccelStep(i);
+#endif
+            FindAndRecalibrateHome(i);
+            target_accel_step = 0;
+        } else {
+            if (delta_steps[i] == 0 && queue_length[i] > 0
+                    && now - last_step_micros[i] >= (uint32_t)dwell_millis[i] * 1000) {
+                AdvanceQueue(i);
+            }
+            // Update speed based on distance to target
+            if (delta_steps[i] > max_accel_step[i]) {
+                target_accel_step = max_accel_step[i];
+            } else {
+                target_accel_step = delta_steps[i];
+            }
+        }
+#if HOME_CALIBRATION_ENABLED
+    } else if (state[i] == LOOK_FOR_HOME) {
+        bool found_home = CheckSensor(i);
+        if (FAKE_HOME_SENSOR || found_home) {
+            MOTION_LOG_INFO(MOTION_EVENT_FOUND_HOME, i, current_step[i]);
+            state[i] = NORMAL;
+            target_accel_step = 0;
+
+            // Reset frame of reference
+            current_step[i] = 0;
+            home_state[i] = IGNORE;
+
+            GoToTargetFlapIndex(i);
+        } else {
+            if (delta_steps[i] == 0) {
+                MOTION_LOG_WARN(MOTION_EVENT_GAVE_UP_LOOKING_FOR_HOME, i, current_step[i]);
+                state[i] = SENSOR_ERROR;
+                target_accel_step = 0;
+            } else {
+                target_accel_step = Acceleration::MAX_ACCEL_STEP / 8;
+            }
+        }
+#endif
+    } else {
+        target_accel_step = 0;
+    }
+
+    if (power_hold[i] && current_accel_step[i] == 0) {
+        target_accel_step = 0;
+    }
+
+    // Update motor
+    if (current_accel_step[i] < target_accel_step) {
+        current_accel_step[i]++;
+    } else if (current_accel_step[i] > target_accel_step) {
+        current_accel_step[i]--;
+    }
+
+    current_period[i] = pgm_read_word_near(&Acceleration::MOTION_PROFILE_PERIODS[motion_profile[i]][current_accel_step[i]]);
+
+    if (current_accel_step[i] > 0) {
+        // Step timing stats are compared against ACCEL_STEP_PERIODS, so only the default profile is recorded
+        if (previous_accel_step > 0 && motion_profile[i] == 0) {
+            scheduler.recordStep(previous_accel_step, now - last_step_micros[i]);
+        }
+        last_step_micros[i] = now;
+
+        current_step[i]++;
+        if (current_step[i] == STEPS_PER_REVOLUTION) {
+            current_step[i] = 0;
+        }
+        current_phase[i]++;
+        if (current_phase[i] == NUM_STEP_PHASES) {
+            current_phase[i] = 0;
+        }
+        if (delta_steps[i] > 0) {
+            delta_steps[i]--;
+        }
+        SetMotor(i, step_pattern[current_phase[i]]);
+    } else {
+        SetMotor(i, 0);
+    }
+
+#if ASSERTIONS_ENABLED
+    // Check modular arithmetic invariant
+    if (current_step[i] >= STEPS_PER_REVOLUTION) {
+        Panic(i, MOTION_EVENT_PANIC_STEP_OUT_OF_RANGE);
+    }
+#endif
+
+    // Schedule relative to when this update was due rather than when it actually ran, so that loop latency
+    // doesn't stretch every step period. Only make up for a limited amount of lateness though; shortening
+    // the next period by too much would ask the motor for a sudden jump in speed that it can't follow. For the
+    // same reason, only lateness that persisted since the previous step is made up for: a one-off delay (e.g.
+    // another module's step occupying the SPI bus) is just absorbed, which matters at higher step rates.
+    uint32_t max_catch_up_micros = current_period[i] / 8;
+    if (last_late_micros[i] < max_catch_up_micros) {
+        max_catch_up_micros = last_late_micros[i];
+    }
+    last_late_micros[i] = late_micros < UINT16_MAX ? late_micros : UINT16_MAX;
+    next_update_micros[i] = now + current_period[i] - (late_micros < max_catch_up_micros ? late_micros : max_catch_up_micros);
+}
+
+/**
+ * Moves on to the module's next queued target. With no dwell, this happens on the module's final step of the
+ * previous move, so it carries straight on without stopping.
+ */
+void MotionEngine::AdvanceQueue(uint8_t i) {
+    uint8_t head = queue_head[i];
+    target_flap_index[i] = queue_flap_index[i][head];
+    dwell_millis[i] = queue_dwell_millis[i][head];
+    queue_head[i] = head + 1 == MODULE_QUEUE_DEPTH ? 0 : head + 1;
+    queue_length[i]--;
+    GoToTargetFlapIndex(i);
+}
+
+#if ADAPTIVE_SPEED
+/**
+ * Slows the module down after a home sensor error. If the error came while a raised speed was still on probation,
+ * that raise is the likely cause, so the next one waits twice as long.
+ */
+void MotionEngine::LowerMaxAccelStep(uint8_t i) {
+    if (speed_on_probation[i] && raise_after_revolutions[i] <= UINT16_MAX / 2) {
+        raise_after_revolutions[i] *= 2;
+    }
+    speed_on_probation[i] = false;
+    clean_revolutions[i] = 0;
+    if (max_accel_step[i] > ADAPTIVE_SPEED_MIN_ACCEL_STEP) {
+        max_accel_step[i]--;
+        max_accel_step_changed = true;
+        MOTION_LOG_INFO(MOTION_EVENT_MAX_ACCEL_STEP_CHANGED, i, max_accel_step[i]);
+    }
+}
+
+/** Speeds the module back up once it's gone raise_after_revolutions past home without an error */
+void MotionEngine::RecordCleanRevolution(uint8_t i) {
+    clean_revolutions[i]++;
+    if (clean_revolutions[i] < raise_after_revolutions[i]) {
+        return;
+    }
+    clean_revolutions[i] = 0;
+    speed_on_probation[i] = false;
+    if (max_accel_step[i] < Acceleration::MAX_ACCEL_STEP) {
+        max_accel_step[i]++;
+        speed_on_probation[i] = true;
+        max_accel_step_changed = true;
+        MOTION_LOG_INFO(MOTION_EVENT_MAX_ACCEL_STEP_CHANGED, i, max_accel_step[i]);
+    }
+}
+#endif
+
+void MotionEngine::ResetErrorCounters(uint8_t i) {
+  count_unexpected_home[i] = 0;
+  count_missed_home[i] = 0;
+}
+
+void MotionEngine::ResetState(uint8_t i) {
+    ResetErrorCounters(i);
+    CheckSensor(i);
+    ClearQueue(i);
+
+    target_flap_index[i] = 0;
+    current_step[i] = 0;
+    delta_steps[i] = 0;
+
+#if HOME_CALIBRATION_ENABLED
+    home_state[i] = IGNORE;
+#endif
+}
+
+void MotionEngine::Init(uint8_t i) {
+    CheckSensor(i);
+}
+
+bool MotionEngine::GetHomeState(uint8_t i) {
+  return (*sensor_in[i] & sensor_bitmask[i]) != 0;
+}
+
+void MotionEngine::IncreaseOffset(uint8_t i, uint8_t flap_tenths) {
+    offset_steps[i] += flap_tenths * STEPS_PER_REVOLUTION / NUM_FLAPS / 10;
+    offset_steps[i] %= STEPS_PER_REVOLUTION;
+    GoToTargetFlapIndex(i);
+}
+
+void MotionEngine::SetOffset(uint8_t i) {
+    offset_steps[i] = current_step[i];
+    //target_flap_index = 0;
+    //GoToTargetFlapIndex();
+    MOTION_LOG_INFO(MOTION_EVENT_OFFSET_SET, i, offset_steps[i]);
+}
+
+void MotionEngine::RestoreOffset(uint8_t i, uint16_t offset) {
+    if (offset != offset_steps[i]) {
+        offset_steps[i] = offset;
+        FindAndRecalibrateHome(i);
+    }
+}
+
+/**
+ * Puts a module that's at rest straight into NORMAL at a known position (e.g. where it was before a power cycle)
+ * instead of homing it. `phase` is the current_phase that the motor was left in. The home sensor checks still
+ * apply, so if the position turns out to be wrong, the next time the module passes home it recalibrates.
+ * Returns false (and does nothing) if the module is disabled or moving.
+ */
+bool MotionEngine::RestorePosition(uint8_t i, uint16_t offset, uint16_t step, uint8_t phase, uint8_t flap_index) {
+    if (state[i] == PANIC || state[i] == STATE_DISABLED || current_accel_step[i] > 0) {
+        return false;
+    }
+    SetMotor(i, 0);
+    state[i] = NORMAL;
+    offset_steps[i] = offset % STEPS_PER_REVOLUTION;
+    current_step[i] = step % STEPS_PER_REVOLUTION;
+    current_phase[i] = phase % NUM_STEP_PHASES;
+    target_flap_index[i] = flap_index < NUM_FLAPS ? flap_index : GetCurrentFlapIndex(i);
+    delta_steps[i] = 0;
+#if HOME_CALIBRATION_ENABLED
+    // Same region Step() would have tracked the module into on its way around from home
+    if (current_step[i] < UNEXPECTED_HOME_START_STEP) {
+        home_state[i] = IGNORE;
+    } else if (current_step[i] < UNEXPECTED_HOME_END_STEP) {
+        home_state[i] = UNEXPECTED;
+    } else {
+        home_state[i] = EXPECTED;
+    }
+#endif
+    return true;
+}
+
+/**
+ * True if the module is stepping, or has a move pending that hasn't started yet (see SynchronizeArrival()).
+ */
+__attribute__((always_inline))
+inline bool MotionEngine::IsMoving(uint8_t i) {
+    return current_accel_step[i] > 0 || (state[i] == NORMAL && delta_steps[i] > 0);
+}
+
+/**
+ * True if the module is moving, or is dwelling between moves with more of its queue still to go. Unlike IsMoving(),
+ * this covers everything that's been asked of the module; IsMoving() is what draws power.
+ */
+__attribute__((always_inline))
+inline bool MotionEngine::IsBusy(uint8_t i) {
+    return IsMoving(i) || (state[i] == NORMAL && queue_length[i] > 0);
+}
+
+/**
+ * Time from the module's next step until the step that completes its current move, following the same
+ * acceleration rules as Step() with the module's motion profile. Each step runs at accel step
+ * min(current + k, MAX_ACCEL_STEP, steps remaining), so only the ramps need to be summed; the cruise in between
+ * is a single multiplication.
+ */
+uint32_t MotionEngine::TravelMicros(uint8_t i) {
+    const uint16_t* periods = Acceleration::MOTION_PROFILE_PERIODS[motion_profile[i]];
+    const int32_t max_accel = max_accel_step[i];
+    int32_t accel = current_accel_step[i];
+    int32_t steps = delta_steps[i];
+
+    // Steps k (1-based) in [cruise_start, cruise_end] are at full speed. The final step's period isn't part of
+    // the move, since the module has arrived by then.
+    int32_t cruise_start = max_accel > accel ? max_accel - accel : 1;
+    int32_t cruise_end = min(steps + 1 - max_accel, steps - 1);
+
+    uint32_t travel = 0;
+    for (int32_t k = 1; k < steps; k++) {
+        if (k == cruise_start && cruise_end >= cruise_start) {
+            travel += (uint32_t)(cruise_end - cruise_start + 1) * pgm_read_word_near(&periods[max_accel]);
+            k = cruise_end;
+            continue;
+        }
+        int32_t a = min(min(accel + k, steps - k + 1), max_accel);
+        travel += pgm_read_word_near(&periods[a]);
+    }
+    return travel;
+}
+
+/**
+ * Delays the start of every module that has a move pending but hasn't started moving yet, so that all modules
+ * that are moving finish their moves at the same time. Modules that are already moving can't be held back, but
+ * they're accounted for, so the make-span is never longer than the longest single move. Call right after
+ * GoToFlapIndex() for all modules, which also clears any start delays left over from the previous call.
+ */
+void MotionEngine::SynchronizeArrival(uint32_t now) {
+    uint32_t arrival = 0;
+    for (uint8_t i = 0; i < NUM_MODULES; i++) {
+        if (state[i] != NORMAL || delta_steps[i] == 0) {
+            continue;
+        }
+        // A module's next step may already be due, in which case it starts on the next pass
+        uint32_t start = (int32_t)(next_update_micros[i] - now) > 0 ? next_update_micros[i] - now : 0;
+        arrival = max(arrival, start + TravelMicros(i));
+    }
+    for (uint8_t i = 0; i < NUM_MODULES; i++) {
+        if (state[i] != NORMAL || delta_steps[i] == 0 || current_accel_step[i] > 0) {
+            continue;
+        }
+        next_update_micros[i] = now + (arrival - TravelMicros(i));
+    }
+}
+
+/** Takes effect from the module's next step, even mid-move. Out of range profiles are ignored. */
+void MotionEngine::SetMotionProfile(uint8_t i, uint8_t profile) {
+    if (profile < Acceleration::NUM_MOTION_PROFILES) {
+        motion_profile[i] = profile;
+    }
+}
+
+/**
+ * Sets the module's top accel step (e.g. a previously learned one), clamped to what ADAPTIVE_SPEED could have
+ * learned. Takes effect from the module's next step, even mid-move.
+ */
+void MotionEngine::SetMaxAccelStep(uint8_t i, uint8_t accel_step) {
+#if ADAPTIVE_SPEED
+    accel_step = max(accel_step, (uint8_t)ADAPTIVE_SPEED_MIN_ACCEL_STEP);
+#else
+    accel_step = max(accel_step, (uint8_t)1);
+#endif
+    max_accel_step[i] = min(accel_step, Acceleration::MAX_ACCEL_STEP);
+}
+
+/**
+ * Adds a target for the module to move to after its current one (and anything queued before it), staying there for
+ * at least dwell_millis before moving on. Targets are only taken from the queue while the module is NORMAL, and a
+ * GoToFlapIndex() replaces the whole queue. Returns false (and does nothing) if the queue is full.
+ */
+bool MotionEngine::QueueFlapIndex(uint8_t i, uint8_t flap_index, uint16_t dwell_millis) {
+    if (queue_length[i] == MODULE_QUEUE_DEPTH) {
+        return false;
+    }
+    uint8_t tail = (queue_head[i] + queue_length[i]) % MODULE_QUEUE_DEPTH;
+    queue_flap_index[i][tail] = flap_index;
+    queue_dwell_millis[i][tail] = dwell_millis;
+    queue_length[i]++;
+    return true;
+}
+
+/** Drops anything queued up for the module. Its current move, if any, carries on. */
+void MotionEngine::ClearQueue(uint8_t i) {
+    queue_length[i] = 0;
+    dwell_millis[i] = 0;
+}
+#endif
@@ -0,0 +1,149 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <stdio.h>
+
+#include "config.h"
+
+#define MOTION_LOG_LEVEL_NONE   0
+#define MOTION_LOG_LEVEL_ERROR  1
+#define MOTION_LOG_LEVEL_WARN   2
+#define MOTION_LOG_LEVEL_INFO   3
+#define MOTION_LOG_LEVEL_DEBUG  4
+
+enum MotionEvent : uint8_t {
+    MOTION_EVENT_PANIC_STEP_OUT_OF_RANGE,
+    MOTION_EVENT_LOOKING_FOR_HOME,
+    MOTION_EVENT_FOUND_HOME,
+    MOTION_EVENT_GAVE_UP_LOOKING_FOR_HOME,
+    MOTION_EVENT_IGNORED_HOME,
+    MOTION_EVENT_UNEXPECTED_HOME,
+    MOTION_EVENT_FOUND_EXPECTED_HOME,
+    MOTION_EVENT_MISSED_HOME,
+    MOTION_EVENT_OFFSET_SET,
+    MOTION_EVENT_MAX_ACCEL_STEP_CHANGED,
+    MOTION_EVENT_HOME_DRIFT,
+
+    NUM_MOTION_EVENTS,
+};
+
+struct MotionLogRecord {
+    uint8_t event;
+    uint8_t module;
+    // The module's current step, or another value depending on the event (see MotionLog::format())
+    uint16_t value;
+};
+
+/**
+ * Log for the motion loop, which can't afford to wait on a UART or format strings between steps.
+ *
+ * Events are recorded as fixed-size binary records into a lock-free single producer/single consumer ring, and
+ * turned into text later by the consumer (SerialTask on ESP32). Recording is a few stores and never blocks; if the
+ * ring is full, the record is dropped and counted instead. Only the motion task may record, and only one other
+ * task may read.
+ *
+ * Use the MOTION_LOG_* macros rather than record(), so that levels above MOTION_LOG_LEVEL compile to nothing.
+ */
+class MotionLog {
+    public:
+        static const uint16_t SIZE = MOTION_LOG_SIZE;
+        static_assert(SIZE > 0 && (SIZE & (SIZE - 1)) == 0, "MOTION_LOG_SIZE must be a power of 2");
+
+        void record(uint8_t event, uint8_t module, uint16_t value) {
+            uint16_t head = head_.load(std::memory_order_relaxed);
+            if ((uint16_t)(head - tail_.load(std::memory_order_acquire)) >= SIZE) {
+                dropped_.store(dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return;
+            }
+            MotionLogRecord& record = records_[head & (SIZE - 1)];
+            record.event = event;
+            record.module = module;
+            record.value = value;
+            head_.store(head + 1, std::memory_order_release);
+        }
+
+        /** Takes the oldest record, if there is one. Consumer only. */
+        bool read(MotionLogRecord& record) {
+            uint16_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail == head_.load(std::memory_order_acquire)) {
+                return false;
+            }
+            record = records_[tail & (SIZE - 1)];
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /** Total number of records dropped because the ring was full */
+        uint32_t dropped() {
+            return dropped_.load(std::memory_order_relaxed);
+        }
+
+        /** Formats a record as a line of text (without a newline) */
+        static int format(const MotionLogRecord& record, char* buffer, size_t size) {
+            // Every format string takes the module index and then the record's value, whether it uses it or not
+            static const char* const FORMATS[NUM_MOTION_EVENTS] = {
+                "#### PANIC! #### Module %u: current_step %u >= STEPS_PER_REVOLUTION",
+                "Module %u: looking for home",
+                "Module %u: found home",
+                "Module %u: gave up looking for home",
+                "Module %u: ignoring home at step %u",
+                "Module %u: unexpected home at step %u",
+                "Module %u: found expected home at step %u",
+                "Module %u: missed expected home at step %u",
+                "Module %u: new offset set to %u steps",
+                "Module %u: top accel step is now %u",
+                "Module %u: home drifted to step %u",
+            };
+            if (record.event >= NUM_MOTION_EVENTS) {
+                return snprintf(buffer, size, "Module %u: unknown motion event %u", record.module, record.event);
+            }
+            return snprintf(buffer, size, FORMATS[record.event], record.module, record.value);
+        }
+
+    private:
+        MotionLogRecord records_[SIZE] = {};
+        // Free-running counts of records written and read; they only ever wrap together
+        std::atomic<uint16_t> head_ = {0};
+        std::atomic<uint16_t> tail_ = {0};
+        std::atomic<uint32_t> dropped_ = {0};
+};
+
+#if MOTION_LOG_LEVEL >= MOTION_LOG_LEVEL_ERROR
+#define MOTION_LOG_ERROR(event, module, value) motion_log.record((event), (module), (value))
+#else
+#define MOTION_LOG_ERROR(event, module, value) do {} while (0)
+#endif
+
+#if MOTION_LOG_LEVEL >= MOTION_LOG_LEVEL_WARN
+#define MOTION_LOG_WARN(event, module, value) motion_log.record((event), (module), (value))
+#else
+#define MOTION_LOG_WARN(event, module, value) do {} while (0)
+#endif
+
+#if MOTION_LOG_LEVEL >= MOTION_LOG_LEVEL_INFO
+#define MOTION_LOG_INFO(event, module, value) motion_log.record((event), (module), (value))
+#else
+#define MOTION_LOG_INFO(event, module, value) do {} while (0)
+#endif
+
+#if MOTION_LOG_LEVEL >= MOTION_LOG_LEVEL_DEBUG
+#define MOTION_LOG_DEBUG(event, module, value) motion_log.record((event), (module), (value))
+#else
+#define MOTION_LOG_DEBUG(event, module, value) do {} while (0)
+#endif
@@ -0,0 +1,176 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#pragma once
+
+#include <Arduino.h>
+
+#include "config.h"
+#include "motion_engine.h"
+
+struct PowerSchedulerStats {
+    uint32_t admissions;
+    uint64_t total_wait_micros;
+    uint32_t max_wait_micros;
+    // Most modules that were ever allowed to move at once on a single channel
+    uint8_t peak_moving;
+};
+
+/**
+ * Keeps the number of modules moving at once on each power channel within a current budget, so that a big move
+ * (or homing everything at boot) doesn't draw more than the power supply or the Chainlink Base over-current
+ * protection allows.
+ *
+ * Modules are assigned to channels in groups of MODULES_PER_POWER_CHANNEL. A module with a move pending waits,
+ * held at rest by MotionEngine::power_hold, until its channel has room; then it's admitted and keeps its slot until
+ * it comes to a stop. When several modules are waiting, the one with the longest move (or a module that's
+ * homing, since that can take a full revolution) goes first, so that short moves fill in around the long ones and
+ * the whole display finishes as soon as possible.
+ *
+ * update() must be called once per motion loop pass, before MotionEngine::Update().
+ */
+class PowerScheduler {
+    public:
+        static const uint8_t NUM_CHANNELS = (NUM_MODULES + MODULES_PER_POWER_CHANNEL - 1) / MODULES_PER_POWER_CHANNEL;
+
+        // Time each module spent waiting for its most recent move to be admitted
+        uint32_t last_wait_micros[NUM_MODULES] = {};
+
+        void begin(uint16_t channel_budget_ma = POWER_CHANNEL_BUDGET_MA) {
+            setChannelBudget(channel_budget_ma);
+            resetStats();
+        }
+
+        /** Milliamps each channel may draw for moving modules, or 0 for no limit. Takes effect on the next update(). */
+        void setChannelBudget(uint16_t channel_budget_ma) {
+            max_moving_ = 0;
+            if (channel_budget_ma > 0) {
+                max_moving_ = max(channel_budget_ma / MODULE_MOVING_CURRENT_MA, 1);
+            }
+            for (uint8_t c = 0; c < NUM_CHANNELS; c++) {
+                moving_[c] = 0;
+            }
+            for (uint8_t i = 0; i < NUM_MODULES; i++) {
+                admitted_[i] = false;
+                waiting_[i] = false;
+                motion_engine.power_hold[i] = max_moving_ > 0;
+            }
+        }
+
+        /** Most modules allowed to move at once per channel, or 0 for no limit */
+        uint8_t maxMoving() const {
+            return max_moving_;
+        }
+
+        static uint8_t channelForModule(uint8_t i) {
+            return i / MODULES_PER_POWER_CHANNEL;
+        }
+
+        void update(uint32_t now) {
+            if (max_moving_ == 0) {
+                return;
+            }
+
+            bool any_waiting = false;
+            for (uint8_t i = 0; i < NUM_MODULES; i++) {
+                bool wants_to_move = motion_engine.IsMoving(i) || motion_engine.state[i] == LOOK_FOR_HOME;
+                if (admitted_[i]) {
+                    if (!wants_to_move) {
+                        admitted_[i] = false;
+                        motion_engine.power_hold[i] = true;
+                        moving_[channelForModule(i)]--;
+                    }
+                } else if (motion_engine.current_accel_step[i] > 0) {
+                    // Already moving (the budget was just changed); it can't be held back, but it uses up a slot
+                    admit(i, now);
+                } else if (wants_to_move) {
+                    if ((int32_t)(motion_engine.next_update_micros[i] - now) > (int32_t)Acceleration::IDLE_PERIOD_MICROS) {
+                        // Start is deliberately delayed (see MotionEngine::SynchronizeArrival()); don't take up a
+                        // slot until then
+                        waiting_[i] = false;
+                        continue;
+                    }
+                    if (!waiting_[i]) {
+                        waiting_[i] = true;
+                        wait_start_micros_[i] = now;
+                    }
+                    any_waiting = true;
+                } else {
+                    waiting_[i] = false;
+                }
+            }
+
+            if (!any_waiting) {
+                return;
+            }
+            for (uint8_t c = 0; c < NUM_CHANNELS; c++) {
+                uint8_t first = c * MODULES_PER_POWER_CHANNEL;
+                uint8_t end = min(first + MODULES_PER_POWER_CHANNEL, NUM_MODULES);
+                while (moving_[c] < max_moving_) {
+                    int16_t next = -1;
+                    uint32_t next_travel = 0;
+                    for (uint8_t i = first; i < end; i++) {
+                        if (!waiting_[i]) {
+                            continue;
+                        }
+                        uint32_t travel = motion_engine.state[i] == LOOK_FOR_HOME ? UINT32_MAX : motion_engine.TravelMicros(i);
+                        if (next < 0 || travel > next_travel) {
+                            next = i;
+                            next_travel = travel;
+                        }
+                    }
+                    if (next < 0) {
+                        break;
+                    }
+                    admit(next, now);
+                }
+            }
+        }
+
+        const PowerSchedulerStats& stats() const {
+            return stats_;
+        }
+
+        void resetStats() {
+            stats_ = {};
+        }
+
+    private:
+        uint8_t max_moving_ = 0;
+        uint8_t moving_[NUM_CHANNELS] = {};
+        bool admitted_[NUM_MODULES] = {};
+        bool waiting_[NUM_MODULES] = {};
+        uint32_t wait_start_micros_[NUM_MODULES] = {};
+        PowerSchedulerStats stats_ = {};
+
+        void admit(uint8_t i, uint32_t now) {
+            uint8_t c = channelForModule(i);
+            admitted_[i] = true;
+            motion_engine.power_hold[i] = false;
+            moving_[c]++;
+            stats_.peak_moving = max(stats_.peak_moving, moving_[c]);
+
+            if (waiting_[i]) {
+                waiting_[i] = false;
+                uint32_t wait = now - wait_start_micros_[i];
+                last_wait_micros[i] = wait;
+                stats_.admissions++;
+                stats_.total_wait_micros += wait;
+                stats_.max_wait_micros = max(stats_.max_wait_micros, wait);
+            }
+        }
+};
+
+PowerScheduler power_scheduler;
@@ -17,7 +17,9 @@
 #ifndef IO_CONFIG_H
 #define IO_CONFIG_H
 
+#ifndef SPLITFLAP_NATIVE
 #include <SPI.h>
+#endif
 
 #if defined(__AVR_ATmega168__) || defined(__AVR_ATmega328P__)
   #define OUT_LATCH_PIN (4)
@@ -57,6 +59,8 @@
 #ifdef ESP32
   #include "driver/spi_master.h"
   #include "driver/spi_slave.h"
+  #include "esp_timer.h"
+  #include "hal/gpio_ll.h"
 
   #define LATCH_PIN 13
 
@@ -78,32 +82,156 @@
   #define SPLITFLAP_SPI_HOST SPI3_HOST
   #define DMA_CHANNEL 1
 
+#if NUM_CHAINS > 1
+  // The second chain (see NUM_CHAINS in config.h) needs its own pins, which depend on the board, so set them in
+  // platformio.ini. Note that the second SPI host can't be shared with the display.
+  #ifndef CHAIN1_SPI_HOST
+  #define CHAIN1_SPI_HOST SPI2_HOST
+  #endif
+  #if !defined(CHAIN1_LATCH_PIN) || !defined(CHAIN1_PIN_NUM_MISO) || !defined(CHAIN1_PIN_NUM_MOSI) || !defined(CHAIN1_PIN_NUM_CLK)
+  #error "NUM_CHAINS > 1 requires CHAIN1_LATCH_PIN, CHAIN1_PIN_NUM_MISO, CHAIN1_PIN_NUM_MOSI and CHAIN1_PIN_NUM_CLK"
+  #endif
+#endif
+
+  struct SpiChainPins {
+    spi_host_device_t host;
+    int miso;
+    int mosi;
+    int clk;
+  };
+
+  static const SpiChainPins SPI_CHAIN_PINS[NUM_CHAINS] = {
+    {SPLITFLAP_SPI_HOST, PIN_NUM_MISO, PIN_NUM_MOSI, PIN_NUM_CLK},
+#if NUM_CHAINS > 1
+    {CHAIN1_SPI_HOST, CHAIN1_PIN_NUM_MISO, CHAIN1_PIN_NUM_MOSI, CHAIN1_PIN_NUM_CLK},
+#endif
+  };
+
+  // The latch callbacks below run from the SPI ISR, which keeps firing while the flash cache is disabled (e.g.
+  // during FFat/NVS writes), so they can only touch IRAM/DRAM. Keep the latch pins here rather than in the
+  // flash-resident SPI_CHAIN_PINS.
+  static DRAM_ATTR const uint8_t SPI_LATCH_PINS[NUM_CHAINS] = {
+    LATCH_PIN,
+#if NUM_CHAINS > 1
+    CHAIN1_LATCH_PIN,
+#endif
+  };
+
+  spi_device_handle_t spi_tx[NUM_CHAINS];
+  spi_device_handle_t spi_rx[NUM_CHAINS];
 
-  spi_device_handle_t spi_tx;
-  spi_device_handle_t spi_rx;
+  spi_transaction_t tx_transaction[NUM_CHAINS];
+  spi_transaction_t rx_transaction[NUM_CHAINS];
+
+
+#endif
 
-  spi_transaction_t tx_transaction;
-  spi_transaction_t rx_transaction;
+#ifdef SPLITFLAP_NATIVE
+  // Host build: the shift register chain is simulated (see firmware/native/sim_chain.h)
+  #include "sim_chain.h"
 
+  #define SPI_CLOCK 4000000
 
+  #define BUFFER_ATTRS
 #endif
 
-#if !defined(__AVR_ATmega168__) && !defined(__AVR_ATmega328P__) && !defined(ARDUINO_ESP8266_WEMOS_D1MINI) && !defined(ESP32)
+#if !defined(__AVR_ATmega168__) && !defined(__AVR_ATmega328P__) && !defined(ARDUINO_ESP8266_WEMOS_D1MINI) && !defined(ESP32) && !defined(SPLITFLAP_NATIVE)
 #error "Unknown/unsupported board for SPI mode. ATmega328-based boards (Uno, Duemilanove, Diecimila), ESP8266 and ESP32 are currently supported"
 #endif
 
+#if SPI_IO_PIPELINED && !defined(ESP32) && !defined(SPLITFLAP_NATIVE)
+#error "SPI_IO_PIPELINED requires an ESP32"
+#endif
+
+#if NUM_CHAINS > 1 && !defined(ESP32) && !defined(SPLITFLAP_NATIVE)
+#error "Multiple shift register chains (NUM_CHAINS > 1) require an ESP32"
+#endif
+
 #ifdef CHAINLINK
-#define MOTOR_BUFFER_LENGTH (NUM_MODULES * 2 / 3 + (NUM_MODULES % 3 != 0) * 2)
-#define SENSOR_BUFFER_LENGTH (NUM_MODULES / 6 + (NUM_MODULES % 6 != 0))
+#define CHAIN_MOTOR_BYTES(n) ((n) * 2 / 3 + ((n) % 3 != 0) * 2)
+#define CHAIN_SENSOR_BYTES(n) ((n) / 6 + ((n) % 6 != 0))
+// Home sensors occupy the low bits of each sensor byte (the Chainlink loopback inputs are in bits 6 and 7)
+#define SENSOR_MODULES_PER_BYTE (6)
 #else
-#define MOTOR_BUFFER_LENGTH (NUM_MODULES / 2 + (NUM_MODULES % 2 != 0))
-#define SENSOR_BUFFER_LENGTH (NUM_MODULES / 4 + (NUM_MODULES % 4 != 0))
+#define CHAIN_MOTOR_BYTES(n) ((n) / 2 + ((n) % 2 != 0))
+#define CHAIN_SENSOR_BYTES(n) ((n) / 4 + ((n) % 4 != 0))
+#define SENSOR_MODULES_PER_BYTE (4)
+#endif
+#define SENSOR_HOME_MASK ((1 << SENSOR_MODULES_PER_BYTE) - 1)
+
+#define MOTOR_BUFFER_LENGTH (CHAIN_MOTOR_BYTES(CHAIN0_MODULES) + CHAIN_MOTOR_BYTES(CHAIN1_MODULES))
+#define SENSOR_BUFFER_LENGTH (CHAIN_SENSOR_BYTES(CHAIN0_MODULES) + CHAIN_SENSOR_BYTES(CHAIN1_MODULES))
+
+/**
+ * Where each shift register chain's modules live in the module index space, and where its bytes live in
+ * motor_buffer/sensor_buffer. Chains are laid out back to back in both, and each chain is laid out just like a
+ * single chain would be. Since every chain but the last holds a multiple of CHAIN_MODULE_MULTIPLE modules, sensor
+ * bytes still map to modules as `byte * SENSOR_MODULES_PER_BYTE + bit`.
+ */
+struct SpiChain {
+  uint8_t first_module;
+  uint8_t num_modules;
+  uint8_t motor_offset;
+  uint8_t motor_length;
+  uint8_t sensor_offset;
+  uint8_t sensor_length;
+};
+
+static const SpiChain SPI_CHAINS[NUM_CHAINS] = {
+  {0, CHAIN0_MODULES, 0, CHAIN_MOTOR_BYTES(CHAIN0_MODULES), 0, CHAIN_SENSOR_BYTES(CHAIN0_MODULES)},
+#if NUM_CHAINS > 1
+  {CHAIN0_MODULES, CHAIN1_MODULES, CHAIN_MOTOR_BYTES(CHAIN0_MODULES), CHAIN_MOTOR_BYTES(CHAIN1_MODULES),
+    CHAIN_SENSOR_BYTES(CHAIN0_MODULES), CHAIN_SENSOR_BYTES(CHAIN1_MODULES)},
 #endif
+};
+
+inline const SpiChain& chain_for_module(uint8_t module) {
+  return SPI_CHAINS[module < CHAIN0_MODULES ? 0 : NUM_CHAINS - 1];
+}
 
 
 BUFFER_ATTRS uint8_t motor_buffer[MOTOR_BUFFER_LENGTH];
 BUFFER_ATTRS uint8_t sensor_buffer[SENSOR_BUFFER_LENGTH];
 
+// Home sensor bits as of the previous motor_sensor_io(), for finding rising edges
+uint8_t last_home_sensors[SENSOR_BUFFER_LENGTH];
+
+// Everything in the outgoing frame other than the motors (Chainlink LEDs and loopbacks). Motor coil patterns are
+// merged in by pack_motor_frame() right before each transfer.
+uint8_t aux_buffer[MOTOR_BUFFER_LENGTH];
+
+// Where each module's coil pattern goes in motor_buffer, precomputed by initialize_modules()
+static uint8_t motor_byte_index[NUM_MODULES];
+static uint8_t motor_shift[NUM_MODULES];
+
+#if SPI_IO_PIPELINED
+// With SPI_IO_PIPELINED, frames alternate between these two buffer pairs (instead of motor_buffer/sensor_buffer)
+// so the next frame can be packed while the previous one is still on the wire. Received sensor bytes are copied
+// to sensor_buffer once the transfer is complete.
+struct IoFrame {
+  BUFFER_ATTRS uint8_t motor[MOTOR_BUFFER_LENGTH];
+  BUFFER_ATTRS uint8_t sensor[SENSOR_BUFFER_LENGTH];
+};
+BUFFER_ATTRS IoFrame io_frames[2];
+uint8_t io_next_frame = 0;
+bool io_in_flight = false;
+#ifdef ESP32
+bool io_tx_done[NUM_CHAINS];
+bool io_rx_done[NUM_CHAINS];
+#endif
+#endif
+
+struct MotorSensorIoStats {
+  uint32_t transfers;
+  // Time from starting a transfer until the shift registers were latched and read back
+  uint64_t total_round_trip_micros;
+  uint32_t max_round_trip_micros;
+  // Time the caller spent blocked waiting for transfers to complete
+  uint64_t total_wait_micros;
+};
+MotorSensorIoStats motor_sensor_io_stats;
+uint32_t io_start_micros;
+
 #ifdef __AVR__
 // Define placement new so we can initialize SplitflapModules at runtime into a static buffer.
 // (see https://arduino.stackexchange.com/a/1499)
@@ -113,12 +241,19 @@ void* operator new(__attribute__((unused)) size_t size, void* ptr) {
 #endif
 
 #ifdef ESP32
-void reset_latch(spi_transaction_t *trans) {
-    digitalWrite(LATCH_PIN, LOW);
+volatile uint32_t io_complete_micros[NUM_CHAINS];
+
+// The rx transaction's `user` field holds its chain index. Queued transactions run these from the SPI ISR, so
+// they must stay in IRAM and avoid flash-resident helpers like digitalWrite()/micros().
+void IRAM_ATTR reset_latch(spi_transaction_t *trans) {
+    uint8_t chain = (uintptr_t)trans->user;
+    gpio_ll_set_level(&GPIO, (gpio_num_t)SPI_LATCH_PINS[chain], 0);
+    io_complete_micros[chain] = (uint32_t)esp_timer_get_time();
 }
 
-void latch_registers(spi_transaction_t *trans) {
-    digitalWrite(LATCH_PIN, HIGH);
+void IRAM_ATTR latch_registers(spi_transaction_t *trans) {
+    uint8_t chain = (uintptr_t)trans->user;
+    gpio_ll_set_level(&GPIO, (gpio_num_t)SPI_LATCH_PINS[chain], 1);
 }
 #endif
 
@@ -133,16 +268,29 @@ static const uint8_t MOTOR_OFFSET[] = {0, 0, 1, 2, 3, 3};
 
 inline void initialize_modules() {
   for (uint8_t i = 0; i < NUM_MODULES; i++) {
+    // Position within the module's own chain; the chain's first module is shifted out last
+    const SpiChain& chain = chain_for_module(i);
+    uint8_t j = i - chain.first_module;
+    uint8_t motor_end = chain.motor_offset + chain.motor_length - 1;
+
     // Create SplitflapModules in a statically allocated buffer using placement new
 #ifdef CHAINLINK
-    modules[i] = new (moduleBuffer[i]) SplitflapModule(motor_buffer[MOTOR_BUFFER_LENGTH - 1 - i/6*4 - MOTOR_OFFSET[i%6]], i % 2 == 0 ? 0 : 4, sensor_buffer[i/6], 1 << (i % 6));
+    modules[i] = new (moduleBuffer[i]) SplitflapModule(i, motor_buffer[motor_end - j/6*4 - MOTOR_OFFSET[j%6]], j % 2 == 0 ? 0 : 4, sensor_buffer[chain.sensor_offset + j/6], 1 << (j % 6));
 #else
-    modules[i] = new (moduleBuffer[i]) SplitflapModule(motor_buffer[MOTOR_BUFFER_LENGTH - 1 - i/2], i % 2 == 0 ? 0 : 4, sensor_buffer[i/4], 1 << (i % 4));
+    modules[i] = new (moduleBuffer[i]) SplitflapModule(i, motor_buffer[motor_end - j/2], j % 2 == 0 ? 0 : 4, sensor_buffer[chain.sensor_offset + j/4], 1 << (j % 4));
 #endif
+    motor_byte_index[i] = motion_engine.motor_out[i] - motor_buffer;
+    motor_shift[i] = motion_engine.motor_bitshift[i];
   }
   
   memset(motor_buffer, 0, MOTOR_BUFFER_LENGTH);
+  memset(aux_buffer, 0, MOTOR_BUFFER_LENGTH);
   memset(sensor_buffer, 0, SENSOR_BUFFER_LENGTH);
+  memset(last_home_sensors, 0, SENSOR_BUFFER_LENGTH);
+#if SPI_IO_PIPELINED
+  memset(io_frames, 0, sizeof(io_frames));
+#endif
+  memset(&motor_sensor_io_stats, 0, sizeof(motor_sensor_io_stats));
 
   // Initialize SPI
 #ifdef IN_LATCH_PIN
@@ -155,93 +303,276 @@ inline void initialize_modules() {
   digitalWrite(OUT_LATCH_PIN, LOW);
 #endif
 
-#ifdef LATCH_PIN
-  pinMode(LATCH_PIN, OUTPUT);
-  digitalWrite(LATCH_PIN, LOW);
-#endif
-
 #ifdef ESP32
 
   esp_err_t ret;
 
-  //Initialize the SPI bus
-  spi_bus_config_t tx_bus_config = {
-      .mosi_io_num = PIN_NUM_MOSI,
-      .miso_io_num = PIN_NUM_MISO,
-      .sclk_io_num = PIN_NUM_CLK,
-      .quadwp_io_num = -1,
-      .quadhd_io_num = -1,
-      .max_transfer_sz = 1000,
-  };
-  ret=spi_bus_initialize(SPLITFLAP_SPI_HOST, &tx_bus_config, SPI_DMA_CH_AUTO);
-  ESP_ERROR_CHECK(ret);
-
-  spi_device_interface_config_t tx_device_config = {
-      .command_bits=0,
-      .address_bits=0,
-      .dummy_bits=0,
-      .mode=3,
-      .duty_cycle_pos=0,
-      .cs_ena_pretrans=0,
-      .cs_ena_posttrans=0,
-      .clock_speed_hz=SPI_CLOCK,
-      .input_delay_ns=0,
-      .spics_io_num=-1,
-      .flags = 0,
-      .queue_size=1,
-      .pre_cb=NULL,
-      .post_cb=NULL,
-  };
-  ret=spi_bus_add_device(SPLITFLAP_SPI_HOST, &tx_device_config, &spi_tx);
-  ESP_ERROR_CHECK(ret);
-
-  spi_device_interface_config_t rx_device_config = {
-      .command_bits=0,
-      .address_bits=0,
-      .dummy_bits=0,
-      .mode=2,
-      .duty_cycle_pos=0,
-      .cs_ena_pretrans=0,
-      .cs_ena_posttrans=0,
-      .clock_speed_hz=SPI_CLOCK,
-      .input_delay_ns=30,
-      .spics_io_num=-1,
-      .flags = SPI_DEVICE_HALFDUPLEX,
-      .queue_size=1,
-      .pre_cb=&latch_registers,
-      .post_cb=&reset_latch,
-  };
-  ret=spi_bus_add_device(SPLITFLAP_SPI_HOST, &rx_device_config, &spi_rx);
-  ESP_ERROR_CHECK(ret);
-
-  memset(&tx_transaction, 0, sizeof(tx_transaction));
-  tx_transaction.length = MOTOR_BUFFER_LENGTH*8;
-  tx_transaction.tx_buffer = &motor_buffer;
-  tx_transaction.rx_buffer = NULL;
-
-  memset(&rx_transaction, 0, sizeof(rx_transaction));
-  rx_transaction.length = SENSOR_BUFFER_LENGTH*8;
-  rx_transaction.rxlength = SENSOR_BUFFER_LENGTH*8;
-  rx_transaction.tx_buffer = NULL;
-  rx_transaction.rx_buffer = &sensor_buffer;
+  for (uint8_t c = 0; c < NUM_CHAINS; c++) {
+    const SpiChainPins& pins = SPI_CHAIN_PINS[c];
+    const SpiChain& chain = SPI_CHAINS[c];
+
+    pinMode(SPI_LATCH_PINS[c], OUTPUT);
+    digitalWrite(SPI_LATCH_PINS[c], LOW);
+
+    //Initialize the SPI bus
+    spi_bus_config_t tx_bus_config = {
+        .mosi_io_num = pins.mosi,
+        .miso_io_num = pins.miso,
+        .sclk_io_num = pins.clk,
+        .quadwp_io_num = -1,
+        .quadhd_io_num = -1,
+        .max_transfer_sz = 1000,
+    };
+    ret=spi_bus_initialize(pins.host, &tx_bus_config, SPI_DMA_CH_AUTO);
+    ESP_ERROR_CHECK(ret);
+
+    spi_device_interface_config_t tx_device_config = {
+        .command_bits=0,
+        .address_bits=0,
+        .dummy_bits=0,
+        .mode=3,
+        .duty_cycle_pos=0,
+        .cs_ena_pretrans=0,
+        .cs_ena_posttrans=0,
+        .clock_speed_hz=SPI_CLOCK,
+        .input_delay_ns=0,
+        .spics_io_num=-1,
+        .flags = 0,
+        .queue_size=1,
+        .pre_cb=NULL,
+        .post_cb=NULL,
+    };
+    ret=spi_bus_add_device(pins.host, &tx_device_config, &spi_tx[c]);
+    ESP_ERROR_CHECK(ret);
+
+    spi_device_interface_config_t rx_device_config = {
+        .command_bits=0,
+        .address_bits=0,
+        .dummy_bits=0,
+        .mode=2,
+        .duty_cycle_pos=0,
+        .cs_ena_pretrans=0,
+        .cs_ena_posttrans=0,
+        .clock_speed_hz=SPI_CLOCK,
+        .input_delay_ns=30,
+        .spics_io_num=-1,
+        .flags = SPI_DEVICE_HALFDUPLEX,
+        .queue_size=1,
+        .pre_cb=&latch_registers,
+        .post_cb=&reset_latch,
+    };
+    ret=spi_bus_add_device(pins.host, &rx_device_config, &spi_rx[c]);
+    ESP_ERROR_CHECK(ret);
+
+    memset(&tx_transaction[c], 0, sizeof(tx_transaction[c]));
+    tx_transaction[c].length = chain.motor_length*8;
+    tx_transaction[c].tx_buffer = motor_buffer + chain.motor_offset;
+    tx_transaction[c].rx_buffer = NULL;
+
+    memset(&rx_transaction[c], 0, sizeof(rx_transaction[c]));
+    rx_transaction[c].length = chain.sensor_length*8;
+    rx_transaction[c].rxlength = chain.sensor_length*8;
+    rx_transaction[c].tx_buffer = NULL;
+    rx_transaction[c].rx_buffer = sensor_buffer + chain.sensor_offset;
+    rx_transaction[c].user = (void*)(uintptr_t)c;
+  }
 
+#elif defined(SPLITFLAP_NATIVE)
+  for (uint8_t c = 0; c < NUM_CHAINS; c++) {
+    sim_chains[c].spi_clock_hz = SPI_CLOCK;
+  }
 #else
   SPI.begin();
   SPI.beginTransaction(SPISettings(SPI_CLOCK, MSBFIRST, SPI_MODE0));
 #endif
 }
 
+/**
+ * Builds a complete outgoing shift register frame: the LED/loopback bits from aux_buffer, plus every module's
+ * current coil pattern.
+ */
+inline void pack_motor_frame(uint8_t frame[MOTOR_BUFFER_LENGTH]) {
+  memcpy(frame, aux_buffer, MOTOR_BUFFER_LENGTH);
+  for (uint8_t i = 0; i < NUM_MODULES; i++) {
+    frame[motor_byte_index[i]] |= motion_engine.motor_coils[i] << motor_shift[i];
+  }
+}
+
+/**
+ * Finds rising edges on all home sensors a byte at a time (new & ~old) and flags them for the affected modules.
+ * Most passes have no edges at all, so this is usually just one AND/compare per sensor byte.
+ */
+inline void detect_home_edges() {
+  for (uint8_t b = 0; b < SENSOR_BUFFER_LENGTH; b++) {
+    uint8_t home = sensor_buffer[b] & SENSOR_HOME_MASK;
+    uint8_t rising = home & ~last_home_sensors[b];
+    last_home_sensors[b] = home;
+    while (rising != 0) {
+      uint8_t bit = __builtin_ctz(rising);
+      rising &= rising - 1;
+      uint16_t module = b * SENSOR_MODULES_PER_BYTE + bit;
+      if (module < NUM_MODULES) {
+        motion_engine.home_edge[module] = true;
+      }
+    }
+  }
+}
+
+inline void record_motor_sensor_io(uint32_t round_trip_micros, uint32_t wait_micros) {
+  MotorSensorIoStats& s = motor_sensor_io_stats;
+  s.transfers++;
+  s.total_round_trip_micros += round_trip_micros;
+  if (round_trip_micros > s.max_round_trip_micros) {
+    s.max_round_trip_micros = round_trip_micros;
+  }
+  s.total_wait_micros += wait_micros;
+}
+
+/** Percentage of SPI transfer time that overlapped with other work instead of blocking the caller */
+inline uint8_t motor_sensor_io_overlap_percent() {
+  const MotorSensorIoStats& s = motor_sensor_io_stats;
+  if (s.total_wait_micros >= s.total_round_trip_micros) {
+    return 0;
+  }
+  return 100 - s.total_wait_micros * 100 / s.total_round_trip_micros;
+}
+
+#if SPI_IO_PIPELINED
+/**
+ * Completes the transfer started by the last motor_sensor_io_queue(), if any: makes its sensor data visible in
+ * sensor_buffer and flags home edges. If `block` is false and the transfer is still running, returns false
+ * without waiting.
+ */
+inline bool finish_motor_sensor_io(bool block) {
+  if (!io_in_flight) {
+    return true;
+  }
+  uint32_t wait_start = micros();
+  IoFrame& frame = io_frames[io_next_frame ^ 1];
+
+  uint32_t round_trip_micros = 0;
+#ifdef ESP32
+  spi_transaction_t* result;
+  TickType_t timeout = block ? portMAX_DELAY : 0;
+  esp_err_t ret;
+  for (uint8_t c = 0; c < NUM_CHAINS; c++) {
+    if (!io_tx_done[c]) {
+      ret = spi_device_get_trans_result(spi_tx[c], &result, timeout);
+      if (ret == ESP_ERR_TIMEOUT) {
+        return false;
+      }
+      ESP_ERROR_CHECK(ret);
+      io_tx_done[c] = true;
+    }
+    if (!io_rx_done[c]) {
+      ret = spi_device_get_trans_result(spi_rx[c], &result, timeout);
+      if (ret == ESP_ERR_TIMEOUT) {
+        return false;
+      }
+      ESP_ERROR_CHECK(ret);
+      io_rx_done[c] = true;
+    }
+  }
+  for (uint8_t c = 0; c < NUM_CHAINS; c++) {
+    round_trip_micros = max(round_trip_micros, (uint32_t)(io_complete_micros[c] - io_start_micros));
+  }
+#else
+  for (uint8_t c = 0; c < NUM_CHAINS; c++) {
+    if (!block && !sim_chains[c].transferComplete()) {
+      return false;
+    }
+  }
+  for (uint8_t c = 0; c < NUM_CHAINS; c++) {
+    sim_chains[c].endTransfer(frame.sensor + SPI_CHAINS[c].sensor_offset);
+    round_trip_micros = max(round_trip_micros, (uint32_t)(sim_chains[c].completeNanos() / 1000) - io_start_micros);
+  }
+#endif
+
+  io_in_flight = false;
+  memcpy(sensor_buffer, frame.sensor, SENSOR_BUFFER_LENGTH);
+  record_motor_sensor_io(round_trip_micros, micros() - wait_start);
+  detect_home_edges();
+  return true;
+}
+
+/**
+ * Packs the current coil patterns into the next frame and queues it for transfer with DMA, then returns without
+ * waiting for it. Only blocks if the previous transfer is still on the wire. The sensor data read by this
+ * transfer shows up in sensor_buffer at the next motor_sensor_io_poll() or motor_sensor_io_queue().
+ */
+inline void motor_sensor_io_queue() {
+  IoFrame& frame = io_frames[io_next_frame];
+  pack_motor_frame(frame.motor);
+  finish_motor_sensor_io(true);
+
+  io_start_micros = micros();
+  for (uint8_t c = 0; c < NUM_CHAINS; c++) {
+    const SpiChain& chain = SPI_CHAINS[c];
+#ifdef ESP32
+    tx_transaction[c].tx_buffer = frame.motor + chain.motor_offset;
+    rx_transaction[c].rx_buffer = frame.sensor + chain.sensor_offset;
+    io_tx_done[c] = false;
+    io_rx_done[c] = false;
+    // Nothing else shares this bus, so the driver runs these in order: the motor frame is shifted out first and
+    // then latched by spi_rx's pre_cb, just like the blocking transfers
+    ESP_ERROR_CHECK(spi_device_queue_trans(spi_tx[c], &tx_transaction[c], portMAX_DELAY));
+    ESP_ERROR_CHECK(spi_device_queue_trans(spi_rx[c], &rx_transaction[c], portMAX_DELAY));
+#else
+    sim_chains[c].beginTransfer(frame.motor + chain.motor_offset, chain.motor_length, chain.sensor_length);
+#endif
+  }
+  io_in_flight = true;
+  io_next_frame ^= 1;
+}
+
+/** Picks up the sensor data from a queued transfer if it has already completed. Never blocks. */
+inline void motor_sensor_io_poll() {
+  finish_motor_sensor_io(false);
+}
+
+/** Transfers the current frame and waits for the sensor data it reads back. */
 inline void motor_sensor_io() {
+  motor_sensor_io_queue();
+  finish_motor_sensor_io(true);
+}
+
+#else
+
+inline void motor_sensor_io() {
+  pack_motor_frame(motor_buffer);
+  io_start_micros = micros();
+
 #ifdef ESP32
     esp_err_t ret;
+
+    // Any other chains transfer in the background while the first one is polled. Their latch callbacks run from
+    // the SPI ISR even though SPI_IO_PIPELINED is off, which is why those have to be IRAM-safe.
+    for (uint8_t c = 1; c < NUM_CHAINS; c++) {
+      ESP_ERROR_CHECK(spi_device_queue_trans(spi_tx[c], &tx_transaction[c], portMAX_DELAY));
+      ESP_ERROR_CHECK(spi_device_queue_trans(spi_rx[c], &rx_transaction[c], portMAX_DELAY));
+    }
     
     // Send data
-    ret=spi_device_polling_transmit(spi_tx, &tx_transaction);
+    ret=spi_device_polling_transmit(spi_tx[0], &tx_transaction[0]);
     assert(ret==ESP_OK);
 
     // Receive data
-    ret=spi_device_polling_transmit(spi_rx, &rx_transaction);
+    ret=spi_device_polling_transmit(spi_rx[0], &rx_transaction[0]);
     assert(ret==ESP_OK);
+
+    for (uint8_t c = 1; c < NUM_CHAINS; c++) {
+      spi_transaction_t* result;
+      ESP_ERROR_CHECK(spi_device_get_trans_result(spi_tx[c], &result, portMAX_DELAY));
+      ESP_ERROR_CHECK(spi_device_get_trans_result(spi_rx[c], &result, portMAX_DELAY));
+    }
+#elif defined(SPLITFLAP_NATIVE)
+    for (uint8_t c = 0; c < NUM_CHAINS; c++) {
+      const SpiChain& chain = SPI_CHAINS[c];
+      sim_chains[c].beginTransfer(motor_buffer + chain.motor_offset, chain.motor_length, chain.sensor_length);
+    }
+    for (uint8_t c = 0; c < NUM_CHAINS; c++) {
+      sim_chains[c].endTransfer(sensor_buffer + SPI_CHAINS[c].sensor_offset);
+    }
 #else
   IN_LATCH();
   delayMicroseconds(1);
@@ -268,22 +599,38 @@ inline void motor_sensor_io() {
 
   OUT_LATCH();
 #endif
+
+  uint32_t elapsed = micros() - io_start_micros;
+  record_motor_sensor_io(elapsed, elapsed);
+  detect_home_edges();
+}
+
+inline void motor_sensor_io_queue() {
+  motor_sensor_io();
 }
 
+inline void motor_sensor_io_poll() {}
+#endif
+
 #ifdef CHAINLINK
 void chainlink_set_led(uint8_t moduleIndex, bool on) {
-  uint8_t groupPosition = moduleIndex % 6;
-  uint8_t byteIndex = MOTOR_BUFFER_LENGTH - 1 - moduleIndex/6*4 - (groupPosition < 3 ? 1 : 2);
+  const SpiChain& chain = chain_for_module(moduleIndex);
+  uint8_t j = moduleIndex - chain.first_module;
+  uint8_t groupPosition = j % 6;
+  uint8_t byteIndex = chain.motor_offset + chain.motor_length - 1 - j/6*4 - (groupPosition < 3 ? 1 : 2);
   uint8_t bitMask = (groupPosition < 3) ? (1 << (4 + groupPosition)) : (1 << (groupPosition - 3));
   if (on) {
-    motor_buffer[byteIndex] |= bitMask;
+    aux_buffer[byteIndex] |= bitMask;
   } else {
-    motor_buffer[byteIndex] &= ~bitMask;
+    aux_buffer[byteIndex] &= ~bitMask;
   }
 }
 
 static uint8_t chainlink_loopbackMotorByte(uint8_t loopbackIndex) {
-  return MOTOR_BUFFER_LENGTH - 1 - (loopbackIndex / 2) * 4 - (((loopbackIndex % 2) == 0) ? 1 : 2);
+  // Two loopbacks per Chainlink Driver
+  const SpiChain& chain = chain_for_module(loopbackIndex / 2 * 6);
+  uint8_t board = loopbackIndex / 2 - chain.first_module / 6;
+  return chain.motor_offset + chain.motor_length - 1 - board * 4 - (((loopbackIndex % 2) == 0) ? 1 : 2);
 }
 static uint8_t chainlink_loopbackMotorBitMask(uint8_t loopbackIndex) {
   return (loopbackIndex % 2) == 0 ? (1 << 7) : (1 << 3);
@@ -299,7 +646,8 @@ bool chainlink_test_startup_loopback(bool results[NUM_LOOPBACKS]) {
     bool success = true;
 
     // Turn off all motors, leds, and loopbacks; make sure all loopback inputs read 0
-    memset(motor_buffer, 0, MOTOR_BUFFER_LENGTH);
+    memset(aux_buffer, 0, MOTOR_BUFFER_LENGTH);
+    memset(motion_engine.motor_coils, 0, NUM_MODULES);
     motor_sensor_io();
     motor_sensor_io();
 
@@ -312,7 +660,7 @@ bool chainlink_test_startup_loopback(bool results[NUM_LOOPBACKS]) {
 
 void chainlink_set_loopback(uint8_t loop_out_index) {
     // Turn on loopback output
-    motor_buffer[chainlink_loopbackMotorByte(loop_out_index)] |= chainlink_loopbackMotorBitMask(loop_out_index);
+    aux_buffer[chainlink_loopbackMotorByte(loop_out_index)] |= chainlink_loopbackMotorBitMask(loop_out_index);
 }
 
 /**
@@ -334,7 +682,7 @@ bool chainlink_validate_loopback(uint8_t loop_out_index, bool results[NUM_LOOPBA
     }
 
     // Turn off loopback output
-    motor_buffer[chainlink_loopbackMotorByte(loop_out_index)] &= ~chainlink_loopbackMotorBitMask(loop_out_index);
+    aux_buffer[chainlink_loopbackMotorByte(loop_out_index)] &= ~chainlink_loopbackMotorBitMask(loop_out_index);
     return success;
 }
 
@@ -0,0 +1,153 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#pragma once
+
+#include <Arduino.h>
+
+#include "acceleration.h"
+
+#if defined(ESP32) && !defined(SPLITFLAP_NATIVE)
+#include <esp_timer.h>
+#endif
+
+struct StepPeriodStats {
+    uint32_t count;
+    uint64_t total_micros;
+    uint32_t max_micros;
+};
+
+/**
+ * Deadline-based timing for the motion loop.
+ *
+ * Each pass samples the clock once (rather than every module calling micros()), modules report when they next
+ * need to be serviced, and the loop then sleeps until the earliest of those deadlines instead of busy-polling.
+ * On ESP32 the sleep uses a one-shot esp_timer that notifies the motion task; elsewhere it falls back to
+ * delayMicroseconds().
+ *
+ * Also accumulates the achieved period between consecutive steps of a module, per acceleration step, so the
+ * ACCEL_STEP_PERIODS table can be checked against what the loop actually delivers.
+ */
+class StepScheduler {
+    public:
+        // Deadlines closer than this are busy-waited, since arming a timer and switching tasks costs about as much
+        static const uint32_t MIN_SLEEP_MICROS = 100;
+        // Wake up this much before the deadline to absorb timer dispatch and context switch latency
+        static const uint32_t WAKE_EARLY_MICROS = 40;
+
+        StepScheduler() {}
+
+        ~StepScheduler() {
+#if defined(ESP32) && !defined(SPLITFLAP_NATIVE)
+            if (timer_ != nullptr) {
+                esp_timer_stop(timer_);
+                esp_timer_delete(timer_);
+            }
+#endif
+        }
+
+        /**
+         * Must be called from the task that will call waitForNextDeadline(), which is the task that gets
+         * woken by the timer.
+         */
+        void begin() {
+#if defined(ESP32) && !defined(SPLITFLAP_NATIVE)
+            esp_timer_create_args_t args = {};
+            args.callback = &StepScheduler::onTimer;
+            args.arg = xTaskGetCurrentTaskHandle();
+            args.dispatch_method = ESP_TIMER_TASK;
+            args.name = "step_scheduler";
+            ESP_ERROR_CHECK(esp_timer_create(&args, &timer_));
+#endif
+            resetStats();
+        }
+
+        /** Samples the clock for this pass. If no module schedules anything sooner, the next pass is an idle poll. */
+        void beginPass() {
+            now_ = micros();
+            next_deadline_ = now_ + Acceleration::ACCEL_STEP_PERIODS[0];
+        }
+
+        uint32_t now() const {
+            return now_;
+        }
+
+        void schedule(uint32_t deadline) {
+            if ((int32_t)(deadline - next_deadline_) < 0) {
+                next_deadline_ = deadline;
+            }
+        }
+
+        uint32_t nextDeadline() const {
+            return next_deadline_;
+        }
+
+        /** Records the time between two consecutive steps of a module that was moving at `accel_step`. */
+        void recordStep(uint8_t accel_step, uint32_t achieved_micros) {
+            StepPeriodStats& s = stats_[accel_step];
+            s.count++;
+            s.total_micros += achieved_micros;
+            if (achieved_micros > s.max_micros) {
+                s.max_micros = achieved_micros;
+            }
+        }
+
+        const StepPeriodStats& stats(uint8_t accel_step) const {
+            return stats_[accel_step];
+        }
+
+        void resetStats() {
+            memset(stats_, 0, sizeof(stats_));
+        }
+
+        /**
+         * Blocks until the earliest scheduled deadline. On ESP32 this returns early if the task is notified
+         * (e.g. because a new command was queued).
+         */
+        void waitForNextDeadline() {
+            int32_t remaining = (int32_t)(next_deadline_ - micros());
+            if (remaining <= 0) {
+                return;
+            }
+#if defined(ESP32) && !defined(SPLITFLAP_NATIVE)
+            if ((uint32_t)remaining > MIN_SLEEP_MICROS) {
+                ESP_ERROR_CHECK(esp_timer_start_once(timer_, remaining - WAKE_EARLY_MICROS));
+                ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+                // Stop the timer in case we were woken by something else; it's fine if it already fired
+                esp_timer_stop(timer_);
+                if ((int32_t)(next_deadline_ - micros()) > (int32_t)WAKE_EARLY_MICROS) {
+                    // Woken early (e.g. by a new command), so let the caller run a pass now
+                    return;
+                }
+            }
+            while ((int32_t)(next_deadline_ - micros()) > 0) {}
+#else
+            delayMicroseconds(remaining);
+#endif
+        }
+
+    private:
+        uint32_t now_ = 0;
+        uint32_t next_deadline_ = 0;
+        StepPeriodStats stats_[Acceleration::MAX_ACCEL_STEP + 1] = {};
+
+#if defined(ESP32) && !defined(SPLITFLAP_NATIVE)
+        esp_timer_handle_t timer_ = nullptr;
+
+        static void onTimer(void* arg) {
+            xTaskNotifyGive((TaskHandle_t)arg);
+        }
+#endif
+};
@@ -16,6 +16,7 @@
 from pathlib import Path
 
 import os
+import re
 import shutil
 import subprocess
 import sys
@@ -34,7 +35,16 @@ def run():
         exit(1)
 
     nanopb_generator_path = nanopb_path / 'generator' / 'nanopb_generator.py'
-    c_generated_output_path = REPO_ROOT / 'arduino' / 'splitflap' / 'esp32' / 'proto_gen'
+
+    # The generated field descriptors must match the nanopb runtime the firmware is built against, so only
+    # generate with the same version as the library pinned in platformio.ini
+    pinned_version = re.search(r'nanopb/Nanopb\s*@\s*([\d.]+)', (REPO_ROOT / 'platformio.ini').read_text()).group(1)
+    generator_version = re.search(r'nanopb_version\s*=\s*"nanopb-([^"]+)"', nanopb_generator_path.read_text()).group(1)
+    if generator_version != pinned_version:
+        print(f'Nanopb checkout is version {generator_version}, but platformio.ini uses {pinned_version}! Check out the matching tag in {nanopb_path}', file=sys.stderr)
+        exit(1)
+
+    c_generated_output_path = REPO_ROOT / 'firmware' / 'esp32' / 'proto_gen'
     
     proto_files = [f for f in os.listdir(proto_path) if f.endswith('.proto')]
     assert len(proto_files) > 0, 'No proto files found!'
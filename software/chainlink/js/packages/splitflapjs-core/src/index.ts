@@ -89,6 +89,13 @@ export class SplitflapCore {
         this.sendModuleCommand(position, PB.SplitflapCommand.ModuleCommand.create({action: PB.SplitflapCommand.ModuleCommand.Action.SET_OFFSET}))
     }
 
+    /**
+     * Switch a module to a slower (or back to the default, 0) motion profile. Saved by saveAllOffsets().
+     */
+    public setMotionProfile(position: number, profile: number): void {
+        this.sendModuleCommand(position, PB.SplitflapCommand.ModuleCommand.create({action: PB.SplitflapCommand.ModuleCommand.Action.SET_MOTION_PROFILE, param: profile}))
+    }
+
     /**
      * Perform a hard reset of the splitflap MCU. May take a few seconds.
      */
@@ -97,6 +104,8 @@ export class SplitflapCore {
     }
 
     protected onStart() {
+        // A lone 0 switches the firmware from the legacy protocol, and ends any partial frame it's in the middle of
+        this.sendBytes(Uint8Array.of(0))
         this.enqueueMessage(PB.ToSplitflap.create({
             requestState: PB.RequestState.create(),
         }))
@@ -44,6 +44,12 @@ export const applyResetModule = (config: PB.SplitflapConfig, position: number):
     return applyResetModules(config, reset)
 }
 
+export const applySynchronizedArrival = (config: PB.SplitflapConfig, synchronizedArrival: boolean): PB.SplitflapConfig => {
+    const newConfig = PB.SplitflapConfig.create(config)
+    newConfig.synchronizedArrival = synchronizedArrival
+    return newConfig
+}
+
 export function convert2dDualRowZigZagTo1dChainlink<T>(arr: T[][], flipFirstRows = false): T[] {
     const cols = arr[0].length
     const rows = arr.length
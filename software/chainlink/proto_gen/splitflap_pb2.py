@@ -1,10 +1,10 @@
 # -*- coding: utf-8 -*-
 # Generated by the protocol buffer compiler.  DO NOT EDIT!
 # source: splitflap.proto
-
+"""Generated protocol buffer code."""
+from google.protobuf.internal import builder as _builder
 from google.protobuf import descriptor as _descriptor
-from google.protobuf import message as _message
-from google.protobuf import reflection as _reflection
+from google.protobuf import descriptor_pool as _descriptor_pool
 from google.protobuf import symbol_database as _symbol_database
 # @@protoc_insertion_point(imports)
 
@@ -14,1168 +14,135 @@ _sym_db = _symbol_database.Default()
 import nanopb_pb2 as nanopb__pb2
 
 
-DESCRIPTOR = _descriptor.FileDescriptor(
-  name='splitflap.proto',
-  package='PB',
-  syntax='proto3',
-  serialized_options=None,
-  create_key=_descriptor._internal_create_key,
-  serialized_pb=b'\n\x0fsplitflap.proto\x12\x02PB\x1a\x0cnanopb.proto\"\x84\x03\n\x0eSplitflapState\x12\x37\n\x07modules\x18\x01 \x03(\x0b\x32\x1e.PB.SplitflapState.ModuleStateB\x06\x92?\x03\x10\xff\x01\x12\x14\n\x0cloopbacks_ok\x18\x02 \x01(\x08\x1a\xa2\x02\n\x0bModuleState\x12\x33\n\x05state\x18\x01 \x01(\x0e\x32$.PB.SplitflapState.ModuleState.State\x12\x19\n\nflap_index\x18\x02 \x01(\rB\x05\x92?\x02\x38\x08\x12\x0e\n\x06moving\x18\x03 \x01(\x08\x12\x12\n\nhome_state\x18\x04 \x01(\x08\x12$\n\x15\x63ount_unexpected_home\x18\x05 \x01(\rB\x05\x92?\x02\x38\x08\x12 \n\x11\x63ount_missed_home\x18\x06 \x01(\rB\x05\x92?\x02\x38\x08\"W\n\x05State\x12\n\n\x06NORMAL\x10\x00\x12\x11\n\rLOOK_FOR_HOME\x10\x01\x12\x10\n\x0cSENSOR_ERROR\x10\x02\x12\t\n\x05PANIC\x10\x03\x12\x12\n\x0eSTATE_DISABLED\x10\x04\"\x1a\n\x03Log\x12\x13\n\x03msg\x18\x01 \x01(\tB\x06\x92?\x03p\xff\x01\"\x14\n\x03\x41\x63k\x12\r\n\x05nonce\x18\x01 \x01(\r\"\xa4\x05\n\x0fSupervisorState\x12\x15\n\ruptime_millis\x18\x01 \x01(\r\x12(\n\x05state\x18\x02 \x01(\x0e\x32\x19.PB.SupervisorState.State\x12\x44\n\x0epower_channels\x18\x03 \x03(\x0b\x32%.PB.SupervisorState.PowerChannelStateB\x05\x92?\x02\x10\x05\x12\x31\n\nfault_info\x18\x04 \x01(\x0b\x32\x1d.PB.SupervisorState.FaultInfo\x1aL\n\x11PowerChannelState\x12\x15\n\rvoltage_volts\x18\x01 \x01(\x02\x12\x14\n\x0c\x63urrent_amps\x18\x02 \x01(\x02\x12\n\n\x02on\x18\x03 \x01(\x08\x1a\x81\x02\n\tFaultInfo\x12\x35\n\x04type\x18\x01 \x01(\x0e\x32\'.PB.SupervisorState.FaultInfo.FaultType\x12\x13\n\x03msg\x18\x02 \x01(\tB\x06\x92?\x03p\xff\x01\x12\x11\n\tts_millis\x18\x03 \x01(\r\"\x94\x01\n\tFaultType\x12\x0b\n\x07UNKNOWN\x10\x00\x12\x08\n\x04NONE\x10\x01\x12\x1e\n\x1aINRUSH_CURRENT_NOT_SETTLED\x10\x02\x12\x16\n\x12SPLITFLAP_SHUTDOWN\x10\x03\x12\x10\n\x0cOUT_OF_RANGE\x10\x04\x12\x10\n\x0cOVER_CURRENT\x10\x05\x12\x14\n\x10UNEXPECTED_POWER\x10\x06\"\x84\x01\n\x05State\x12\x0b\n\x07UNKNOWN\x10\x00\x12\x1b\n\x17STARTING_VERIFY_PSU_OFF\x10\x01\x12\x1c\n\x18STARTING_VERIFY_VOLTAGES\x10\x02\x12\x1c\n\x18STARTING_ENABLE_CHANNELS\x10\x03\x12\n\n\x06NORMAL\x10\x04\x12\t\n\x05\x46\x41ULT\x10\x05\"\xfa\x01\n\x0cGeneralState\x12&\n\x17serial_protocol_version\x18\x01 \x01(\rB\x05\x92?\x02\x38\x10\x12\x15\n\ruptime_millis\x18\x02 \x01(\r\x12.\n\nbuild_info\x18\x03 \x01(\x0b\x32\x1a.PB.GeneralState.BuildInfo\x12!\n\x12\x66lap_character_set\x18\x04 \x01(\x0c\x42\x05\x92?\x02\x08P\x1aX\n\tBuildInfo\x12\x17\n\x08git_hash\x18\x01 \x01(\tB\x05\x92?\x02pZ\x12\x19\n\nbuild_date\x18\x02 \x01(\tB\x05\x92?\x02p\x0c\x12\x17\n\x08\x62uild_os\x18\x03 \x01(\tB\x05\x92?\x02p\x0c\"\xd5\x01\n\rFromSplitflap\x12-\n\x0fsplitflap_state\x18\x01 \x01(\x0b\x32\x12.PB.SplitflapStateH\x00\x12\x16\n\x03log\x18\x02 \x01(\x0b\x32\x07.PB.LogH\x00\x12\x16\n\x03\x61\x63k\x18\x03 \x01(\x0b\x32\x07.PB.AckH\x00\x12/\n\x10supervisor_state\x18\x04 \x01(\x0b\x32\x13.PB.SupervisorStateH\x00\x12)\n\rgeneral_state\x18\x05 \x01(\x0b\x32\x10.PB.GeneralStateH\x00\x42\t\n\x07payload\"\xca\x02\n\x10SplitflapCommand\x12;\n\x07modules\x18\x02 \x03(\x0b\x32\".PB.SplitflapCommand.ModuleCommandB\x06\x92?\x03\x10\xff\x01\x12\x18\n\x10save_all_offsets\x18\x03 \x01(\x08\x1a\xde\x01\n\rModuleCommand\x12\x39\n\x06\x61\x63tion\x18\x01 \x01(\x0e\x32).PB.SplitflapCommand.ModuleCommand.Action\x12\x14\n\x05param\x18\x02 \x01(\rB\x05\x92?\x02\x38\x08\"|\n\x06\x41\x63tion\x12\t\n\x05NO_OP\x10\x00\x12\x0e\n\nGO_TO_FLAP\x10\x01\x12\x12\n\x0eRESET_AND_HOME\x10\x02\x12\x19\n\x15INCREASE_OFFSET_TENTH\x10Z\x12\x18\n\x14INCREASE_OFFSET_HALF\x10[\x12\x0e\n\nSET_OFFSET\x10\\\"\xb9\x01\n\x0fSplitflapConfig\x12\x39\n\x07modules\x18\x01 \x03(\x0b\x32 .PB.SplitflapConfig.ModuleConfigB\x06\x92?\x03\x10\xff\x01\x1ak\n\x0cModuleConfig\x12 \n\x11target_flap_index\x18\x01 \x01(\rB\x05\x92?\x02\x38\x08\x12\x1d\n\x0emovement_nonce\x18\x02 \x01(\rB\x05\x92?\x02\x38\x08\x12\x1a\n\x0breset_nonce\x18\x03 \x01(\rB\x05\x92?\x02\x38\x08\"\x0e\n\x0cRequestState\"\xb6\x01\n\x0bToSplitflap\x12\r\n\x05nonce\x18\x01 \x01(\r\x12\x31\n\x11splitflap_command\x18\x02 \x01(\x0b\x32\x14.PB.SplitflapCommandH\x00\x12/\n\x10splitflap_config\x18\x03 \x01(\x0b\x32\x13.PB.SplitflapConfigH\x00\x12)\n\rrequest_state\x18\x04 \x01(\x0b\x32\x10.PB.RequestStateH\x00\x42\t\n\x07payload\"g\n\x17PersistentConfiguration\x12\x0f\n\x07version\x18\x01 \x01(\r\x12\x11\n\tnum_flaps\x18\x02 \x01(\r\x12(\n\x13module_offset_steps\x18\x03 \x03(\rB\x0b\x92?\x03\x10\xff\x01\x92?\x02\x38\x10\x62\x06proto3'
-  ,
-  dependencies=[nanopb__pb2.DESCRIPTOR,])
-
-
-
-_SPLITFLAPSTATE_MODULESTATE_STATE = _descriptor.EnumDescriptor(
-  name='State',
-  full_name='PB.SplitflapState.ModuleState.State',
-  filename=None,
-  file=DESCRIPTOR,
-  create_key=_descriptor._internal_create_key,
-  values=[
-    _descriptor.EnumValueDescriptor(
-      name='NORMAL', index=0, number=0,
-      serialized_options=None,
-      type=None,
-      create_key=_descriptor._internal_create_key),
-    _descriptor.EnumValueDescriptor(
-      name='LOOK_FOR_HOME', index=1, number=1,
-      serialized_options=None,
-      type=None,
-      create_key=_descriptor._internal_create_key),
-    _descriptor.EnumValueDescriptor(
-      name='SENSOR_ERROR', index=2, number=2,
-      serialized_options=None,
-      type=None,
-      create_key=_descriptor._internal_create_key),
-    _descriptor.EnumValueDescriptor(
-      name='PANIC', index=3, number=3,
-      serialized_options=None,
-      type=None,
-      create_key=_descriptor._internal_create_key),
-    _descriptor.EnumValueDescriptor(
-      name='STATE_DISABLED', index=4, number=4,
-      serialized_options=None,
-      type=None,
-      create_key=_descriptor._internal_create_key),
-  ],
-  containing_type=None,
-  serialized_options=None,
-  serialized_start=339,
-  serialized_end=426,
-)
-_sym_db.RegisterEnumDescriptor(_SPLITFLAPSTATE_MODULESTATE_STATE)
-
-_SUPERVISORSTATE_FAULTINFO_FAULTTYPE = _descriptor.EnumDescriptor(
-  name='FaultType',
-  full_name='PB.SupervisorState.FaultInfo.FaultType',
-  filename=None,
-  file=DESCRIPTOR,
-  create_key=_descriptor._internal_create_key,
-  values=[
-    _descriptor.EnumValueDescriptor(
-      name='UNKNOWN', index=0, number=0,
-      serialized_options=None,
-      type=None,
-      create_key=_descriptor._internal_create_key),
-    _descriptor.EnumValueDescriptor(
-      name='NONE', index=1, number=1,
-      serialized_options=None,
-      type=None,
-      create_key=_descriptor._internal_create_key),
-    _descriptor.EnumValueDescriptor(
-      name='INRUSH_CURRENT_NOT_SETTLED', index=2, number=2,
-      serialized_options=None,
-      type=None,
-      create_key=_descriptor._internal_create_key),
-    _descriptor.EnumValueDescriptor(
-      name='SPLITFLAP_SHUTDOWN', index=3, number=3,
-      serialized_options=None,
-      type=None,
-      create_key=_descriptor._internal_create_key),
-    _descriptor.EnumValueDescriptor(
-      name='OUT_OF_RANGE', index=4, number=4,
-      serialized_options=None,
-      type=None,
-      create_key=_descriptor._internal_create_key),
-    _descriptor.EnumValueDescriptor(
-      name='OVER_CURRENT', index=5, number=5,
-      serialized_options=None,
-      type=None,
-      create_key=_descriptor._internal_create_key),
-    _descriptor.EnumValueDescriptor(
-      name='UNEXPECTED_POWER', index=6, number=6,
-      serialized_options=None,
-      type=None,
-      create_key=_descriptor._internal_create_key),
-  ],
-  containing_type=None,
-  serialized_options=None,
-  serialized_start=872,
-  serialized_end=1020,
-)
-_sym_db.RegisterEnumDescriptor(_SUPERVISORSTATE_FAULTINFO_FAULTTYPE)
-
-_SUPERVISORSTATE_STATE = _descriptor.EnumDescriptor(
-  name='State',
-  full_name='PB.SupervisorState.State',
-  filename=None,
-  file=DESCRIPTOR,
-  create_key=_descriptor._internal_create_key,
-  values=[
-    _descriptor.EnumValueDescriptor(
-      name='UNKNOWN', index=0, number=0,
-      serialized_options=None,
-      type=None,
-      create_key=_descriptor._internal_create_key),
-    _descriptor.EnumValueDescriptor(
-      name='STARTING_VERIFY_PSU_OFF', index=1, number=1,
-      serialized_options=None,
-      type=None,
-      create_key=_descriptor._internal_create_key),
-    _descriptor.EnumValueDescriptor(
-      name='STARTING_VERIFY_VOLTAGES', index=2, number=2,
-      serialized_options=None,
-      type=None,
-      create_key=_descriptor._internal_create_key),
-    _descriptor.EnumValueDescriptor(
-      name='STARTING_ENABLE_CHANNELS', index=3, number=3,
-      serialized_options=None,
-      type=None,
-      create_key=_descriptor._internal_create_key),
-    _descriptor.EnumValueDescriptor(
-      name='NORMAL', index=4, number=4,
-      serialized_options=None,
-      type=None,
-      create_key=_descriptor._internal_create_key),
-    _descriptor.EnumValueDescriptor(
-      name='FAULT', index=5, number=5,
-      serialized_options=None,
-      type=None,
-      create_key=_descriptor._internal_create_key),
-  ],
-  containing_type=None,
-  serialized_options=None,
-  serialized_start=1023,
-  serialized_end=1155,
-)
-_sym_db.RegisterEnumDescriptor(_SUPERVISORSTATE_STATE)
-
-_SPLITFLAPCOMMAND_MODULECOMMAND_ACTION = _descriptor.EnumDescriptor(
-  name='Action',
-  full_name='PB.SplitflapCommand.ModuleCommand.Action',
-  filename=None,
-  file=DESCRIPTOR,
-  create_key=_descriptor._internal_create_key,
-  values=[
-    _descriptor.EnumValueDescriptor(
-      name='NO_OP', index=0, number=0,
-      serialized_options=None,
-      type=None,
-      create_key=_descriptor._internal_create_key),
-    _descriptor.EnumValueDescriptor(
-      name='GO_TO_FLAP', index=1, number=1,
-      serialized_options=None,
-      type=None,
-      create_key=_descriptor._internal_create_key),
-    _descriptor.EnumValueDescriptor(
-      name='RESET_AND_HOME', index=2, number=2,
-      serialized_options=None,
-      type=None,
-      create_key=_descriptor._internal_create_key),
-    _descriptor.EnumValueDescriptor(
-      name='INCREASE_OFFSET_TENTH', index=3, number=90,
-      serialized_options=None,
-      type=None,
-      create_key=_descriptor._internal_create_key),
-    _descriptor.EnumValueDescriptor(
-      name='INCREASE_OFFSET_HALF', index=4, number=91,
-      serialized_options=None,
-      type=None,
-      create_key=_descriptor._internal_create_key),
-    _descriptor.EnumValueDescriptor(
-      name='SET_OFFSET', index=5, number=92,
-      serialized_options=None,
-      type=None,
-      create_key=_descriptor._internal_create_key),
-  ],
-  containing_type=None,
-  serialized_options=None,
-  serialized_start=1833,
-  serialized_end=1957,
-)
-_sym_db.RegisterEnumDescriptor(_SPLITFLAPCOMMAND_MODULECOMMAND_ACTION)
-
-
-_SPLITFLAPSTATE_MODULESTATE = _descriptor.Descriptor(
-  name='ModuleState',
-  full_name='PB.SplitflapState.ModuleState',
-  filename=None,
-  file=DESCRIPTOR,
-  containing_type=None,
-  create_key=_descriptor._internal_create_key,
-  fields=[
-    _descriptor.FieldDescriptor(
-      name='state', full_name='PB.SplitflapState.ModuleState.state', index=0,
-      number=1, type=14, cpp_type=8, label=1,
-      has_default_value=False, default_value=0,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=None, file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-    _descriptor.FieldDescriptor(
-      name='flap_index', full_name='PB.SplitflapState.ModuleState.flap_index', index=1,
-      number=2, type=13, cpp_type=3, label=1,
-      has_default_value=False, default_value=0,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=b'\222?\0028\010', file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-    _descriptor.FieldDescriptor(
-      name='moving', full_name='PB.SplitflapState.ModuleState.moving', index=2,
-      number=3, type=8, cpp_type=7, label=1,
-      has_default_value=False, default_value=False,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=None, file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-    _descriptor.FieldDescriptor(
-      name='home_state', full_name='PB.SplitflapState.ModuleState.home_state', index=3,
-      number=4, type=8, cpp_type=7, label=1,
-      has_default_value=False, default_value=False,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=None, file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-    _descriptor.FieldDescriptor(
-      name='count_unexpected_home', full_name='PB.SplitflapState.ModuleState.count_unexpected_home', index=4,
-      number=5, type=13, cpp_type=3, label=1,
-      has_default_value=False, default_value=0,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=b'\222?\0028\010', file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-    _descriptor.FieldDescriptor(
-      name='count_missed_home', full_name='PB.SplitflapState.ModuleState.count_missed_home', index=5,
-      number=6, type=13, cpp_type=3, label=1,
-      has_default_value=False, default_value=0,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=b'\222?\0028\010', file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-  ],
-  extensions=[
-  ],
-  nested_types=[],
-  enum_types=[
-    _SPLITFLAPSTATE_MODULESTATE_STATE,
-  ],
-  serialized_options=None,
-  is_extendable=False,
-  syntax='proto3',
-  extension_ranges=[],
-  oneofs=[
-  ],
-  serialized_start=136,
-  serialized_end=426,
-)
-
-_SPLITFLAPSTATE = _descriptor.Descriptor(
-  name='SplitflapState',
-  full_name='PB.SplitflapState',
-  filename=None,
-  file=DESCRIPTOR,
-  containing_type=None,
-  create_key=_descriptor._internal_create_key,
-  fields=[
-    _descriptor.FieldDescriptor(
-      name='modules', full_name='PB.SplitflapState.modules', index=0,
-      number=1, type=11, cpp_type=10, label=3,
-      has_default_value=False, default_value=[],
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=b'\222?\003\020\377\001', file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-    _descriptor.FieldDescriptor(
-      name='loopbacks_ok', full_name='PB.SplitflapState.loopbacks_ok', index=1,
-      number=2, type=8, cpp_type=7, label=1,
-      has_default_value=False, default_value=False,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=None, file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-  ],
-  extensions=[
-  ],
-  nested_types=[_SPLITFLAPSTATE_MODULESTATE, ],
-  enum_types=[
-  ],
-  serialized_options=None,
-  is_extendable=False,
-  syntax='proto3',
-  extension_ranges=[],
-  oneofs=[
-  ],
-  serialized_start=38,
-  serialized_end=426,
-)
-
-
-_LOG = _descriptor.Descriptor(
-  name='Log',
-  full_name='PB.Log',
-  filename=None,
-  file=DESCRIPTOR,
-  containing_type=None,
-  create_key=_descriptor._internal_create_key,
-  fields=[
-    _descriptor.FieldDescriptor(
-      name='msg', full_name='PB.Log.msg', index=0,
-      number=1, type=9, cpp_type=9, label=1,
-      has_default_value=False, default_value=b"".decode('utf-8'),
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=b'\222?\003p\377\001', file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-  ],
-  extensions=[
-  ],
-  nested_types=[],
-  enum_types=[
-  ],
-  serialized_options=None,
-  is_extendable=False,
-  syntax='proto3',
-  extension_ranges=[],
-  oneofs=[
-  ],
-  serialized_start=428,
-  serialized_end=454,
-)
-
-
-_ACK = _descriptor.Descriptor(
-  name='Ack',
-  full_name='PB.Ack',
-  filename=None,
-  file=DESCRIPTOR,
-  containing_type=None,
-  create_key=_descriptor._internal_create_key,
-  fields=[
-    _descriptor.FieldDescriptor(
-      name='nonce', full_name='PB.Ack.nonce', index=0,
-      number=1, type=13, cpp_type=3, label=1,
-      has_default_value=False, default_value=0,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=None, file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-  ],
-  extensions=[
-  ],
-  nested_types=[],
-  enum_types=[
-  ],
-  serialized_options=None,
-  is_extendable=False,
-  syntax='proto3',
-  extension_ranges=[],
-  oneofs=[
-  ],
-  serialized_start=456,
-  serialized_end=476,
-)
-
-
-_SUPERVISORSTATE_POWERCHANNELSTATE = _descriptor.Descriptor(
-  name='PowerChannelState',
-  full_name='PB.SupervisorState.PowerChannelState',
-  filename=None,
-  file=DESCRIPTOR,
-  containing_type=None,
-  create_key=_descriptor._internal_create_key,
-  fields=[
-    _descriptor.FieldDescriptor(
-      name='voltage_volts', full_name='PB.SupervisorState.PowerChannelState.voltage_volts', index=0,
-      number=1, type=2, cpp_type=6, label=1,
-      has_default_value=False, default_value=float(0),
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=None, file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-    _descriptor.FieldDescriptor(
-      name='current_amps', full_name='PB.SupervisorState.PowerChannelState.current_amps', index=1,
-      number=2, type=2, cpp_type=6, label=1,
-      has_default_value=False, default_value=float(0),
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=None, file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-    _descriptor.FieldDescriptor(
-      name='on', full_name='PB.SupervisorState.PowerChannelState.on', index=2,
-      number=3, type=8, cpp_type=7, label=1,
-      has_default_value=False, default_value=False,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=None, file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-  ],
-  extensions=[
-  ],
-  nested_types=[],
-  enum_types=[
-  ],
-  serialized_options=None,
-  is_extendable=False,
-  syntax='proto3',
-  extension_ranges=[],
-  oneofs=[
-  ],
-  serialized_start=684,
-  serialized_end=760,
-)
-
-_SUPERVISORSTATE_FAULTINFO = _descriptor.Descriptor(
-  name='FaultInfo',
-  full_name='PB.SupervisorState.FaultInfo',
-  filename=None,
-  file=DESCRIPTOR,
-  containing_type=None,
-  create_key=_descriptor._internal_create_key,
-  fields=[
-    _descriptor.FieldDescriptor(
-      name='type', full_name='PB.SupervisorState.FaultInfo.type', index=0,
-      number=1, type=14, cpp_type=8, label=1,
-      has_default_value=False, default_value=0,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=None, file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-    _descriptor.FieldDescriptor(
-      name='msg', full_name='PB.SupervisorState.FaultInfo.msg', index=1,
-      number=2, type=9, cpp_type=9, label=1,
-      has_default_value=False, default_value=b"".decode('utf-8'),
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=b'\222?\003p\377\001', file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-    _descriptor.FieldDescriptor(
-      name='ts_millis', full_name='PB.SupervisorState.FaultInfo.ts_millis', index=2,
-      number=3, type=13, cpp_type=3, label=1,
-      has_default_value=False, default_value=0,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=None, file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-  ],
-  extensions=[
-  ],
-  nested_types=[],
-  enum_types=[
-    _SUPERVISORSTATE_FAULTINFO_FAULTTYPE,
-  ],
-  serialized_options=None,
-  is_extendable=False,
-  syntax='proto3',
-  extension_ranges=[],
-  oneofs=[
-  ],
-  serialized_start=763,
-  serialized_end=1020,
-)
-
-_SUPERVISORSTATE = _descriptor.Descriptor(
-  name='SupervisorState',
-  full_name='PB.SupervisorState',
-  filename=None,
-  file=DESCRIPTOR,
-  containing_type=None,
-  create_key=_descriptor._internal_create_key,
-  fields=[
-    _descriptor.FieldDescriptor(
-      name='uptime_millis', full_name='PB.SupervisorState.uptime_millis', index=0,
-      number=1, type=13, cpp_type=3, label=1,
-      has_default_value=False, default_value=0,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=None, file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-    _descriptor.FieldDescriptor(
-      name='state', full_name='PB.SupervisorState.state', index=1,
-      number=2, type=14, cpp_type=8, label=1,
-      has_default_value=False, default_value=0,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=None, file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-    _descriptor.FieldDescriptor(
-      name='power_channels', full_name='PB.SupervisorState.power_channels', index=2,
-      number=3, type=11, cpp_type=10, label=3,
-      has_default_value=False, default_value=[],
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=b'\222?\002\020\005', file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-    _descriptor.FieldDescriptor(
-      name='fault_info', full_name='PB.SupervisorState.fault_info', index=3,
-      number=4, type=11, cpp_type=10, label=1,
-      has_default_value=False, default_value=None,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=None, file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-  ],
-  extensions=[
-  ],
-  nested_types=[_SUPERVISORSTATE_POWERCHANNELSTATE, _SUPERVISORSTATE_FAULTINFO, ],
-  enum_types=[
-    _SUPERVISORSTATE_STATE,
-  ],
-  serialized_options=None,
-  is_extendable=False,
-  syntax='proto3',
-  extension_ranges=[],
-  oneofs=[
-  ],
-  serialized_start=479,
-  serialized_end=1155,
-)
-
-
-_GENERALSTATE_BUILDINFO = _descriptor.Descriptor(
-  name='BuildInfo',
-  full_name='PB.GeneralState.BuildInfo',
-  filename=None,
-  file=DESCRIPTOR,
-  containing_type=None,
-  create_key=_descriptor._internal_create_key,
-  fields=[
-    _descriptor.FieldDescriptor(
-      name='git_hash', full_name='PB.GeneralState.BuildInfo.git_hash', index=0,
-      number=1, type=9, cpp_type=9, label=1,
-      has_default_value=False, default_value=b"".decode('utf-8'),
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=b'\222?\002pZ', file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-    _descriptor.FieldDescriptor(
-      name='build_date', full_name='PB.GeneralState.BuildInfo.build_date', index=1,
-      number=2, type=9, cpp_type=9, label=1,
-      has_default_value=False, default_value=b"".decode('utf-8'),
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=b'\222?\002p\014', file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-    _descriptor.FieldDescriptor(
-      name='build_os', full_name='PB.GeneralState.BuildInfo.build_os', index=2,
-      number=3, type=9, cpp_type=9, label=1,
-      has_default_value=False, default_value=b"".decode('utf-8'),
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=b'\222?\002p\014', file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-  ],
-  extensions=[
-  ],
-  nested_types=[],
-  enum_types=[
-  ],
-  serialized_options=None,
-  is_extendable=False,
-  syntax='proto3',
-  extension_ranges=[],
-  oneofs=[
-  ],
-  serialized_start=1320,
-  serialized_end=1408,
-)
-
-_GENERALSTATE = _descriptor.Descriptor(
-  name='GeneralState',
-  full_name='PB.GeneralState',
-  filename=None,
-  file=DESCRIPTOR,
-  containing_type=None,
-  create_key=_descriptor._internal_create_key,
-  fields=[
-    _descriptor.FieldDescriptor(
-      name='serial_protocol_version', full_name='PB.GeneralState.serial_protocol_version', index=0,
-      number=1, type=13, cpp_type=3, label=1,
-      has_default_value=False, default_value=0,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=b'\222?\0028\020', file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-    _descriptor.FieldDescriptor(
-      name='uptime_millis', full_name='PB.GeneralState.uptime_millis', index=1,
-      number=2, type=13, cpp_type=3, label=1,
-      has_default_value=False, default_value=0,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=None, file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-    _descriptor.FieldDescriptor(
-      name='build_info', full_name='PB.GeneralState.build_info', index=2,
-      number=3, type=11, cpp_type=10, label=1,
-      has_default_value=False, default_value=None,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=None, file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-    _descriptor.FieldDescriptor(
-      name='flap_character_set', full_name='PB.GeneralState.flap_character_set', index=3,
-      number=4, type=12, cpp_type=9, label=1,
-      has_default_value=False, default_value=b"",
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=b'\222?\002\010P', file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-  ],
-  extensions=[
-  ],
-  nested_types=[_GENERALSTATE_BUILDINFO, ],
-  enum_types=[
-  ],
-  serialized_options=None,
-  is_extendable=False,
-  syntax='proto3',
-  extension_ranges=[],
-  oneofs=[
-  ],
-  serialized_start=1158,
-  serialized_end=1408,
-)
-
-
-_FROMSPLITFLAP = _descriptor.Descriptor(
-  name='FromSplitflap',
-  full_name='PB.FromSplitflap',
-  filename=None,
-  file=DESCRIPTOR,
-  containing_type=None,
-  create_key=_descriptor._internal_create_key,
-  fields=[
-    _descriptor.FieldDescriptor(
-      name='splitflap_state', full_name='PB.FromSplitflap.splitflap_state', index=0,
-      number=1, type=11, cpp_type=10, label=1,
-      has_default_value=False, default_value=None,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=None, file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-    _descriptor.FieldDescriptor(
-      name='log', full_name='PB.FromSplitflap.log', index=1,
-      number=2, type=11, cpp_type=10, label=1,
-      has_default_value=False, default_value=None,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=None, file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-    _descriptor.FieldDescriptor(
-      name='ack', full_name='PB.FromSplitflap.ack', index=2,
-      number=3, type=11, cpp_type=10, label=1,
-      has_default_value=False, default_value=None,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=None, file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-    _descriptor.FieldDescriptor(
-      name='supervisor_state', full_name='PB.FromSplitflap.supervisor_state', index=3,
-      number=4, type=11, cpp_type=10, label=1,
-      has_default_value=False, default_value=None,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=None, file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-    _descriptor.FieldDescriptor(
-      name='general_state', full_name='PB.FromSplitflap.general_state', index=4,
-      number=5, type=11, cpp_type=10, label=1,
-      has_default_value=False, default_value=None,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=None, file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-  ],
-  extensions=[
-  ],
-  nested_types=[],
-  enum_types=[
-  ],
-  serialized_options=None,
-  is_extendable=False,
-  syntax='proto3',
-  extension_ranges=[],
-  oneofs=[
-    _descriptor.OneofDescriptor(
-      name='payload', full_name='PB.FromSplitflap.payload',
-      index=0, containing_type=None,
-      create_key=_descriptor._internal_create_key,
-    fields=[]),
-  ],
-  serialized_start=1411,
-  serialized_end=1624,
-)
-
-
-_SPLITFLAPCOMMAND_MODULECOMMAND = _descriptor.Descriptor(
-  name='ModuleCommand',
-  full_name='PB.SplitflapCommand.ModuleCommand',
-  filename=None,
-  file=DESCRIPTOR,
-  containing_type=None,
-  create_key=_descriptor._internal_create_key,
-  fields=[
-    _descriptor.FieldDescriptor(
-      name='action', full_name='PB.SplitflapCommand.ModuleCommand.action', index=0,
-      number=1, type=14, cpp_type=8, label=1,
-      has_default_value=False, default_value=0,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=None, file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-    _descriptor.FieldDescriptor(
-      name='param', full_name='PB.SplitflapCommand.ModuleCommand.param', index=1,
-      number=2, type=13, cpp_type=3, label=1,
-      has_default_value=False, default_value=0,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=b'\222?\0028\010', file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-  ],
-  extensions=[
-  ],
-  nested_types=[],
-  enum_types=[
-    _SPLITFLAPCOMMAND_MODULECOMMAND_ACTION,
-  ],
-  serialized_options=None,
-  is_extendable=False,
-  syntax='proto3',
-  extension_ranges=[],
-  oneofs=[
-  ],
-  serialized_start=1735,
-  serialized_end=1957,
-)
-
-_SPLITFLAPCOMMAND = _descriptor.Descriptor(
-  name='SplitflapCommand',
-  full_name='PB.SplitflapCommand',
-  filename=None,
-  file=DESCRIPTOR,
-  containing_type=None,
-  create_key=_descriptor._internal_create_key,
-  fields=[
-    _descriptor.FieldDescriptor(
-      name='modules', full_name='PB.SplitflapCommand.modules', index=0,
-      number=2, type=11, cpp_type=10, label=3,
-      has_default_value=False, default_value=[],
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=b'\222?\003\020\377\001', file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-    _descriptor.FieldDescriptor(
-      name='save_all_offsets', full_name='PB.SplitflapCommand.save_all_offsets', index=1,
-      number=3, type=8, cpp_type=7, label=1,
-      has_default_value=False, default_value=False,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=None, file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-  ],
-  extensions=[
-  ],
-  nested_types=[_SPLITFLAPCOMMAND_MODULECOMMAND, ],
-  enum_types=[
-  ],
-  serialized_options=None,
-  is_extendable=False,
-  syntax='proto3',
-  extension_ranges=[],
-  oneofs=[
-  ],
-  serialized_start=1627,
-  serialized_end=1957,
-)
-
-
-_SPLITFLAPCONFIG_MODULECONFIG = _descriptor.Descriptor(
-  name='ModuleConfig',
-  full_name='PB.SplitflapConfig.ModuleConfig',
-  filename=None,
-  file=DESCRIPTOR,
-  containing_type=None,
-  create_key=_descriptor._internal_create_key,
-  fields=[
-    _descriptor.FieldDescriptor(
-      name='target_flap_index', full_name='PB.SplitflapConfig.ModuleConfig.target_flap_index', index=0,
-      number=1, type=13, cpp_type=3, label=1,
-      has_default_value=False, default_value=0,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=b'\222?\0028\010', file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-    _descriptor.FieldDescriptor(
-      name='movement_nonce', full_name='PB.SplitflapConfig.ModuleConfig.movement_nonce', index=1,
-      number=2, type=13, cpp_type=3, label=1,
-      has_default_value=False, default_value=0,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=b'\222?\0028\010', file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-    _descriptor.FieldDescriptor(
-      name='reset_nonce', full_name='PB.SplitflapConfig.ModuleConfig.reset_nonce', index=2,
-      number=3, type=13, cpp_type=3, label=1,
-      has_default_value=False, default_value=0,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=b'\222?\0028\010', file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-  ],
-  extensions=[
-  ],
-  nested_types=[],
-  enum_types=[
-  ],
-  serialized_options=None,
-  is_extendable=False,
-  syntax='proto3',
-  extension_ranges=[],
-  oneofs=[
-  ],
-  serialized_start=2038,
-  serialized_end=2145,
-)
-
-_SPLITFLAPCONFIG = _descriptor.Descriptor(
-  name='SplitflapConfig',
-  full_name='PB.SplitflapConfig',
-  filename=None,
-  file=DESCRIPTOR,
-  containing_type=None,
-  create_key=_descriptor._internal_create_key,
-  fields=[
-    _descriptor.FieldDescriptor(
-      name='modules', full_name='PB.SplitflapConfig.modules', index=0,
-      number=1, type=11, cpp_type=10, label=3,
-      has_default_value=False, default_value=[],
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=b'\222?\003\020\377\001', file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-  ],
-  extensions=[
-  ],
-  nested_types=[_SPLITFLAPCONFIG_MODULECONFIG, ],
-  enum_types=[
-  ],
-  serialized_options=None,
-  is_extendable=False,
-  syntax='proto3',
-  extension_ranges=[],
-  oneofs=[
-  ],
-  serialized_start=1960,
-  serialized_end=2145,
-)
-
-
-_REQUESTSTATE = _descriptor.Descriptor(
-  name='RequestState',
-  full_name='PB.RequestState',
-  filename=None,
-  file=DESCRIPTOR,
-  containing_type=None,
-  create_key=_descriptor._internal_create_key,
-  fields=[
-  ],
-  extensions=[
-  ],
-  nested_types=[],
-  enum_types=[
-  ],
-  serialized_options=None,
-  is_extendable=False,
-  syntax='proto3',
-  extension_ranges=[],
-  oneofs=[
-  ],
-  serialized_start=2147,
-  serialized_end=2161,
-)
-
-
-_TOSPLITFLAP = _descriptor.Descriptor(
-  name='ToSplitflap',
-  full_name='PB.ToSplitflap',
-  filename=None,
-  file=DESCRIPTOR,
-  containing_type=None,
-  create_key=_descriptor._internal_create_key,
-  fields=[
-    _descriptor.FieldDescriptor(
-      name='nonce', full_name='PB.ToSplitflap.nonce', index=0,
-      number=1, type=13, cpp_type=3, label=1,
-      has_default_value=False, default_value=0,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=None, file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-    _descriptor.FieldDescriptor(
-      name='splitflap_command', full_name='PB.ToSplitflap.splitflap_command', index=1,
-      number=2, type=11, cpp_type=10, label=1,
-      has_default_value=False, default_value=None,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=None, file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-    _descriptor.FieldDescriptor(
-      name='splitflap_config', full_name='PB.ToSplitflap.splitflap_config', index=2,
-      number=3, type=11, cpp_type=10, label=1,
-      has_default_value=False, default_value=None,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=None, file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-    _descriptor.FieldDescriptor(
-      name='request_state', full_name='PB.ToSplitflap.request_state', index=3,
-      number=4, type=11, cpp_type=10, label=1,
-      has_default_value=False, default_value=None,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=None, file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-  ],
-  extensions=[
-  ],
-  nested_types=[],
-  enum_types=[
-  ],
-  serialized_options=None,
-  is_extendable=False,
-  syntax='proto3',
-  extension_ranges=[],
-  oneofs=[
-    _descriptor.OneofDescriptor(
-      name='payload', full_name='PB.ToSplitflap.payload',
-      index=0, containing_type=None,
-      create_key=_descriptor._internal_create_key,
-    fields=[]),
-  ],
-  serialized_start=2164,
-  serialized_end=2346,
-)
-
-
-_PERSISTENTCONFIGURATION = _descriptor.Descriptor(
-  name='PersistentConfiguration',
-  full_name='PB.PersistentConfiguration',
-  filename=None,
-  file=DESCRIPTOR,
-  containing_type=None,
-  create_key=_descriptor._internal_create_key,
-  fields=[
-    _descriptor.FieldDescriptor(
-      name='version', full_name='PB.PersistentConfiguration.version', index=0,
-      number=1, type=13, cpp_type=3, label=1,
-      has_default_value=False, default_value=0,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=None, file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-    _descriptor.FieldDescriptor(
-      name='num_flaps', full_name='PB.PersistentConfiguration.num_flaps', index=1,
-      number=2, type=13, cpp_type=3, label=1,
-      has_default_value=False, default_value=0,
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=None, file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-    _descriptor.FieldDescriptor(
-      name='module_offset_steps', full_name='PB.PersistentConfiguration.module_offset_steps', index=2,
-      number=3, type=13, cpp_type=3, label=3,
-      has_default_value=False, default_value=[],
-      message_type=None, enum_type=None, containing_type=None,
-      is_extension=False, extension_scope=None,
-      serialized_options=b'\222?\003\020\377\001\222?\0028\020', file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
-  ],
-  extensions=[
-  ],
-  nested_types=[],
-  enum_types=[
-  ],
-  serialized_options=None,
-  is_extendable=False,
-  syntax='proto3',
-  extension_ranges=[],
-  oneofs=[
-  ],
-  serialized_start=2348,
-  serialized_end=2451,
-)
-
-_SPLITFLAPSTATE_MODULESTATE.fields_by_name['state'].enum_type = _SPLITFLAPSTATE_MODULESTATE_STATE
-_SPLITFLAPSTATE_MODULESTATE.containing_type = _SPLITFLAPSTATE
-_SPLITFLAPSTATE_MODULESTATE_STATE.containing_type = _SPLITFLAPSTATE_MODULESTATE
-_SPLITFLAPSTATE.fields_by_name['modules'].message_type = _SPLITFLAPSTATE_MODULESTATE
-_SUPERVISORSTATE_POWERCHANNELSTATE.containing_type = _SUPERVISORSTATE
-_SUPERVISORSTATE_FAULTINFO.fields_by_name['type'].enum_type = _SUPERVISORSTATE_FAULTINFO_FAULTTYPE
-_SUPERVISORSTATE_FAULTINFO.containing_type = _SUPERVISORSTATE
-_SUPERVISORSTATE_FAULTINFO_FAULTTYPE.containing_type = _SUPERVISORSTATE_FAULTINFO
-_SUPERVISORSTATE.fields_by_name['state'].enum_type = _SUPERVISORSTATE_STATE
-_SUPERVISORSTATE.fields_by_name['power_channels'].message_type = _SUPERVISORSTATE_POWERCHANNELSTATE
-_SUPERVISORSTATE.fields_by_name['fault_info'].message_type = _SUPERVISORSTATE_FAULTINFO
-_SUPERVISORSTATE_STATE.containing_type = _SUPERVISORSTATE
-_GENERALSTATE_BUILDINFO.containing_type = _GENERALSTATE
-_GENERALSTATE.fields_by_name['build_info'].message_type = _GENERALSTATE_BUILDINFO
-_FROMSPLITFLAP.fields_by_name['splitflap_state'].message_type = _SPLITFLAPSTATE
-_FROMSPLITFLAP.fields_by_name['log'].message_type = _LOG
-_FROMSPLITFLAP.fields_by_name['ack'].message_type = _ACK
-_FROMSPLITFLAP.fields_by_name['supervisor_state'].message_type = _SUPERVISORSTATE
-_FROMSPLITFLAP.fields_by_name['general_state'].message_type = _GENERALSTATE
-_FROMSPLITFLAP.oneofs_by_name['payload'].fields.append(
-  _FROMSPLITFLAP.fields_by_name['splitflap_state'])
-_FROMSPLITFLAP.fields_by_name['splitflap_state'].containing_oneof = _FROMSPLITFLAP.oneofs_by_name['payload']
-_FROMSPLITFLAP.oneofs_by_name['payload'].fields.append(
-  _FROMSPLITFLAP.fields_by_name['log'])
-_FROMSPLITFLAP.fields_by_name['log'].containing_oneof = _FROMSPLITFLAP.oneofs_by_name['payload']
-_FROMSPLITFLAP.oneofs_by_name['payload'].fields.append(
-  _FROMSPLITFLAP.fields_by_name['ack'])
-_FROMSPLITFLAP.fields_by_name['ack'].containing_oneof = _FROMSPLITFLAP.oneofs_by_name['payload']
-_FROMSPLITFLAP.oneofs_by_name['payload'].fields.append(
-  _FROMSPLITFLAP.fields_by_name['supervisor_state'])
-_FROMSPLITFLAP.fields_by_name['supervisor_state'].containing_oneof = _FROMSPLITFLAP.oneofs_by_name['payload']
-_FROMSPLITFLAP.oneofs_by_name['payload'].fields.append(
-  _FROMSPLITFLAP.fields_by_name['general_state'])
-_FROMSPLITFLAP.fields_by_name['general_state'].containing_oneof = _FROMSPLITFLAP.oneofs_by_name['payload']
-_SPLITFLAPCOMMAND_MODULECOMMAND.fields_by_name['action'].enum_type = _SPLITFLAPCOMMAND_MODULECOMMAND_ACTION
-_SPLITFLAPCOMMAND_MODULECOMMAND.containing_type = _SPLITFLAPCOMMAND
-_SPLITFLAPCOMMAND_MODULECOMMAND_ACTION.containing_type = _SPLITFLAPCOMMAND_MODULECOMMAND
-_SPLITFLAPCOMMAND.fields_by_name['modules'].message_type = _SPLITFLAPCOMMAND_MODULECOMMAND
-_SPLITFLAPCONFIG_MODULECONFIG.containing_type = _SPLITFLAPCONFIG
-_SPLITFLAPCONFIG.fields_by_name['modules'].message_type = _SPLITFLAPCONFIG_MODULECONFIG
-_TOSPLITFLAP.fields_by_name['splitflap_command'].message_type = _SPLITFLAPCOMMAND
-_TOSPLITFLAP.fields_by_name['splitflap_config'].message_type = _SPLITFLAPCONFIG
-_TOSPLITFLAP.fields_by_name['request_state'].message_type = _REQUESTSTATE
-_TOSPLITFLAP.oneofs_by_name['payload'].fields.append(
-  _TOSPLITFLAP.fields_by_name['splitflap_command'])
-_TOSPLITFLAP.fields_by_name['splitflap_command'].containing_oneof = _TOSPLITFLAP.oneofs_by_name['payload']
-_TOSPLITFLAP.oneofs_by_name['payload'].fields.append(
-  _TOSPLITFLAP.fields_by_name['splitflap_config'])
-_TOSPLITFLAP.fields_by_name['splitflap_config'].containing_oneof = _TOSPLITFLAP.oneofs_by_name['payload']
-_TOSPLITFLAP.oneofs_by_name['payload'].fields.append(
-  _TOSPLITFLAP.fields_by_name['request_state'])
-_TOSPLITFLAP.fields_by_name['request_state'].containing_oneof = _TOSPLITFLAP.oneofs_by_name['payload']
-DESCRIPTOR.message_types_by_name['SplitflapState'] = _SPLITFLAPSTATE
-DESCRIPTOR.message_types_by_name['Log'] = _LOG
-DESCRIPTOR.message_types_by_name['Ack'] = _ACK
-DESCRIPTOR.message_types_by_name['SupervisorState'] = _SUPERVISORSTATE
-DESCRIPTOR.message_types_by_name['GeneralState'] = _GENERALSTATE
-DESCRIPTOR.message_types_by_name['FromSplitflap'] = _FROMSPLITFLAP
-DESCRIPTOR.message_types_by_name['SplitflapCommand'] = _SPLITFLAPCOMMAND
-DESCRIPTOR.message_types_by_name['SplitflapConfig'] = _SPLITFLAPCONFIG
-DESCRIPTOR.message_types_by_name['RequestState'] = _REQUESTSTATE
-DESCRIPTOR.message_types_by_name['ToSplitflap'] = _TOSPLITFLAP
-DESCRIPTOR.message_types_by_name['PersistentConfiguration'] = _PERSISTENTCONFIGURATION
-_sym_db.RegisterFileDescriptor(DESCRIPTOR)
-
-SplitflapState = _reflection.GeneratedProtocolMessageType('SplitflapState', (_message.Message,), {
-
-  'ModuleState' : _reflection.GeneratedProtocolMessageType('ModuleState', (_message.Message,), {
-    'DESCRIPTOR' : _SPLITFLAPSTATE_MODULESTATE,
-    '__module__' : 'splitflap_pb2'
-    # @@protoc_insertion_point(class_scope:PB.SplitflapState.ModuleState)
-    })
-  ,
-  'DESCRIPTOR' : _SPLITFLAPSTATE,
-  '__module__' : 'splitflap_pb2'
-  # @@protoc_insertion_point(class_scope:PB.SplitflapState)
-  })
-_sym_db.RegisterMessage(SplitflapState)
-_sym_db.RegisterMessage(SplitflapState.ModuleState)
-
-Log = _reflection.GeneratedProtocolMessageType('Log', (_message.Message,), {
-  'DESCRIPTOR' : _LOG,
-  '__module__' : 'splitflap_pb2'
-  # @@protoc_insertion_point(class_scope:PB.Log)
-  })
-_sym_db.RegisterMessage(Log)
-
-Ack = _reflection.GeneratedProtocolMessageType('Ack', (_message.Message,), {
-  'DESCRIPTOR' : _ACK,
-  '__module__' : 'splitflap_pb2'
-  # @@protoc_insertion_point(class_scope:PB.Ack)
-  })
-_sym_db.RegisterMessage(Ack)
-
-SupervisorState = _reflection.GeneratedProtocolMessageType('SupervisorState', (_message.Message,), {
-
-  'PowerChannelState' : _reflection.GeneratedProtocolMessageType('PowerChannelState', (_message.Message,), {
-    'DESCRIPTOR' : _SUPERVISORSTATE_POWERCHANNELSTATE,
-    '__module__' : 'splitflap_pb2'
-    # @@protoc_insertion_point(class_scope:PB.SupervisorState.PowerChannelState)
-    })
-  ,
-
-  'FaultInfo' : _reflection.GeneratedProtocolMessageType('FaultInfo', (_message.Message,), {
-    'DESCRIPTOR' : _SUPERVISORSTATE_FAULTINFO,
-    '__module__' : 'splitflap_pb2'
-    # @@protoc_insertion_point(class_scope:PB.SupervisorState.FaultInfo)
-    })
-  ,
-  'DESCRIPTOR' : _SUPERVISORSTATE,
-  '__module__' : 'splitflap_pb2'
-  # @@protoc_insertion_point(class_scope:PB.SupervisorState)
-  })
-_sym_db.RegisterMessage(SupervisorState)
-_sym_db.RegisterMessage(SupervisorState.PowerChannelState)
-_sym_db.RegisterMessage(SupervisorState.FaultInfo)
-
-GeneralState = _reflection.GeneratedProtocolMessageType('GeneralState', (_message.Message,), {
-
-  'BuildInfo' : _reflection.GeneratedProtocolMessageType('BuildInfo', (_message.Message,), {
-    'DESCRIPTOR' : _GENERALSTATE_BUILDINFO,
-    '__module__' : 'splitflap_pb2'
-    # @@protoc_insertion_point(class_scope:PB.GeneralState.BuildInfo)
-    })
-  ,
-  'DESCRIPTOR' : _GENERALSTATE,
-  '__module__' : 'splitflap_pb2'
-  # @@protoc_insertion_point(class_scope:PB.GeneralState)
-  })
-_sym_db.RegisterMessage(GeneralState)
-_sym_db.RegisterMessage(GeneralState.BuildInfo)
-
-FromSplitflap = _reflection.GeneratedProtocolMessageType('FromSplitflap', (_message.Message,), {
-  'DESCRIPTOR' : _FROMSPLITFLAP,
-  '__module__' : 'splitflap_pb2'
-  # @@protoc_insertion_point(class_scope:PB.FromSplitflap)
-  })
-_sym_db.RegisterMessage(FromSplitflap)
-
-SplitflapCommand = _reflection.GeneratedProtocolMessageType('SplitflapCommand', (_message.Message,), {
-
-  'ModuleCommand' : _reflection.GeneratedProtocolMessageType('ModuleCommand', (_message.Message,), {
-    'DESCRIPTOR' : _SPLITFLAPCOMMAND_MODULECOMMAND,
-    '__module__' : 'splitflap_pb2'
-    # @@protoc_insertion_point(class_scope:PB.SplitflapCommand.ModuleCommand)
-    })
-  ,
-  'DESCRIPTOR' : _SPLITFLAPCOMMAND,
-  '__module__' : 'splitflap_pb2'
-  # @@protoc_insertion_point(class_scope:PB.SplitflapCommand)
-  })
-_sym_db.RegisterMessage(SplitflapCommand)
-_sym_db.RegisterMessage(SplitflapCommand.ModuleCommand)
-
-SplitflapConfig = _reflection.GeneratedProtocolMessageType('SplitflapConfig', (_message.Message,), {
-
-  'ModuleConfig' : _reflection.GeneratedProtocolMessageType('ModuleConfig', (_message.Message,), {
-    'DESCRIPTOR' : _SPLITFLAPCONFIG_MODULECONFIG,
-    '__module__' : 'splitflap_pb2'
-    # @@protoc_insertion_point(class_scope:PB.SplitflapConfig.ModuleConfig)
-    })
-  ,
-  'DESCRIPTOR' : _SPLITFLAPCONFIG,
-  '__module__' : 'splitflap_pb2'
-  # @@protoc_insertion_point(class_scope:PB.SplitflapConfig)
-  })
-_sym_db.RegisterMessage(SplitflapConfig)
-_sym_db.RegisterMessage(SplitflapConfig.ModuleConfig)
-
-RequestState = _reflection.GeneratedProtocolMessageType('RequestState', (_message.Message,), {
-  'DESCRIPTOR' : _REQUESTSTATE,
-  '__module__' : 'splitflap_pb2'
-  # @@protoc_insertion_point(class_scope:PB.RequestState)
-  })
-_sym_db.RegisterMessage(RequestState)
-
-ToSplitflap = _reflection.GeneratedProtocolMessageType('ToSplitflap', (_message.Message,), {
-  'DESCRIPTOR' : _TOSPLITFLAP,
-  '__module__' : 'splitflap_pb2'
-  # @@protoc_insertion_point(class_scope:PB.ToSplitflap)
-  })
-_sym_db.RegisterMessage(ToSplitflap)
-
-PersistentConfiguration = _reflection.GeneratedProtocolMessageType('PersistentConfiguration', (_message.Message,), {
-  'DESCRIPTOR' : _PERSISTENTCONFIGURATION,
-  '__module__' : 'splitflap_pb2'
-  # @@protoc_insertion_point(class_scope:PB.PersistentConfiguration)
-  })
-_sym_db.RegisterMessage(PersistentConfiguration)
-
-
-_SPLITFLAPSTATE_MODULESTATE.fields_by_name['flap_index']._options = None
-_SPLITFLAPSTATE_MODULESTATE.fields_by_name['count_unexpected_home']._options = None
-_SPLITFLAPSTATE_MODULESTATE.fields_by_name['count_missed_home']._options = None
-_SPLITFLAPSTATE.fields_by_name['modules']._options = None
-_LOG.fields_by_name['msg']._options = None
-_SUPERVISORSTATE_FAULTINFO.fields_by_name['msg']._options = None
-_SUPERVISORSTATE.fields_by_name['power_channels']._options = None
-_GENERALSTATE_BUILDINFO.fields_by_name['git_hash']._options = None
-_GENERALSTATE_BUILDINFO.fields_by_name['build_date']._options = None
-_GENERALSTATE_BUILDINFO.fields_by_name['build_os']._options = None
-_GENERALSTATE.fields_by_name['serial_protocol_version']._options = None
-_GENERALSTATE.fields_by_name['flap_character_set']._options = None
-_SPLITFLAPCOMMAND_MODULECOMMAND.fields_by_name['param']._options = None
-_SPLITFLAPCOMMAND.fields_by_name['modules']._options = None
-_SPLITFLAPCONFIG_MODULECONFIG.fields_by_name['target_flap_index']._options = None
-_SPLITFLAPCONFIG_MODULECONFIG.fields_by_name['movement_nonce']._options = None
-_SPLITFLAPCONFIG_MODULECONFIG.fields_by_name['reset_nonce']._options = None
-_SPLITFLAPCONFIG.fields_by_name['modules']._options = None
-_PERSISTENTCONFIGURATION.fields_by_name['module_offset_steps']._options = None
+DESCRIPTOR = _descriptor_pool.Default().AddSerializedFile(b'\n\x0fsplitflap.proto\x12\x02PB\x1a\x0cnanopb.proto\"\xf5\x03\n\x0eSplitflapState\x12\x36\n\x07modules\x18\x01 \x03(\x0b\x32\x1e.PB.SplitflapState.ModuleStateB\x05\x92?\x02\x18\x01\x12\x14\n\x0cloopbacks_ok\x18\x02 \x01(\x08\x12\x12\n\ngeneration\x18\x03 \x01(\r\x1a\x80\x03\n\x0bModuleState\x12\x33\n\x05state\x18\x01 \x01(\x0e\x32$.PB.SplitflapState.ModuleState.State\x12\x19\n\nflap_index\x18\x02 \x01(\rB\x05\x92?\x02\x38\x08\x12\x0e\n\x06moving\x18\x03 \x01(\x08\x12\x12\n\nhome_state\x18\x04 \x01(\x08\x12$\n\x15\x63ount_unexpected_home\x18\x05 \x01(\rB\x05\x92?\x02\x38\x08\x12 \n\x11\x63ount_missed_home\x18\x06 \x01(\rB\x05\x92?\x02\x38\x08\x12 \n\x11queue_wait_millis\x18\x07 \x01(\rB\x05\x92?\x02\x38\x10\x12\x1b\n\x0cqueued_flaps\x18\x08 \x01(\rB\x05\x92?\x02\x38\x08\x12\x1d\n\x0emax_accel_step\x18\t \x01(\rB\x05\x92?\x02\x38\x08\"W\n\x05State\x12\n\n\x06NORMAL\x10\x00\x12\x11\n\rLOOK_FOR_HOME\x10\x01\x12\x10\n\x0cSENSOR_ERROR\x10\x02\x12\t\n\x05PANIC\x10\x03\x12\x12\n\x0eSTATE_DISABLED\x10\x04\"\xb0\x01\n\x13SplitflapStateDelta\x12\x17\n\x0f\x62\x61se_generation\x18\x01 \x01(\r\x12\x12\n\ngeneration\x18\x02 \x01(\r\x12\x36\n\x07modules\x18\x03 \x03(\x0b\x32\x1e.PB.SplitflapState.ModuleStateB\x05\x92?\x02\x18\x01\x12\x1e\n\x0emodule_indices\x18\x04 \x01(\x0c\x42\x06\x92?\x03\x08\xff\x01\x12\x14\n\x0cloopbacks_ok\x18\x05 \x01(\x08\"\x1a\n\x03Log\x12\x13\n\x03msg\x18\x01 \x01(\tB\x06\x92?\x03p\xff\x01\"G\n\x03\x41\x63k\x12\r\n\x05nonce\x18\x01 \x01(\r\x12\x18\n\x10window_end_nonce\x18\x02 \x01(\r\x12\x17\n\x0fwindow_received\x18\x03 \x01(\r\"\xa4\x05\n\x0fSupervisorState\x12\x15\n\ruptime_millis\x18\x01 \x01(\r\x12(\n\x05state\x18\x02 \x01(\x0e\x32\x19.PB.SupervisorState.State\x12\x44\n\x0epower_channels\x18\x03 \x03(\x0b\x32%.PB.SupervisorState.PowerChannelStateB\x05\x92?\x02\x10\x05\x12\x31\n\nfault_info\x18\x04 \x01(\x0b\x32\x1d.PB.SupervisorState.FaultInfo\x1aL\n\x11PowerChannelState\x12\x15\n\rvoltage_volts\x18\x01 \x01(\x02\x12\x14\n\x0c\x63urrent_amps\x18\x02 \x01(\x02\x12\n\n\x02on\x18\x03 \x01(\x08\x1a\x81\x02\n\tFaultInfo\x12\x35\n\x04type\x18\x01 \x01(\x0e\x32\'.PB.SupervisorState.FaultInfo.FaultType\x12\x13\n\x03msg\x18\x02 \x01(\tB\x06\x92?\x03p\xff\x01\x12\x11\n\tts_millis\x18\x03 \x01(\r\"\x94\x01\n\tFaultType\x12\x0b\n\x07UNKNOWN\x10\x00\x12\x08\n\x04NONE\x10\x01\x12\x1e\n\x1aINRUSH_CURRENT_NOT_SETTLED\x10\x02\x12\x16\n\x12SPLITFLAP_SHUTDOWN\x10\x03\x12\x10\n\x0cOUT_OF_RANGE\x10\x04\x12\x10\n\x0cOVER_CURRENT\x10\x05\x12\x14\n\x10UNEXPECTED_POWER\x10\x06\"\x84\x01\n\x05State\x12\x0b\n\x07UNKNOWN\x10\x00\x12\x1b\n\x17STARTING_VERIFY_PSU_OFF\x10\x01\x12\x1c\n\x18STARTING_VERIFY_VOLTAGES\x10\x02\x12\x1c\n\x18STARTING_ENABLE_CHANNELS\x10\x03\x12\n\n\x06NORMAL\x10\x04\x12\t\n\x05\x46\x41ULT\x10\x05\"\xdc\x02\n\x0cGeneralState\x12&\n\x17serial_protocol_version\x18\x01 \x01(\rB\x05\x92?\x02\x38\x10\x12\x15\n\ruptime_millis\x18\x02 \x01(\r\x12.\n\nbuild_info\x18\x03 \x01(\x0b\x32\x1a.PB.GeneralState.BuildInfo\x12!\n\x12\x66lap_character_set\x18\x04 \x01(\x0c\x42\x05\x92?\x02\x08P\x12!\n\x12module_queue_depth\x18\x05 \x01(\rB\x05\x92?\x02\x38\x08\x12\x1d\n\x0emax_accel_step\x18\x06 \x01(\rB\x05\x92?\x02\x38\x08\x12\x1e\n\x0f\x61\x63k_window_size\x18\x07 \x01(\rB\x05\x92?\x02\x38\x08\x1aX\n\tBuildInfo\x12\x17\n\x08git_hash\x18\x01 \x01(\tB\x05\x92?\x02pZ\x12\x19\n\nbuild_date\x18\x02 \x01(\tB\x05\x92?\x02p\x0c\x12\x17\n\x08\x62uild_os\x18\x03 \x01(\tB\x05\x92?\x02p\x0c\"\x8f\x02\n\rFromSplitflap\x12-\n\x0fsplitflap_state\x18\x01 \x01(\x0b\x32\x12.PB.SplitflapStateH\x00\x12\x16\n\x03log\x18\x02 \x01(\x0b\x32\x07.PB.LogH\x00\x12\x16\n\x03\x61\x63k\x18\x03 \x01(\x0b\x32\x07.PB.AckH\x00\x12/\n\x10supervisor_state\x18\x04 \x01(\x0b\x32\x13.PB.SupervisorStateH\x00\x12)\n\rgeneral_state\x18\x05 \x01(\x0b\x32\x10.PB.GeneralStateH\x00\x12\x38\n\x15splitflap_state_delta\x18\x06 \x01(\x0b\x32\x17.PB.SplitflapStateDeltaH\x00\x42\t\n\x07payload\"\xa0\x03\n\x10SplitflapCommand\x12:\n\x07modules\x18\x02 \x03(\x0b\x32\".PB.SplitflapCommand.ModuleCommandB\x05\x92?\x02\x18\x01\x12\x18\n\x10save_all_offsets\x18\x03 \x01(\x08\x1a\xb5\x02\n\rModuleCommand\x12\x39\n\x06\x61\x63tion\x18\x01 \x01(\x0e\x32).PB.SplitflapCommand.ModuleCommand.Action\x12\x14\n\x05param\x18\x02 \x01(\rB\x05\x92?\x02\x38\x08\x12\x1b\n\x0c\x64well_millis\x18\x03 \x01(\rB\x05\x92?\x02\x38\x10\"\xb5\x01\n\x06\x41\x63tion\x12\t\n\x05NO_OP\x10\x00\x12\x0e\n\nGO_TO_FLAP\x10\x01\x12\x12\n\x0eRESET_AND_HOME\x10\x02\x12\x0e\n\nQUEUE_FLAP\x10\x03\x12\x0f\n\x0b\x43LEAR_QUEUE\x10\x04\x12\x19\n\x15INCREASE_OFFSET_TENTH\x10Z\x12\x18\n\x14INCREASE_OFFSET_HALF\x10[\x12\x0e\n\nSET_OFFSET\x10\\\x12\x16\n\x12SET_MOTION_PROFILE\x10]\"\xd6\x01\n\x0fSplitflapConfig\x12\x38\n\x07modules\x18\x01 \x03(\x0b\x32 .PB.SplitflapConfig.ModuleConfigB\x05\x92?\x02\x18\x01\x12\x1c\n\x14synchronized_arrival\x18\x02 \x01(\x08\x1ak\n\x0cModuleConfig\x12 \n\x11target_flap_index\x18\x01 \x01(\rB\x05\x92?\x02\x38\x08\x12\x1d\n\x0emovement_nonce\x18\x02 \x01(\rB\x05\x92?\x02\x38\x08\x12\x1a\n\x0breset_nonce\x18\x03 \x01(\rB\x05\x92?\x02\x38\x08\"$\n\x0cRequestState\x12\x14\n\x0cstate_deltas\x18\x01 \x01(\x08\"D\n\x0eTimelineUpload\x12\x0e\n\x06offset\x18\x01 \x01(\r\x12\x14\n\x04\x64\x61ta\x18\x02 \x01(\x0c\x42\x06\x92?\x03\x08\x80\x08\x12\x0c\n\x04\x64one\x18\x03 \x01(\x08\"q\n\x0fTimelineControl\x12*\n\x06\x61\x63tion\x18\x01 \x01(\x0e\x32\x1a.PB.TimelineControl.Action\x12\x14\n\x05loops\x18\x02 \x01(\rB\x05\x92?\x02\x38\x10\"\x1c\n\x06\x41\x63tion\x12\x08\n\x04STOP\x10\x00\x12\x08\n\x04PLAY\x10\x01\"\xb1\x02\n\x0bToSplitflap\x12\r\n\x05nonce\x18\x01 \x01(\r\x12\x31\n\x11splitflap_command\x18\x02 \x01(\x0b\x32\x14.PB.SplitflapCommandH\x00\x12/\n\x10splitflap_config\x18\x03 \x01(\x0b\x32\x13.PB.SplitflapConfigH\x00\x12)\n\rrequest_state\x18\x04 \x01(\x0b\x32\x10.PB.RequestStateH\x00\x12-\n\x0ftimeline_upload\x18\x05 \x01(\x0b\x32\x12.PB.TimelineUploadH\x00\x12/\n\x10timeline_control\x18\x06 \x01(\x0b\x32\x13.PB.TimelineControlH\x00\x12\x11\n\tpipelined\x18\x07 \x01(\x08:\x06\x92?\x03\xb0\x01\x01\x42\t\n\x07payload\"\xf8\x02\n\x17PersistentConfiguration\x12\x0f\n\x07version\x18\x01 \x01(\r\x12\x11\n\tnum_flaps\x18\x02 \x01(\r\x12(\n\x13module_offset_steps\x18\x03 \x03(\rB\x0b\x92?\x03\x10\xff\x01\x92?\x02\x38\x10\x12*\n\x15module_motion_profile\x18\x04 \x03(\rB\x0b\x92?\x03\x10\xff\x01\x92?\x02\x38\x08\x12%\n\x10module_rest_step\x18\x05 \x03(\rB\x0b\x92?\x03\x10\xff\x01\x92?\x02\x38\x10\x12&\n\x11module_rest_phase\x18\x06 \x03(\rB\x0b\x92?\x03\x10\xff\x01\x92?\x02\x38\x08\x12+\n\x16module_rest_flap_index\x18\x07 \x03(\rB\x0b\x92?\x03\x10\xff\x01\x92?\x02\x38\x08\x12\x16\n\x0e\x63lean_shutdown\x18\x08 \x01(\x08\x12#\n\x14steps_per_revolution\x18\t \x01(\rB\x05\x92?\x02\x38\x10\x12*\n\x15module_max_accel_step\x18\n \x03(\rB\x0b\x92?\x03\x10\xff\x01\x92?\x02\x38\x08\x62\x06proto3')
+
+_builder.BuildMessageAndEnumDescriptors(DESCRIPTOR, globals())
+_builder.BuildTopDescriptorsAndMessages(DESCRIPTOR, 'splitflap_pb2', globals())
+if _descriptor._USE_C_DESCRIPTORS == False:
+
+  DESCRIPTOR._options = None
+  _SPLITFLAPSTATE_MODULESTATE.fields_by_name['flap_index']._options = None
+  _SPLITFLAPSTATE_MODULESTATE.fields_by_name['flap_index']._serialized_options = b'\222?\0028\010'
+  _SPLITFLAPSTATE_MODULESTATE.fields_by_name['count_unexpected_home']._options = None
+  _SPLITFLAPSTATE_MODULESTATE.fields_by_name['count_unexpected_home']._serialized_options = b'\222?\0028\010'
+  _SPLITFLAPSTATE_MODULESTATE.fields_by_name['count_missed_home']._options = None
+  _SPLITFLAPSTATE_MODULESTATE.fields_by_name['count_missed_home']._serialized_options = b'\222?\0028\010'
+  _SPLITFLAPSTATE_MODULESTATE.fields_by_name['queue_wait_millis']._options = None
+  _SPLITFLAPSTATE_MODULESTATE.fields_by_name['queue_wait_millis']._serialized_options = b'\222?\0028\020'
+  _SPLITFLAPSTATE_MODULESTATE.fields_by_name['queued_flaps']._options = None
+  _SPLITFLAPSTATE_MODULESTATE.fields_by_name['queued_flaps']._serialized_options = b'\222?\0028\010'
+  _SPLITFLAPSTATE_MODULESTATE.fields_by_name['max_accel_step']._options = None
+  _SPLITFLAPSTATE_MODULESTATE.fields_by_name['max_accel_step']._serialized_options = b'\222?\0028\010'
+  _SPLITFLAPSTATE.fields_by_name['modules']._options = None
+  _SPLITFLAPSTATE.fields_by_name['modules']._serialized_options = b'\222?\002\030\001'
+  _SPLITFLAPSTATEDELTA.fields_by_name['modules']._options = None
+  _SPLITFLAPSTATEDELTA.fields_by_name['modules']._serialized_options = b'\222?\002\030\001'
+  _SPLITFLAPSTATEDELTA.fields_by_name['module_indices']._options = None
+  _SPLITFLAPSTATEDELTA.fields_by_name['module_indices']._serialized_options = b'\222?\003\010\377\001'
+  _LOG.fields_by_name['msg']._options = None
+  _LOG.fields_by_name['msg']._serialized_options = b'\222?\003p\377\001'
+  _SUPERVISORSTATE_FAULTINFO.fields_by_name['msg']._options = None
+  _SUPERVISORSTATE_FAULTINFO.fields_by_name['msg']._serialized_options = b'\222?\003p\377\001'
+  _SUPERVISORSTATE.fields_by_name['power_channels']._options = None
+  _SUPERVISORSTATE.fields_by_name['power_channels']._serialized_options = b'\222?\002\020\005'
+  _GENERALSTATE_BUILDINFO.fields_by_name['git_hash']._options = None
+  _GENERALSTATE_BUILDINFO.fields_by_name['git_hash']._serialized_options = b'\222?\002pZ'
+  _GENERALSTATE_BUILDINFO.fields_by_name['build_date']._options = None
+  _GENERALSTATE_BUILDINFO.fields_by_name['build_date']._serialized_options = b'\222?\002p\014'
+  _GENERALSTATE_BUILDINFO.fields_by_name['build_os']._options = None
+  _GENERALSTATE_BUILDINFO.fields_by_name['build_os']._serialized_options = b'\222?\002p\014'
+  _GENERALSTATE.fields_by_name['serial_protocol_version']._options = None
+  _GENERALSTATE.fields_by_name['serial_protocol_version']._serialized_options = b'\222?\0028\020'
+  _GENERALSTATE.fields_by_name['flap_character_set']._options = None
+  _GENERALSTATE.fields_by_name['flap_character_set']._serialized_options = b'\222?\002\010P'
+  _GENERALSTATE.fields_by_name['module_queue_depth']._options = None
+  _GENERALSTATE.fields_by_name['module_queue_depth']._serialized_options = b'\222?\0028\010'
+  _GENERALSTATE.fields_by_name['max_accel_step']._options = None
+  _GENERALSTATE.fields_by_name['max_accel_step']._serialized_options = b'\222?\0028\010'
+  _GENERALSTATE.fields_by_name['ack_window_size']._options = None
+  _GENERALSTATE.fields_by_name['ack_window_size']._serialized_options = b'\222?\0028\010'
+  _SPLITFLAPCOMMAND_MODULECOMMAND.fields_by_name['param']._options = None
+  _SPLITFLAPCOMMAND_MODULECOMMAND.fields_by_name['param']._serialized_options = b'\222?\0028\010'
+  _SPLITFLAPCOMMAND_MODULECOMMAND.fields_by_name['dwell_millis']._options = None
+  _SPLITFLAPCOMMAND_MODULECOMMAND.fields_by_name['dwell_millis']._serialized_options = b'\222?\0028\020'
+  _SPLITFLAPCOMMAND.fields_by_name['modules']._options = None
+  _SPLITFLAPCOMMAND.fields_by_name['modules']._serialized_options = b'\222?\002\030\001'
+  _SPLITFLAPCONFIG_MODULECONFIG.fields_by_name['target_flap_index']._options = None
+  _SPLITFLAPCONFIG_MODULECONFIG.fields_by_name['target_flap_index']._serialized_options = b'\222?\0028\010'
+  _SPLITFLAPCONFIG_MODULECONFIG.fields_by_name['movement_nonce']._options = None
+  _SPLITFLAPCONFIG_MODULECONFIG.fields_by_name['movement_nonce']._serialized_options = b'\222?\0028\010'
+  _SPLITFLAPCONFIG_MODULECONFIG.fields_by_name['reset_nonce']._options = None
+  _SPLITFLAPCONFIG_MODULECONFIG.fields_by_name['reset_nonce']._serialized_options = b'\222?\0028\010'
+  _SPLITFLAPCONFIG.fields_by_name['modules']._options = None
+  _SPLITFLAPCONFIG.fields_by_name['modules']._serialized_options = b'\222?\002\030\001'
+  _TIMELINEUPLOAD.fields_by_name['data']._options = None
+  _TIMELINEUPLOAD.fields_by_name['data']._serialized_options = b'\222?\003\010\200\010'
+  _TIMELINECONTROL.fields_by_name['loops']._options = None
+  _TIMELINECONTROL.fields_by_name['loops']._serialized_options = b'\222?\0028\020'
+  _TOSPLITFLAP._options = None
+  _TOSPLITFLAP._serialized_options = b'\222?\003\260\001\001'
+  _PERSISTENTCONFIGURATION.fields_by_name['module_offset_steps']._options = None
+  _PERSISTENTCONFIGURATION.fields_by_name['module_offset_steps']._serialized_options = b'\222?\003\020\377\001\222?\0028\020'
+  _PERSISTENTCONFIGURATION.fields_by_name['module_motion_profile']._options = None
+  _PERSISTENTCONFIGURATION.fields_by_name['module_motion_profile']._serialized_options = b'\222?\003\020\377\001\222?\0028\010'
+  _PERSISTENTCONFIGURATION.fields_by_name['module_rest_step']._options = None
+  _PERSISTENTCONFIGURATION.fields_by_name['module_rest_step']._serialized_options = b'\222?\003\020\377\001\222?\0028\020'
+  _PERSISTENTCONFIGURATION.fields_by_name['module_rest_phase']._options = None
+  _PERSISTENTCONFIGURATION.fields_by_name['module_rest_phase']._serialized_options = b'\222?\003\020\377\001\222?\0028\010'
+  _PERSISTENTCONFIGURATION.fields_by_name['module_rest_flap_index']._options = None
+  _PERSISTENTCONFIGURATION.fields_by_name['module_rest_flap_index']._serialized_options = b'\222?\003\020\377\001\222?\0028\010'
+  _PERSISTENTCONFIGURATION.fields_by_name['steps_per_revolution']._options = None
+  _PERSISTENTCONFIGURATION.fields_by_name['steps_per_revolution']._serialized_options = b'\222?\0028\020'
+  _PERSISTENTCONFIGURATION.fields_by_name['module_max_accel_step']._options = None
+  _PERSISTENTCONFIGURATION.fields_by_name['module_max_accel_step']._serialized_options = b'\222?\003\020\377\001\222?\0028\010'
+  _SPLITFLAPSTATE._serialized_start=38
+  _SPLITFLAPSTATE._serialized_end=539
+  _SPLITFLAPSTATE_MODULESTATE._serialized_start=155
+  _SPLITFLAPSTATE_MODULESTATE._serialized_end=539
+  _SPLITFLAPSTATE_MODULESTATE_STATE._serialized_start=452
+  _SPLITFLAPSTATE_MODULESTATE_STATE._serialized_end=539
+  _SPLITFLAPSTATEDELTA._serialized_start=542
+  _SPLITFLAPSTATEDELTA._serialized_end=718
+  _LOG._serialized_start=720
+  _LOG._serialized_end=746
+  _ACK._serialized_start=748
+  _ACK._serialized_end=819
+  _SUPERVISORSTATE._serialized_start=822
+  _SUPERVISORSTATE._serialized_end=1498
+  _SUPERVISORSTATE_POWERCHANNELSTATE._serialized_start=1027
+  _SUPERVISORSTATE_POWERCHANNELSTATE._serialized_end=1103
+  _SUPERVISORSTATE_FAULTINFO._serialized_start=1106
+  _SUPERVISORSTATE_FAULTINFO._serialized_end=1363
+  _SUPERVISORSTATE_FAULTINFO_FAULTTYPE._serialized_start=1215
+  _SUPERVISORSTATE_FAULTINFO_FAULTTYPE._serialized_end=1363
+  _SUPERVISORSTATE_STATE._serialized_start=1366
+  _SUPERVISORSTATE_STATE._serialized_end=1498
+  _GENERALSTATE._serialized_start=1501
+  _GENERALSTATE._serialized_end=1849
+  _GENERALSTATE_BUILDINFO._serialized_start=1761
+  _GENERALSTATE_BUILDINFO._serialized_end=1849
+  _FROMSPLITFLAP._serialized_start=1852
+  _FROMSPLITFLAP._serialized_end=2123
+  _SPLITFLAPCOMMAND._serialized_start=2126
+  _SPLITFLAPCOMMAND._serialized_end=2542
+  _SPLITFLAPCOMMAND_MODULECOMMAND._serialized_start=2233
+  _SPLITFLAPCOMMAND_MODULECOMMAND._serialized_end=2542
+  _SPLITFLAPCOMMAND_MODULECOMMAND_ACTION._serialized_start=2361
+  _SPLITFLAPCOMMAND_MODULECOMMAND_ACTION._serialized_end=2542
+  _SPLITFLAPCONFIG._serialized_start=2545
+  _SPLITFLAPCONFIG._serialized_end=2759
+  _SPLITFLAPCONFIG_MODULECONFIG._serialized_start=2652
+  _SPLITFLAPCONFIG_MODULECONFIG._serialized_end=2759
+  _REQUESTSTATE._serialized_start=2761
+  _REQUESTSTATE._serialized_end=2797
+  _TIMELINEUPLOAD._serialized_start=2799
+  _TIMELINEUPLOAD._serialized_end=2867
+  _TIMELINECONTROL._serialized_start=2869
+  _TIMELINECONTROL._serialized_end=2982
+  _TIMELINECONTROL_ACTION._serialized_start=2954
+  _TIMELINECONTROL_ACTION._serialized_end=2982
+  _TOSPLITFLAP._serialized_start=2985
+  _TOSPLITFLAP._serialized_end=3290
+  _PERSISTENTCONFIGURATION._serialized_start=3293
+  _PERSISTENTCONFIGURATION._serialized_end=3669
 # @@protoc_insertion_point(module_scope)
@@ -2,6 +2,8 @@ import argparse
 from cobs import cobs
 from collections import (
     defaultdict,
+    deque,
+    OrderedDict,
 )
 from contextlib import contextmanager
 from enum import Enum
@@ -40,6 +42,8 @@ class Splitflap(object):
         ALL = 3             # All modules move on every command, regardless of whether they are already at the specified character
 
     RETRY_TIMEOUT = 0.25
+    # Matches the max_size of TimelineUpload.data in splitflap.proto
+    TIMELINE_CHUNK_SIZE = 1024
 
     _LEGACY_ALPHABET = [
         ' ', 'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I',
@@ -48,14 +52,19 @@ class Splitflap(object):
         '3', '4', '5', '6', '7', '8', '9', '.', ',', "'",
     ]
 
-    def __init__(self, serial_instance):
+    def __init__(self, serial_instance, state_deltas=True):
         self._serial = serial_instance
+        self._state_deltas = state_deltas
         self._logger = logging.getLogger('splitflap')
+        # ToSplitflap messages to send, and Acks from the device, for the write thread
         self._out_q = Queue()
-        self._ack_q = Queue()
-        self._next_nonce = randint(0, 255)
+        self._next_nonce = randint(0, 0xffffffff)
         self._run = True
 
+        # How many configs can be waiting for acks at once. Stays at 1 (each message waits for the previous one's
+        # ack) unless the device reports that it supports pipelining.
+        self._ack_window_size = 1
+
         self._lock = Lock()
         self._message_handlers = defaultdict(list)
 
@@ -65,6 +74,10 @@ class Splitflap(object):
         self._alphabet = Splitflap._LEGACY_ALPHABET
         self._alphabet_received = False
 
+        # Latest full state, with any SplitflapStateDelta messages applied since the last SplitflapState
+        self._state = None
+        self._awaiting_keyframe = False
+
     def _read_loop(self):
         self._logger.debug('Read loop started')
         buffer = b''
@@ -109,70 +122,141 @@ class Splitflap(object):
         self._logger.debug(message)
 
         payload_type = message.WhichOneof('payload')
+        payload = getattr(message, payload_type)
+
+        # Deltas are handed to handlers as the full state they produce
+        if payload_type == 'splitflap_state_delta':
+            payload = self._apply_state_delta(payload)
+            if payload is None:
+                return
+            payload_type = 'splitflap_state'
+        elif payload_type == 'splitflap_state':
+            self._state = payload
+            self._awaiting_keyframe = False
 
         # If this is an ack, notify the write thread
         if payload_type == 'ack':
-            nonce = message.ack.nonce
-            self._ack_q.put(nonce)
+            self._out_q.put(payload)
         elif payload_type == 'splitflap_state':
-            num_modules_reported = len(message.splitflap_state.modules)
+            num_modules_reported = len(payload.modules)
             if self._num_modules is None:
                 self._num_modules = num_modules_reported
                 for i in range(num_modules_reported):
                     self._current_config.modules.append(splitflap_pb2.SplitflapConfig.ModuleConfig())
             else:
                 assert self._num_modules == num_modules_reported, f'Number of reported modules changed (was {self._num_modules}, now {num_modules_reported})'
-        elif payload_type == 'general_state' and not self._alphabet_received:
-            self._alphabet_received = True
-            self._alphabet = list(message.general_state.flap_character_set.decode('utf-8'))
+        elif payload_type == 'general_state':
+            if not self._alphabet_received:
+                self._alphabet_received = True
+                self._alphabet = list(payload.flap_character_set.decode('utf-8'))
+            if payload.serial_protocol_version >= 3 and payload.ack_window_size > 1:
+                self._ack_window_size = payload.ack_window_size
 
         with self._lock:
             for handler in self._message_handlers[payload_type] + self._message_handlers[None]:
                 try:
-                    handler(getattr(message, payload_type))
+                    handler(payload)
                 except:
                     self._logger.warning(f'Unhandled exception in message handler ({payload_type})', exc_info=True)
+
+    def _apply_state_delta(self, delta):
+        """Applies a SplitflapStateDelta to the latest state, returning the new state, or None if it doesn't apply."""
+        if self._state is None or delta.base_generation != self._state.generation:
+            # Missed a message in between; ask for a keyframe (once) and drop deltas until it arrives
+            if not self._awaiting_keyframe:
+                self._logger.debug(f'Got state delta for generation {delta.base_generation} without its base, requesting state')
+                self._awaiting_keyframe = True
+                self.request_state()
+            return None
+
+        state = splitflap_pb2.SplitflapState()
+        state.CopyFrom(self._state)
+        for module_index, module in zip(delta.module_indices, delta.modules):
+            state.modules[module_index].CopyFrom(module)
+        state.loopbacks_ok = delta.loopbacks_ok
+        state.generation = delta.generation
+        self._state = state
+        return state
     
     def _write_loop(self):
         self._logger.debug('Write loop started')
-        while True:
-            data = self._out_q.get()
-            # Check for shutdown
-            if not self._run:
-                self._logger.debug('Write loop exiting @ _out_q')
-                return
-            (nonce, encoded_message) = data
-
-            next_retry = 0
-            while True:
-                if time.time() >= next_retry:
-                    if next_retry > 0:
-                        self._logger.debug('Retry write...')
-                    self._serial.write(encoded_message)
-                    self._serial.write(b'\0')
-                    next_retry = time.time() + Splitflap.RETRY_TIMEOUT
-                
-                try:
-                    latest_ack_nonce = self._ack_q.get(timeout=next_retry - time.time())
-                except Empty:
-                    latest_ack_nonce = None
+        # Messages not sent yet
+        pending = deque()
+        # Nonce -> [encoded message, next retry time] for messages awaiting acks, in the order they were sent
+        in_flight = OrderedDict()
+        in_flight_pipelined = False
 
-                # Check for shutdown
-                if not self._run:
-                    self._logger.debug('Write loop exiting @ _ack_q')
-                    return
+        # A lone 0 switches the firmware from the legacy protocol, and ends any partial frame it's in the middle of
+        self._write_encoded(b'')
 
-                if latest_ack_nonce == nonce:
-                    break
+        while True:
+            timeout = None
+            if in_flight:
+                timeout = max(0, min(retry for _, retry in in_flight.values()) - time.time())
+            try:
+                item = self._out_q.get(timeout=timeout)
+            except Empty:
+                item = None
+
+            while item is not None:
+                if isinstance(item, splitflap_pb2.Ack):
+                    self._handle_ack(item, in_flight)
                 else:
-                    self._logger.debug(f'Got unexpected nonce: {latest_ack_nonce}')
-    
-    def _enqueue_message(self, message):
-        nonce = self._next_nonce
-        self._next_nonce += 1
+                    pending.append(item)
+                    if len(pending) > 10:
+                        self._logger.warning(f'Output queue length is high! ({len(pending)}) Is the splitflap still connected and functional?')
+                try:
+                    item = self._out_q.get_nowait()
+                except Empty:
+                    item = None
 
-        message.nonce = nonce
+            # Check for shutdown
+            if not self._run:
+                self._logger.debug('Write loop exiting')
+                return
 
+            now = time.time()
+            for encoded_message_and_retry in in_flight.values():
+                if now >= encoded_message_and_retry[1]:
+                    self._logger.debug('Retry write...')
+                    self._write_encoded(encoded_message_and_retry[0])
+                    encoded_message_and_retry[1] = now + Splitflap.RETRY_TIMEOUT
+
+            # Only configs are pipelined, since a retried message can take effect after later ones (see
+            # ToSplitflap.pipelined). Anything else waits for everything before it to be acked, and everything after
+            # it waits for its ack in turn.
+            while pending:
+                pipelined = self._ack_window_size > 1 and pending[0].WhichOneof('payload') == 'splitflap_config'
+                if in_flight:
+                    # The device only recognizes retries within its window of nonces
+                    oldest_nonce = next(iter(in_flight))
+                    window_full = (self._next_nonce - oldest_nonce) & 0xffffffff >= self._ack_window_size
+                    if not pipelined or not in_flight_pipelined or window_full:
+                        break
+
+                message = pending.popleft()
+                nonce = self._next_nonce
+                self._next_nonce = (self._next_nonce + 1) & 0xffffffff
+                message.nonce = nonce
+                message.pipelined = pipelined
+                encoded_message = self._encode_message(message)
+                self._write_encoded(encoded_message)
+                in_flight[nonce] = [encoded_message, time.time() + Splitflap.RETRY_TIMEOUT]
+                in_flight_pipelined = pipelined
+
+    def _handle_ack(self, ack, in_flight):
+        if ack.nonce not in in_flight:
+            self._logger.debug(f'Got unexpected nonce: {ack.nonce}')
+        in_flight.pop(ack.nonce, None)
+
+        # Pipelined acks also cover everything else the device has handled recently, in case earlier acks were lost
+        if ack.window_received:
+            for nonce in list(in_flight):
+                behind = (ack.window_end_nonce - nonce) & 0xffffffff
+                if behind < 32 and ack.window_received & (1 << behind):
+                    del in_flight[nonce]
+
+    def _encode_message(self, message):
         payload = bytearray(message.SerializeToString())
 
         crc = zlib.crc32(payload) & 0xffffffff
@@ -181,14 +265,14 @@ class Splitflap(object):
         payload.append((crc >> 16) & 0xff)
         payload.append((crc >> 24) & 0xff)
 
-        encoded_message = cobs.encode(payload)
+        return cobs.encode(payload)
 
-        self._out_q.put((nonce, encoded_message))
+    def _write_encoded(self, encoded_message):
+        self._serial.write(encoded_message)
+        self._serial.write(b'\0')
 
-        approx_q_length = self._out_q.qsize()
-        self._logger.debug(f'Out q length: {approx_q_length}')
-        if approx_q_length > 10:
-            self._logger.warning(f'Output queue length is high! ({approx_q_length}) Is the splitflap still connected and functional?')
+    def _enqueue_message(self, message):
+        self._out_q.put(message)
 
     def get_alphabet(self):
         return self._alphabet
@@ -227,6 +311,60 @@ class Splitflap(object):
         message.splitflap_config.CopyFrom(self._current_config)
         self._enqueue_message(message)
 
+    def set_synchronized_arrival(self, enabled):
+        """When enabled, subsequent set_text/set_positions calls make all moving modules land at the same time."""
+        self._current_config.synchronized_arrival = enabled
+
+    def queue_positions(self, positions, dwell_millis=0):
+        """Adds a flap index (or None to leave it alone) to the end of each module's queue on the device.
+
+        Each module works through its queue on its own, staying on each flap for at least dwell_millis before moving
+        on, so a whole sequence can be sent up front with one call per step. set_text/set_positions replace any
+        queue that hasn't finished yet.
+        """
+        assert self._num_modules is not None, 'Cannot queue positions before number of modules is known'
+        assert len(positions) <= self._num_modules, 'More positions specified than modules'
+
+        message = splitflap_pb2.ToSplitflap()
+        for i, position in enumerate(positions):
+            module = message.splitflap_command.modules.add()
+            if position is not None:
+                module.action = splitflap_pb2.SplitflapCommand.ModuleCommand.Action.QUEUE_FLAP
+                module.param = position
+                module.dwell_millis = dwell_millis
+                # Where the module ends up, so that later set_positions calls don't send it back
+                self._current_config.modules[i].target_flap_index = position
+        self._enqueue_message(message)
+
+    def clear_queues(self):
+        """Drops everything queued up by queue_positions; moves already under way carry on."""
+        message = splitflap_pb2.ToSplitflap()
+        for i in range(self._num_modules):
+            module = message.splitflap_command.modules.add()
+            module.action = splitflap_pb2.SplitflapCommand.ModuleCommand.Action.CLEAR_QUEUE
+        self._enqueue_message(message)
+
+    def upload_timeline(self, timeline):
+        """Stores an animation timeline (e.g. from timeline.Timeline.encode()) on the device, replacing the previous one."""
+        for offset in range(0, len(timeline), Splitflap.TIMELINE_CHUNK_SIZE):
+            message = splitflap_pb2.ToSplitflap()
+            message.timeline_upload.offset = offset
+            message.timeline_upload.data = bytes(timeline[offset:offset + Splitflap.TIMELINE_CHUNK_SIZE])
+            message.timeline_upload.done = offset + Splitflap.TIMELINE_CHUNK_SIZE >= len(timeline)
+            self._enqueue_message(message)
+
+    def play_timeline(self, loops=0):
+        """Plays the stored timeline loops times, or until stop_timeline() (or any other move) if loops is 0."""
+        message = splitflap_pb2.ToSplitflap()
+        message.timeline_control.action = splitflap_pb2.TimelineControl.Action.PLAY
+        message.timeline_control.loops = loops
+        self._enqueue_message(message)
+
+    def stop_timeline(self):
+        message = splitflap_pb2.ToSplitflap()
+        message.timeline_control.action = splitflap_pb2.TimelineControl.Action.STOP
+        self._enqueue_message(message)
+
     def start(self):
         self.read_thread = Thread(target=self._read_loop)
         self.write_thread = Thread(target=self._write_loop)
@@ -239,7 +377,6 @@ class Splitflap(object):
         self.read_thread.join()
         self._logger.debug('Read thread terminated')
         self._out_q.put(None)
-        self._ack_q.put(None)
         self.write_thread.join()
         self._logger.debug('Write thread terminated')
     
@@ -255,6 +392,7 @@ class Splitflap(object):
     def request_state(self):
         message = splitflap_pb2.ToSplitflap()
         message.request_state.SetInParent()
+        message.request_state.state_deltas = self._state_deltas
         self._enqueue_message(message)
 
     def hard_reset(self):
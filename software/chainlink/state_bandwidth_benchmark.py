@@ -0,0 +1,168 @@
+import argparse
+import os
+import random
+import struct
+import sys
+import zlib
+
+from cobs import cobs
+
+software_root = os.path.dirname(os.path.abspath(__file__))
+sys.path.append(os.path.join(software_root, 'proto_gen'))
+
+from proto_gen import splitflap_pb2
+
+# Keep in sync with firmware/esp32/splitflap/serial_proto_protocol.cpp
+MIN_STATE_INTERVAL_MILLIS = 100
+PERIODIC_STATE_INTERVAL_MILLIS = 5000
+
+SPLITFLAP_BAUD = 230400
+NUM_FLAPS = 40
+
+
+def _frame_size(message):
+    """Bytes on the wire for a FromSplitflap message: COBS-encoded proto + CRC32, plus the 0 delimiter."""
+    payload = message.SerializeToString()
+    crc = zlib.crc32(payload) & 0xffffffff
+    return len(cobs.encode(payload + struct.pack('<I', crc))) + 1
+
+
+# Keep in sync with SerialLegacyJsonProtocol::dumpStatus() in firmware/esp32/splitflap/serial_legacy_json_protocol.cpp
+_LEGACY_STATE_NAMES = {
+    splitflap_pb2.SplitflapState.ModuleState.NORMAL: 'normal',
+    splitflap_pb2.SplitflapState.ModuleState.LOOK_FOR_HOME: 'look_for_home',
+    splitflap_pb2.SplitflapState.ModuleState.SENSOR_ERROR: 'sensor_error',
+    splitflap_pb2.SplitflapState.ModuleState.PANIC: 'panic',
+    splitflap_pb2.SplitflapState.ModuleState.STATE_DISABLED: 'disabled',
+}
+
+
+def _legacy_status(modules):
+    """The legacy JSON protocol's status line for the modules, and how many separate stream writes it takes."""
+    parts = ['{"type":"status", "modules":[']
+    for i, module in enumerate(modules):
+        parts += [
+            '{"state":"', _LEGACY_STATE_NAMES[module.state],
+            '", "flap":"', 'X',
+            '", "count_missed_home":', str(module.count_missed_home),
+            ', "count_unexpected_home":', str(module.count_unexpected_home),
+            '}',
+        ]
+        if i < len(modules) - 1:
+            parts.append(', ')
+    parts.append(']}\n')
+    return ''.join(parts).encode(), len(parts)
+
+
+def _simulate(num_modules, seconds, text_interval_millis, flaps_per_second, seed):
+    """Yields (millis, [ModuleState]) every MIN_STATE_INTERVAL_MILLIS for a display showing a new random text every
+    text_interval_millis. Each module starts its move somewhere in the first second (as the power scheduler spreads
+    them out) and then steps through the flaps at flaps_per_second."""
+    rng = random.Random(seed)
+    flap_index = [0] * num_modules
+    target = [0] * num_modules
+    start_millis = [0] * num_modules
+    progress = [0.0] * num_modules
+
+    for millis in range(0, seconds * 1000, MIN_STATE_INTERVAL_MILLIS):
+        if millis % text_interval_millis == 0:
+            for i in range(num_modules):
+                target[i] = rng.randrange(NUM_FLAPS)
+                start_millis[i] = millis + rng.randrange(0, 1000, MIN_STATE_INTERVAL_MILLIS)
+
+        modules = []
+        for i in range(num_modules):
+            moving = millis >= start_millis[i] and flap_index[i] != target[i]
+            if moving:
+                progress[i] += flaps_per_second * MIN_STATE_INTERVAL_MILLIS / 1000
+                while progress[i] >= 1 and flap_index[i] != target[i]:
+                    progress[i] -= 1
+                    flap_index[i] = (flap_index[i] + 1) % NUM_FLAPS
+                moving = flap_index[i] != target[i]
+            if not moving:
+                progress[i] = 0.0
+            modules.append(splitflap_pb2.SplitflapState.ModuleState(
+                flap_index=flap_index[i],
+                moving=moving,
+                home_state=flap_index[i] == 0,
+                max_accel_step=14,
+            ))
+        yield millis, modules
+
+
+def run(num_modules, seconds, text_interval_millis, flaps_per_second, baud, seed):
+    full_bytes = 0
+    full_max_frame = 0
+    delta_bytes = 0
+    delta_max_frame = 0
+    frames = 0
+    keyframes = 0
+    keyframe_bytes = 0
+
+    last_sent = None
+    last_keyframe_millis = None
+    generation = 0
+    for millis, modules in _simulate(num_modules, seconds, text_interval_millis, flaps_per_second, seed):
+        keyframe = last_keyframe_millis is None or millis - last_keyframe_millis > PERIODIC_STATE_INTERVAL_MILLIS
+        if not keyframe and modules == last_sent:
+            continue
+        frames += 1
+        generation += 1
+
+        # Current encoding: the full state on every change, as well as periodically
+        full = splitflap_pb2.FromSplitflap()
+        full.splitflap_state.modules.extend(modules)
+        full.splitflap_state.generation = generation
+        size = _frame_size(full)
+        full_bytes += size
+        full_max_frame = max(full_max_frame, size)
+
+        # Deltas for changes, with the full state as a periodic keyframe (or if every module changed)
+        indices = [] if keyframe else [i for i in range(num_modules) if modules[i] != last_sent[i]]
+        if keyframe or len(indices) == num_modules:
+            size = _frame_size(full)
+            last_keyframe_millis = millis
+            keyframes += 1
+            keyframe_bytes += size
+        else:
+            delta = splitflap_pb2.FromSplitflap()
+            delta.splitflap_state_delta.base_generation = generation - 1
+            delta.splitflap_state_delta.generation = generation
+            delta.splitflap_state_delta.modules.extend(modules[i] for i in indices)
+            delta.splitflap_state_delta.module_indices = bytes(indices)
+            size = _frame_size(delta)
+        delta_bytes += size
+        delta_max_frame = max(delta_max_frame, size)
+
+        last_sent = modules
+
+    link_bytes_per_second = baud / 10
+
+    print(f'{num_modules} modules, {seconds}s, new text every {text_interval_millis}ms, {flaps_per_second} flaps/s, {baud} baud ({link_bytes_per_second:.0f} bytes/s)')
+    print(f'{frames} state messages')
+    for name, total, max_frame in (('Full state', full_bytes, full_max_frame), ('Delta', delta_bytes, delta_max_frame)):
+        bytes_per_second = total / seconds
+        print(f'{name:>10}: {total:8d} bytes, {bytes_per_second:8.0f} bytes/s ({bytes_per_second / link_bytes_per_second * 100:5.1f}% of link), largest frame {max_frame} bytes ({max_frame / link_bytes_per_second * 1000:.1f}ms)')
+
+    # Cost of a single status update of every module, as the legacy protocol sends after each move
+    legacy_line, legacy_writes = _legacy_status(last_sent)
+    state = splitflap_pb2.FromSplitflap()
+    state.splitflap_state.modules.extend(last_sent)
+    state.splitflap_state.generation = generation
+    delta_frames = max(1, frames - keyframes)
+    print(f'Per status update: legacy JSON {len(legacy_line)} bytes in {legacy_writes} stream writes, SplitflapState {_frame_size(state)} bytes in 2 (a COBS frame and its delimiter), SplitflapStateDelta {(delta_bytes - keyframe_bytes) / delta_frames:.0f} bytes on average')
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser('Compares serial bandwidth of SplitflapState vs SplitflapStateDelta while animating, and the cost of a legacy JSON status update')
+    parser.add_argument('--modules', type=int, default=108)
+    parser.add_argument('--seconds', type=int, default=60)
+    parser.add_argument('--text-interval-millis', type=int, default=3000, help='How often the simulated display shows new text')
+    parser.add_argument('--flaps-per-second', type=float, default=12, help='How fast each simulated module moves')
+    parser.add_argument('--baud', type=int, default=SPLITFLAP_BAUD)
+    parser.add_argument('--seed', type=int, default=0)
+    args = parser.parse_args()
+
+    assert 0 < args.modules <= 255
+    assert args.text_interval_millis % MIN_STATE_INTERVAL_MILLIS == 0
+    run(args.modules, args.seconds, args.text_interval_millis, args.flaps_per_second, args.baud, args.seed)
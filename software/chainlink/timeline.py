@@ -0,0 +1,78 @@
+import argparse
+import logging
+import struct
+
+from splitflap_proto import (
+    ask_for_serial_port,
+    splitflap_context,
+)
+
+# Keep in sync with firmware/esp32/core/timeline.h
+_MAGIC = b'SFTL'
+_VERSION = 1
+NO_CHANGE = 0xFF
+
+FLAG_AFTER_STOP = 1 << 0
+FLAG_SYNCHRONIZED_ARRIVAL = 1 << 1
+FLAG_FORCE_MOVEMENT = 1 << 2
+
+
+class Timeline(object):
+    """Builds an animation timeline to upload with Splitflap.upload_timeline() and play back on the device."""
+
+    def __init__(self, num_modules):
+        assert 0 < num_modules <= 255
+        self._num_modules = num_modules
+        self._frames = []
+
+    def add_frame(self, positions, delay_millis=0, flags=FLAG_AFTER_STOP):
+        """Adds a frame of flap indexes (None leaves a module alone), shown delay_millis after the previous one.
+
+        With FLAG_AFTER_STOP (the default) the delay counts from when the previous frame's modules have all
+        stopped; otherwise it counts from when the previous frame was shown, so moves can overlap.
+        """
+        assert len(positions) <= self._num_modules, 'More positions specified than modules'
+        assert 0 <= delay_millis <= 0xFFFF
+        assert len(self._frames) < 0xFFFF, 'Too many frames'
+        targets = [NO_CHANGE if p is None else p for p in positions]
+        targets += [NO_CHANGE] * (self._num_modules - len(targets))
+        self._frames.append(struct.pack('<HBB', delay_millis, flags, 0) + bytes(targets))
+
+    def add_text(self, text, alphabet, delay_millis=0, flags=FLAG_AFTER_STOP):
+        """Adds a frame showing text, padded with blanks to the full width"""
+        text = text[:self._num_modules].ljust(self._num_modules)
+        self.add_frame([alphabet.index(c) if c in alphabet else 0 for c in text], delay_millis, flags)
+
+    def encode(self):
+        assert self._frames, 'A timeline needs at least one frame'
+        header = _MAGIC + struct.pack('<BBH', _VERSION, self._num_modules, len(self._frames))
+        return header + b''.join(self._frames)
+
+
+def _run_example():
+    p = ask_for_serial_port()
+    with splitflap_context(p) as s:
+        modules = s.get_num_modules()
+        alphabet = s.get_alphabet()
+
+        # Scroll a message across the display, one frame every 2 seconds after the modules stop
+        message = ' ' * modules + 'HELLO WORLD' + ' ' * modules
+        timeline = Timeline(modules)
+        for i in range(len(message) - modules + 1):
+            timeline.add_text(message[i:i + modules], alphabet, delay_millis=2000)
+
+        s.upload_timeline(timeline.encode())
+        s.play_timeline()
+        input('Playing. Press enter to stop...')
+        s.stop_timeline()
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser('Splitflap timeline example')
+    parser.add_argument('--verbose', '-v', action='store_true', help='Enable verbose logging')
+    args = parser.parse_args()
+
+    log_level = logging.DEBUG if args.verbose else logging.INFO
+    logging.basicConfig(level=log_level, format='%(asctime)s:%(name)s:%(levelname)s:%(message)s')
+
+    _run_example()
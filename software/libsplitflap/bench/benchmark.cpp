@@ -0,0 +1,182 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+/*
+ * Measures how many configs per second the client gets acked, and how long each takes to be acked, against a fake
+ * firmware on a pty. Compares stop-and-wait (max_in_flight = 1, like protocol version 2) with pipelining.
+ *
+ *     splitflap_benchmark [--modules N] [--messages N] [--latency-micros N] [--loss P] [--baud N] [--seed N]
+ */
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "fake_firmware.h"
+#include "splitflap/client.h"
+
+using namespace splitflap;
+using Clock = std::chrono::steady_clock;
+
+struct BenchmarkOptions {
+    std::vector<size_t> num_modules = {12, 108};
+    size_t num_messages = 500;
+    std::chrono::microseconds latency = std::chrono::microseconds(2000);
+    double loss = 0;
+    uint32_t baud = 230400;
+    uint32_t seed = 0;
+};
+
+static double percentile(std::vector<double> values, double p) {
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, (size_t)(p * values.size()))];
+}
+
+static bool run(const BenchmarkOptions& options, size_t num_modules, uint32_t max_in_flight) {
+    FakeFirmware::Options firmware_options;
+    firmware_options.baud = options.baud;
+    firmware_options.latency = options.latency;
+    firmware_options.loss = options.loss;
+    firmware_options.num_modules = num_modules;
+    firmware_options.seed = options.seed;
+    FakeFirmware firmware(firmware_options);
+    firmware.start();
+
+    Client::Options client_options;
+    client_options.baud = options.baud;
+    client_options.max_in_flight = max_in_flight;
+    std::unique_ptr<Client> client = Client::open(firmware.devicePath(), client_options);
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool connected = false;
+    size_t acked = 0;
+    client->onGeneralState([&](const GeneralState&) {
+        std::lock_guard<std::mutex> lock(mutex);
+        connected = true;
+        cv.notify_all();
+    });
+    client->start();
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!cv.wait_for(lock, std::chrono::seconds(5), [&]() { return connected; })) {
+            fprintf(stderr, "No GeneralState from the fake firmware\n");
+            return false;
+        }
+    }
+    while (client->pending() > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::mt19937 rng(options.seed);
+    std::vector<std::vector<ModuleConfig>> configs(options.num_messages, std::vector<ModuleConfig>(num_modules));
+    for (std::vector<ModuleConfig>& config : configs) {
+        for (ModuleConfig& module : config) {
+            module.target_flap_index = (uint8_t)(rng() % 40);
+        }
+    }
+
+    std::vector<Clock::time_point> sent(options.num_messages);
+    std::vector<double> latency_millis(options.num_messages);
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < options.num_messages; i++) {
+        sent[i] = Clock::now();
+        client->sendConfig(configs[i], false, [&, i]() {
+            latency_millis[i] = std::chrono::duration<double, std::milli>(Clock::now() - sent[i]).count();
+            std::lock_guard<std::mutex> lock(mutex);
+            acked++;
+            cv.notify_all();
+        });
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!cv.wait_for(lock, std::chrono::seconds(300), [&]() { return acked == options.num_messages; })) {
+            fprintf(stderr, "Timed out with %zu of %zu configs acked\n", acked, options.num_messages);
+            return false;
+        }
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    client->stop();
+    firmware.stop();
+    Stats stats = client->stats();
+    FakeFirmware::Counts counts = firmware.counts();
+
+    // Whatever got skipped along the way, the display has to end up showing the last config
+    bool ok = true;
+    for (size_t i = 0; i < num_modules; i++) {
+        ok = ok && counts.targets[i] == configs.back()[i].target_flap_index;
+    }
+
+    printf("%7zu  %-14s  %8.1f  %8.1f  %8.1f  %7llu  %7llu  %7llu  %s\n",
+           num_modules,
+           max_in_flight > 1 ? "pipelined" : "stop-and-wait",
+           options.num_messages / seconds,
+           percentile(latency_millis, 0.5),
+           percentile(latency_millis, 0.99),
+           (unsigned long long)stats.retries,
+           (unsigned long long)counts.configs_applied,
+           (unsigned long long)counts.configs_skipped,
+           ok ? "ok" : "WRONG FINAL STATE");
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    BenchmarkOptions options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 == argc) {
+            fprintf(stderr, "Missing value for %s\n", arg.c_str());
+            return 2;
+        }
+        const char* value = argv[++i];
+        if (arg == "--modules") {
+            options.num_modules = {(size_t)atoi(value)};
+        } else if (arg == "--messages") {
+            options.num_messages = (size_t)atoi(value);
+        } else if (arg == "--latency-micros") {
+            options.latency = std::chrono::microseconds(atoi(value));
+        } else if (arg == "--loss") {
+            options.loss = atof(value);
+        } else if (arg == "--baud") {
+            options.baud = (uint32_t)atoi(value);
+        } else if (arg == "--seed") {
+            options.seed = (uint32_t)atoi(value);
+        } else {
+            fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            return 2;
+        }
+    }
+    if (options.num_messages == 0) {
+        fprintf(stderr, "--messages must be at least 1\n");
+        return 2;
+    }
+
+    printf("%zu configs, %u baud, %lldus latency, %.1f%% loss\n", options.num_messages, options.baud,
+           (long long)options.latency.count(), options.loss * 100);
+    printf("%7s  %-14s  %8s  %8s  %8s  %7s  %7s  %7s\n",
+           "modules", "mode", "msgs/s", "p50 ms", "p99 ms", "retries", "applied", "skipped");
+    bool ok = true;
+    for (size_t num_modules : options.num_modules) {
+        for (uint32_t max_in_flight : {1u, 32u}) {
+            ok = run(options, num_modules, max_in_flight) && ok;
+        }
+    }
+    return ok ? 0 : 1;
+}
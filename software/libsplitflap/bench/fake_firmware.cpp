@@ -0,0 +1,320 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "fake_firmware.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <system_error>
+#include <termios.h>
+#include <unistd.h>
+
+#include "framing.h"
+#include "protocol.h"
+
+namespace splitflap {
+
+// Keep in sync with firmware/esp32/splitflap/serial_proto_protocol.{h,cpp}
+static const int32_t ACK_WINDOW_SIZE = 32;
+static const auto MIN_STATE_INTERVAL = std::chrono::milliseconds(100);
+
+// SplitflapConfig fields; keep in sync with proto/splitflap.proto
+static const uint32_t CONFIG_MODULES = 1;
+static const uint32_t MODULE_CONFIG_TARGET_FLAP_INDEX = 1;
+
+static const char FLAP_CHARACTER_SET[] = " ABCDEFGHIJKLMNOPQRSTUVWXYZgfrwyopt0123456789!?.,";
+
+FakeFirmware::FakeFirmware(const Options& options) : options_(options), rng_(options.seed) {
+    master_fd_ = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (master_fd_ < 0 || grantpt(master_fd_) != 0 || unlockpt(master_fd_) != 0) {
+        throw std::system_error(errno, std::generic_category(), "Couldn't create pty");
+    }
+    device_path_ = ptsname(master_fd_);
+
+    // Keep the slave open so that the master doesn't see a hangup between clients, and make it raw so the line
+    // discipline doesn't touch anything before the client configures it
+    slave_fd_ = ::open(device_path_.c_str(), O_RDWR | O_NOCTTY | O_CLOEXEC);
+    struct termios tty;
+    if (slave_fd_ < 0 || tcgetattr(slave_fd_, &tty) != 0) {
+        throw std::system_error(errno, std::generic_category(), "Couldn't open " + device_path_);
+    }
+    cfmakeraw(&tty);
+    tcsetattr(slave_fd_, TCSANOW, &tty);
+    fcntl(master_fd_, F_SETFL, fcntl(master_fd_, F_GETFL) | O_NONBLOCK);
+
+    state_.modules.resize(options_.num_modules);
+    for (ModuleState& module : state_.modules) {
+        module.home_state = true;
+        module.max_accel_step = 14;
+    }
+    state_.loopbacks_ok = true;
+    counts_.targets.resize(options_.num_modules);
+}
+
+FakeFirmware::~FakeFirmware() {
+    stop();
+    ::close(slave_fd_);
+    ::close(master_fd_);
+}
+
+void FakeFirmware::start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+    thread_ = std::thread(&FakeFirmware::run, this);
+}
+
+void FakeFirmware::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    thread_.join();
+}
+
+FakeFirmware::Counts FakeFirmware::counts() {
+    std::lock_guard<std::mutex> lock(counts_mutex_);
+    return counts_;
+}
+
+void FakeFirmware::run() {
+    uint8_t buffer[4096];
+    while (running_.load(std::memory_order_acquire)) {
+        // Wake up for the next event, but check for stop() now and then
+        Clock::time_point now = Clock::now();
+        Clock::time_point wake_at = now + std::chrono::milliseconds(20);
+        if (!events_.empty() && events_.begin()->first < wake_at) {
+            wake_at = events_.begin()->first;
+        }
+        struct pollfd poll_fd = {master_fd_, (short)(POLLIN | (tx_pending_.empty() ? 0 : POLLOUT)), 0};
+        auto timeout = std::chrono::ceil<std::chrono::milliseconds>(wake_at - now).count();
+        poll(&poll_fd, 1, (int)std::max<int64_t>(0, timeout));
+
+        now = Clock::now();
+        if (poll_fd.revents & POLLIN) {
+            ssize_t count = ::read(master_fd_, buffer, sizeof(buffer));
+            for (ssize_t i = 0; i < count; i++) {
+                if (buffer[i] != 0) {
+                    rx_frame_.push_back(buffer[i]);
+                    continue;
+                }
+                // The frame has to get down the line after everything before it
+                rx_line_free_ = std::max(rx_line_free_, now) + lineTime(rx_frame_.size() + 1);
+                if (!rx_frame_.empty()) {
+                    events_.emplace(rx_line_free_ + options_.latency, Event{false, std::move(rx_frame_)});
+                }
+                rx_frame_.clear();
+            }
+        }
+
+        while (!events_.empty() && events_.begin()->first <= now) {
+            Event event = std::move(events_.begin()->second);
+            events_.erase(events_.begin());
+            if (event.to_host) {
+                tx_pending_.insert(tx_pending_.end(), event.data.begin(), event.data.end());
+            } else {
+                handleFrame(event.data, now);
+            }
+        }
+
+        sendState(now);
+        flush();
+    }
+}
+
+void FakeFirmware::handleFrame(std::vector<uint8_t>& frame, Clock::time_point now) {
+    size_t payload_length;
+    uint32_t field;
+    const uint8_t* payload;
+    size_t message_length;
+    uint32_t nonce;
+    bool pipelined;
+    if (drop() || !decodeFrame(frame.data(), frame.size(), payload_length)
+            || !parseEnvelope(frame.data(), payload_length, field, payload, message_length, &nonce, &pipelined)) {
+        count(&Counts::frames_dropped);
+        return;
+    }
+
+    // Same as SerialProtoProtocol::handlePacket()
+    bool already_handled = pipelined ? !markPipelinedNonce(nonce) : nonce == last_nonce_;
+
+    std::vector<uint8_t> response;
+    Ack ack;
+    ack.nonce = nonce;
+    if (pipelined) {
+        ack.window_end_nonce = window_end_nonce_;
+        ack.window_received = window_received_;
+    }
+    encodeAckMessage(ack, response);
+    send(response, now);
+
+    if (already_handled) {
+        count(&Counts::duplicates);
+        return;
+    }
+    if (!pipelined) {
+        last_nonce_ = nonce;
+    }
+
+    switch (field) {
+        case to_splitflap::SPLITFLAP_CONFIG:
+            if (pipelined && (int32_t)(nonce - last_config_nonce_) < 0) {
+                count(&Counts::configs_skipped);
+                break;
+            }
+            last_config_nonce_ = nonce;
+            applyConfig(payload, message_length);
+            count(&Counts::configs_applied);
+            break;
+        case to_splitflap::SPLITFLAP_COMMAND:
+            count(&Counts::commands_applied);
+            break;
+        case to_splitflap::REQUEST_STATE: {
+            ProtoReader reader(payload, message_length);
+            while (reader.next()) {
+                state_deltas_ = state_deltas_ || (reader.field() == 1 && reader.varint() != 0);
+            }
+            state_requested_ = true;
+
+            GeneralState general_state;
+            general_state.serial_protocol_version = options_.serial_protocol_version;
+            general_state.uptime_millis = 1000;
+            general_state.flap_character_set = FLAP_CHARACTER_SET;
+            general_state.module_queue_depth = 10;
+            general_state.max_accel_step = 14;
+            general_state.ack_window_size = options_.serial_protocol_version >= 3 ? options_.ack_window_size : 0;
+            response.clear();
+            encodeGeneralStateMessage(general_state, response);
+            send(response, now);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+bool FakeFirmware::markPipelinedNonce(uint32_t nonce) {
+    // Same as SerialProtoProtocol::markPipelinedNonce()
+    int32_t ahead = (int32_t)(nonce - window_end_nonce_);
+    if (window_received_ == 0 || ahead >= ACK_WINDOW_SIZE || ahead <= -ACK_WINDOW_SIZE) {
+        window_end_nonce_ = nonce;
+        window_received_ = 1;
+        last_config_nonce_ = nonce - 1;
+        return true;
+    }
+    if (ahead > 0) {
+        window_end_nonce_ = nonce;
+        window_received_ = (window_received_ << ahead) | 1;
+        return true;
+    }
+    uint32_t bit = 1UL << -ahead;
+    if (window_received_ & bit) {
+        return false;
+    }
+    window_received_ |= bit;
+    return true;
+}
+
+void FakeFirmware::applyConfig(const uint8_t* data, size_t length) {
+    // Modules go straight to their targets
+    size_t i = 0;
+    ProtoReader reader(data, length);
+    while (reader.next() && i < state_.modules.size()) {
+        if (reader.field() != CONFIG_MODULES) {
+            continue;
+        }
+        uint8_t target = 0;
+        ProtoReader module(reader.data(), reader.length());
+        while (module.next()) {
+            if (module.field() == MODULE_CONFIG_TARGET_FLAP_INDEX) {
+                target = (uint8_t)module.varint();
+            }
+        }
+        state_.modules[i].flap_index = target;
+        state_.modules[i].home_state = target == 0;
+        std::lock_guard<std::mutex> lock(counts_mutex_);
+        counts_.targets[i] = target;
+        i++;
+    }
+}
+
+void FakeFirmware::sendState(Clock::time_point now) {
+    if (!state_requested_ && now - last_state_sent_ < MIN_STATE_INTERVAL) {
+        return;
+    }
+
+    std::vector<uint8_t> changed;
+    for (size_t i = 0; i < state_.modules.size(); i++) {
+        if (i >= last_sent_state_.modules.size()
+                || memcmp(&state_.modules[i], &last_sent_state_.modules[i], sizeof(ModuleState)) != 0) {
+            changed.push_back((uint8_t)i);
+        }
+    }
+    if (!state_requested_ && changed.empty()) {
+        return;
+    }
+
+    uint32_t base_generation = state_.generation++;
+    std::vector<uint8_t> message;
+    if (state_requested_ || !state_deltas_ || changed.size() == state_.modules.size()) {
+        encodeStateMessage(state_, message);
+    } else {
+        encodeStateDeltaMessage(base_generation, state_, changed, message);
+    }
+    send(message, now);
+
+    state_requested_ = false;
+    last_sent_state_ = state_;
+    last_state_sent_ = now;
+}
+
+void FakeFirmware::send(const std::vector<uint8_t>& payload, Clock::time_point now) {
+    std::vector<uint8_t> frame;
+    appendFrame(payload.data(), payload.size(), frame);
+    tx_line_free_ = std::max(tx_line_free_, now) + lineTime(frame.size());
+    if (drop()) {
+        count(&Counts::frames_dropped);
+        return;
+    }
+    events_.emplace(tx_line_free_ + options_.latency, Event{true, std::move(frame)});
+}
+
+void FakeFirmware::flush() {
+    if (tx_pending_.empty()) {
+        return;
+    }
+    ssize_t count = ::write(master_fd_, tx_pending_.data(), tx_pending_.size());
+    if (count > 0) {
+        tx_pending_.erase(tx_pending_.begin(), tx_pending_.begin() + count);
+    }
+}
+
+void FakeFirmware::count(uint64_t Counts::*counter) {
+    std::lock_guard<std::mutex> lock(counts_mutex_);
+    counts_.*counter += 1;
+}
+
+bool FakeFirmware::drop() {
+    return options_.loss > 0 && std::uniform_real_distribution<double>(0, 1)(rng_) < options_.loss;
+}
+
+FakeFirmware::Clock::duration FakeFirmware::lineTime(size_t bytes) const {
+    return std::chrono::duration_cast<Clock::duration>(
+            std::chrono::microseconds((uint64_t)bytes * 10 * 1000000 / options_.baud));
+}
+
+} // namespace splitflap
@@ -0,0 +1,128 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "splitflap/client.h"
+
+namespace splitflap {
+
+/**
+ * Stands in for the firmware's SerialProtoProtocol at the other end of a pty, so the client can be exercised without
+ * hardware. It acks (and dedups) like the firmware does, including the pipelined nonce window and skipping stale
+ * configs, and reports module state as keyframes and deltas.
+ *
+ * The pty itself is instantaneous, so the serial line is simulated: frames in each direction take their time at the
+ * given baud rate one after another, plus a fixed latency, and can be dropped at random.
+ */
+class FakeFirmware {
+    public:
+        struct Options {
+            uint32_t baud = 230400;
+            // One-way latency on top of the line time, e.g. for USB
+            std::chrono::microseconds latency = std::chrono::microseconds(2000);
+            // Chance of dropping each frame, in either direction
+            double loss = 0;
+            uint16_t serial_protocol_version = 3;
+            uint8_t ack_window_size = 32;
+            size_t num_modules = 108;
+            uint32_t seed = 0;
+        };
+
+        struct Counts {
+            uint64_t configs_applied = 0;
+            // Pipelined configs that arrived after a newer one had already been applied
+            uint64_t configs_skipped = 0;
+            uint64_t commands_applied = 0;
+            uint64_t duplicates = 0;
+            uint64_t frames_dropped = 0;
+            // Module targets from the last config applied
+            std::vector<uint8_t> targets;
+        };
+
+        explicit FakeFirmware(const Options& options);
+        ~FakeFirmware();
+
+        /** Path of the pty for the client to open */
+        const std::string& devicePath() const { return device_path_; }
+
+        void start();
+        void stop();
+
+        Counts counts();
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Event {
+            // Either a frame that has made it to the device, or one on its way back to the host
+            bool to_host;
+            std::vector<uint8_t> data;
+        };
+
+        const Options options_;
+        int master_fd_;
+        int slave_fd_;
+        std::string device_path_;
+
+        std::thread thread_;
+        std::atomic<bool> running_ = {false};
+
+        std::mutex counts_mutex_;
+        Counts counts_;
+
+        std::mt19937 rng_;
+        std::multimap<Clock::time_point, Event> events_;
+        Clock::time_point rx_line_free_;
+        Clock::time_point tx_line_free_;
+
+        std::vector<uint8_t> rx_frame_;
+        std::vector<uint8_t> tx_pending_;
+
+        uint32_t last_nonce_ = 0;
+        uint32_t window_end_nonce_ = 0;
+        uint32_t window_received_ = 0;
+        uint32_t last_config_nonce_ = 0;
+
+        SplitflapState state_;
+        SplitflapState last_sent_state_;
+        bool state_deltas_ = false;
+        bool state_requested_ = false;
+        Clock::time_point last_state_sent_;
+
+        void run();
+        void receive(Clock::time_point now);
+        void handleFrame(std::vector<uint8_t>& frame, Clock::time_point now);
+        bool markPipelinedNonce(uint32_t nonce);
+        void applyConfig(const uint8_t* data, size_t length);
+        void sendState(Clock::time_point now);
+        void send(const std::vector<uint8_t>& payload, Clock::time_point now);
+        void flush();
+        void count(uint64_t Counts::*counter);
+        bool drop();
+        Clock::duration lineTime(size_t bytes) const;
+};
+
+} // namespace splitflap
@@ -0,0 +1,212 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "splitflap.h"
+
+namespace splitflap {
+
+using ModuleState = splitflap_module_state;
+using ModuleConfig = splitflap_module_config;
+using ModuleCommand = splitflap_module_command;
+
+struct SplitflapState {
+    std::vector<ModuleState> modules;
+    bool loopbacks_ok = false;
+    uint32_t generation = 0;
+};
+
+struct GeneralState {
+    uint16_t serial_protocol_version = 0;
+    uint32_t uptime_millis = 0;
+    std::string_view flap_character_set;
+    uint8_t module_queue_depth = 0;
+    uint8_t max_accel_step = 0;
+    uint8_t ack_window_size = 0;
+};
+
+struct Stats {
+    uint64_t frames_sent = 0;
+    uint64_t retries = 0;
+    uint64_t acks = 0;
+    // Frames that failed COBS decoding, CRC or proto parsing
+    uint64_t bad_frames = 0;
+};
+
+/**
+ * Client for Chainlink splitflap firmware's serial protocol (see firmware/esp32/splitflap/serial_proto_protocol.h):
+ * COBS-framed protobuf messages with a CRC32, acked by nonce.
+ *
+ * All I/O happens on one thread, which waits on the port with epoll. Sends can come from any thread; they're queued
+ * and the I/O thread picks them up. Received frames are decoded in place in the receive buffer and parsed straight
+ * into the reported state, without intermediate message structs.
+ *
+ * Once the device reports serial_protocol_version 3 or later, configs are pipelined: up to the device's
+ * ack_window_size of them can be waiting for acks at once (see ToSplitflap.pipelined). Any other message waits for
+ * everything before it to be acked, and holds up everything after it until it's acked itself, so commands keep
+ * their order.
+ */
+class Client {
+    public:
+        struct Options {
+            // Serial port speed; ignored for ptys
+            uint32_t baud = 230400;
+            // Ask for SplitflapStateDelta messages instead of full states (handlers get full states either way)
+            bool state_deltas = true;
+            // How long to wait for an ack before sending a message again
+            std::chrono::milliseconds retry_timeout = std::chrono::milliseconds(250);
+            // Most configs to have waiting for acks at once, if the device allows that many; 1 turns pipelining off
+            uint32_t max_in_flight = 32;
+        };
+
+        using AckCallback = std::function<void()>;
+        using StateHandler = std::function<void(const SplitflapState&)>;
+        using GeneralStateHandler = std::function<void(const GeneralState&)>;
+        using LogHandler = std::function<void(std::string_view)>;
+
+        /** Opens and configures a serial port. Throws std::system_error on failure. */
+        static std::unique_ptr<Client> open(const std::string& path, const Options& options);
+
+        /** Takes over an already open, non-blocking file descriptor, e.g. a pty */
+        Client(int fd, const Options& options);
+        ~Client();
+
+        Client(const Client&) = delete;
+        Client& operator=(const Client&) = delete;
+
+        // Handlers run on the I/O thread, and must be set before start()
+        void onState(StateHandler handler) { state_handler_ = std::move(handler); }
+        void onGeneralState(GeneralStateHandler handler) { general_state_handler_ = std::move(handler); }
+        void onLog(LogHandler handler) { log_handler_ = std::move(handler); }
+
+        /** Starts the I/O thread, and requests the device's state */
+        void start();
+
+        /** Stops the I/O thread. Anything not acked yet is dropped. */
+        void stop();
+
+        // Each send is queued and returns right away; on_ack runs on the I/O thread once the device acks it
+        void sendConfig(const ModuleConfig* modules, size_t num_modules, bool synchronized_arrival = false,
+                        AckCallback on_ack = nullptr);
+        void sendConfig(const std::vector<ModuleConfig>& modules, bool synchronized_arrival = false,
+                        AckCallback on_ack = nullptr) {
+            sendConfig(modules.data(), modules.size(), synchronized_arrival, std::move(on_ack));
+        }
+        void sendCommand(const ModuleCommand* modules, size_t num_modules, AckCallback on_ack = nullptr);
+        void sendCommand(const std::vector<ModuleCommand>& modules, AckCallback on_ack = nullptr) {
+            sendCommand(modules.data(), modules.size(), std::move(on_ack));
+        }
+        void requestState(AckCallback on_ack = nullptr);
+
+        /** Number of sends that haven't been acked yet */
+        size_t pending() const { return pending_.load(std::memory_order_acquire); }
+
+        Stats stats();
+
+    private:
+        struct Outgoing {
+            // ToSplitflap payload field number, and the payload message encoded
+            uint8_t payload_field;
+            std::vector<uint8_t> payload;
+            AckCallback on_ack;
+        };
+
+        struct InFlight {
+            uint32_t nonce;
+            // Complete frame, COBS-encoded with its delimiter, for retries
+            std::vector<uint8_t> frame;
+            std::chrono::steady_clock::time_point retry_at;
+            AckCallback on_ack;
+        };
+
+        const Options options_;
+        int fd_;
+        int epoll_fd_;
+        int wake_fd_;
+
+        std::thread thread_;
+        std::atomic<bool> running_ = {false};
+
+        std::mutex queue_mutex_;
+        std::deque<Outgoing> queue_;
+        std::atomic<size_t> pending_ = {0};
+
+        std::mutex stats_mutex_;
+        Stats stats_;
+
+        // Everything below is only touched by the I/O thread
+
+        std::deque<Outgoing> unsent_;
+        std::deque<InFlight> in_flight_;
+        bool in_flight_pipelined_ = false;
+        // Starts out random, so that a new client isn't mistaken for retries from the last one
+        uint32_t next_nonce_;
+        uint32_t ack_window_size_ = 1;
+
+        std::vector<uint8_t> rx_buffer_;
+        size_t rx_length_ = 0;
+        // Set while skipping the rest of a frame that didn't fit in rx_buffer_
+        bool rx_overflowed_ = false;
+
+        std::vector<uint8_t> tx_buffer_;
+        size_t tx_offset_ = 0;
+        bool waiting_for_writable_ = false;
+        // Set once the port reports an error or hangs up, e.g. when the device is unplugged
+        bool port_failed_ = false;
+        std::vector<uint8_t> encode_buffer_;
+
+        SplitflapState state_;
+        bool have_state_ = false;
+        bool awaiting_keyframe_ = false;
+
+        StateHandler state_handler_;
+        GeneralStateHandler general_state_handler_;
+        LogHandler log_handler_;
+
+        void enqueue(Outgoing&& outgoing);
+        void wake();
+
+        void run();
+        int pollTimeoutMillis();
+        void handleReadable();
+        void handleWritable();
+        void updateWritableInterest();
+        void handleFrame(uint8_t* frame, size_t length);
+        void handleAck(uint32_t nonce, uint32_t window_end_nonce, uint32_t window_received);
+        std::deque<InFlight>::iterator completeInFlight(std::deque<InFlight>::iterator it);
+        void requestKeyframe();
+
+        void retryExpired();
+        void sendUnsent();
+        void writeFrame(const std::vector<uint8_t>& frame);
+        std::chrono::microseconds lineTime(size_t bytes) const;
+        void failPort();
+        void countStat(uint64_t Stats::*stat);
+};
+
+} // namespace splitflap
@@ -0,0 +1,151 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#pragma once
+
+/*
+ * C API for talking to Chainlink splitflap firmware over its serial protocol (see
+ * firmware/esp32/splitflap/serial_proto_protocol.h), for use from other languages. The C++ API is in client.h.
+ *
+ * Functions that can fail return 0 on success, or -1 with errno set. Callbacks run on the client's I/O thread, and
+ * must not block it.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Keep in sync with SplitflapState.ModuleState.State in proto/splitflap.proto */
+typedef enum {
+    SPLITFLAP_MODULE_NORMAL = 0,
+    SPLITFLAP_MODULE_LOOK_FOR_HOME = 1,
+    SPLITFLAP_MODULE_SENSOR_ERROR = 2,
+    SPLITFLAP_MODULE_PANIC = 3,
+    SPLITFLAP_MODULE_DISABLED = 4,
+} splitflap_module_state_kind;
+
+/* Keep in sync with SplitflapCommand.ModuleCommand.Action in proto/splitflap.proto */
+typedef enum {
+    SPLITFLAP_ACTION_NO_OP = 0,
+    SPLITFLAP_ACTION_GO_TO_FLAP = 1,
+    SPLITFLAP_ACTION_RESET_AND_HOME = 2,
+    SPLITFLAP_ACTION_QUEUE_FLAP = 3,
+    SPLITFLAP_ACTION_CLEAR_QUEUE = 4,
+    SPLITFLAP_ACTION_INCREASE_OFFSET_TENTH = 90,
+    SPLITFLAP_ACTION_INCREASE_OFFSET_HALF = 91,
+    SPLITFLAP_ACTION_SET_OFFSET = 92,
+    SPLITFLAP_ACTION_SET_MOTION_PROFILE = 93,
+} splitflap_action;
+
+/* Fields match SplitflapState.ModuleState */
+typedef struct {
+    uint8_t state; /* splitflap_module_state_kind */
+    uint8_t flap_index;
+    bool moving;
+    bool home_state;
+    uint8_t count_unexpected_home;
+    uint8_t count_missed_home;
+    uint16_t queue_wait_millis;
+    uint8_t queued_flaps;
+    uint8_t max_accel_step;
+} splitflap_module_state;
+
+/* Fields match SplitflapConfig.ModuleConfig */
+typedef struct {
+    uint8_t target_flap_index;
+    uint8_t movement_nonce;
+    uint8_t reset_nonce;
+} splitflap_module_config;
+
+/* Fields match SplitflapCommand.ModuleCommand */
+typedef struct {
+    uint8_t action; /* splitflap_action */
+    uint8_t param;
+    uint16_t dwell_millis;
+} splitflap_module_command;
+
+typedef struct {
+    uint16_t serial_protocol_version;
+    uint32_t uptime_millis;
+    /* Not NUL-terminated; only valid during the callback */
+    const char* flap_character_set;
+    size_t flap_character_set_length;
+    uint8_t module_queue_depth;
+    uint8_t max_accel_step;
+    uint8_t ack_window_size;
+} splitflap_general_state;
+
+typedef struct {
+    /* Serial port speed; ignored for ptys */
+    uint32_t baud;
+    /* Ask for SplitflapStateDelta messages instead of full states (the state callback gets full states either way) */
+    bool state_deltas;
+    /* How long to wait for an ack before sending a message again */
+    uint32_t retry_timeout_millis;
+    /* Most configs to have waiting for acks at once, if the device allows that many; 1 turns pipelining off */
+    uint32_t max_in_flight;
+} splitflap_options;
+
+typedef struct splitflap_client splitflap_client;
+
+typedef void (*splitflap_ack_callback)(void* user_data);
+typedef void (*splitflap_state_callback)(const splitflap_module_state* modules, size_t num_modules,
+                                         bool loopbacks_ok, void* user_data);
+typedef void (*splitflap_general_state_callback)(const splitflap_general_state* state, void* user_data);
+/* msg is not NUL-terminated, and is only valid during the callback */
+typedef void (*splitflap_log_callback)(const char* msg, size_t length, void* user_data);
+
+/* Fills in the default options */
+void splitflap_options_init(splitflap_options* options);
+
+/* Opens a serial port (e.g. /dev/ttyUSB0). options may be NULL for the defaults. Returns NULL on error. */
+splitflap_client* splitflap_open(const char* path, const splitflap_options* options);
+
+/* Takes over an already open, non-blocking file descriptor, e.g. a pty. Returns NULL on error. */
+splitflap_client* splitflap_from_fd(int fd, const splitflap_options* options);
+
+/* Stops the I/O thread if it's running and closes the port */
+void splitflap_close(splitflap_client* client);
+
+/* Callbacks must be set before splitflap_start() */
+void splitflap_set_state_callback(splitflap_client* client, splitflap_state_callback callback, void* user_data);
+void splitflap_set_general_state_callback(splitflap_client* client, splitflap_general_state_callback callback,
+                                          void* user_data);
+void splitflap_set_log_callback(splitflap_client* client, splitflap_log_callback callback, void* user_data);
+
+/* Starts the I/O thread, and requests the device's state */
+int splitflap_start(splitflap_client* client);
+
+/*
+ * Each send is queued and returns right away; callback (which may be NULL) runs once the device acks it. Messages
+ * take effect in the order they're sent, except that a config that had to be sent again may be skipped once a newer
+ * one has taken effect.
+ */
+int splitflap_send_config(splitflap_client* client, const splitflap_module_config* modules, size_t num_modules,
+                          bool synchronized_arrival, splitflap_ack_callback callback, void* user_data);
+int splitflap_send_command(splitflap_client* client, const splitflap_module_command* modules, size_t num_modules,
+                           splitflap_ack_callback callback, void* user_data);
+int splitflap_request_state(splitflap_client* client, splitflap_ack_callback callback, void* user_data);
+
+/* Number of messages sent with the functions above that haven't been acked yet */
+size_t splitflap_pending(splitflap_client* client);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
@@ -0,0 +1,474 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "splitflap/client.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <random>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <system_error>
+#include <unistd.h>
+
+#include "framing.h"
+#include "protocol.h"
+#include "serial_port.h"
+
+namespace splitflap {
+
+// Comfortably more than the largest encoded FromSplitflap (7160 bytes, a SplitflapStateDelta with 255 modules) plus CRC
+// and COBS overhead
+static const size_t RX_BUFFER_SIZE = 8192;
+
+// The device's window of pipelined nonces is a 32-bit bitmap (see Ack.window_received)
+static const uint32_t MAX_ACK_WINDOW_SIZE = 32;
+
+// Protocol version that added pipelining
+static const uint16_t PIPELINING_PROTOCOL_VERSION = 3;
+
+std::unique_ptr<Client> Client::open(const std::string& path, const Options& options) {
+    return std::make_unique<Client>(openSerialPort(path, options.baud), options);
+}
+
+Client::Client(int fd, const Options& options) :
+        options_(options),
+        fd_(fd),
+        epoll_fd_(-1),
+        wake_fd_(-1),
+        next_nonce_(std::random_device()()),
+        rx_buffer_(RX_BUFFER_SIZE) {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ >= 0) {
+        wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    }
+    struct epoll_event wake_event = {};
+    wake_event.events = EPOLLIN;
+    wake_event.data.fd = wake_fd_;
+    struct epoll_event port_event = {};
+    port_event.events = EPOLLIN;
+    port_event.data.fd = fd_;
+    if (wake_fd_ < 0
+            || epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &wake_event) != 0
+            || epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd_, &port_event) != 0) {
+        int error = errno;
+        if (wake_fd_ >= 0) {
+            ::close(wake_fd_);
+        }
+        if (epoll_fd_ >= 0) {
+            ::close(epoll_fd_);
+        }
+        ::close(fd_);
+        throw std::system_error(error, std::generic_category(), "Couldn't set up epoll");
+    }
+}
+
+Client::~Client() {
+    stop();
+    ::close(wake_fd_);
+    ::close(epoll_fd_);
+    ::close(fd_);
+}
+
+void Client::start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+    // Handlers only get full states, so nothing's reported until the first one arrives
+    awaiting_keyframe_ = true;
+    requestState();
+    thread_ = std::thread(&Client::run, this);
+}
+
+void Client::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    wake();
+    thread_.join();
+
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    queue_.clear();
+    unsent_.clear();
+    in_flight_.clear();
+    pending_.store(0, std::memory_order_release);
+}
+
+void Client::sendConfig(const ModuleConfig* modules, size_t num_modules, bool synchronized_arrival,
+                        AckCallback on_ack) {
+    Outgoing outgoing = {to_splitflap::SPLITFLAP_CONFIG, {}, std::move(on_ack)};
+    encodeConfig(modules, num_modules, synchronized_arrival, outgoing.payload);
+    enqueue(std::move(outgoing));
+}
+
+void Client::sendCommand(const ModuleCommand* modules, size_t num_modules, AckCallback on_ack) {
+    Outgoing outgoing = {to_splitflap::SPLITFLAP_COMMAND, {}, std::move(on_ack)};
+    encodeCommand(modules, num_modules, outgoing.payload);
+    enqueue(std::move(outgoing));
+}
+
+void Client::requestState(AckCallback on_ack) {
+    Outgoing outgoing = {to_splitflap::REQUEST_STATE, {}, std::move(on_ack)};
+    encodeRequestState(options_.state_deltas, outgoing.payload);
+    enqueue(std::move(outgoing));
+}
+
+Stats Client::stats() {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return stats_;
+}
+
+void Client::enqueue(Outgoing&& outgoing) {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        queue_.push_back(std::move(outgoing));
+        pending_.fetch_add(1, std::memory_order_acq_rel);
+    }
+    wake();
+}
+
+void Client::wake() {
+    uint64_t one = 1;
+    // Can only fail if the counter is about to overflow, in which case the I/O thread is already awake
+    ssize_t result = ::write(wake_fd_, &one, sizeof(one));
+    (void)result;
+}
+
+void Client::run() {
+    // A lone 0 switches the firmware from the legacy protocol, and ends any partial frame it's in the middle of
+    writeFrame(std::vector<uint8_t>(1, 0));
+
+    struct epoll_event events[2];
+    while (running_.load(std::memory_order_acquire)) {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            while (!queue_.empty()) {
+                unsent_.push_back(std::move(queue_.front()));
+                queue_.pop_front();
+            }
+        }
+
+        retryExpired();
+        sendUnsent();
+        updateWritableInterest();
+
+        int count = epoll_wait(epoll_fd_, events, sizeof(events) / sizeof(events[0]), pollTimeoutMillis());
+        for (int i = 0; i < count; i++) {
+            if (events[i].data.fd == wake_fd_) {
+                uint64_t value;
+                ssize_t result = ::read(wake_fd_, &value, sizeof(value));
+                (void)result;
+                continue;
+            }
+            if (events[i].events & EPOLLOUT) {
+                handleWritable();
+            }
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                handleReadable();
+            }
+        }
+    }
+}
+
+int Client::pollTimeoutMillis() {
+    if (in_flight_.empty()) {
+        return -1;
+    }
+    auto retry_at = in_flight_.front().retry_at;
+    for (const InFlight& in_flight : in_flight_) {
+        retry_at = std::min(retry_at, in_flight.retry_at);
+    }
+    auto wait = std::chrono::ceil<std::chrono::milliseconds>(retry_at - std::chrono::steady_clock::now());
+    return (int)std::max<int64_t>(0, wait.count());
+}
+
+void Client::handleReadable() {
+    while (!port_failed_) {
+        ssize_t count = ::read(fd_, rx_buffer_.data() + rx_length_, rx_buffer_.size() - rx_length_);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return;
+        }
+        if (count <= 0) {
+            failPort();
+            return;
+        }
+
+        // Decode each complete frame where it is in the buffer
+        size_t scan_from = rx_length_;
+        rx_length_ += count;
+        size_t frame_start = 0;
+        for (size_t i = scan_from; i < rx_length_; i++) {
+            if (rx_buffer_[i] != 0) {
+                continue;
+            }
+            if (rx_overflowed_) {
+                rx_overflowed_ = false;
+            } else if (i > frame_start) {
+                handleFrame(&rx_buffer_[frame_start], i - frame_start);
+            }
+            frame_start = i + 1;
+        }
+
+        // Keep the start of the next frame
+        if (frame_start > 0) {
+            memmove(rx_buffer_.data(), rx_buffer_.data() + frame_start, rx_length_ - frame_start);
+            rx_length_ -= frame_start;
+        }
+        if (rx_length_ == rx_buffer_.size()) {
+            // Too long to be a frame, so skip to the next delimiter
+            if (!rx_overflowed_) {
+                countStat(&Stats::bad_frames);
+            }
+            rx_overflowed_ = true;
+            rx_length_ = 0;
+        }
+    }
+}
+
+void Client::handleWritable() {
+    while (!port_failed_ && tx_offset_ < tx_buffer_.size()) {
+        ssize_t count = ::write(fd_, tx_buffer_.data() + tx_offset_, tx_buffer_.size() - tx_offset_);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return;
+        }
+        if (count < 0) {
+            failPort();
+            return;
+        }
+        tx_offset_ += count;
+    }
+    tx_buffer_.clear();
+    tx_offset_ = 0;
+}
+
+void Client::updateWritableInterest() {
+    bool want_writable = !port_failed_ && tx_offset_ < tx_buffer_.size();
+    if (want_writable == waiting_for_writable_) {
+        return;
+    }
+    struct epoll_event event = {};
+    event.events = want_writable ? EPOLLIN | EPOLLOUT : EPOLLIN;
+    event.data.fd = fd_;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd_, &event) == 0) {
+        waiting_for_writable_ = want_writable;
+    }
+}
+
+void Client::failPort() {
+    port_failed_ = true;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd_, nullptr);
+    tx_buffer_.clear();
+    tx_offset_ = 0;
+}
+
+void Client::handleFrame(uint8_t* frame, size_t length) {
+    size_t payload_length;
+    uint32_t field;
+    const uint8_t* payload;
+    size_t message_length;
+    if (!decodeFrame(frame, length, payload_length)
+            || !parseEnvelope(frame, payload_length, field, payload, message_length)) {
+        countStat(&Stats::bad_frames);
+        return;
+    }
+
+    bool ok = true;
+    switch (field) {
+        case from_splitflap::SPLITFLAP_STATE:
+            ok = parseState(payload, message_length, state_);
+            have_state_ = ok;
+            if (ok) {
+                awaiting_keyframe_ = false;
+                if (state_handler_) {
+                    state_handler_(state_);
+                }
+            }
+            break;
+        case from_splitflap::SPLITFLAP_STATE_DELTA: {
+            if (!have_state_) {
+                requestKeyframe();
+                break;
+            }
+            DeltaResult result = applyStateDelta(payload, message_length, state_);
+            if (result == DeltaResult::APPLIED) {
+                if (state_handler_) {
+                    state_handler_(state_);
+                }
+            } else if (result == DeltaResult::WRONG_BASE) {
+                // Missed a delta (probably a corrupted frame), so the state is out of date until the next keyframe
+                requestKeyframe();
+            }
+            ok = result != DeltaResult::MALFORMED;
+            break;
+        }
+        case from_splitflap::ACK: {
+            Ack ack;
+            ok = parseAck(payload, message_length, ack);
+            if (ok) {
+                handleAck(ack.nonce, ack.window_end_nonce, ack.window_received);
+            }
+            break;
+        }
+        case from_splitflap::GENERAL_STATE: {
+            GeneralState general_state;
+            ok = parseGeneralState(payload, message_length, general_state);
+            if (!ok) {
+                break;
+            }
+            if (general_state.serial_protocol_version >= PIPELINING_PROTOCOL_VERSION
+                    && general_state.ack_window_size > 1) {
+                ack_window_size_ = std::min({(uint32_t)general_state.ack_window_size, options_.max_in_flight,
+                                             MAX_ACK_WINDOW_SIZE});
+            } else {
+                ack_window_size_ = 1;
+            }
+            if (general_state_handler_) {
+                general_state_handler_(general_state);
+            }
+            break;
+        }
+        case from_splitflap::LOG: {
+            std::string_view msg;
+            ok = parseLog(payload, message_length, msg);
+            if (ok && log_handler_) {
+                log_handler_(msg);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    if (!ok) {
+        countStat(&Stats::bad_frames);
+    }
+}
+
+void Client::handleAck(uint32_t nonce, uint32_t window_end_nonce, uint32_t window_received) {
+    for (auto it = in_flight_.begin(); it != in_flight_.end();) {
+        // Pipelined acks also cover everything else the device has handled recently, in case earlier acks were lost
+        uint32_t behind = window_end_nonce - it->nonce;
+        bool in_window = window_received != 0 && behind < MAX_ACK_WINDOW_SIZE && (window_received >> behind) & 1;
+        if (it->nonce == nonce || in_window) {
+            it = completeInFlight(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+std::deque<Client::InFlight>::iterator Client::completeInFlight(std::deque<InFlight>::iterator it) {
+    AckCallback on_ack = std::move(it->on_ack);
+    it = in_flight_.erase(it);
+    pending_.fetch_sub(1, std::memory_order_acq_rel);
+    countStat(&Stats::acks);
+    if (on_ack) {
+        on_ack();
+    }
+    return it;
+}
+
+void Client::requestKeyframe() {
+    if (awaiting_keyframe_) {
+        return;
+    }
+    awaiting_keyframe_ = true;
+    Outgoing outgoing = {to_splitflap::REQUEST_STATE, {}, nullptr};
+    encodeRequestState(options_.state_deltas, outgoing.payload);
+    unsent_.push_back(std::move(outgoing));
+    pending_.fetch_add(1, std::memory_order_acq_rel);
+}
+
+void Client::retryExpired() {
+    auto now = std::chrono::steady_clock::now();
+    // Don't pile retries onto a port that isn't taking what it already has
+    bool port_backed_up = tx_offset_ < tx_buffer_.size();
+    for (InFlight& in_flight : in_flight_) {
+        if (now >= in_flight.retry_at) {
+            if (!port_backed_up) {
+                writeFrame(in_flight.frame);
+                countStat(&Stats::retries);
+            }
+            in_flight.retry_at = now + options_.retry_timeout + lineTime(in_flight.frame.size());
+        }
+    }
+}
+
+void Client::sendUnsent() {
+    // Only configs are pipelined, since a retried message can take effect after later ones (see
+    // ToSplitflap.pipelined). Anything else waits for everything before it to be acked, and everything after it
+    // waits for its ack in turn.
+    while (!unsent_.empty()) {
+        bool pipelined = ack_window_size_ > 1 && unsent_.front().payload_field == to_splitflap::SPLITFLAP_CONFIG;
+        if (!in_flight_.empty()) {
+            // The device only recognizes retries within its window of nonces
+            bool window_full = next_nonce_ - in_flight_.front().nonce >= ack_window_size_;
+            if (!pipelined || !in_flight_pipelined_ || window_full) {
+                break;
+            }
+        }
+
+        Outgoing outgoing = std::move(unsent_.front());
+        unsent_.pop_front();
+
+        InFlight in_flight = {next_nonce_++, {}, {}, std::move(outgoing.on_ack)};
+        encode_buffer_.clear();
+        encodeToSplitflap(in_flight.nonce, outgoing.payload_field, outgoing.payload, pipelined, encode_buffer_);
+        appendFrame(encode_buffer_.data(), encode_buffer_.size(), in_flight.frame);
+        writeFrame(in_flight.frame);
+
+        // A long run of pipelined frames takes a while to get down the line, so don't count that against the
+        // ack timeout
+        size_t queued_bytes = in_flight.frame.size();
+        for (const InFlight& earlier : in_flight_) {
+            queued_bytes += earlier.frame.size();
+        }
+        in_flight.retry_at = std::chrono::steady_clock::now() + options_.retry_timeout + lineTime(queued_bytes);
+        in_flight_.push_back(std::move(in_flight));
+        in_flight_pipelined_ = pipelined;
+        countStat(&Stats::frames_sent);
+    }
+}
+
+void Client::writeFrame(const std::vector<uint8_t>& frame) {
+    if (port_failed_) {
+        return;
+    }
+    tx_buffer_.insert(tx_buffer_.end(), frame.begin(), frame.end());
+    if (!waiting_for_writable_) {
+        handleWritable();
+    }
+}
+
+std::chrono::microseconds Client::lineTime(size_t bytes) const {
+    if (options_.baud == 0) {
+        return std::chrono::microseconds(0);
+    }
+    // 10 bits per byte, with the start and stop bits
+    return std::chrono::microseconds((uint64_t)bytes * 10 * 1000000 / options_.baud);
+}
+
+void Client::countStat(uint64_t Stats::*stat) {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats_.*stat += 1;
+}
+
+} // namespace splitflap
@@ -0,0 +1,114 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "framing.h"
+
+#include <cstring>
+
+namespace splitflap {
+
+static const uint32_t* crc32Table() {
+    static const auto table = [] {
+        std::vector<uint32_t> table(256);
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+            }
+            table[i] = crc;
+        }
+        return table;
+    }();
+    return table.data();
+}
+
+uint32_t crc32(const uint8_t* data, size_t length, uint32_t crc) {
+    const uint32_t* table = crc32Table();
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+void appendFrame(const uint8_t* payload, size_t length, std::vector<uint8_t>& out) {
+    uint32_t crc = crc32(payload, length);
+    const uint8_t crc_bytes[4] = {
+        (uint8_t)(crc & 0xFF),
+        (uint8_t)((crc >> 8) & 0xFF),
+        (uint8_t)((crc >> 16) & 0xFF),
+        (uint8_t)((crc >> 24) & 0xFF),
+    };
+    size_t total = length + sizeof(crc_bytes);
+    auto byteAt = [&](size_t i) {
+        return i < length ? payload[i] : crc_bytes[i - length];
+    };
+
+    // COBS: each block is a code byte (1 + the number of non-zero bytes that follow it) standing in for the next 0
+    out.reserve(out.size() + total + total / 254 + 2);
+    size_t code_index = out.size();
+    out.push_back(0);
+    uint8_t code = 1;
+    for (size_t i = 0; i < total; i++) {
+        uint8_t b = byteAt(i);
+        if (b == 0) {
+            out[code_index] = code;
+            code_index = out.size();
+            out.push_back(0);
+            code = 1;
+        } else {
+            out.push_back(b);
+            code++;
+            if (code == 0xFF) {
+                out[code_index] = code;
+                code_index = out.size();
+                out.push_back(0);
+                code = 1;
+            }
+        }
+    }
+    out[code_index] = code;
+    out.push_back(0);
+}
+
+bool decodeFrame(uint8_t* frame, size_t length, size_t& payload_length) {
+    // Decoded data is never longer than what's left to decode, so it can be written over the frame as we go
+    size_t read = 0;
+    size_t write = 0;
+    while (read < length) {
+        uint8_t code = frame[read++];
+        if (code == 0 || read + code - 1 > length) {
+            return false;
+        }
+        memmove(frame + write, frame + read, code - 1);
+        write += code - 1;
+        read += code - 1;
+        if (code != 0xFF && read < length) {
+            frame[write++] = 0;
+        }
+    }
+
+    if (write < 4) {
+        return false;
+    }
+    payload_length = write - 4;
+    uint32_t provided_crc = frame[payload_length]
+                         | (frame[payload_length + 1] << 8)
+                         | (frame[payload_length + 2] << 16)
+                         | ((uint32_t)frame[payload_length + 3] << 24);
+    return crc32(frame, payload_length) == provided_crc;
+}
+
+} // namespace splitflap
@@ -0,0 +1,39 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace splitflap {
+
+/**
+ * Appends payload as a frame the way SerialProtoProtocol sends and expects them: the payload followed by its
+ * little-endian CRC32, COBS-encoded, then a 0 delimiter.
+ */
+void appendFrame(const uint8_t* payload, size_t length, std::vector<uint8_t>& out);
+
+/**
+ * Undoes appendFrame() in place, given a frame without its delimiter. Returns false if the frame is malformed or the
+ * CRC doesn't match; otherwise payload_length is the length of the payload now at the start of frame.
+ */
+bool decodeFrame(uint8_t* frame, size_t length, size_t& payload_length);
+
+/** Standard (zlib) CRC32, continuing from crc */
+uint32_t crc32(const uint8_t* data, size_t length, uint32_t crc = 0);
+
+} // namespace splitflap
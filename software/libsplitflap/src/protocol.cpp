@@ -0,0 +1,473 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "protocol.h"
+
+#include <cstring>
+
+namespace splitflap {
+
+// Protobuf wire types
+static const uint8_t WIRE_VARINT = 0;
+static const uint8_t WIRE_64BIT = 1;
+static const uint8_t WIRE_LENGTH_DELIMITED = 2;
+static const uint8_t WIRE_32BIT = 5;
+
+// Fields of the messages below; keep in sync with proto/splitflap.proto
+namespace module_state {
+    const uint32_t STATE = 1;
+    const uint32_t FLAP_INDEX = 2;
+    const uint32_t MOVING = 3;
+    const uint32_t HOME_STATE = 4;
+    const uint32_t COUNT_UNEXPECTED_HOME = 5;
+    const uint32_t COUNT_MISSED_HOME = 6;
+    const uint32_t QUEUE_WAIT_MILLIS = 7;
+    const uint32_t QUEUED_FLAPS = 8;
+    const uint32_t MAX_ACCEL_STEP = 9;
+}
+namespace splitflap_state {
+    const uint32_t MODULES = 1;
+    const uint32_t LOOPBACKS_OK = 2;
+    const uint32_t GENERATION = 3;
+}
+namespace splitflap_state_delta {
+    const uint32_t BASE_GENERATION = 1;
+    const uint32_t GENERATION = 2;
+    const uint32_t MODULES = 3;
+    const uint32_t MODULE_INDICES = 4;
+    const uint32_t LOOPBACKS_OK = 5;
+}
+namespace ack {
+    const uint32_t NONCE = 1;
+    const uint32_t WINDOW_END_NONCE = 2;
+    const uint32_t WINDOW_RECEIVED = 3;
+}
+namespace general_state {
+    const uint32_t SERIAL_PROTOCOL_VERSION = 1;
+    const uint32_t UPTIME_MILLIS = 2;
+    const uint32_t FLAP_CHARACTER_SET = 4;
+    const uint32_t MODULE_QUEUE_DEPTH = 5;
+    const uint32_t MAX_ACCEL_STEP = 6;
+    const uint32_t ACK_WINDOW_SIZE = 7;
+}
+namespace log_message {
+    const uint32_t MSG = 1;
+}
+namespace splitflap_config {
+    const uint32_t MODULES = 1;
+    const uint32_t SYNCHRONIZED_ARRIVAL = 2;
+    const uint32_t TARGET_FLAP_INDEX = 1;
+    const uint32_t MOVEMENT_NONCE = 2;
+    const uint32_t RESET_NONCE = 3;
+}
+namespace splitflap_command {
+    const uint32_t MODULES = 2;
+    const uint32_t ACTION = 1;
+    const uint32_t PARAM = 2;
+    const uint32_t DWELL_MILLIS = 3;
+}
+namespace request_state {
+    const uint32_t STATE_DELTAS = 1;
+}
+
+void ProtoWriter::rawVarint(uint64_t value) {
+    while (value >= 0x80) {
+        out_.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    out_.push_back((uint8_t)value);
+}
+
+void ProtoWriter::varint(uint32_t field, uint64_t value) {
+    if (value == 0) {
+        return;
+    }
+    rawVarint((field << 3) | WIRE_VARINT);
+    rawVarint(value);
+}
+
+void ProtoWriter::bytes(uint32_t field, const void* data, size_t length) {
+    if (length == 0) {
+        return;
+    }
+    rawVarint((field << 3) | WIRE_LENGTH_DELIMITED);
+    rawVarint(length);
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    out_.insert(out_.end(), bytes, bytes + length);
+}
+
+size_t ProtoWriter::beginMessage(uint32_t field) {
+    rawVarint((field << 3) | WIRE_LENGTH_DELIMITED);
+    // Most sub-messages are short, so leave room for a 1-byte length and make more once we know it's longer
+    out_.push_back(0);
+    return out_.size();
+}
+
+void ProtoWriter::endMessage(size_t start) {
+    size_t length = out_.size() - start;
+    uint8_t prefix[10];
+    size_t prefix_length = 0;
+    uint64_t value = length;
+    while (value >= 0x80) {
+        prefix[prefix_length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    prefix[prefix_length++] = (uint8_t)value;
+
+    if (prefix_length > 1) {
+        out_.insert(out_.begin() + start, prefix_length - 1, 0);
+    }
+    memcpy(out_.data() + start - 1, prefix, prefix_length);
+}
+
+bool ProtoReader::readVarint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos_ == end_) {
+            return false;
+        }
+        uint8_t b = *pos_++;
+        value |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ProtoReader::next() {
+    if (!ok_ || pos_ == end_) {
+        return false;
+    }
+    uint64_t tag;
+    if (!readVarint(tag)) {
+        ok_ = false;
+        return false;
+    }
+    field_ = (uint32_t)(tag >> 3);
+    wire_type_ = tag & 0x7;
+    switch (wire_type_) {
+        case WIRE_VARINT:
+            ok_ = readVarint(varint_);
+            break;
+        case WIRE_LENGTH_DELIMITED: {
+            uint64_t length;
+            ok_ = readVarint(length) && length <= (uint64_t)(end_ - pos_);
+            if (ok_) {
+                data_ = pos_;
+                length_ = (size_t)length;
+                pos_ += length;
+            }
+            break;
+        }
+        case WIRE_64BIT:
+        case WIRE_32BIT: {
+            size_t size = wire_type_ == WIRE_64BIT ? 8 : 4;
+            ok_ = size <= (size_t)(end_ - pos_);
+            pos_ += ok_ ? size : 0;
+            break;
+        }
+        default:
+            ok_ = false;
+            break;
+    }
+    return ok_;
+}
+
+void encodeConfig(const ModuleConfig* modules, size_t num_modules, bool synchronized_arrival, std::vector<uint8_t>& out) {
+    ProtoWriter writer(out);
+    for (size_t i = 0; i < num_modules; i++) {
+        size_t start = writer.beginMessage(splitflap_config::MODULES);
+        writer.varint(splitflap_config::TARGET_FLAP_INDEX, modules[i].target_flap_index);
+        writer.varint(splitflap_config::MOVEMENT_NONCE, modules[i].movement_nonce);
+        writer.varint(splitflap_config::RESET_NONCE, modules[i].reset_nonce);
+        writer.endMessage(start);
+    }
+    writer.varint(splitflap_config::SYNCHRONIZED_ARRIVAL, synchronized_arrival);
+}
+
+void encodeCommand(const ModuleCommand* modules, size_t num_modules, std::vector<uint8_t>& out) {
+    ProtoWriter writer(out);
+    for (size_t i = 0; i < num_modules; i++) {
+        size_t start = writer.beginMessage(splitflap_command::MODULES);
+        writer.varint(splitflap_command::ACTION, modules[i].action);
+        writer.varint(splitflap_command::PARAM, modules[i].param);
+        writer.varint(splitflap_command::DWELL_MILLIS, modules[i].dwell_millis);
+        writer.endMessage(start);
+    }
+}
+
+void encodeRequestState(bool state_deltas, std::vector<uint8_t>& out) {
+    ProtoWriter writer(out);
+    writer.varint(request_state::STATE_DELTAS, state_deltas);
+}
+
+void encodeToSplitflap(uint32_t nonce, uint32_t payload_field, const std::vector<uint8_t>& payload, bool pipelined,
+                       std::vector<uint8_t>& out) {
+    ProtoWriter writer(out);
+    writer.varint(to_splitflap::NONCE, nonce);
+    // Written even if empty, since which payload it is matters
+    size_t start = writer.beginMessage(payload_field);
+    out.insert(out.end(), payload.begin(), payload.end());
+    writer.endMessage(start);
+    writer.varint(to_splitflap::PIPELINED, pipelined);
+}
+
+static bool parseModuleState(const uint8_t* data, size_t length, ModuleState& module) {
+    module = {};
+    ProtoReader reader(data, length);
+    while (reader.next()) {
+        uint8_t value = (uint8_t)reader.varint();
+        switch (reader.field()) {
+            case module_state::STATE:                   module.state = value; break;
+            case module_state::FLAP_INDEX:              module.flap_index = value; break;
+            case module_state::MOVING:                  module.moving = value != 0; break;
+            case module_state::HOME_STATE:              module.home_state = value != 0; break;
+            case module_state::COUNT_UNEXPECTED_HOME:   module.count_unexpected_home = value; break;
+            case module_state::COUNT_MISSED_HOME:       module.count_missed_home = value; break;
+            case module_state::QUEUE_WAIT_MILLIS:       module.queue_wait_millis = (uint16_t)reader.varint(); break;
+            case module_state::QUEUED_FLAPS:            module.queued_flaps = value; break;
+            case module_state::MAX_ACCEL_STEP:          module.max_accel_step = value; break;
+            default: break;
+        }
+    }
+    return reader.ok();
+}
+
+bool parseState(const uint8_t* data, size_t length, SplitflapState& state) {
+    // Reuses the modules vector's storage, since every state is the same size
+    size_t num_modules = 0;
+    state.loopbacks_ok = false;
+    state.generation = 0;
+    ProtoReader reader(data, length);
+    while (reader.next()) {
+        switch (reader.field()) {
+            case splitflap_state::MODULES:
+                if (num_modules == state.modules.size()) {
+                    state.modules.emplace_back();
+                }
+                if (!parseModuleState(reader.data(), reader.length(), state.modules[num_modules++])) {
+                    return false;
+                }
+                break;
+            case splitflap_state::LOOPBACKS_OK:
+                state.loopbacks_ok = reader.varint() != 0;
+                break;
+            case splitflap_state::GENERATION:
+                state.generation = (uint32_t)reader.varint();
+                break;
+            default:
+                break;
+        }
+    }
+    state.modules.resize(num_modules);
+    return reader.ok();
+}
+
+DeltaResult applyStateDelta(const uint8_t* data, size_t length, SplitflapState& state) {
+    // The module entries are only meaningful with their indices, which come after them, so find those first
+    uint32_t base_generation = 0;
+    uint32_t generation = 0;
+    bool loopbacks_ok = false;
+    const uint8_t* indices = nullptr;
+    size_t num_indices = 0;
+    ProtoReader reader(data, length);
+    while (reader.next()) {
+        switch (reader.field()) {
+            case splitflap_state_delta::BASE_GENERATION: base_generation = (uint32_t)reader.varint(); break;
+            case splitflap_state_delta::GENERATION:      generation = (uint32_t)reader.varint(); break;
+            case splitflap_state_delta::MODULE_INDICES:  indices = reader.data(); num_indices = reader.length(); break;
+            case splitflap_state_delta::LOOPBACKS_OK:    loopbacks_ok = reader.varint() != 0; break;
+            default: break;
+        }
+    }
+    if (!reader.ok()) {
+        return DeltaResult::MALFORMED;
+    }
+    if (base_generation != state.generation) {
+        return DeltaResult::WRONG_BASE;
+    }
+
+    // Check everything before changing anything, so that a bad delta doesn't leave the state half-applied
+    size_t num_modules = 0;
+    ProtoReader modules(data, length);
+    while (modules.next()) {
+        if (modules.field() == splitflap_state_delta::MODULES) {
+            if (num_modules == num_indices || indices[num_modules] >= state.modules.size()) {
+                return DeltaResult::MALFORMED;
+            }
+            ModuleState module;
+            if (!parseModuleState(modules.data(), modules.length(), module)) {
+                return DeltaResult::MALFORMED;
+            }
+            num_modules++;
+        }
+    }
+    if (num_modules != num_indices) {
+        return DeltaResult::MALFORMED;
+    }
+
+    num_modules = 0;
+    ProtoReader apply(data, length);
+    while (apply.next()) {
+        if (apply.field() == splitflap_state_delta::MODULES) {
+            parseModuleState(apply.data(), apply.length(), state.modules[indices[num_modules++]]);
+        }
+    }
+    state.loopbacks_ok = loopbacks_ok;
+    state.generation = generation;
+    return DeltaResult::APPLIED;
+}
+
+bool parseAck(const uint8_t* data, size_t length, Ack& result) {
+    result = {};
+    ProtoReader reader(data, length);
+    while (reader.next()) {
+        switch (reader.field()) {
+            case ack::NONCE:            result.nonce = (uint32_t)reader.varint(); break;
+            case ack::WINDOW_END_NONCE: result.window_end_nonce = (uint32_t)reader.varint(); break;
+            case ack::WINDOW_RECEIVED:  result.window_received = (uint32_t)reader.varint(); break;
+            default: break;
+        }
+    }
+    return reader.ok();
+}
+
+bool parseGeneralState(const uint8_t* data, size_t length, GeneralState& state) {
+    state = {};
+    ProtoReader reader(data, length);
+    while (reader.next()) {
+        switch (reader.field()) {
+            case general_state::SERIAL_PROTOCOL_VERSION:
+                state.serial_protocol_version = (uint16_t)reader.varint();
+                break;
+            case general_state::UPTIME_MILLIS:
+                state.uptime_millis = (uint32_t)reader.varint();
+                break;
+            case general_state::FLAP_CHARACTER_SET:
+                state.flap_character_set = std::string_view((const char*)reader.data(), reader.length());
+                break;
+            case general_state::MODULE_QUEUE_DEPTH:
+                state.module_queue_depth = (uint8_t)reader.varint();
+                break;
+            case general_state::MAX_ACCEL_STEP:
+                state.max_accel_step = (uint8_t)reader.varint();
+                break;
+            case general_state::ACK_WINDOW_SIZE:
+                state.ack_window_size = (uint8_t)reader.varint();
+                break;
+            default:
+                break;
+        }
+    }
+    return reader.ok();
+}
+
+bool parseLog(const uint8_t* data, size_t length, std::string_view& msg) {
+    msg = {};
+    ProtoReader reader(data, length);
+    while (reader.next()) {
+        if (reader.field() == log_message::MSG) {
+            msg = std::string_view((const char*)reader.data(), reader.length());
+        }
+    }
+    return reader.ok();
+}
+
+bool parseEnvelope(const uint8_t* data, size_t length, uint32_t& payload_field, const uint8_t*& payload,
+                   size_t& payload_length, uint32_t* nonce, bool* pipelined) {
+    payload_field = 0;
+    if (nonce) {
+        *nonce = 0;
+    }
+    if (pipelined) {
+        *pipelined = false;
+    }
+    ProtoReader reader(data, length);
+    while (reader.next()) {
+        if (reader.isLengthDelimited()) {
+            payload_field = reader.field();
+            payload = reader.data();
+            payload_length = reader.length();
+        } else if (reader.field() == to_splitflap::NONCE && nonce) {
+            *nonce = (uint32_t)reader.varint();
+        } else if (reader.field() == to_splitflap::PIPELINED && pipelined) {
+            *pipelined = reader.varint() != 0;
+        }
+    }
+    return reader.ok() && payload_field != 0;
+}
+
+void encodeAckMessage(const Ack& value, std::vector<uint8_t>& out) {
+    ProtoWriter writer(out);
+    size_t start = writer.beginMessage(from_splitflap::ACK);
+    writer.varint(ack::NONCE, value.nonce);
+    writer.varint(ack::WINDOW_END_NONCE, value.window_end_nonce);
+    writer.varint(ack::WINDOW_RECEIVED, value.window_received);
+    writer.endMessage(start);
+}
+
+void encodeGeneralStateMessage(const GeneralState& state, std::vector<uint8_t>& out) {
+    ProtoWriter writer(out);
+    size_t start = writer.beginMessage(from_splitflap::GENERAL_STATE);
+    writer.varint(general_state::SERIAL_PROTOCOL_VERSION, state.serial_protocol_version);
+    writer.varint(general_state::UPTIME_MILLIS, state.uptime_millis);
+    writer.bytes(general_state::FLAP_CHARACTER_SET, state.flap_character_set.data(), state.flap_character_set.size());
+    writer.varint(general_state::MODULE_QUEUE_DEPTH, state.module_queue_depth);
+    writer.varint(general_state::MAX_ACCEL_STEP, state.max_accel_step);
+    writer.varint(general_state::ACK_WINDOW_SIZE, state.ack_window_size);
+    writer.endMessage(start);
+}
+
+static void encodeModuleState(ProtoWriter& writer, uint32_t field, const ModuleState& module) {
+    size_t start = writer.beginMessage(field);
+    writer.varint(module_state::STATE, module.state);
+    writer.varint(module_state::FLAP_INDEX, module.flap_index);
+    writer.varint(module_state::MOVING, module.moving);
+    writer.varint(module_state::HOME_STATE, module.home_state);
+    writer.varint(module_state::COUNT_UNEXPECTED_HOME, module.count_unexpected_home);
+    writer.varint(module_state::COUNT_MISSED_HOME, module.count_missed_home);
+    writer.varint(module_state::QUEUE_WAIT_MILLIS, module.queue_wait_millis);
+    writer.varint(module_state::QUEUED_FLAPS, module.queued_flaps);
+    writer.varint(module_state::MAX_ACCEL_STEP, module.max_accel_step);
+    writer.endMessage(start);
+}
+
+void encodeStateMessage(const SplitflapState& state, std::vector<uint8_t>& out) {
+    ProtoWriter writer(out);
+    size_t start = writer.beginMessage(from_splitflap::SPLITFLAP_STATE);
+    for (const ModuleState& module : state.modules) {
+        encodeModuleState(writer, splitflap_state::MODULES, module);
+    }
+    writer.varint(splitflap_state::LOOPBACKS_OK, state.loopbacks_ok);
+    writer.varint(splitflap_state::GENERATION, state.generation);
+    writer.endMessage(start);
+}
+
+void encodeStateDeltaMessage(uint32_t base_generation, const SplitflapState& state, const std::vector<uint8_t>& indices,
+                             std::vector<uint8_t>& out) {
+    ProtoWriter writer(out);
+    size_t start = writer.beginMessage(from_splitflap::SPLITFLAP_STATE_DELTA);
+    writer.varint(splitflap_state_delta::BASE_GENERATION, base_generation);
+    writer.varint(splitflap_state_delta::GENERATION, state.generation);
+    for (uint8_t i : indices) {
+        encodeModuleState(writer, splitflap_state_delta::MODULES, state.modules[i]);
+    }
+    writer.bytes(splitflap_state_delta::MODULE_INDICES, indices.data(), indices.size());
+    writer.varint(splitflap_state_delta::LOOPBACKS_OK, state.loopbacks_ok);
+    writer.endMessage(start);
+}
+
+} // namespace splitflap
@@ -0,0 +1,144 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "splitflap/client.h"
+
+namespace splitflap {
+
+/*
+ * Just enough of the protobuf wire format for the messages in proto/splitflap.proto that the client sends and
+ * receives, encoded and parsed by hand so that received messages can be read straight out of the receive buffer.
+ * Field numbers must be kept in sync with proto/splitflap.proto.
+ */
+
+namespace to_splitflap {
+    const uint32_t NONCE = 1;
+    const uint32_t SPLITFLAP_COMMAND = 2;
+    const uint32_t SPLITFLAP_CONFIG = 3;
+    const uint32_t REQUEST_STATE = 4;
+    const uint32_t TIMELINE_UPLOAD = 5;
+    const uint32_t TIMELINE_CONTROL = 6;
+    const uint32_t PIPELINED = 7;
+}
+
+namespace from_splitflap {
+    const uint32_t SPLITFLAP_STATE = 1;
+    const uint32_t LOG = 2;
+    const uint32_t ACK = 3;
+    const uint32_t SUPERVISOR_STATE = 4;
+    const uint32_t GENERAL_STATE = 5;
+    const uint32_t SPLITFLAP_STATE_DELTA = 6;
+}
+
+class ProtoWriter {
+    public:
+        explicit ProtoWriter(std::vector<uint8_t>& out) : out_(out) {}
+
+        // Like nanopb (and proto3 in general), zero values are left out
+        void varint(uint32_t field, uint64_t value);
+        void bytes(uint32_t field, const void* data, size_t length);
+
+        /** Starts a length-delimited sub-message; pass the result to endMessage() once its fields are written */
+        size_t beginMessage(uint32_t field);
+        void endMessage(size_t start);
+
+    private:
+        std::vector<uint8_t>& out_;
+
+        void rawVarint(uint64_t value);
+};
+
+class ProtoReader {
+    public:
+        ProtoReader(const uint8_t* data, size_t length) : pos_(data), end_(data + length) {}
+
+        /** Moves on to the next field. Returns false at the end, or if the message is malformed (see ok()). */
+        bool next();
+
+        uint32_t field() const { return field_; }
+
+        // Value of the current field, if it's a varint
+        uint64_t varint() const { return varint_; }
+        // Contents of the current field, if it's length-delimited
+        const uint8_t* data() const { return data_; }
+        size_t length() const { return length_; }
+        bool isVarint() const { return wire_type_ == 0; }
+        bool isLengthDelimited() const { return wire_type_ == 2; }
+
+        bool ok() const { return ok_; }
+
+    private:
+        const uint8_t* pos_;
+        const uint8_t* end_;
+        bool ok_ = true;
+
+        uint32_t field_ = 0;
+        uint8_t wire_type_ = 0;
+        uint64_t varint_ = 0;
+        const uint8_t* data_ = nullptr;
+        size_t length_ = 0;
+
+        bool readVarint(uint64_t& value);
+};
+
+struct Ack {
+    uint32_t nonce = 0;
+    uint32_t window_end_nonce = 0;
+    uint32_t window_received = 0;
+};
+
+enum class DeltaResult {
+    APPLIED,
+    // base_generation isn't the state's generation, so a delta in between was missed
+    WRONG_BASE,
+    MALFORMED,
+};
+
+// Encoders for the payloads of ToSplitflap
+void encodeConfig(const ModuleConfig* modules, size_t num_modules, bool synchronized_arrival, std::vector<uint8_t>& out);
+void encodeCommand(const ModuleCommand* modules, size_t num_modules, std::vector<uint8_t>& out);
+void encodeRequestState(bool state_deltas, std::vector<uint8_t>& out);
+
+/** Wraps an encoded payload in a ToSplitflap message */
+void encodeToSplitflap(uint32_t nonce, uint32_t payload_field, const std::vector<uint8_t>& payload, bool pipelined,
+                       std::vector<uint8_t>& out);
+
+// Parsers for the payloads of FromSplitflap; each returns false if the message is malformed
+bool parseState(const uint8_t* data, size_t length, SplitflapState& state);
+bool parseAck(const uint8_t* data, size_t length, Ack& ack);
+bool parseGeneralState(const uint8_t* data, size_t length, GeneralState& state);
+bool parseLog(const uint8_t* data, size_t length, std::string_view& msg);
+
+/** Applies a SplitflapStateDelta to state, if it builds on state's generation */
+DeltaResult applyStateDelta(const uint8_t* data, size_t length, SplitflapState& state);
+
+/** Finds the payload of a FromSplitflap (or ToSplitflap) message, and the nonce and pipelined flag of a ToSplitflap */
+bool parseEnvelope(const uint8_t* data, size_t length, uint32_t& payload_field, const uint8_t*& payload,
+                   size_t& payload_length, uint32_t* nonce = nullptr, bool* pipelined = nullptr);
+
+// Encoders for FromSplitflap messages, for fake firmware
+void encodeAckMessage(const Ack& ack, std::vector<uint8_t>& out);
+void encodeGeneralStateMessage(const GeneralState& state, std::vector<uint8_t>& out);
+void encodeStateMessage(const SplitflapState& state, std::vector<uint8_t>& out);
+void encodeStateDeltaMessage(uint32_t base_generation, const SplitflapState& state, const std::vector<uint8_t>& indices,
+                             std::vector<uint8_t>& out);
+
+} // namespace splitflap
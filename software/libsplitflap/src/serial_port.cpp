@@ -0,0 +1,73 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "serial_port.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <system_error>
+#include <termios.h>
+#include <unistd.h>
+
+namespace splitflap {
+
+static speed_t toSpeed(uint32_t baud) {
+    switch (baud) {
+        case 9600:      return B9600;
+        case 19200:     return B19200;
+        case 38400:     return B38400;
+        case 57600:     return B57600;
+        case 115200:    return B115200;
+        case 230400:    return B230400;
+#ifdef B460800
+        case 460800:    return B460800;
+#endif
+#ifdef B921600
+        case 921600:    return B921600;
+#endif
+        default:
+            throw std::system_error(EINVAL, std::generic_category(), "Unsupported baud rate " + std::to_string(baud));
+    }
+}
+
+int openSerialPort(const std::string& path, uint32_t baud) {
+    speed_t speed = toSpeed(baud);
+
+    int fd = ::open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "Couldn't open " + path);
+    }
+
+    struct termios tty;
+    if (tcgetattr(fd, &tty) != 0) {
+        int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "Couldn't get attributes of " + path);
+    }
+    cfmakeraw(&tty);
+    tty.c_cflag |= CLOCAL | CREAD;
+    tty.c_cflag &= ~(CSTOPB | CRTSCTS);
+    cfsetispeed(&tty, speed);
+    cfsetospeed(&tty, speed);
+    if (tcsetattr(fd, TCSANOW, &tty) != 0) {
+        int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "Couldn't configure " + path);
+    }
+    tcflush(fd, TCIOFLUSH);
+    return fd;
+}
+
+} // namespace splitflap
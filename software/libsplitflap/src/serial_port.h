@@ -0,0 +1,29 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace splitflap {
+
+/**
+ * Opens a serial port in raw, non-blocking mode at the given baud rate, and returns its file descriptor. Throws
+ * std::system_error on failure.
+ */
+int openSerialPort(const std::string& path, uint32_t baud);
+
+} // namespace splitflap
@@ -0,0 +1,162 @@
+/*
+   Copyright 2024 Scott Bezek and the splitflap contributors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "splitflap/splitflap.h"
+
+#include <cerrno>
+#include <new>
+#include <system_error>
+
+#include "splitflap/client.h"
+
+using splitflap::Client;
+
+struct splitflap_client {
+    std::unique_ptr<Client> client;
+};
+
+static Client::Options toOptions(const splitflap_options* options) {
+    splitflap_options defaults;
+    if (options == nullptr) {
+        splitflap_options_init(&defaults);
+        options = &defaults;
+    }
+    Client::Options result;
+    result.baud = options->baud;
+    result.state_deltas = options->state_deltas;
+    result.retry_timeout = std::chrono::milliseconds(options->retry_timeout_millis);
+    result.max_in_flight = options->max_in_flight;
+    return result;
+}
+
+static Client::AckCallback toAckCallback(splitflap_ack_callback callback, void* user_data) {
+    if (callback == nullptr) {
+        return nullptr;
+    }
+    return [callback, user_data]() { callback(user_data); };
+}
+
+// Runs f, turning any exception into -1 and errno
+template <typename F>
+static int translateExceptions(F f) {
+    try {
+        f();
+        return 0;
+    } catch (const std::system_error& e) {
+        errno = e.code().value();
+    } catch (const std::bad_alloc&) {
+        errno = ENOMEM;
+    } catch (...) {
+        errno = EIO;
+    }
+    return -1;
+}
+
+extern "C" {
+
+void splitflap_options_init(splitflap_options* options) {
+    Client::Options defaults;
+    options->baud = defaults.baud;
+    options->state_deltas = defaults.state_deltas;
+    options->retry_timeout_millis = (uint32_t)defaults.retry_timeout.count();
+    options->max_in_flight = defaults.max_in_flight;
+}
+
+splitflap_client* splitflap_open(const char* path, const splitflap_options* options) {
+    splitflap_client* result = nullptr;
+    translateExceptions([&]() {
+        result = new splitflap_client{Client::open(path, toOptions(options))};
+    });
+    return result;
+}
+
+splitflap_client* splitflap_from_fd(int fd, const splitflap_options* options) {
+    splitflap_client* result = nullptr;
+    translateExceptions([&]() {
+        result = new splitflap_client{std::make_unique<Client>(fd, toOptions(options))};
+    });
+    return result;
+}
+
+void splitflap_close(splitflap_client* client) {
+    delete client;
+}
+
+void splitflap_set_state_callback(splitflap_client* client, splitflap_state_callback callback, void* user_data) {
+    if (callback == nullptr) {
+        client->client->onState(nullptr);
+        return;
+    }
+    client->client->onState([callback, user_data](const splitflap::SplitflapState& state) {
+        callback(state.modules.data(), state.modules.size(), state.loopbacks_ok, user_data);
+    });
+}
+
+void splitflap_set_general_state_callback(splitflap_client* client, splitflap_general_state_callback callback,
+                                          void* user_data) {
+    if (callback == nullptr) {
+        client->client->onGeneralState(nullptr);
+        return;
+    }
+    client->client->onGeneralState([callback, user_data](const splitflap::GeneralState& state) {
+        splitflap_general_state result = {};
+        result.serial_protocol_version = state.serial_protocol_version;
+        result.uptime_millis = state.uptime_millis;
+        result.flap_character_set = state.flap_character_set.data();
+        result.flap_character_set_length = state.flap_character_set.size();
+        result.module_queue_depth = state.module_queue_depth;
+        result.max_accel_step = state.max_accel_step;
+        result.ack_window_size = state.ack_window_size;
+        callback(&result, user_data);
+    });
+}
+
+void splitflap_set_log_callback(splitflap_client* client, splitflap_log_callback callback, void* user_data) {
+    if (callback == nullptr) {
+        client->client->onLog(nullptr);
+        return;
+    }
+    client->client->onLog([callback, user_data](std::string_view msg) {
+        callback(msg.data(), msg.size(), user_data);
+    });
+}
+
+int splitflap_start(splitflap_client* client) {
+    return translateExceptions([&]() { client->client->start(); });
+}
+
+int splitflap_send_config(splitflap_client* client, const splitflap_module_config* modules, size_t num_modules,
+                          bool synchronized_arrival, splitflap_ack_callback callback, void* user_data) {
+    return translateExceptions([&]() {
+        client->client->sendConfig(modules, num_modules, synchronized_arrival, toAckCallback(callback, user_data));
+    });
+}
+
+int splitflap_send_command(splitflap_client* client, const splitflap_module_command* modules, size_t num_modules,
+                           splitflap_ack_callback callback, void* user_data) {
+    return translateExceptions([&]() {
+        client->client->sendCommand(modules, num_modules, toAckCallback(callback, user_data));
+    });
+}
+
+int splitflap_request_state(splitflap_client* client, splitflap_ack_callback callback, void* user_data) {
+    return translateExceptions([&]() { client->client->requestState(toAckCallback(callback, user_data)); });
+}
+
+size_t splitflap_pending(splitflap_client* client) {
+    return client->client->pending();
+}
+
+} // extern "C"